@@ -130,3 +130,14 @@ function (add_unit_test NAME SOURCES INCLUDE_DIRS COMPILE_OPTIONS)
 endfunction (add_unit_test)
 
 enable_testing()
+
+# Add a host benchmark
+# NOTE: This assumes the benchmark is named on the form bm_<NAME>.c and provides its own main().
+# Benchmarks are registered as tests, and fail if the optimized implementation disagrees with the
+# reference implementation it is measured against.
+function (add_benchmark NAME SOURCES INCLUDE_DIRS COMPILE_OPTIONS)
+    add_executable(bm_${NAME} ${SOURCES})
+    target_compile_options(bm_${NAME} PUBLIC ${COMPILE_OPTIONS})
+    target_include_directories(bm_${NAME} PUBLIC ${INCLUDE_DIRS})
+    add_test(bm_${NAME} bm_${NAME})
+endfunction (add_benchmark)
@@ -214,7 +214,12 @@ typedef struct
 {
     /** Opcode of the message. */
     access_opcode_t opcode;
-    /** Pointer to the first byte of message data (excludes the opcode). */
+    /**
+     * Pointer to the first byte of message data (excludes the opcode).
+     *
+     * The data is borrowed from the stack's receive buffers, and is only valid for the duration of
+     * the opcode handler callback. Use @ref access_message_retain() to keep it beyond that.
+     */
     const uint8_t * p_data;
     /** Length of @c p_data. */
     uint16_t length;
@@ -222,6 +227,15 @@ typedef struct
     access_message_rx_meta_t meta_data;
 } access_message_rx_t;
 
+/** Received access message that has been copied out of the stack's receive buffers. */
+typedef struct
+{
+    /** Message, with @c p_data pointing into the buffer supplied to @ref access_message_retain(). */
+    access_message_rx_t message;
+    /** Copy of the core RX metadata, referenced by @c message.meta_data.p_core_metadata. */
+    nrf_mesh_rx_metadata_t core_metadata;
+} access_message_retained_t;
+
 /** Access layer TX parameter structure. */
 typedef struct
 {
@@ -402,6 +416,27 @@ uint32_t access_model_reply(access_model_handle_t handle,
                             const access_message_rx_t * p_message,
                             const access_message_tx_t * p_reply);
 
+/**
+ * Copies a received access message out of the stack's receive buffers.
+ *
+ * The message passed to an @ref access_opcode_handler_cb_t "opcode handler callback" references
+ * data owned by the stack. Models that need the message after the callback returns must retain it
+ * with this function, instead of holding on to the pointers in @p p_message.
+ *
+ * @param[in]  p_message     Incoming message to retain.
+ * @param[out] p_data_buffer Buffer to copy the message data into.
+ * @param[in]  buffer_size   Size of @p p_data_buffer.
+ * @param[out] p_retained    Retained message, referencing @p p_data_buffer.
+ *
+ * @retval NRF_SUCCESS          Successfully retained the message.
+ * @retval NRF_ERROR_NULL       NULL pointer supplied to function.
+ * @retval NRF_ERROR_DATA_SIZE  @p p_data_buffer is too small for the message data.
+ */
+uint32_t access_message_retain(const access_message_rx_t * p_message,
+                               uint8_t * p_data_buffer,
+                               uint16_t buffer_size,
+                               access_message_retained_t * p_retained);
+
 /**
  * Returns the element index for the model handle
  *
@@ -102,6 +102,17 @@ void dsm_init(void);
  */
 bool dsm_flash_config_load(void);
 
+/**
+ * Commit all changes that are waiting to be flashed immediately.
+ *
+ * Hands every entry pending in the write-behind window (see @ref DSM_FLASH_WRITE_BEHIND_DELAY_US)
+ * to the flash manager, without waiting for the window to expire. Call this before powering down,
+ * and wait for the flash manager to finish. If the flash manager runs out of memory, the remaining
+ * entries are committed as soon as memory is available, and @ref dsm_has_unflashed_data keeps
+ * returning true until they are.
+ */
+void dsm_flash_flush(void);
+
 /**
  * Check whether there's data waiting to be flashed.
  *
@@ -517,7 +528,11 @@ uint32_t dsm_subnet_key_get(dsm_handle_t subnet_handle, uint8_t * p_key);
  * @retval         NRF_ERROR_FORBIDDEN       The given device key has already been added before.
  * @retval         NRF_ERROR_INVALID_PARAMS  The given address isn't a unicast address.
  * @retval         NRF_ERROR_NO_MEM          The device key storage is out of space,
- *                                           @see DSM_DEVICE_MAX.
+ *                                           @see DSM_DEVICE_MAX, or all the device keys in RAM
+ *                                           are still waiting to be written to flash. The latter
+ *                                           is transient, and the call can be retried once the
+ *                                           flash manager has written them, @see
+ *                                           DSM_DEVKEY_CACHE_SIZE.
  */
 uint32_t dsm_devkey_add(uint16_t raw_unicast_addr, dsm_handle_t subnet_handle, const uint8_t * p_key, dsm_handle_t * p_devkey_handle);
 
@@ -533,6 +548,24 @@ uint32_t dsm_devkey_add(uint16_t raw_unicast_addr, dsm_handle_t subnet_handle, c
  */
 uint32_t dsm_devkey_delete(dsm_handle_t dev_handle);
 
+/**
+ * Sets the number of elements of the node that owns a device key.
+ *
+ * Device key messages to or from any of the node's elements are then encrypted with its device key.
+ * A device key covers a single element until this is called.
+ *
+ * @param[in] devkey_handle The handle for the existing device key.
+ * @param[in] element_count Number of elements of the node, starting at the device key's unicast address.
+ *
+ * @retval NRF_SUCCESS              The element count has been set successfully.
+ * @retval NRF_ERROR_NOT_FOUND      The given device key handle is not valid.
+ * @retval NRF_ERROR_INVALID_PARAM  The element count is 0, or the elements don't all have unicast addresses.
+ * @retval NRF_ERROR_FORBIDDEN      Another device key is owned by one of the elements.
+ * @retval NRF_ERROR_BUSY           The device key is only stored in flash, and the flash area is busy,
+ *                                  @see DSM_DEVKEY_CACHE_SIZE.
+ */
+uint32_t dsm_devkey_element_count_set(dsm_handle_t devkey_handle, uint16_t element_count);
+
 /**
  * Obtains the handle for a device key.
  *
@@ -688,6 +721,8 @@ uint32_t dsm_appkey_get_all(dsm_handle_t subnet_handle, mesh_key_index_t * p_key
  * @retval NRF_ERROR_NOT_FOUND The given application handle is not valid.
  * @retval NRF_ERROR_NULL An unexpected NULL pointer is given.
  * @retval NRF_ERROR_INVALID_STATE There are no allocated subnets.
+ * @retval NRF_ERROR_BUSY The device key is only stored in flash, and the flash area is busy,
+ * @see DSM_DEVKEY_CACHE_SIZE.
  */
 uint32_t dsm_tx_secmat_get(dsm_handle_t subnet_handle, dsm_handle_t app_handle, nrf_mesh_secmat_t * p_secmat);
 
@@ -65,6 +65,9 @@
 /** Invalid opcode format. */
 #define ACCESS_OPCODE_INVALID              (0x7F)
 
+/** Invalid index in the opcode dispatch index, terminating the hash bucket lists. */
+#define ACCESS_OPCODE_INDEX_INVALID        (0xFFFF)
+
 /* Internal state defines used for tracking the state of an instance. */
 #define ACCESS_INTERNAL_STATE_ALLOCATED (1 << 0)
 #define ACCESS_INTERNAL_STATE_OUTDATED  (1 << 1)
@@ -153,6 +156,17 @@ typedef struct
     uint8_t internal_state;
 } access_common_t;
 
+/** Entry in the opcode dispatch index, linking an opcode to a model that handles it. */
+typedef struct
+{
+    /** Model handling the opcode. */
+    access_model_handle_t model_handle;
+    /** Index of the opcode in the model's opcode handler list. */
+    uint16_t opcode_index;
+    /** Index of the next entry in the same hash bucket, or @ref ACCESS_OPCODE_INDEX_INVALID. */
+    uint16_t next;
+} access_opcode_index_entry_t;
+
 typedef struct
 {
     uint16_t subscription_list_count;
@@ -101,6 +101,7 @@ typedef struct
     uint16_t     key_owner;
     dsm_handle_t subnet_handle;
     uint8_t      key[NRF_MESH_KEY_SIZE];
+    uint16_t     element_count; /**< Not present in entries stored by earlier versions, which cover one element. */
 } dsm_flash_entry_devkey_t;
 
 typedef struct
@@ -81,6 +81,16 @@ static nrf_mesh_evt_handler_t m_evt_handler;
 /** Default TTL value for the node. */
 static uint8_t m_default_ttl = ACCESS_DEFAULT_TTL;
 
+/** Opcode dispatch index, with the entries of each opcode hash bucket sorted by model handle. */
+static uint16_t m_opcode_index_buckets[ACCESS_OPCODE_INDEX_BUCKET_COUNT];
+static access_opcode_index_entry_t m_opcode_index_entries[ACCESS_OPCODE_INDEX_ENTRY_COUNT];
+static uint16_t m_opcode_index_entry_count;
+/** Set when a model's opcodes didn't fit in the opcode dispatch index. */
+static bool m_opcode_index_overflow;
+
+/** Reverse subscription index, with the models subscribing to each address handle. */
+static uint32_t m_subscribed_models[DSM_ADDR_MAX][BITFIELD_BLOCK_COUNT(ACCESS_MODEL_COUNT)];
+
 /* ********** Static asserts ********** */
 
 NRF_MESH_STATIC_ASSERT(ACCESS_MODEL_COUNT > 0);
@@ -89,6 +99,8 @@ NRF_MESH_STATIC_ASSERT(ACCESS_PUBLISH_RESOLUTION_MAX <=
                        ((1 << ACCESS_PUBLISH_STEP_RES_BITS) - 1));
 NRF_MESH_STATIC_ASSERT(ACCESS_PUBLISH_PERIOD_STEP_MAX <=
                        ((1 << ACCESS_PUBLISH_STEP_NUM_BITS) - 1));
+NRF_MESH_STATIC_ASSERT(IS_POWER_OF_2(ACCESS_OPCODE_INDEX_BUCKET_COUNT));
+NRF_MESH_STATIC_ASSERT(ACCESS_OPCODE_INDEX_ENTRY_COUNT < ACCESS_OPCODE_INDEX_INVALID);
 
 /* ********** Static functions ********** */
 
@@ -211,7 +223,7 @@ static bool opcodes_are_valid(const access_opcode_handler_t * p_opcode_handlers,
     return true;
 }
 
-static bool is_opcode_of_model(access_common_t * p_model, access_opcode_t opcode, uint32_t * p_opcode_index)
+static bool is_opcode_of_model(const access_common_t * p_model, access_opcode_t opcode, uint32_t * p_opcode_index)
 {
     for (uint32_t i = 0; i < p_model->opcode_count; ++i)
     {
@@ -225,6 +237,65 @@ static bool is_opcode_of_model(access_common_t * p_model, access_opcode_t opcode
     return false;
 }
 
+static inline uint32_t opcode_index_hash(access_opcode_t opcode)
+{
+    return (opcode.opcode ^ (opcode.opcode >> 8) ^ opcode.company_id) & (ACCESS_OPCODE_INDEX_BUCKET_COUNT - 1);
+}
+
+static void opcode_index_clear(void)
+{
+    for (uint32_t i = 0; i < ACCESS_OPCODE_INDEX_BUCKET_COUNT; ++i)
+    {
+        m_opcode_index_buckets[i] = ACCESS_OPCODE_INDEX_INVALID;
+    }
+    m_opcode_index_entry_count = 0;
+    m_opcode_index_overflow = false;
+}
+
+/**
+ * Adds the opcodes of a model to the opcode dispatch index.
+ *
+ * Entries are kept sorted by model handle within each bucket, so models are called in the same
+ * order as when searching all models. If an opcode occurs more than once in a model's opcode list,
+ * only the first handler is indexed.
+ *
+ * @param[in] handle Handle of the model to add.
+ */
+static void opcode_index_model_add(access_model_handle_t handle)
+{
+    const access_common_t * p_model = &m_model_pool[handle];
+
+    if (m_opcode_index_entry_count + p_model->opcode_count > ACCESS_OPCODE_INDEX_ENTRY_COUNT)
+    {
+        __LOG(LOG_SRC_ACCESS, LOG_LEVEL_WARN, "Opcode index full, dispatching by searching all models\n");
+        m_opcode_index_overflow = true;
+        return;
+    }
+
+    for (uint16_t i = 0; i < p_model->opcode_count; ++i)
+    {
+        uint32_t first_index;
+        (void) is_opcode_of_model(p_model, p_model->p_opcode_handlers[i].opcode, &first_index);
+        if (first_index != i)
+        {
+            continue;
+        }
+
+        uint16_t * p_next = &m_opcode_index_buckets[opcode_index_hash(p_model->p_opcode_handlers[i].opcode)];
+        while (*p_next != ACCESS_OPCODE_INDEX_INVALID &&
+               m_opcode_index_entries[*p_next].model_handle < handle)
+        {
+            p_next = &m_opcode_index_entries[*p_next].next;
+        }
+
+        access_opcode_index_entry_t * p_entry = &m_opcode_index_entries[m_opcode_index_entry_count];
+        p_entry->model_handle = handle;
+        p_entry->opcode_index = i;
+        p_entry->next = *p_next;
+        *p_next = m_opcode_index_entry_count++;
+    }
+}
+
 static inline bool model_handle_valid_and_allocated(access_model_handle_t handle)
 {
     return (handle < ACCESS_MODEL_COUNT && ACCESS_INTERNAL_STATE_IS_ALLOCATED(m_model_pool[handle].internal_state));
@@ -418,6 +489,8 @@ static void access_state_clear(void)
     memset(&m_model_pool[0], 0, sizeof(m_model_pool));
     memset(&m_element_pool[0], 0, sizeof(m_element_pool));
     memset(&m_subscription_list_pool[0], 0, sizeof(m_subscription_list_pool));
+    memset(&m_subscribed_models[0][0], 0, sizeof(m_subscribed_models));
+    opcode_index_clear();
     for (uint16_t i = 0; i < sizeof(m_model_pool)/sizeof(m_model_pool[0]); ++i)
     {
         m_model_pool[i].model_info.publish_address_handle = DSM_HANDLE_INVALID;
@@ -427,11 +500,59 @@ static void access_state_clear(void)
     }
 }
 
-static bool model_subscribes_to_addr(const access_common_t * p_model, dsm_handle_t address_handle)
+static inline bool model_subscribes_to_addr(access_model_handle_t handle, dsm_handle_t address_handle)
+{
+    return bitfield_get(m_subscribed_models[address_handle], handle);
+}
+
+/**
+ * Updates the reverse subscription index for all models using a subscription list.
+ *
+ * @param[in] list_index     Index of the subscription list that changed.
+ * @param[in] address_handle Address handle added to or removed from the list.
+ * @param[in] subscribed     Whether the address handle was added to the list.
+ */
+static void subscription_index_list_update(uint16_t list_index, dsm_handle_t address_handle, bool subscribed)
+{
+    for (access_model_handle_t i = 0; i < ACCESS_MODEL_COUNT; ++i)
+    {
+        if (m_model_pool[i].model_info.subscription_pool_index == list_index)
+        {
+            if (subscribed)
+            {
+                bitfield_set(m_subscribed_models[address_handle], i);
+            }
+            else
+            {
+                bitfield_clear(m_subscribed_models[address_handle], i);
+            }
+        }
+    }
+}
+
+/** Adds all subscriptions in a model's subscription list to the reverse subscription index. */
+static void subscription_index_model_add(access_model_handle_t handle)
+{
+    const uint16_t list_index = m_model_pool[handle].model_info.subscription_pool_index;
+    if (list_index < ACCESS_SUBSCRIPTION_LIST_COUNT)
+    {
+        const access_subscription_list_t * p_sub = &m_subscription_list_pool[list_index];
+        for (uint32_t i = bitfield_next_get(p_sub->bitfield, DSM_ADDR_MAX, 0);
+             i != DSM_ADDR_MAX;
+             i = bitfield_next_get(p_sub->bitfield, DSM_ADDR_MAX, i+1))
+        {
+            bitfield_set(m_subscribed_models[i], handle);
+        }
+    }
+}
+
+static void subscription_index_rebuild(void)
 {
-    return (p_model->model_info.subscription_pool_index < ACCESS_SUBSCRIPTION_LIST_COUNT &&
-            bitfield_get(m_subscription_list_pool[p_model->model_info.subscription_pool_index].bitfield,
-                         address_handle));
+    memset(&m_subscribed_models[0][0], 0, sizeof(m_subscribed_models));
+    for (access_model_handle_t i = 0; i < ACCESS_MODEL_COUNT; ++i)
+    {
+        subscription_index_model_add(i);
+    }
 }
 
 /**
@@ -852,6 +973,7 @@ bool access_flash_config_load(void)
     {
         m_metadata_stored = true;
         config_restored = restore_subscription_lists() && restore_elements() && restore_models();
+        subscription_index_rebuild();
     }
 
     if (!config_restored)
@@ -932,6 +1054,43 @@ void access_flash_config_store(void)
 }
 #endif /* PERSISTENT_STORAGE */
 
+/**
+ * Checks whether a model should receive a message, apart from handling its opcode.
+ *
+ * @param[in] handle             Model to check.
+ * @param[in] p_message          Incoming message.
+ * @param[in] is_element_message Whether the message is addressed to an element.
+ * @param[in] element_index      Element the message is addressed to, if @p is_element_message.
+ * @param[in] address_handle     Subscription address the message is addressed to, otherwise.
+ *
+ * @returns Whether the model is addressed and bound to the application key of the message.
+ */
+static bool model_accepts_message(access_model_handle_t handle,
+                                  const access_message_rx_t * p_message,
+                                  bool is_element_message,
+                                  uint16_t element_index,
+                                  dsm_handle_t address_handle)
+{
+    const access_common_t * p_model = &m_model_pool[handle];
+    bool address_match =
+        (is_element_message ? (p_model->model_info.element_index == element_index)
+                            : (model_subscribes_to_addr(handle, address_handle)));
+
+    return (ACCESS_INTERNAL_STATE_IS_ALLOCATED(p_model->internal_state) &&
+            address_match &&
+            bitfield_get(p_model->model_info.application_keys_bitfield, p_message->meta_data.appkey_handle));
+}
+
+static void model_message_dispatch(access_model_handle_t handle, uint32_t opcode_index, const access_message_rx_t * p_message)
+{
+    access_common_t * p_model = &m_model_pool[handle];
+    if (p_message->meta_data.dst.type == NRF_MESH_ADDRESS_TYPE_UNICAST)
+    {
+        access_reliable_message_rx_cb(handle, p_message, p_model->p_args);
+    }
+    p_model->p_opcode_handlers[opcode_index].handler(handle, p_message, p_model->p_args);
+}
+
 /* ********** Private API ********** */
 void access_incoming_handle(const access_message_rx_t * p_message)
 {
@@ -949,25 +1108,48 @@ void access_incoming_handle(const access_message_rx_t * p_message)
             NRF_MESH_ERROR_CHECK(dsm_address_handle_get(p_dst, &address_handle));
         }
 
-        for (int i = 0; i < ACCESS_MODEL_COUNT; ++i)
+        if (m_opcode_index_overflow)
         {
-            access_common_t * p_model = &m_model_pool[i];
-            uint32_t opcode_index;
-
-            bool address_match =
-                (is_element_message ? (p_model->model_info.element_index == element_index)
-                                    : (model_subscribes_to_addr(p_model, address_handle)));
+            uint32_t candidates[BITFIELD_BLOCK_COUNT(ACCESS_MODEL_COUNT)];
+            if (is_element_message)
+            {
+                bitfield_set_all(candidates, ACCESS_MODEL_COUNT);
+            }
+            else
+            {
+                /* Only visit the models subscribing to the address. */
+                memcpy(candidates, m_subscribed_models[address_handle], sizeof(candidates));
+            }
 
-            if (ACCESS_INTERNAL_STATE_IS_ALLOCATED(p_model->internal_state) &&
-                address_match &&
-                bitfield_get(p_model->model_info.application_keys_bitfield, p_message->meta_data.appkey_handle) &&
-                is_opcode_of_model(p_model, p_message->opcode, &opcode_index))
+            for (uint32_t i = bitfield_next_get(candidates, ACCESS_MODEL_COUNT, 0);
+                 i < ACCESS_MODEL_COUNT;
+                 i = bitfield_next_get(candidates, ACCESS_MODEL_COUNT, i+1))
+            {
+                uint32_t opcode_index;
+                if (model_accepts_message(i, p_message, is_element_message, element_index, address_handle) &&
+                    is_opcode_of_model(&m_model_pool[i], p_message->opcode, &opcode_index))
+                {
+                    model_message_dispatch(i, opcode_index, p_message);
+                }
+            }
+        }
+        else
+        {
+            uint16_t index = m_opcode_index_buckets[opcode_index_hash(p_message->opcode)];
+            while (index != ACCESS_OPCODE_INDEX_INVALID)
             {
-                if (p_dst->type == NRF_MESH_ADDRESS_TYPE_UNICAST)
+                const access_opcode_index_entry_t * p_entry = &m_opcode_index_entries[index];
+                const access_common_t * p_model = &m_model_pool[p_entry->model_handle];
+                const access_opcode_t * p_opcode = &p_model->p_opcode_handlers[p_entry->opcode_index].opcode;
+                /* The handler may change the index, get the next entry first. */
+                index = p_entry->next;
+
+                if (p_opcode->opcode == p_message->opcode.opcode &&
+                    p_opcode->company_id == p_message->opcode.company_id &&
+                    model_accepts_message(p_entry->model_handle, p_message, is_element_message, element_index, address_handle))
                 {
-                    access_reliable_message_rx_cb(i, p_message, p_model->p_args);
+                    model_message_dispatch(p_entry->model_handle, p_entry->opcode_index, p_message);
                 }
-                p_model->p_opcode_handlers[opcode_index].handler(i, p_message, p_model->p_args);
             }
         }
     }
@@ -1055,6 +1237,7 @@ uint32_t access_model_add(const access_model_add_params_t * p_model_params,
     m_model_pool[*p_model_handle].publication_state.publish_timeout_cb = p_model_params->publish_timeout_cb;
     m_model_pool[*p_model_handle].publication_state.model_handle = *p_model_handle;
     ACCESS_INTERNAL_STATE_ALLOCATED_SET(m_model_pool[*p_model_handle].internal_state);
+    opcode_index_model_add(*p_model_handle);
 
     return NRF_SUCCESS;
 }
@@ -1085,6 +1268,36 @@ uint32_t access_model_reply(access_model_handle_t handle,
     }
 }
 
+uint32_t access_message_retain(const access_message_rx_t * p_message,
+                               uint8_t * p_data_buffer,
+                               uint16_t buffer_size,
+                               access_message_retained_t * p_retained)
+{
+    if (p_message == NULL || p_retained == NULL || (p_data_buffer == NULL && p_message->length > 0))
+    {
+        return NRF_ERROR_NULL;
+    }
+    else if (p_message->length > buffer_size)
+    {
+        return NRF_ERROR_DATA_SIZE;
+    }
+    else
+    {
+        if (p_message->length > 0)
+        {
+            memcpy(p_data_buffer, p_message->p_data, p_message->length);
+        }
+        p_retained->message = *p_message;
+        p_retained->message.p_data = p_data_buffer;
+        if (p_message->meta_data.p_core_metadata != NULL)
+        {
+            p_retained->core_metadata = *p_message->meta_data.p_core_metadata;
+            p_retained->message.meta_data.p_core_metadata = &p_retained->core_metadata;
+        }
+        return NRF_SUCCESS;
+    }
+}
+
 uint32_t access_model_element_index_get(access_model_handle_t handle, uint16_t * p_element_index)
 {
     if (p_element_index == NULL)
@@ -1282,6 +1495,7 @@ uint32_t access_model_subscription_lists_share(access_model_handle_t owner, acce
         {
             m_model_pool[other].model_info.subscription_pool_index = m_model_pool[owner].model_info.subscription_pool_index;
             ACCESS_INTERNAL_STATE_OUTDATED_SET(m_model_pool[other].internal_state);
+            subscription_index_model_add(other);
             status = NRF_SUCCESS;
         }
     }
@@ -1311,6 +1525,7 @@ uint32_t access_model_subscription_add(access_model_handle_t handle, dsm_handle_
     {
         bitfield_set(m_subscription_list_pool[m_model_pool[handle].model_info.subscription_pool_index].bitfield, address_handle);
         ACCESS_INTERNAL_STATE_OUTDATED_SET(m_subscription_list_pool[m_model_pool[handle].model_info.subscription_pool_index].internal_state);
+        subscription_index_list_update(m_model_pool[handle].model_info.subscription_pool_index, address_handle, true);
         return NRF_SUCCESS;
     }
 }
@@ -1337,6 +1552,7 @@ uint32_t access_model_subscription_remove(access_model_handle_t handle, dsm_hand
     {
         bitfield_clear(m_subscription_list_pool[m_model_pool[handle].model_info.subscription_pool_index].bitfield, address_handle);
         ACCESS_INTERNAL_STATE_OUTDATED_SET(m_subscription_list_pool[m_model_pool[handle].model_info.subscription_pool_index].internal_state);
+        subscription_index_list_update(m_model_pool[handle].model_info.subscription_pool_index, address_handle, false);
         return NRF_SUCCESS;
     }
 }
@@ -1359,19 +1575,19 @@ uint32_t access_model_subscriptions_get(access_model_handle_t handle,
     }
     else
     {
+        const access_subscription_list_t * p_sub = &m_subscription_list_pool[m_model_pool[handle].model_info.subscription_pool_index];
         const uint32_t max_count = *p_count;
         *p_count = 0;
-        for (uint32_t i = 0; i < DSM_ADDR_MAX; ++i)
+        for (uint32_t i = bitfield_next_get(p_sub->bitfield, DSM_ADDR_MAX, 0);
+             i != DSM_ADDR_MAX;
+             i = bitfield_next_get(p_sub->bitfield, DSM_ADDR_MAX, i+1))
         {
-            if (model_subscribes_to_addr(&m_model_pool[handle], i))
+            if (*p_count >= max_count)
             {
-                if (*p_count >= max_count)
-                {
-                    return NRF_ERROR_INVALID_LENGTH;
-                }
-                p_address_handles[*p_count] = i;
-                (*p_count)++;
+                return NRF_ERROR_INVALID_LENGTH;
             }
+            p_address_handles[*p_count] = i;
+            (*p_count)++;
         }
         return NRF_SUCCESS;
     }
@@ -45,6 +45,7 @@
 #include "nrf_mesh_defines.h"
 #include "packet_mesh.h"
 #include "nrf_mesh_keygen.h"
+#include "enc.h"
 #include "nrf_mesh_utils.h"
 #include "nrf_mesh_assert.h"
 #include "bitfield.h"
@@ -59,6 +60,10 @@
 #if PERSISTENT_STORAGE
 #include "flash_manager.h"
 #include "device_state_manager_flash.h"
+#if DSM_FLASH_WRITE_BEHIND_DELAY_US > 0
+#include "timer.h"
+#include "timer_scheduler.h"
+#endif
 #endif
 
 #if GATT_PROXY
@@ -83,6 +88,45 @@
  * handle starts after the last nonvirtual handle */
 #define DSM_VIRTUAL_HANDLE_START     DSM_NONVIRTUAL_ADDR_MAX
 
+/** Number of network security materials per subnet: the current and the key refresh updated one. */
+#define SUBNET_SECMAT_COUNT         (2)
+/** Index of the current network security material of a subnet. */
+#define SUBNET_SECMAT_CURRENT       (0)
+/** Index of the updated network security material of a subnet. */
+#define SUBNET_SECMAT_UPDATED       (1)
+
+/** Number of NID lookup buckets, one for every possible 7-bit NID. */
+#define NID_BUCKET_COUNT            (PACKET_MESH_NET_NID_MASK + 1)
+/** Empty NID bucket, or end of a NID bucket chain. */
+#define NID_ENTRY_NONE              (0)
+/** Flag in @ref subnet_t::nid_bucket, set when the security material is linked into a NID bucket. */
+#define NID_BUCKET_LINKED           (PACKET_MESH_NET_NID_MASK_INV)
+
+/** Number of application security materials per appkey: the current and the key refresh updated one. */
+#define APPKEY_SECMAT_COUNT         (2)
+/** Index of the current application security material of an appkey. */
+#define APPKEY_SECMAT_CURRENT       (0)
+/** Index of the updated application security material of an appkey. */
+#define APPKEY_SECMAT_UPDATED       (1)
+
+/** Number of AID lookup buckets in each subnet, one for every possible 6-bit AID. */
+#define AID_BUCKET_COUNT            (PACKET_MESH_TRS_ACCESS_AID_MASK + 1)
+/** Empty AID bucket, or end of an AID bucket chain. */
+#define AID_ENTRY_NONE              (0)
+/** Flag in @ref appkey_t::aid_bucket, set when the security material is linked into an AID bucket. */
+#define AID_BUCKET_LINKED           (0x80)
+
+/** Number of devkey lookup buckets. Unicast addresses are mostly handed out in sequence, so
+ * hashing on the address modulo the number of devkeys spreads them evenly. */
+#define DEVKEY_BUCKET_COUNT         (DSM_DEVICE_MAX)
+/** Empty devkey bucket, or end of a devkey bucket chain. */
+#define DEVKEY_ENTRY_NONE           (0)
+
+/** Number of bits in the RX address prefilter. */
+#define RX_ADDRESS_FILTER_BITS      (512)
+/** Number of prefilter bits set for each subscribed address. */
+#define RX_ADDRESS_FILTER_HASHES    (2)
+
 #if PERSISTENT_STORAGE
 /** Margin to leave on each flash page, to accommodate padding. We'll never pad more than what's
  * required to fit the largest entry. */
@@ -118,6 +162,16 @@ NRF_MESH_STATIC_ASSERT(DSM_VIRTUAL_HANDLE_START + DSM_VIRTUAL_ADDR_MAX < DSM_FLA
 NRF_MESH_STATIC_ASSERT(DSM_APP_MAX >= 1);
 NRF_MESH_STATIC_ASSERT(DSM_SUBNET_MAX >= 1);
 NRF_MESH_STATIC_ASSERT(DSM_DEVICE_MAX >= 1);
+NRF_MESH_STATIC_ASSERT(DSM_DEVICE_MAX < UINT16_MAX);
+NRF_MESH_STATIC_ASSERT(DSM_DEVKEY_CACHE_SIZE >= 1 && DSM_DEVKEY_CACHE_SIZE <= DSM_DEVICE_MAX);
+/* Device keys can only be evicted from RAM if they're kept in flash. Both the source and the
+ * destination device key of a message must fit in the cache at once: */
+NRF_MESH_STATIC_ASSERT(DSM_DEVKEY_CACHE_SIZE == DSM_DEVICE_MAX ||
+                       (PERSISTENT_STORAGE && DSM_DEVKEY_CACHE_SIZE >= 2));
+/* NID bucket entries encode the subnet handle and secmat index in a single byte: */
+NRF_MESH_STATIC_ASSERT(DSM_SUBNET_MAX * SUBNET_SECMAT_COUNT < UINT8_MAX);
+/* AID bucket entries encode the appkey handle and secmat index in a single byte: */
+NRF_MESH_STATIC_ASSERT(DSM_APP_MAX * APPKEY_SECMAT_COUNT < UINT8_MAX);
 
 /*****************************************************************************
 * Local typedefs
@@ -139,6 +193,15 @@ typedef struct
         nrf_mesh_beacon_tx_info_t tx_info;
         nrf_mesh_beacon_info_t info;
     } beacon;
+
+    /** Next entry in the NID bucket chain of each security material. */
+    uint8_t nid_next[SUBNET_SECMAT_COUNT];
+    /** NID bucket each security material is linked into, with @ref NID_BUCKET_LINKED set, or 0 if unlinked. */
+    uint8_t nid_bucket[SUBNET_SECMAT_COUNT];
+
+    /** Application security materials bound to this subnet by AID. Each bucket is the head of a
+     * chain of AID entries through @ref appkey_t::aid_next, sorted by appkey handle. */
+    uint8_t aid_buckets[AID_BUCKET_COUNT];
 } subnet_t;
 
 typedef struct
@@ -149,16 +212,31 @@ typedef struct
 
     bool key_updated;
     nrf_mesh_application_secmat_t secmat_updated;
+
+    /** Next entry in the AID bucket chain of each security material. */
+    uint8_t aid_next[APPKEY_SECMAT_COUNT];
+    /** AID bucket each security material is linked into, with @ref AID_BUCKET_LINKED set, or 0 if unlinked. */
+    uint8_t aid_bucket[APPKEY_SECMAT_COUNT];
 } appkey_t;
 
-/** Device key instance. */
+/** Device key instance. The key itself is only kept in RAM while it's in a @ref devkey_slot_t. */
 typedef struct
 {
     uint16_t key_owner; /**< Unicast address of the device that owns the devkey. */
     dsm_handle_t subnet_handle; /**< Subnetwork this device key is bound to. */
-    nrf_mesh_application_secmat_t secmat; /**< Security material for packet encryption and decryption. */
+    uint16_t bucket_next; /**< Next entry in the devkey bucket chain of the key owner. */
+    uint16_t slot; /**< Cache slot holding the key (slot index + 1), or @ref DEVKEY_ENTRY_NONE if it's only in flash. */
+    uint16_t element_count; /**< Number of elements of the key owner, starting at @c key_owner. */
 } devkey_t;
 
+/** Device key cache slot. */
+typedef struct
+{
+    nrf_mesh_application_secmat_t secmat; /**< Security material for packet encryption and decryption. */
+    uint16_t entry; /**< Devkey held by this slot (devkey index + 1), or @ref DEVKEY_ENTRY_NONE if it's free. */
+    uint32_t last_used; /**< Value of @ref m_devkey_slot_clock when the key was last used. */
+} devkey_slot_t;
+
 typedef struct
 {
     uint16_t address;
@@ -233,8 +311,30 @@ static dsm_local_unicast_address_t m_local_unicast_addr;
 static subnet_t m_subnets[DSM_SUBNET_MAX];
 /** Security information associated with each appkey */
 static appkey_t m_appkeys[DSM_APP_MAX];
-/** Security information associated with each devkey */
+/** Information associated with each devkey */
 static devkey_t m_devkeys[DSM_DEVICE_MAX];
+/** Device keys kept in RAM. */
+static devkey_slot_t m_devkey_slots[DSM_DEVKEY_CACHE_SIZE];
+/** Device key cache use counter, for finding the least recently used slot. */
+static uint32_t m_devkey_slot_clock;
+/** Upper bound for the element count of any devkey owner, limiting the element range lookup. */
+static uint16_t m_devkey_element_count_max = 1;
+
+/** Network security materials by NID. Each bucket is the head of a chain of NID entries through
+ * @ref subnet_t::nid_next, sorted by subnet handle. */
+static uint8_t m_nid_buckets[NID_BUCKET_COUNT];
+
+/** Raw values of the subscribed nonvirtual addresses, sorted for binary search. */
+static uint16_t m_rx_nonvirtual_addresses[DSM_NONVIRTUAL_ADDR_MAX];
+/** Number of addresses in @ref m_rx_nonvirtual_addresses. */
+static uint16_t m_rx_nonvirtual_address_count;
+/** Bloom filter of the raw values of all subscribed addresses, rejecting most other addresses
+ * before searching the address lists. */
+static uint32_t m_rx_address_filter[BITFIELD_BLOCK_COUNT(RX_ADDRESS_FILTER_BITS)];
+
+/** Devkeys by owner address. Each bucket is the head of a chain of devkey entries (devkey index + 1)
+ * through @ref devkey_t::bucket_next. */
+static uint16_t m_devkey_buckets[DEVKEY_BUCKET_COUNT];
 
 /** Flag indicating whether the device is part of the primary subnet */
 static bool m_has_primary_subnet;
@@ -263,6 +363,9 @@ static uint32_t m_devkey_needs_flashing[BITFIELD_BLOCK_COUNT(DSM_DEVICE_MAX)];
 
 static bool flash_save(dsm_entry_type_t type, uint32_t index);
 static bool flash_invalidate(dsm_entry_type_t type, uint32_t index);
+#if PERSISTENT_STORAGE
+static const dsm_flash_entry_devkey_t * devkey_flash_entry_get(uint32_t index, uint16_t * p_element_count);
+#endif
 
 /* Checks if a given address handle is a valid non-virtual address handle. */
 static inline bool address_handle_nonvirtual_valid(dsm_handle_t address_handle)
@@ -363,26 +466,128 @@ static bool address_exists(uint16_t address, dsm_handle_t * p_handle, nrf_mesh_a
     return false;
 }
 
-/** Checks if the given nonvirtual address exists in the rx address list.
- *  Returns a suitable location for a new group rx address if it does not.
- */
-static bool address_nonvirtual_subscription_exists(uint16_t address, dsm_handle_t * p_handle)
+static inline uint32_t rx_address_filter_bit(uint16_t address, uint32_t hash_index)
 {
-    *p_handle = DSM_HANDLE_INVALID;
-    for (uint32_t i = 0; i < DSM_NONVIRTUAL_ADDR_MAX; ++i)
+    /* Group addresses are usually allocated in sequence, spread neighbours across the filter. */
+    uint32_t hash = (uint32_t) address * (hash_index == 0 ? 0x9E3779B1u : 0x85EBCA77u);
+    return (hash >> 16) % RX_ADDRESS_FILTER_BITS;
+}
+
+static void rx_address_filter_add(uint16_t address)
+{
+    for (uint32_t i = 0; i < RX_ADDRESS_FILTER_HASHES; ++i)
+    {
+        bitfield_set(m_rx_address_filter, rx_address_filter_bit(address, i));
+    }
+}
+
+static bool rx_address_filter_may_contain(uint16_t address)
+{
+    for (uint32_t i = 0; i < RX_ADDRESS_FILTER_HASHES; ++i)
     {
-        if (*p_handle == DSM_HANDLE_INVALID && !bitfield_get(m_addr_nonvirtual_allocated, i))
+        if (!bitfield_get(m_rx_address_filter, rx_address_filter_bit(address, i)))
         {
-            *p_handle = i;
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Rebuilds the RX address prefilter, as addresses can't be removed from it. */
+static void rx_address_filter_rebuild(void)
+{
+    bitfield_clear_all(m_rx_address_filter, RX_ADDRESS_FILTER_BITS);
+    for (uint32_t i = 0; i < m_rx_nonvirtual_address_count; ++i)
+    {
+        rx_address_filter_add(m_rx_nonvirtual_addresses[i]);
+    }
+    for (uint32_t i = 0; i < DSM_VIRTUAL_ADDR_MAX; ++i)
+    {
+        if (bitfield_get(m_addr_virtual_allocated, i) && m_virtual_addresses[i].subscription_count > 0)
+        {
+            rx_address_filter_add(m_virtual_addresses[i].address);
         }
-        else if (m_addresses[i].address == address && m_addresses[i].subscription_count > 0)
+    }
+}
+
+/** Gets the position of the first subscribed nonvirtual address that isn't lower than the given one. */
+static uint32_t rx_nonvirtual_address_lower_bound(uint16_t address)
+{
+    uint32_t low = 0;
+    uint32_t high = m_rx_nonvirtual_address_count;
+    while (low < high)
+    {
+        uint32_t mid = (low + high) / 2;
+        if (m_rx_nonvirtual_addresses[mid] < address)
         {
-            *p_handle = i;
-            return true;
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
         }
     }
+    return low;
+}
 
-    return false;
+/** Checks if the given nonvirtual address is subscribed to. */
+static bool rx_nonvirtual_address_exists(uint16_t address)
+{
+    if (!rx_address_filter_may_contain(address))
+    {
+        return false;
+    }
+    uint32_t index = rx_nonvirtual_address_lower_bound(address);
+    return (index < m_rx_nonvirtual_address_count && m_rx_nonvirtual_addresses[index] == address);
+}
+
+/** Adds an address to the RX address lookups, when its subscription count becomes nonzero. */
+static void rx_address_subscribed(dsm_handle_t address_handle)
+{
+    if (address_handle < DSM_NONVIRTUAL_ADDR_MAX)
+    {
+        uint16_t address = m_addresses[address_handle].address;
+        uint32_t index = rx_nonvirtual_address_lower_bound(address);
+        NRF_MESH_ASSERT(m_rx_nonvirtual_address_count < DSM_NONVIRTUAL_ADDR_MAX);
+        memmove(&m_rx_nonvirtual_addresses[index + 1],
+                &m_rx_nonvirtual_addresses[index],
+                (m_rx_nonvirtual_address_count - index) * sizeof(m_rx_nonvirtual_addresses[0]));
+        m_rx_nonvirtual_addresses[index] = address;
+        m_rx_nonvirtual_address_count++;
+        rx_address_filter_add(address);
+    }
+    else
+    {
+        rx_address_filter_add(m_virtual_addresses[address_handle - DSM_VIRTUAL_HANDLE_START].address);
+    }
+}
+
+/** Removes an address from the RX address lookups, when its subscription count drops to zero. */
+static void rx_address_unsubscribed(dsm_handle_t address_handle)
+{
+    if (address_handle < DSM_NONVIRTUAL_ADDR_MAX)
+    {
+        uint32_t index = rx_nonvirtual_address_lower_bound(m_addresses[address_handle].address);
+        NRF_MESH_ASSERT(index < m_rx_nonvirtual_address_count &&
+                        m_rx_nonvirtual_addresses[index] == m_addresses[address_handle].address);
+        m_rx_nonvirtual_address_count--;
+        memmove(&m_rx_nonvirtual_addresses[index],
+                &m_rx_nonvirtual_addresses[index + 1],
+                (m_rx_nonvirtual_address_count - index) * sizeof(m_rx_nonvirtual_addresses[0]));
+    }
+    rx_address_filter_rebuild();
+}
+
+/** Increments the subscription count of an address, and adds it to the RX address lookups if needed. */
+static void address_subscription_count_increment(dsm_handle_t address_handle)
+{
+    uint8_t * p_count = (address_handle < DSM_NONVIRTUAL_ADDR_MAX)
+                            ? &m_addresses[address_handle].subscription_count
+                            : &m_virtual_addresses[address_handle - DSM_VIRTUAL_HANDLE_START].subscription_count;
+    if ((*p_count)++ == 0)
+    {
+        rx_address_subscribed(address_handle);
+    }
 }
 
 /** Gets the group address if it's in the address subscription list.
@@ -413,10 +618,7 @@ static bool rx_group_address_get(uint16_t address, nrf_mesh_address_t * p_addres
         case NRF_MESH_ALL_NODES_ADDR:
             return true;
         default:
-        {
-            dsm_handle_t handle;
-            return address_nonvirtual_subscription_exists(address, &handle);
-        }
+            return rx_nonvirtual_address_exists(address);
     }
 }
 
@@ -483,6 +685,11 @@ static bool virtual_address_uuid_index_get(const uint8_t * p_uuid, uint16_t * p_
  */
 static bool rx_virtual_address_get(uint16_t address, nrf_mesh_address_t * p_address)
 {
+    if (!rx_address_filter_may_contain(address))
+    {
+        return false;
+    }
+
     uint16_t virtual_addr_index;
     /* Set the virtual_addr_index to the given uuid if it exists.*/
     if (NULL == p_address->p_virtual_uuid || !virtual_address_uuid_index_get(p_address->p_virtual_uuid, &virtual_addr_index))
@@ -555,26 +762,270 @@ static inline bool net_key_handle_get(mesh_key_index_t net_key_index, dsm_handle
     return false;
 }
 
+static inline uint16_t * devkey_bucket_get(uint16_t owner_addr)
+{
+    return &m_devkey_buckets[owner_addr % DEVKEY_BUCKET_COUNT];
+}
+
+static void devkey_entry_link(uint32_t index)
+{
+    uint16_t * p_bucket = devkey_bucket_get(m_devkeys[index].key_owner);
+    m_devkeys[index].bucket_next = *p_bucket;
+    *p_bucket = (uint16_t) (index + 1);
+}
+
+static void devkey_entry_unlink(uint32_t index)
+{
+    uint16_t * p_link = devkey_bucket_get(m_devkeys[index].key_owner);
+    while (*p_link != index + 1)
+    {
+        NRF_MESH_ASSERT(*p_link != DEVKEY_ENTRY_NONE);
+        p_link = &m_devkeys[*p_link - 1].bucket_next;
+    }
+    *p_link = m_devkeys[index].bucket_next;
+}
+
+/** Gets the index of the devkey owned by the given address, or @ref DSM_DEVICE_MAX if there is none. */
+static uint32_t devkey_index_get(uint16_t owner_addr)
+{
+    for (uint16_t entry = *devkey_bucket_get(owner_addr);
+         entry != DEVKEY_ENTRY_NONE;
+         entry = m_devkeys[entry - 1].bucket_next)
+    {
+        if (m_devkeys[entry - 1].key_owner == owner_addr)
+        {
+            return entry - 1;
+        }
+    }
+    return DSM_DEVICE_MAX;
+}
+
+/** Gets the index of the devkey whose owner's element range covers the given address, or
+ * @ref DSM_DEVICE_MAX if there is none. */
+static uint32_t devkey_index_by_element_get(uint16_t element_addr)
+{
+    uint32_t index = devkey_index_get(element_addr);
+    for (uint32_t offset = 1;
+         index == DSM_DEVICE_MAX && offset < m_devkey_element_count_max && offset < element_addr;
+         ++offset)
+    {
+        /* Element ranges don't overlap, so only the closest owner below the address can cover it. */
+        uint32_t owner_index = devkey_index_get(element_addr - offset);
+        if (owner_index < DSM_DEVICE_MAX)
+        {
+            return (m_devkeys[owner_index].element_count > offset ? owner_index : DSM_DEVICE_MAX);
+        }
+    }
+    return index;
+}
+
+/** Marks the cache slot as the most recently used one, and gets its security material. */
+static const nrf_mesh_application_secmat_t * devkey_slot_use(uint32_t slot)
+{
+    m_devkey_slots[slot].last_used = ++m_devkey_slot_clock;
+    return &m_devkey_slots[slot].secmat;
+}
+
+/** Drops the key of the given devkey from RAM. */
+static void devkey_slot_free(uint32_t index)
+{
+    if (m_devkeys[index].slot != DEVKEY_ENTRY_NONE)
+    {
+        m_devkey_slots[m_devkeys[index].slot - 1].entry = DEVKEY_ENTRY_NONE;
+        m_devkeys[index].slot = DEVKEY_ENTRY_NONE;
+    }
+}
+
+#if PERSISTENT_STORAGE
+/** Checks whether flash holds the same version of the devkey as the given cache slot. */
+static bool devkey_slot_is_flashed(uint32_t slot)
+{
+    uint32_t index = m_devkey_slots[slot].entry - 1;
+    uint16_t element_count;
+    const dsm_flash_entry_devkey_t * p_flash_entry = devkey_flash_entry_get(index, &element_count);
+    return (p_flash_entry != NULL &&
+            p_flash_entry->key_owner == m_devkeys[index].key_owner &&
+            p_flash_entry->subnet_handle == m_devkeys[index].subnet_handle &&
+            element_count == m_devkeys[index].element_count &&
+            memcmp(p_flash_entry->key, m_devkey_slots[slot].secmat.key, NRF_MESH_KEY_SIZE) == 0);
+}
+
+/** Finds the least recently used cache slot whose key is safely stored in flash, and evicts the key. */
+static uint32_t devkey_slot_evict(void)
+{
+    uint32_t checked[BITFIELD_BLOCK_COUNT(DSM_DEVKEY_CACHE_SIZE)];
+    bitfield_clear_all(checked, DSM_DEVKEY_CACHE_SIZE);
+    for (uint32_t i = 0; i < DSM_DEVKEY_CACHE_SIZE; ++i)
+    {
+        uint32_t oldest = DSM_DEVKEY_CACHE_SIZE;
+        for (uint32_t slot = 0; slot < DSM_DEVKEY_CACHE_SIZE; ++slot)
+        {
+            if (!bitfield_get(checked, slot) &&
+                (oldest == DSM_DEVKEY_CACHE_SIZE ||
+                 m_devkey_slot_clock - m_devkey_slots[slot].last_used >
+                 m_devkey_slot_clock - m_devkey_slots[oldest].last_used))
+            {
+                oldest = slot;
+            }
+        }
+
+        if (devkey_slot_is_flashed(oldest))
+        {
+            uint32_t index = m_devkey_slots[oldest].entry - 1;
+            devkey_slot_free(index);
+            /* The flash copy is up to date: */
+            bitfield_clear(m_devkey_needs_flashing, index);
+            return oldest;
+        }
+        bitfield_set(checked, oldest);
+    }
+    return DSM_DEVKEY_CACHE_SIZE;
+}
+
+#if DSM_FLASH_WRITE_BEHIND_DELAY_US > 0
+static bool flash_entry_write(dsm_entry_type_t type, uint32_t index);
+
+/** Hands the cached keys that are waiting for the write-behind window to the flash manager, so they
+ * can be evicted as soon as they're written. */
+static void devkey_slots_flush(void)
+{
+    for (uint32_t slot = 0; slot < DSM_DEVKEY_CACHE_SIZE; ++slot)
+    {
+        uint32_t index = m_devkey_slots[slot].entry - 1;
+        if (m_devkey_slots[slot].entry != DEVKEY_ENTRY_NONE &&
+            bitfield_get(m_devkey_needs_flashing, index) &&
+            flash_entry_write(DSM_ENTRY_TYPE_DEVKEY, index))
+        {
+            bitfield_clear(m_devkey_needs_flashing, index);
+        }
+    }
+}
+#endif
+#endif
+
+/** Assigns a cache slot to the given devkey, evicting another key to flash if @p evict is set and
+ * the cache is full. Returns whether the devkey has a slot. */
+static bool devkey_slot_alloc(uint32_t index, bool evict)
+{
+    if (m_devkeys[index].slot != DEVKEY_ENTRY_NONE)
+    {
+        return true;
+    }
+
+    uint32_t slot = 0;
+    while (slot < DSM_DEVKEY_CACHE_SIZE && m_devkey_slots[slot].entry != DEVKEY_ENTRY_NONE)
+    {
+        slot++;
+    }
+#if PERSISTENT_STORAGE
+    if (slot == DSM_DEVKEY_CACHE_SIZE && evict)
+    {
+        slot = devkey_slot_evict();
+    }
+#if DSM_FLASH_WRITE_BEHIND_DELAY_US > 0
+    if (slot == DSM_DEVKEY_CACHE_SIZE && evict)
+    {
+        /* All the cached keys may be waiting for the write-behind window. If the flash manager
+         * writes them right away, one of them can be evicted: */
+        devkey_slots_flush();
+        slot = devkey_slot_evict();
+    }
+#endif
+#endif
+    if (slot == DSM_DEVKEY_CACHE_SIZE)
+    {
+        return false;
+    }
+
+    m_devkey_slots[slot].entry = (uint16_t) (index + 1);
+    m_devkey_slots[slot].secmat.aid = 0;
+    m_devkey_slots[slot].secmat.is_device_key = true;
+    m_devkeys[index].slot = (uint16_t) (slot + 1);
+    (void) devkey_slot_use(slot);
+    return true;
+}
+
+/** Gets the security material of the given devkey, loading the key from flash if it isn't in RAM.
+ * Returns NULL if the key couldn't be loaded. */
+static const nrf_mesh_application_secmat_t * devkey_secmat_get(uint32_t index)
+{
+    if (m_devkeys[index].slot == DEVKEY_ENTRY_NONE)
+    {
+#if PERSISTENT_STORAGE
+        uint16_t element_count;
+        const dsm_flash_entry_devkey_t * p_flash_entry = devkey_flash_entry_get(index, &element_count);
+        if (p_flash_entry == NULL || !devkey_slot_alloc(index, true))
+        {
+            return NULL;
+        }
+        NRF_MESH_ASSERT(p_flash_entry->key_owner == m_devkeys[index].key_owner);
+        memcpy(m_devkey_slots[m_devkeys[index].slot - 1].secmat.key, p_flash_entry->key, NRF_MESH_KEY_SIZE);
+#else
+        /* All device keys fit in RAM without persistent storage. */
+        NRF_MESH_ASSERT(false);
+#endif
+    }
+    return devkey_slot_use(m_devkeys[index].slot - 1);
+}
+
+/** Drops the state the AES backend keeps for the key of the given devkey, which is being deleted. */
+static void devkey_key_forget(uint32_t index)
+{
+    if (m_devkeys[index].slot != DEVKEY_ENTRY_NONE)
+    {
+        enc_key_forget(m_devkey_slots[m_devkeys[index].slot - 1].secmat.key);
+    }
+#if PERSISTENT_STORAGE
+    else
+    {
+        uint16_t element_count;
+        const dsm_flash_entry_devkey_t * p_flash_entry = devkey_flash_entry_get(index, &element_count);
+        if (p_flash_entry != NULL)
+        {
+            enc_key_forget(p_flash_entry->key);
+        }
+    }
+#endif
+}
+
+/** Drops the state the AES backend keeps for the keys derived from a network key. */
+static void network_keys_forget(const nrf_mesh_network_secmat_t * p_secmat,
+                                const nrf_mesh_beacon_secmat_t * p_beacon_secmat)
+{
+    enc_key_forget(p_secmat->encryption_key);
+    enc_key_forget(p_secmat->privacy_key);
+    enc_key_forget(p_beacon_secmat->key);
+#if GATT_PROXY
+    enc_key_forget(p_beacon_secmat->identity_key);
+#endif
+}
+
 /** Finds the devkey handle of the given owner address, or an available
  * handle if it doesn't exist. Returns true if the devkey exists.
  */
 static bool dev_key_handle_get(uint16_t owner_addr, dsm_handle_t * p_handle)
 {
+    uint32_t index = devkey_index_get(owner_addr);
+    if (index < DSM_DEVICE_MAX)
+    {
+        *p_handle = DSM_DEVKEY_HANDLE_START + index;
+        return true;
+    }
+
     *p_handle = DSM_HANDLE_INVALID;
-    for (uint32_t i = 0; i < DSM_DEVICE_MAX; i++)
+    for (uint32_t i = 0; i < BITFIELD_BLOCK_COUNT(DSM_DEVICE_MAX); ++i)
     {
-        if (bitfield_get(m_devkey_allocated, i))
+        if (m_devkey_allocated[i] != UINT32_MAX)
         {
-            if (m_devkeys[i].key_owner == owner_addr)
+            for (uint32_t j = i * BITFIELD_BLOCK_SIZE; j < DSM_DEVICE_MAX; ++j)
             {
-                *p_handle = DSM_DEVKEY_HANDLE_START + i;
-                return true;
+                if (!bitfield_get(m_devkey_allocated, j))
+                {
+                    *p_handle = DSM_DEVKEY_HANDLE_START + j;
+                    return false;
+                }
             }
         }
-        else if (*p_handle == DSM_HANDLE_INVALID)
-        {
-            *p_handle = DSM_DEVKEY_HANDLE_START + i;
-        }
     }
     return false;
 }
@@ -652,32 +1103,122 @@ static bool get_all_subnets(mesh_key_index_t * p_key_list, uint32_t * p_count)
     return true;
 }
 
-/** Returns the index to the m_subnets array for the given network secmat,
+/** Returns the index to the m_subnets array for the given network secmat and the index of the
+ *  secmat within the subnet, regardless of the key refresh phase.
  *  Returns DSM_HANDLE_INVALID if not found.
  */
-static dsm_handle_t get_subnet_handle(const nrf_mesh_network_secmat_t * p_secmat)
+static dsm_handle_t get_subnet_handle_by_secmat(const nrf_mesh_network_secmat_t * p_secmat, uint32_t * p_secmat_index)
 {
-    NRF_MESH_ASSERT(NULL != p_secmat);
+    const nrf_mesh_network_secmat_t * p_first[SUBNET_SECMAT_COUNT];
+    p_first[SUBNET_SECMAT_CURRENT] = &m_subnets[0].secmat;
+    p_first[SUBNET_SECMAT_UPDATED] = &m_subnets[0].secmat_updated;
 
-    dsm_handle_t retval = DSM_HANDLE_INVALID;
-    for(uint16_t i = 0; i < DSM_SUBNET_MAX; i++)
+    for (uint32_t i = 0; i < SUBNET_SECMAT_COUNT; i++)
     {
-        if (m_subnets[i].key_refresh_phase != NRF_MESH_KEY_REFRESH_PHASE_0)
+        if (p_secmat >= p_first[i] && (const void *) p_secmat < (const void *) &m_subnets[DSM_SUBNET_MAX])
         {
-            if (p_secmat == &m_subnets[i].secmat || p_secmat == &m_subnets[i].secmat_updated)
+            /* The secmat is offset by the same amount in each structure, so the delta must be a
+             * whole number of subnets for the pointer to refer to this secmat. */
+            uint32_t offset = (uint32_t) ((const uint8_t *) p_secmat - (const uint8_t *) p_first[i]);
+            if ((offset % sizeof(subnet_t)) == 0 && (offset / sizeof(subnet_t)) < DSM_SUBNET_MAX)
             {
-                retval = i;
-                break;
+                *p_secmat_index = i;
+                return (offset / sizeof(subnet_t));
             }
         }
-        else if (p_secmat == &m_subnets[i].secmat)
+    }
+    return DSM_HANDLE_INVALID;
+}
+
+/** Returns the index to the m_subnets array for the given network secmat,
+ *  Returns DSM_HANDLE_INVALID if not found.
+ */
+static dsm_handle_t get_subnet_handle(const nrf_mesh_network_secmat_t * p_secmat)
+{
+    NRF_MESH_ASSERT(NULL != p_secmat);
+
+    uint32_t secmat_index;
+    dsm_handle_t handle = get_subnet_handle_by_secmat(p_secmat, &secmat_index);
+
+    /* The updated secmat is only valid during key refresh: */
+    if (handle != DSM_HANDLE_INVALID &&
+        secmat_index == SUBNET_SECMAT_UPDATED &&
+        m_subnets[handle].key_refresh_phase == NRF_MESH_KEY_REFRESH_PHASE_0)
+    {
+        return DSM_HANDLE_INVALID;
+    }
+    return handle;
+}
+
+/** Encodes a subnet handle and secmat index as a NID bucket entry. */
+static inline uint8_t nid_entry_get(dsm_handle_t subnet_handle, uint32_t secmat_index)
+{
+    return (uint8_t) (subnet_handle * SUBNET_SECMAT_COUNT + secmat_index + 1);
+}
+
+/** Gets the chain link following the given NID bucket entry. */
+static inline uint8_t * nid_entry_next_get(uint8_t entry)
+{
+    return &m_subnets[(entry - 1) / SUBNET_SECMAT_COUNT].nid_next[(entry - 1) % SUBNET_SECMAT_COUNT];
+}
+
+static void nid_entry_link(dsm_handle_t subnet_handle, uint32_t secmat_index, uint8_t nid)
+{
+    uint8_t entry = nid_entry_get(subnet_handle, secmat_index);
+    uint8_t * p_link = &m_nid_buckets[nid];
+
+    /* Keep the chain sorted by handle, to iterate over the subnets in order: */
+    while (*p_link != NID_ENTRY_NONE && *p_link < entry)
+    {
+        p_link = nid_entry_next_get(*p_link);
+    }
+    m_subnets[subnet_handle].nid_next[secmat_index] = *p_link;
+    *p_link = entry;
+    m_subnets[subnet_handle].nid_bucket[secmat_index] = NID_BUCKET_LINKED | nid;
+}
+
+static void nid_entry_unlink(dsm_handle_t subnet_handle, uint32_t secmat_index)
+{
+    if (m_subnets[subnet_handle].nid_bucket[secmat_index] & NID_BUCKET_LINKED)
+    {
+        uint8_t entry = nid_entry_get(subnet_handle, secmat_index);
+        uint8_t * p_link = &m_nid_buckets[m_subnets[subnet_handle].nid_bucket[secmat_index] & PACKET_MESH_NET_NID_MASK];
+        while (*p_link != entry)
         {
-            retval = i;
-            break;
+            NRF_MESH_ASSERT(*p_link != NID_ENTRY_NONE);
+            p_link = nid_entry_next_get(*p_link);
         }
+        *p_link = m_subnets[subnet_handle].nid_next[secmat_index];
+        m_subnets[subnet_handle].nid_bucket[secmat_index] = 0;
+    }
+}
+
+/** Relinks the subnet's security materials into the NID buckets. Must be called whenever the
+ *  subnet is allocated or freed, or its secmats or key refresh phase change.
+ *
+ *  The updated secmat is only linked separately if its NID differs from the current one, otherwise
+ *  both are found through the current secmat's entry.
+ */
+static void nid_index_update(dsm_handle_t subnet_handle)
+{
+    const subnet_t * p_subnet = &m_subnets[subnet_handle];
+
+    for (uint32_t i = 0; i < SUBNET_SECMAT_COUNT; i++)
+    {
+        nid_entry_unlink(subnet_handle, i);
     }
 
-    return retval;
+    if (bitfield_get(m_subnet_allocated, subnet_handle))
+    {
+        uint8_t nid = p_subnet->secmat.nid & PACKET_MESH_NET_NID_MASK;
+        uint8_t nid_updated = p_subnet->secmat_updated.nid & PACKET_MESH_NET_NID_MASK;
+
+        nid_entry_link(subnet_handle, SUBNET_SECMAT_CURRENT, nid);
+        if (p_subnet->key_refresh_phase != NRF_MESH_KEY_REFRESH_PHASE_0 && nid_updated != nid)
+        {
+            nid_entry_link(subnet_handle, SUBNET_SECMAT_UPDATED, nid_updated);
+        }
+    }
 }
 
 /** Returns the index to the m_subnets array for the given beacon info,
@@ -698,6 +1239,31 @@ static dsm_handle_t get_subnet_handle_by_beacon_info(const nrf_mesh_beacon_info_
     return DSM_HANDLE_INVALID;
 }
 
+/** Returns the index to the m_appkeys array for the given application secmat and the index of
+ *  the secmat within the appkey, regardless of whether the key is being updated.
+ *  Returns DSM_HANDLE_INVALID if not found.
+ */
+static dsm_handle_t get_app_handle_by_secmat(const nrf_mesh_application_secmat_t * p_secmat, uint32_t * p_secmat_index)
+{
+    const nrf_mesh_application_secmat_t * p_first[APPKEY_SECMAT_COUNT];
+    p_first[APPKEY_SECMAT_CURRENT] = &m_appkeys[0].secmat;
+    p_first[APPKEY_SECMAT_UPDATED] = &m_appkeys[0].secmat_updated;
+
+    for (uint32_t i = 0; i < APPKEY_SECMAT_COUNT; i++)
+    {
+        if (p_secmat >= p_first[i] && (const void *) p_secmat < (const void *) &m_appkeys[DSM_APP_MAX])
+        {
+            uint32_t offset = (uint32_t) ((const uint8_t *) p_secmat - (const uint8_t *) p_first[i]);
+            if ((offset % sizeof(appkey_t)) == 0 && (offset / sizeof(appkey_t)) < DSM_APP_MAX)
+            {
+                *p_secmat_index = i;
+                return (offset / sizeof(appkey_t));
+            }
+        }
+    }
+    return DSM_HANDLE_INVALID;
+}
+
 /** Returns the index to the m_appkeys array for the given appkey secmat,
  *  Returns DSM_HANDLE_INVALID if not found.
  */
@@ -705,22 +1271,23 @@ static dsm_handle_t get_app_handle(const nrf_mesh_application_secmat_t * p_secma
 {
     NRF_MESH_ASSERT(NULL != p_secmat);
 
-    if (p_secmat >= &m_appkeys[0].secmat &&
-        p_secmat <= &m_appkeys[DSM_APP_MAX - 1].secmat)
+    uint32_t secmat_index;
+    dsm_handle_t app_handle = get_app_handle_by_secmat(p_secmat, &secmat_index);
+    if (app_handle != DSM_HANDLE_INVALID)
     {
-        /* The secmat is offset by the same amount in each structure, so since
-         * we're getting the delta between two substructures of the same structure
-         * type, this will get the right index. */
-        return (((uint32_t) p_secmat - (uint32_t) &m_appkeys[0].secmat) / sizeof(appkey_t));
+        return app_handle;
     }
-    else if (p_secmat >= &m_devkeys[0].secmat &&
-             p_secmat <= &m_devkeys[DSM_DEVICE_MAX - 1].secmat)
+    else if (p_secmat >= &m_devkey_slots[0].secmat &&
+             p_secmat <= &m_devkey_slots[DSM_DEVKEY_CACHE_SIZE - 1].secmat)
     {
         /* The secmat is offset by the same amount in each structure, so since
          * we're getting the delta between two substructures of the same structure
          * type, this will get the right index. */
-        return DSM_DEVKEY_HANDLE_START + (((uint32_t) p_secmat - (uint32_t) &m_devkeys[0].secmat) / sizeof(devkey_t));
-
+        uint32_t slot = ((uint32_t) p_secmat - (uint32_t) &m_devkey_slots[0].secmat) / sizeof(devkey_slot_t);
+        if (m_devkey_slots[slot].entry != DEVKEY_ENTRY_NONE)
+        {
+            return DSM_DEVKEY_HANDLE_START + m_devkey_slots[slot].entry - 1;
+        }
     }
     return DSM_HANDLE_INVALID;
 }
@@ -762,35 +1329,83 @@ static const nrf_mesh_application_secmat_t * get_devkey_secmat(uint16_t key_addr
     {
         return NULL;
     }
-    for (uint32_t i = 0; i < DSM_DEVICE_MAX; ++i)
+
+    uint32_t index = devkey_index_by_element_get(key_address);
+    if (index == DSM_DEVICE_MAX && is_own_unicast_addr(key_address))
+    {
+        /* The device key belongs to the node, and covers all of its elements: */
+        index = devkey_index_get(m_local_unicast_addr.address_start);
+    }
+    return (index < DSM_DEVICE_MAX ? devkey_secmat_get(index) : NULL);
+}
+
+/** Encodes an appkey handle and secmat index as an AID bucket entry. */
+static inline uint8_t aid_entry_get(dsm_handle_t app_handle, uint32_t secmat_index)
+{
+    return (uint8_t) (app_handle * APPKEY_SECMAT_COUNT + secmat_index + 1);
+}
+
+/** Gets the chain link following the given AID bucket entry. */
+static inline uint8_t * aid_entry_next_get(uint8_t entry)
+{
+    return &m_appkeys[(entry - 1) / APPKEY_SECMAT_COUNT].aid_next[(entry - 1) % APPKEY_SECMAT_COUNT];
+}
+
+static void aid_entry_link(dsm_handle_t app_handle, uint32_t secmat_index, uint8_t aid)
+{
+    uint8_t entry = aid_entry_get(app_handle, secmat_index);
+    uint8_t * p_link = &m_subnets[m_appkeys[app_handle].subnet_handle].aid_buckets[aid];
+
+    /* Keep the chain sorted by handle, to try the keys in order: */
+    while (*p_link != AID_ENTRY_NONE && *p_link < entry)
+    {
+        p_link = aid_entry_next_get(*p_link);
+    }
+    m_appkeys[app_handle].aid_next[secmat_index] = *p_link;
+    *p_link = entry;
+    m_appkeys[app_handle].aid_bucket[secmat_index] = AID_BUCKET_LINKED | aid;
+}
+
+static void aid_entry_unlink(dsm_handle_t app_handle, uint32_t secmat_index)
+{
+    if (m_appkeys[app_handle].aid_bucket[secmat_index] & AID_BUCKET_LINKED)
     {
-        if (m_devkeys[i].key_owner == key_address)
+        uint8_t entry = aid_entry_get(app_handle, secmat_index);
+        uint8_t * p_link = &m_subnets[m_appkeys[app_handle].subnet_handle]
+                                .aid_buckets[m_appkeys[app_handle].aid_bucket[secmat_index] & PACKET_MESH_TRS_ACCESS_AID_MASK];
+        while (*p_link != entry)
         {
-            return &m_devkeys[i].secmat;
+            NRF_MESH_ASSERT(*p_link != AID_ENTRY_NONE);
+            p_link = aid_entry_next_get(*p_link);
         }
+        *p_link = m_appkeys[app_handle].aid_next[secmat_index];
+        m_appkeys[app_handle].aid_bucket[secmat_index] = 0;
     }
-    return NULL;
 }
 
-static void get_app_secmat(dsm_handle_t subnet_handle, uint8_t aid, const nrf_mesh_application_secmat_t ** pp_app_secmat)
+/** Relinks the appkey's security materials into the AID buckets of its subnet. Must be called
+ *  whenever the appkey is allocated or freed, or its secmats change.
+ *
+ *  While the key is being updated, both the current and the updated secmat are linked, as packets
+ *  may be encrypted with either of them.
+ */
+static void aid_index_update(dsm_handle_t app_handle)
 {
-    uint32_t i = 0;
-    if (*pp_app_secmat != NULL)
+    const appkey_t * p_appkey = &m_appkeys[app_handle];
+
+    for (uint32_t i = 0; i < APPKEY_SECMAT_COUNT; i++)
     {
-        /* Iterate over the proceeding elements */
-        i = get_app_handle(*pp_app_secmat) + 1;
+        aid_entry_unlink(app_handle, i);
     }
-    for (; i < DSM_APP_MAX; i++)
+
+    if (bitfield_get(m_appkey_allocated, app_handle))
     {
-        if (bitfield_get(m_appkey_allocated, i) &&
-            m_appkeys[i].subnet_handle == subnet_handle &&
-            ((m_appkeys[i].secmat.aid & PACKET_MESH_TRS_ACCESS_AID_MASK) == (aid & PACKET_MESH_TRS_ACCESS_AID_MASK)))
+        aid_entry_link(app_handle, APPKEY_SECMAT_CURRENT, p_appkey->secmat.aid & PACKET_MESH_TRS_ACCESS_AID_MASK);
+        if (p_appkey->key_updated)
         {
-            *pp_app_secmat = &m_appkeys[i].secmat;
-            return;
+            aid_entry_link(app_handle, APPKEY_SECMAT_UPDATED, p_appkey->secmat_updated.aid & PACKET_MESH_TRS_ACCESS_AID_MASK);
         }
     }
-    *pp_app_secmat = NULL;
 }
 
 static void subnet_set(mesh_key_index_t net_key_index, const uint8_t * p_key, dsm_handle_t handle)
@@ -813,6 +1428,7 @@ static void subnet_set(mesh_key_index_t net_key_index, const uint8_t * p_key, ds
     m_subnets[handle].key_refresh_phase = NRF_MESH_KEY_REFRESH_PHASE_0;
     bitfield_set(m_subnet_allocated, handle);
     bitfield_set(m_subnet_needs_flashing, handle);
+    nid_index_update(handle);
 }
 
 static void appkey_set(mesh_key_index_t app_key_index, dsm_handle_t subnet_handle, const uint8_t * p_key, dsm_handle_t handle)
@@ -826,17 +1442,32 @@ static void appkey_set(mesh_key_index_t app_key_index, dsm_handle_t subnet_handl
     m_appkeys[handle].subnet_handle = subnet_handle;
     bitfield_set(m_appkey_allocated, handle);
     bitfield_set(m_appkey_needs_flashing, handle);
+    aid_index_update(handle);
 }
 
-static void devkey_set(uint16_t key_owner, dsm_handle_t subnet_handle, const uint8_t * p_key, dsm_handle_t handle)
+static void devkey_set(uint16_t key_owner, dsm_handle_t subnet_handle, uint16_t element_count, dsm_handle_t handle)
 {
     uint32_t index = handle - DSM_DEVKEY_HANDLE_START;
-    memcpy(m_devkeys[index].secmat.key, p_key, NRF_MESH_KEY_SIZE);
-    m_devkeys[index].secmat.aid = 0;
-    m_devkeys[index].secmat.is_device_key = true;
+    if (bitfield_get(m_devkey_allocated, index))
+    {
+        devkey_entry_unlink(index);
+    }
     m_devkeys[index].subnet_handle = subnet_handle;
     m_devkeys[index].key_owner = key_owner;
+    m_devkeys[index].element_count = element_count;
+    if (element_count > m_devkey_element_count_max)
+    {
+        m_devkey_element_count_max = element_count;
+    }
+    devkey_entry_link(index);
     bitfield_set(m_devkey_allocated, index);
+}
+
+/** Sets the key of a devkey that has a cache slot. */
+static void devkey_key_set(uint32_t index, const uint8_t * p_key)
+{
+    NRF_MESH_ASSERT(m_devkeys[index].slot != DEVKEY_ENTRY_NONE);
+    memcpy(m_devkey_slots[m_devkeys[index].slot - 1].secmat.key, p_key, NRF_MESH_KEY_SIZE);
     bitfield_set(m_devkey_needs_flashing, index);
 }
 
@@ -930,7 +1561,7 @@ static uint32_t add_address(uint16_t raw_address, dsm_handle_t * p_address_handl
         *p_address_handle = handle;
         if (role == DSM_ADDRESS_ROLE_SUBSCRIBE)
         {
-            m_addresses[*p_address_handle].subscription_count++;
+            address_subscription_count_increment(handle);
         }
         else
         {
@@ -963,7 +1594,7 @@ static uint32_t add_address_virtual(const uint8_t * p_label_uuid, dsm_handle_t *
     *p_address_handle = handle;
     if (role == DSM_ADDRESS_ROLE_SUBSCRIBE)
     {
-        m_virtual_addresses[dest].subscription_count++;
+        address_subscription_count_increment(handle);
     }
     else
     {
@@ -992,6 +1623,12 @@ static flash_manager_t m_flash_manager;
 static bool m_flash_is_available;
 /** Memory listener used to recover from no-mem returns on the flash manager. */
 static fm_mem_listener_t m_flash_mem_listener_update_all;
+#if DSM_FLASH_WRITE_BEHIND_DELAY_US > 0
+/** Timer committing all entries marked for flashing at the end of the write-behind window. */
+static timer_event_t m_flash_write_behind_timer;
+/** Whether the write-behind timer is running. */
+static bool m_flash_write_behind_pending;
+#endif
 
 /* Flash utility functions */
 static void addr_unicast_to_flash_entry(uint32_t index, dsm_flash_entry_t * p_dst, uint16_t * p_entry_len);
@@ -1046,6 +1683,29 @@ NRF_MESH_STATIC_ASSERT(sizeof(m_flash_groups) / sizeof(m_flash_groups[0]) == DSM
 /*****************************************************************************
 * Flash utility functions
 *****************************************************************************/
+/** Gets the element count of a devkey flash entry. */
+static uint16_t devkey_flash_entry_element_count_get(const dsm_flash_entry_devkey_t * p_entry, uint16_t entry_len)
+{
+    /* Entries stored before element counts were added cover a single element: */
+    return (entry_len >= offsetof(dsm_flash_entry_devkey_t, element_count) + sizeof(p_entry->element_count) ?
+            p_entry->element_count : 1);
+}
+
+/** Gets the devkey stored in flash, or NULL if it's not stored or the flash area isn't available. */
+static const dsm_flash_entry_devkey_t * devkey_flash_entry_get(uint32_t index, uint16_t * p_element_count)
+{
+    const fm_entry_t * p_entry =
+        flash_manager_entry_get(&m_flash_manager, m_flash_groups[DSM_ENTRY_TYPE_DEVKEY].flash_start_handle + index);
+    if (p_entry == NULL)
+    {
+        return NULL;
+    }
+    const dsm_flash_entry_devkey_t * p_devkey = &((const dsm_flash_entry_t *) p_entry->data)->devkey;
+    *p_element_count = devkey_flash_entry_element_count_get(
+        p_devkey, (p_entry->header.len_words - FLASH_MANAGER_ENTRY_LEN_OVERHEAD) * WORD_SIZE);
+    return p_devkey;
+}
+
 static void addr_unicast_to_dsm_entry(uint32_t index, const dsm_flash_entry_t * p_entry, uint16_t entry_len)
 {
     /* Ignore the index, as there can only be one. */
@@ -1069,6 +1729,7 @@ static void subnet_to_dsm_entry(uint32_t index, const dsm_flash_entry_t * p_entr
     {
         NRF_MESH_ASSERT(entry_len == ALIGN_VAL(sizeof(dsm_flash_entry_subnet_t) - sizeof(p_key_data->key_updated), WORD_SIZE));
     }
+    nid_index_update(index);
 }
 
 static void appkey_to_dsm_entry(uint32_t index, const dsm_flash_entry_t * p_entry, uint16_t entry_len)
@@ -1088,6 +1749,7 @@ static void appkey_to_dsm_entry(uint32_t index, const dsm_flash_entry_t * p_entr
     {
         NRF_MESH_ASSERT(entry_len == ALIGN_VAL(sizeof(dsm_flash_entry_appkey_t) - sizeof(p_key_data->key_updated), WORD_SIZE));
     }
+    aid_index_update(index);
 }
 
 static void devkey_to_dsm_entry(uint32_t index, const dsm_flash_entry_t * p_entry, uint16_t entry_len)
@@ -1095,8 +1757,13 @@ static void devkey_to_dsm_entry(uint32_t index, const dsm_flash_entry_t * p_entr
     const dsm_flash_entry_devkey_t * p_key_data = &p_entry->devkey;
     devkey_set(p_key_data->key_owner,
                p_key_data->subnet_handle,
-               p_key_data->key,
+               devkey_flash_entry_element_count_get(p_key_data, entry_len),
                DSM_DEVKEY_HANDLE_START + index);
+    /* Keys that don't fit in RAM are loaded from flash when they're needed: */
+    if (devkey_slot_alloc(index, false))
+    {
+        devkey_key_set(index, p_key_data->key);
+    }
 }
 
 static void addr_nonvirtual_to_dsm_entry(uint32_t index, const dsm_flash_entry_t * p_entry, uint16_t entry_len)
@@ -1162,9 +1829,12 @@ static void appkey_to_flash_entry(uint32_t index, dsm_flash_entry_t * p_dst, uin
 static void devkey_to_flash_entry(uint32_t index, dsm_flash_entry_t * p_dst, uint16_t * p_entry_len)
 {
     dsm_flash_entry_devkey_t * p_entry = &p_dst->devkey;
-    memcpy(p_entry->key, m_devkeys[index].secmat.key, NRF_MESH_KEY_SIZE);
+    /* Devkeys are only evicted from RAM once their flash entry is up to date. */
+    NRF_MESH_ASSERT(m_devkeys[index].slot != DEVKEY_ENTRY_NONE);
+    memcpy(p_entry->key, m_devkey_slots[m_devkeys[index].slot - 1].secmat.key, NRF_MESH_KEY_SIZE);
     p_entry->key_owner = m_devkeys[index].key_owner;
     p_entry->subnet_handle = m_devkeys[index].subnet_handle;
+    p_entry->element_count = m_devkeys[index].element_count;
 }
 
 static void addr_nonvirtual_to_flash_entry(uint32_t index, dsm_flash_entry_t * p_dst, uint16_t * p_entry_len)
@@ -1242,7 +1912,7 @@ static void flash_load(dsm_entry_type_t type, uint32_t index, const dsm_flash_en
     bitfield_set(p_group->p_allocated_bitfield, index);
 }
 
-static bool flash_save(dsm_entry_type_t type, uint32_t index)
+static bool flash_entry_write(dsm_entry_type_t type, uint32_t index)
 {
     bearer_event_critical_section_begin();
     NRF_MESH_ASSERT(type < DSM_ENTRY_TYPES);
@@ -1271,7 +1941,7 @@ static bool flash_save(dsm_entry_type_t type, uint32_t index)
     return success;
 }
 
-static bool flash_invalidate(dsm_entry_type_t type, uint32_t index)
+static bool flash_entry_invalidate(dsm_entry_type_t type, uint32_t index)
 {
     bearer_event_critical_section_begin();
     NRF_MESH_ASSERT(type < DSM_ENTRY_TYPES);
@@ -1295,6 +1965,67 @@ static bool flash_invalidate(dsm_entry_type_t type, uint32_t index)
     return success;
 }
 
+static void flash_update_all(void);
+
+#if DSM_FLASH_WRITE_BEHIND_DELAY_US > 0
+/**
+ * Mark an entry for flashing, and start the write-behind window if it isn't running already.
+ *
+ * The window is not extended by later changes, so no change waits more than
+ * @ref DSM_FLASH_WRITE_BEHIND_DELAY_US before it's handed to the flash manager.
+ */
+static void flash_write_behind_mark(dsm_entry_type_t type, uint32_t index)
+{
+    bearer_event_critical_section_begin();
+    NRF_MESH_ASSERT(type < DSM_ENTRY_TYPES);
+    bitfield_set(m_flash_groups[type].p_needs_flashing_bitfield, index);
+    if (!m_flash_write_behind_pending)
+    {
+        m_flash_write_behind_pending = true;
+        m_flash_write_behind_timer.timestamp = timer_now() + DSM_FLASH_WRITE_BEHIND_DELAY_US;
+        timer_sch_schedule(&m_flash_write_behind_timer);
+    }
+    bearer_event_critical_section_end();
+}
+
+static void flash_write_behind_abort(void)
+{
+    if (m_flash_write_behind_pending)
+    {
+        timer_sch_abort(&m_flash_write_behind_timer);
+        m_flash_write_behind_pending = false;
+    }
+}
+
+static void flash_write_behind_timeout(timestamp_t timestamp, void * p_context)
+{
+    m_flash_write_behind_pending = false;
+    flash_update_all();
+}
+
+static bool flash_save(dsm_entry_type_t type, uint32_t index)
+{
+    flash_write_behind_mark(type, index);
+    return true;
+}
+
+static bool flash_invalidate(dsm_entry_type_t type, uint32_t index)
+{
+    flash_write_behind_mark(type, index);
+    return true;
+}
+#else
+static bool flash_save(dsm_entry_type_t type, uint32_t index)
+{
+    return flash_entry_write(type, index);
+}
+
+static bool flash_invalidate(dsm_entry_type_t type, uint32_t index)
+{
+    return flash_entry_invalidate(type, index);
+}
+#endif
+
 /** Run through all entries, and update the flash state for the ones that need it. */
 static void flash_update_all(void)
 {
@@ -1313,11 +2044,11 @@ static void flash_update_all(void)
                     bool success;
                     if (bitfield_get(p_group->p_allocated_bitfield, index))
                     {
-                        success = flash_save(type, index);
+                        success = flash_entry_write(type, index);
                     }
                     else
                     {
-                        success = flash_invalidate(type, index);
+                        success = flash_entry_invalidate(type, index);
                     }
 
                     if (success)
@@ -1354,7 +2085,7 @@ static void flash_operation_complete(const fm_entry_t * p_entry, fm_result_t res
 {
     /* If we get an AREA_FULL then our calculations for flash space required are buggy. */
     NRF_MESH_ASSERT(result != FM_RESULT_ERROR_AREA_FULL);
-    /* We do not invalidate in this module, so a NOT_FOUND should not be received. */
+    /* Entries are only invalidated after they have been written, see flash_invalidate_complete(). */
     NRF_MESH_ASSERT(result != FM_RESULT_ERROR_NOT_FOUND);
     if (result == FM_RESULT_ERROR_FLASH_MALFUNCTION)
     {
@@ -1379,6 +2110,14 @@ static void flash_write_complete(const flash_manager_t * p_manager, const fm_ent
 
 static void flash_invalidate_complete(const flash_manager_t * p_manager, fm_handle_t handle, fm_result_t result)
 {
+#if DSM_FLASH_WRITE_BEHIND_DELAY_US > 0
+    /* An entry that was added and removed within the same write-behind window never made it to
+     * flash, so there's nothing to invalidate. */
+    if (result == FM_RESULT_ERROR_NOT_FOUND)
+    {
+        return;
+    }
+#endif
     flash_operation_complete(NULL, result);
 }
 
@@ -1475,6 +2214,14 @@ bool dsm_flash_config_load(void)
     return bitfield_get(m_addr_unicast_allocated, 0);
 }
 
+void dsm_flash_flush(void)
+{
+#if DSM_FLASH_WRITE_BEHIND_DELAY_US > 0
+    flash_write_behind_abort();
+#endif
+    flash_update_all();
+}
+
 bool dsm_has_unflashed_data(void)
 {
     for (uint32_t i = 0; i < DSM_ENTRY_TYPES; i++)
@@ -1512,6 +2259,9 @@ bool dsm_flash_config_load(void)
 {
     return false;
 }
+void dsm_flash_flush(void)
+{
+}
 bool dsm_has_unflashed_data(void)
 {
     return false;
@@ -1527,6 +2277,9 @@ const void * dsm_flash_area_get(void)
 void dsm_clear(void)
 {
 #if PERSISTENT_STORAGE
+#if DSM_FLASH_WRITE_BEHIND_DELAY_US > 0
+    flash_write_behind_abort();
+#endif
     for (uint32_t i = 0; i < DSM_ENTRY_TYPES; ++i)
     {
         bitfield_clear_all(m_flash_groups[i].p_allocated_bitfield, m_flash_groups[i].entry_count);
@@ -1546,6 +2299,8 @@ void dsm_clear(void)
         m_virtual_addresses[i].subscription_count = 0;
         m_virtual_addresses[i].publish_count = 0;
     }
+    m_rx_nonvirtual_address_count = 0;
+    bitfield_clear_all(m_rx_address_filter, RX_ADDRESS_FILTER_BITS);
 
     bitfield_clear_all(m_addr_unicast_allocated, BITFIELD_BLOCK_COUNT(1));
     bitfield_clear_all(m_addr_nonvirtual_allocated, BITFIELD_BLOCK_COUNT(DSM_NONVIRTUAL_ADDR_MAX));
@@ -1554,6 +2309,28 @@ void dsm_clear(void)
     bitfield_clear_all(m_appkey_allocated, BITFIELD_BLOCK_COUNT(DSM_APP_MAX));
     bitfield_clear_all(m_devkey_allocated, BITFIELD_BLOCK_COUNT(DSM_DEVICE_MAX));
 
+    /* Unlink all network and application secmats from the NID and AID lookups, and all devkeys from
+     * the devkey lookup */
+    memset(m_nid_buckets, NID_ENTRY_NONE, sizeof(m_nid_buckets));
+    memset(m_devkey_buckets, DEVKEY_ENTRY_NONE, sizeof(m_devkey_buckets));
+    for (uint32_t i = 0; i < DSM_DEVKEY_CACHE_SIZE; ++i)
+    {
+        if (m_devkey_slots[i].entry != DEVKEY_ENTRY_NONE)
+        {
+            devkey_slot_free(m_devkey_slots[i].entry - 1);
+        }
+    }
+    m_devkey_element_count_max = 1;
+    for (uint32_t i = 0; i < DSM_SUBNET_MAX; ++i)
+    {
+        memset(m_subnets[i].nid_bucket, 0, sizeof(m_subnets[i].nid_bucket));
+        memset(m_subnets[i].aid_buckets, AID_ENTRY_NONE, sizeof(m_subnets[i].aid_buckets));
+    }
+    for (uint32_t i = 0; i < DSM_APP_MAX; ++i)
+    {
+        memset(m_appkeys[i].aid_bucket, 0, sizeof(m_appkeys[i].aid_bucket));
+    }
+
     m_local_unicast_addr.address_start = NRF_MESH_ADDR_UNASSIGNED;
     m_local_unicast_addr.count = 0;
     m_has_primary_subnet = false;
@@ -1576,6 +2353,12 @@ void dsm_init(void)
 #if PERSISTENT_STORAGE
     m_flash_mem_listener_update_all.callback = flash_mem_listener_callback;
     m_flash_mem_listener_update_all.p_args = flash_update_all;
+#if DSM_FLASH_WRITE_BEHIND_DELAY_US > 0
+    m_flash_write_behind_timer.cb = flash_write_behind_timeout;
+    m_flash_write_behind_timer.interval = 0;
+    m_flash_write_behind_timer.p_context = NULL;
+    m_flash_write_behind_pending = false;
+#endif
 
     m_flash_is_available = false;
     build_flash_area();
@@ -1675,15 +2458,7 @@ uint32_t dsm_address_subscription_add_handle(dsm_handle_t address_handle)
 {
     if (address_handle_valid(address_handle))
     {
-        if (address_handle >= DSM_NONVIRTUAL_ADDR_MAX)
-        {
-            m_virtual_addresses[address_handle - DSM_VIRTUAL_HANDLE_START].subscription_count++;
-        }
-        else
-        {
-            m_addresses[address_handle].subscription_count++;
-        }
-
+        address_subscription_count_increment(address_handle);
         return NRF_SUCCESS;
     }
     else
@@ -1786,7 +2561,10 @@ uint32_t dsm_address_subscription_remove(dsm_handle_t address_handle)
                 }
                 else
                 {
-                    --m_addresses[address_handle].subscription_count;
+                    if (--m_addresses[address_handle].subscription_count == 0)
+                    {
+                        rx_address_unsubscribed(address_handle);
+                    }
                     return address_delete_if_unused(address_handle);
                 }
             }
@@ -1798,7 +2576,10 @@ uint32_t dsm_address_subscription_remove(dsm_handle_t address_handle)
                 }
                 else
                 {
-                    --m_virtual_addresses[address_handle - DSM_VIRTUAL_HANDLE_START].subscription_count;
+                    if (--m_virtual_addresses[address_handle - DSM_VIRTUAL_HANDLE_START].subscription_count == 0)
+                    {
+                        rx_address_unsubscribed(address_handle);
+                    }
                     return address_delete_if_unused(address_handle);
                 }
             }
@@ -2114,6 +2895,7 @@ uint32_t dsm_subnet_update(dsm_handle_t subnet_handle, const uint8_t * p_key)
 #endif
 
         m_subnets[subnet_handle].key_refresh_phase = NRF_MESH_KEY_REFRESH_PHASE_1;
+        nid_index_update(subnet_handle);
         net_state_key_refresh_phase_changed(m_subnets[subnet_handle].net_key_index,
                                             m_subnets[subnet_handle].beacon.info.secmat_updated.net_id,
                                             NRF_MESH_KEY_REFRESH_PHASE_1);
@@ -2158,12 +2940,14 @@ uint32_t dsm_subnet_update_commit(dsm_handle_t subnet_handle)
     }
     else if (m_subnets[subnet_handle].key_refresh_phase != NRF_MESH_KEY_REFRESH_PHASE_0)
     {
+        network_keys_forget(&m_subnets[subnet_handle].secmat, &m_subnets[subnet_handle].beacon.info.secmat);
         memcpy(m_subnets[subnet_handle].root_key, m_subnets[subnet_handle].root_key_updated, NRF_MESH_KEY_SIZE);
         memcpy(&m_subnets[subnet_handle].secmat, &m_subnets[subnet_handle].secmat_updated, sizeof(m_subnets[subnet_handle].secmat));
         memcpy(&m_subnets[subnet_handle].beacon.info.secmat, &m_subnets[subnet_handle].beacon.info.secmat_updated,
                 sizeof(m_subnets[subnet_handle].beacon.info.secmat));
 
         m_subnets[subnet_handle].key_refresh_phase = NRF_MESH_KEY_REFRESH_PHASE_0;
+        nid_index_update(subnet_handle);
         net_state_key_refresh_phase_changed(m_subnets[subnet_handle].net_key_index,
                                             m_subnets[subnet_handle].beacon.info.secmat.net_id,
                                             NRF_MESH_KEY_REFRESH_PHASE_0);
@@ -2175,8 +2959,10 @@ uint32_t dsm_subnet_update_commit(dsm_handle_t subnet_handle)
                     && m_appkeys[i].subnet_handle == subnet_handle
                     && m_appkeys[i].key_updated)
             {
+                enc_key_forget(m_appkeys[i].secmat.key);
                 memcpy(&m_appkeys[i].secmat, &m_appkeys[i].secmat_updated, sizeof(nrf_mesh_application_secmat_t));
                 m_appkeys[i].key_updated = false;
+                aid_index_update(i);
 
                 bitfield_set(m_appkey_needs_flashing, i);
                 (void) flash_save(DSM_ENTRY_TYPE_APPKEY, i);
@@ -2218,7 +3004,14 @@ uint32_t dsm_subnet_delete(dsm_handle_t subnet_handle)
         m_has_primary_subnet = false;
     }
 
+    network_keys_forget(&m_subnets[subnet_handle].secmat, &m_subnets[subnet_handle].beacon.info.secmat);
+    if (m_subnets[subnet_handle].key_refresh_phase != NRF_MESH_KEY_REFRESH_PHASE_0)
+    {
+        network_keys_forget(&m_subnets[subnet_handle].secmat_updated,
+                            &m_subnets[subnet_handle].beacon.info.secmat_updated);
+    }
     bitfield_clear(m_subnet_allocated, subnet_handle);
+    nid_index_update(subnet_handle);
     (void) flash_invalidate(DSM_ENTRY_TYPE_SUBNET, subnet_handle);
     return NRF_SUCCESS;
 }
@@ -2282,13 +3075,15 @@ uint32_t dsm_devkey_add(uint16_t raw_unicast_addr, dsm_handle_t subnet_handle, c
     {
         return NRF_ERROR_FORBIDDEN;
     }
-    else if (handle == DSM_HANDLE_INVALID)
+    else if (handle == DSM_HANDLE_INVALID ||
+             !devkey_slot_alloc(handle - DSM_DEVKEY_HANDLE_START, true))
     {
         return NRF_ERROR_NO_MEM;
     }
     else
     {
-        devkey_set(raw_unicast_addr, subnet_handle, p_key, handle);
+        devkey_set(raw_unicast_addr, subnet_handle, 1, handle);
+        devkey_key_set(handle - DSM_DEVKEY_HANDLE_START, p_key);
         (void) flash_save(DSM_ENTRY_TYPE_DEVKEY, handle - DSM_DEVKEY_HANDLE_START);
         *p_devkey_handle = handle;
     }
@@ -2306,6 +3101,9 @@ uint32_t dsm_devkey_delete(dsm_handle_t devkey_handle)
     }
     else
     {
+        devkey_entry_unlink(devkey_index);
+        devkey_key_forget(devkey_index);
+        devkey_slot_free(devkey_index);
         m_devkeys[devkey_index].key_owner = NRF_MESH_ADDR_UNASSIGNED;
         bitfield_clear(m_devkey_allocated, devkey_index);
         (void) flash_invalidate(DSM_ENTRY_TYPE_DEVKEY, devkey_index);
@@ -2313,6 +3111,53 @@ uint32_t dsm_devkey_delete(dsm_handle_t devkey_handle)
     }
 }
 
+uint32_t dsm_devkey_element_count_set(dsm_handle_t devkey_handle, uint16_t element_count)
+{
+    uint32_t devkey_index = devkey_handle - DSM_DEVKEY_HANDLE_START;
+    if (devkey_handle < DSM_DEVKEY_HANDLE_START ||
+        devkey_handle >= DSM_DEVKEY_HANDLE_START + DSM_DEVICE_MAX ||
+        !bitfield_get(m_devkey_allocated, devkey_index))
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    uint16_t key_owner = m_devkeys[devkey_index].key_owner;
+    uint16_t last_element = key_owner + element_count - 1;
+    if (element_count == 0 ||
+        last_element < key_owner ||
+        nrf_mesh_address_type_get(last_element) != NRF_MESH_ADDRESS_TYPE_UNICAST)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    /* Element ranges of different nodes can't overlap: */
+    for (uint16_t i = 1; i < element_count; ++i)
+    {
+        if (devkey_index_get(key_owner + i) != DSM_DEVICE_MAX)
+        {
+            return NRF_ERROR_FORBIDDEN;
+        }
+    }
+
+    /* The key must be in RAM to write it back to flash: */
+    if (devkey_secmat_get(devkey_index) == NULL)
+    {
+        return NRF_ERROR_BUSY;
+    }
+
+    if (m_devkeys[devkey_index].element_count != element_count)
+    {
+        m_devkeys[devkey_index].element_count = element_count;
+        if (element_count > m_devkey_element_count_max)
+        {
+            m_devkey_element_count_max = element_count;
+        }
+        bitfield_set(m_devkey_needs_flashing, devkey_index);
+        (void) flash_save(DSM_ENTRY_TYPE_DEVKEY, devkey_index);
+    }
+    return NRF_SUCCESS;
+}
+
 uint32_t dsm_devkey_handle_get(uint16_t unicast_address, dsm_handle_t * p_devkey_handle)
 {
     if (p_devkey_handle == NULL)
@@ -2399,6 +3244,7 @@ uint32_t dsm_appkey_update(dsm_handle_t app_handle, const uint8_t * p_key)
         memcpy(m_appkeys[app_handle].secmat_updated.key, p_key, NRF_MESH_KEY_SIZE);
         NRF_MESH_ASSERT(nrf_mesh_keygen_aid(p_key, &m_appkeys[app_handle].secmat_updated.aid) == NRF_SUCCESS);
         m_appkeys[app_handle].secmat_updated.is_device_key = m_appkeys[app_handle].secmat.is_device_key;
+        aid_index_update(app_handle);
 
         bitfield_set(m_appkey_needs_flashing, app_handle);
         (void) flash_save(DSM_ENTRY_TYPE_APPKEY, app_handle);
@@ -2414,7 +3260,13 @@ uint32_t dsm_appkey_delete(dsm_handle_t app_handle)
     }
     else
     {
+        enc_key_forget(m_appkeys[app_handle].secmat.key);
+        if (m_appkeys[app_handle].key_updated)
+        {
+            enc_key_forget(m_appkeys[app_handle].secmat_updated.key);
+        }
         bitfield_clear(m_appkey_allocated, app_handle);
+        aid_index_update(app_handle);
         (void) flash_invalidate(DSM_ENTRY_TYPE_APPKEY, app_handle);
         return NRF_SUCCESS;
     }
@@ -2483,7 +3335,11 @@ uint32_t dsm_tx_secmat_get(dsm_handle_t subnet_handle, dsm_handle_t app_handle,
     }
     else
     {/* Device key */
-        p_secmat->p_app = &m_devkeys[app_handle - DSM_DEVKEY_HANDLE_START].secmat;
+        p_secmat->p_app = devkey_secmat_get(app_handle - DSM_DEVKEY_HANDLE_START);
+        if (p_secmat->p_app == NULL)
+        {
+            return NRF_ERROR_BUSY;
+        }
     }
 
     /* Use updated network security credentials during key refresh phase 2: */
@@ -2538,39 +3394,42 @@ void nrf_mesh_net_secmat_next_get(uint8_t nid, const nrf_mesh_network_secmat_t *
     NRF_MESH_ASSERT(NULL != pp_secmat);
     NRF_MESH_ASSERT(NULL != pp_secmat_secondary);
 
-    uint32_t i = 0;
-    if (*pp_secmat != NULL)
+    nid &= PACKET_MESH_NET_NID_MASK;
+
+    uint8_t entry;
+    if (*pp_secmat == NULL)
     {
-        i = get_subnet_handle(*pp_secmat) + 1; /* we want to iterate over the proceeding elements */
+        entry = m_nid_buckets[nid];
+    }
+    else
+    {
+        /* Continue along the bucket chain from the previous secmat: */
+        uint32_t secmat_index;
+        dsm_handle_t handle = get_subnet_handle_by_secmat(*pp_secmat, &secmat_index);
+        NRF_MESH_ASSERT(handle != DSM_HANDLE_INVALID);
+        NRF_MESH_ASSERT(m_subnets[handle].nid_bucket[secmat_index] == (NID_BUCKET_LINKED | nid));
+        entry = m_subnets[handle].nid_next[secmat_index];
     }
 
     *pp_secmat = NULL;
     *pp_secmat_secondary = NULL;
-    nid &= PACKET_MESH_NET_NID_MASK;
 
-    for (; i < DSM_SUBNET_MAX; i++)
+    if (entry != NID_ENTRY_NONE)
     {
-        if (bitfield_get(m_subnet_allocated, i))
+        const subnet_t * p_subnet = &m_subnets[(entry - 1) / SUBNET_SECMAT_COUNT];
+        if ((entry - 1) % SUBNET_SECMAT_COUNT == SUBNET_SECMAT_UPDATED)
+        {
+            /* During key refresh, the updated key is linked on its own if its NID differs: */
+            *pp_secmat = &p_subnet->secmat_updated;
+        }
+        else
         {
+            *pp_secmat = &p_subnet->secmat;
             /* If the NIDs for the old and the new network are equal, return both: */
-            if (m_subnets[i].key_refresh_phase != NRF_MESH_KEY_REFRESH_PHASE_0
-                    && (m_subnets[i].secmat.nid == nid && m_subnets[i].secmat_updated.nid == nid))
-            {
-                *pp_secmat = &m_subnets[i].secmat;
-                *pp_secmat_secondary = &m_subnets[i].secmat_updated;
-                break;
-            }
-            /* During key refresh, return the updated key if it matches the NID: */
-            else if (m_subnets[i].key_refresh_phase != NRF_MESH_KEY_REFRESH_PHASE_0
-                    && m_subnets[i].secmat_updated.nid == nid)
+            if (p_subnet->key_refresh_phase != NRF_MESH_KEY_REFRESH_PHASE_0
+                && (p_subnet->secmat_updated.nid & PACKET_MESH_NET_NID_MASK) == nid)
             {
-                *pp_secmat = &m_subnets[i].secmat_updated;
-                break;
-            }
-            else if (m_subnets[i].secmat.nid == nid)
-            {
-                *pp_secmat = &m_subnets[i].secmat;
-                break;
+                *pp_secmat_secondary = &p_subnet->secmat_updated;
             }
         }
     }
@@ -2586,10 +3445,37 @@ void nrf_mesh_app_secmat_next_get(const nrf_mesh_network_secmat_t * p_network_se
     if (subnet_handle == DSM_HANDLE_INVALID)
     {
         *pp_app_secmat = NULL;
+        return;
+    }
+
+    aid &= PACKET_MESH_TRS_ACCESS_AID_MASK;
+
+    uint8_t entry;
+    if (*pp_app_secmat == NULL)
+    {
+        entry = m_subnets[subnet_handle].aid_buckets[aid];
+    }
+    else
+    {
+        /* Continue along the bucket chain from the previous secmat: */
+        uint32_t secmat_index;
+        dsm_handle_t app_handle = get_app_handle_by_secmat(*pp_app_secmat, &secmat_index);
+        NRF_MESH_ASSERT(app_handle != DSM_HANDLE_INVALID);
+        NRF_MESH_ASSERT(m_appkeys[app_handle].aid_bucket[secmat_index] == (AID_BUCKET_LINKED | aid));
+        entry = m_appkeys[app_handle].aid_next[secmat_index];
+    }
+
+    if (entry == AID_ENTRY_NONE)
+    {
+        *pp_app_secmat = NULL;
+    }
+    else if ((entry - 1) % APPKEY_SECMAT_COUNT == APPKEY_SECMAT_UPDATED)
+    {
+        *pp_app_secmat = &m_appkeys[(entry - 1) / APPKEY_SECMAT_COUNT].secmat_updated;
     }
     else
     {
-        get_app_secmat(subnet_handle,aid, pp_app_secmat);
+        *pp_app_secmat = &m_appkeys[(entry - 1) / APPKEY_SECMAT_COUNT].secmat;
     }
 }
 
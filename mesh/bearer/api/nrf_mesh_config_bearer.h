@@ -112,6 +112,15 @@
 #define SCANNER_BUFFER_SIZE 512
 #endif
 
+/**
+ * Maximum number of scanner packets processed in a single bearer event. Processing several packets
+ * per event saves bearer event round trips on a busy scanner, while the limit keeps the other
+ * bearer event users from being starved.
+ */
+#ifndef SCANNER_RX_BATCH_SIZE
+#define SCANNER_RX_BATCH_SIZE 8
+#endif
+
 /** Buffer size for the experimental Instaburst RX module. */
 #ifndef INSTABURST_RX_BUFFER_SIZE
 #define INSTABURST_RX_BUFFER_SIZE   (1024)
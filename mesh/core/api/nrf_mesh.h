@@ -253,6 +253,17 @@ typedef struct
     uint8_t privacy_key[NRF_MESH_KEY_SIZE];
 } nrf_mesh_network_secmat_t;
 
+/**
+ * AES-CMAC subkeys of a key, precomputed for keys that authenticate many packets.
+ */
+typedef struct
+{
+    /** Subkey K1, used when the last block of the message is complete. */
+    uint8_t k1[NRF_MESH_KEY_SIZE];
+    /** Subkey K2, used when the last block of the message is padded. */
+    uint8_t k2[NRF_MESH_KEY_SIZE];
+} nrf_mesh_cmac_subkeys_t;
+
 /**
  * Security material for the Bluetooth Mesh network beacons.
  * This structure is used when sending a mesh network beacon advertisement.
@@ -264,6 +275,8 @@ typedef struct
 {
     /** Beacon key */
     uint8_t key[NRF_MESH_KEY_SIZE];
+    /** AES-CMAC subkeys of the beacon key. */
+    nrf_mesh_cmac_subkeys_t key_cmac_subkeys;
     /** Network ID */
     uint8_t net_id[NRF_MESH_NETID_SIZE];
 #if GATT_PROXY
@@ -86,6 +86,9 @@
 /**
  * Use the hardware AES-ECB block.
  *
+ * Set to 0 to use the software AES implementation instead, e.g., on targets without the AES-ECB
+ * peripheral or when running on the host.
+ *
  * @warning The S110 SoftDevice protects this hardware peripheral, but does not
  *          use it when we are in a timeslot. If there is not enough time to
  *          finish the AES-ECB operation before our timeslot ends, the module
@@ -95,6 +98,22 @@
 #define AES_USE_HARDWARE 1
 #endif
 
+/**
+ * Number of expanded AES keys cached by the software AES implementation. Only used when
+ * @ref AES_USE_HARDWARE is 0.
+ *
+ * Every subnet uses three keys (encryption, privacy and beacon key), and six during a key refresh.
+ * Every application key and device key uses one more. The default covers one subnet with a few
+ * application and device keys. Each entry takes 192 bytes of RAM.
+ *
+ * @note If more keys are in use than there are entries, the cache thrashes. Trial decryption with
+ * several keys that share a NID or AID then expands a key on most encryptions, costing about one
+ * extra block encryption each time.
+ */
+#ifndef AES_KEY_SCHEDULE_CACHE_SIZE
+#define AES_KEY_SCHEDULE_CACHE_SIZE 8
+#endif
+
 /** @} end of MESH_CONFIG_ENC */
 
 /**
@@ -235,6 +254,15 @@
 #define MSG_CACHE_ENTRY_COUNT 32
 #endif
 
+/**
+ * Number of slots in the message cache hash index. Must be a power of two, and larger than
+ * @ref MSG_CACHE_ENTRY_COUNT. Keeping the index at least twice the size of the cache keeps the
+ * lookup and insert probe sequences short.
+ */
+#ifndef MSG_CACHE_HASH_TABLE_SIZE
+#define MSG_CACHE_HASH_TABLE_SIZE (2 * MSG_CACHE_ENTRY_COUNT)
+#endif
+
 /** @} end of MESH_CONFIG_MSG_CACHE */
 
 /**
@@ -297,14 +325,81 @@
  * @defgroup MESH_CONFIG_TRANSPORT Transport layer configuration
  * @{
  */
-/** Maximum number of concurrent transport SAR sessions, shared by RX and TX. */
+/**
+ * Maximum number of concurrent transport SAR sessions, shared by RX and TX. Must be less than 255.
+ *
+ * Devices that receive segmented messages from many nodes at once, such as gateways collecting
+ * status replies to a group command, should raise this. When all sessions are in use, incoming
+ * segments for new sessions are dropped without acknowledgment, and the peers retransmit them.
+ */
 #ifndef TRANSPORT_SAR_SESSIONS_MAX
 #define TRANSPORT_SAR_SESSIONS_MAX (4)
 #endif
 
-/** Number of elements in the SAR RX cache, storing the last RX sessions. Must be power of two. */
+/**
+ * Number of hash buckets used for looking up active SAR sessions. Must be power of two.
+ *
+ * Should be kept at or above @ref TRANSPORT_SAR_SESSIONS_MAX to keep the lookup chains short.
+ */
+#ifndef TRANSPORT_SAR_SESSION_HASH_SIZE
+#define TRANSPORT_SAR_SESSION_HASH_SIZE (8)
+#endif
+
+/**
+ * @defgroup MESH_CONFIG_SAR_ARENA SAR arena configuration
+ * Number of blocks in each class of the SAR payload arena, see @ref SAR_ARENA. The blocks of
+ * class SEGn hold n segments. Allocations that don't find a free block in their class use a block
+ * from a larger class.
+ *
+ * An RX session holds a single block, which grows with the highest segment received. A 32 segment
+ * message in progress will briefly hold a SEG16 and a SEG32 block while it grows. The default block
+ * counts are sized for a small number of concurrent sessions, and must be raised along with
+ * @ref TRANSPORT_SAR_SESSIONS_MAX if all sessions may carry full-length messages.
+ * @{
+ */
+
+/** Use the SAR arena instead of @c malloc and @c free for SAR payload buffers. */
+#ifndef TRANSPORT_SAR_ARENA_ENABLED
+#define TRANSPORT_SAR_ARENA_ENABLED 0
+#endif
+
+#ifndef TRANSPORT_SAR_ARENA_SEG1_BLOCKS
+#define TRANSPORT_SAR_ARENA_SEG1_BLOCKS (2)
+#endif
+#ifndef TRANSPORT_SAR_ARENA_SEG2_BLOCKS
+#define TRANSPORT_SAR_ARENA_SEG2_BLOCKS (2)
+#endif
+#ifndef TRANSPORT_SAR_ARENA_SEG4_BLOCKS
+#define TRANSPORT_SAR_ARENA_SEG4_BLOCKS (2)
+#endif
+#ifndef TRANSPORT_SAR_ARENA_SEG8_BLOCKS
+#define TRANSPORT_SAR_ARENA_SEG8_BLOCKS (2)
+#endif
+#ifndef TRANSPORT_SAR_ARENA_SEG16_BLOCKS
+#define TRANSPORT_SAR_ARENA_SEG16_BLOCKS (2)
+#endif
+#ifndef TRANSPORT_SAR_ARENA_SEG32_BLOCKS
+#define TRANSPORT_SAR_ARENA_SEG32_BLOCKS (2)
+#endif
+/** @} end of MESH_CONFIG_SAR_ARENA */
+
+/**
+ * Number of elements in the SAR RX cache, storing the last RX sessions. Must be power of two.
+ *
+ * Late segments of a session in the cache are acknowledged (or ignored, if the session failed)
+ * instead of starting a new reassembly. The cache should hold all sessions that can complete
+ * within @ref TRANSPORT_SAR_RX_CACHE_TIMEOUT_MS.
+ */
 #ifndef TRANSPORT_SAR_RX_CACHE_LEN
-#define TRANSPORT_SAR_RX_CACHE_LEN (8)
+#define TRANSPORT_SAR_RX_CACHE_LEN (256)
+#endif
+
+/**
+ * Time in milliseconds a completed SAR RX session is kept in the SAR RX cache. Should be longer
+ * than the time a peer keeps retransmitting the segments of a session.
+ */
+#ifndef TRANSPORT_SAR_RX_CACHE_TIMEOUT_MS
+#define TRANSPORT_SAR_RX_CACHE_TIMEOUT_MS (60000)
 #endif
 
 /** Default TTL value for SAR segmentation acknowledgments */
@@ -312,6 +407,53 @@
 #define TRANSPORT_SAR_SEGACK_TTL_DEFAULT (8)
 #endif
 
+/**
+ * Adapt the SAR retransmission timeout to the measured round trip time of each destination.
+ *
+ * The time from sending the first segment of a message until the first segment acknowledgment is
+ * used to keep a smoothed round trip time estimate per unicast destination. The retransmission
+ * timeout of later messages to the destination is derived from the estimate, and doubled for every
+ * round that isn't acknowledged. Destinations without an estimate use the configured base timeout
+ * and per hop addition. Segments are sent in bursts of at most @ref TRANSPORT_SAR_TX_PACING_WINDOW.
+ */
+#ifndef TRANSPORT_SAR_TX_ADAPTIVE_RETRY_ENABLED
+#define TRANSPORT_SAR_TX_ADAPTIVE_RETRY_ENABLED 0
+#endif
+
+/** Number of destinations to keep a round trip time estimate for, in adaptive retransmission mode. */
+#ifndef TRANSPORT_SAR_RTT_CACHE_SIZE
+#define TRANSPORT_SAR_RTT_CACHE_SIZE (8)
+#endif
+
+/**
+ * Maximum number of segments of a SAR session to hand to the network layer at a time, in adaptive
+ * retransmission mode. The next burst is sent when the previous segments have been transmitted.
+ */
+#ifndef TRANSPORT_SAR_TX_PACING_WINDOW
+#define TRANSPORT_SAR_TX_PACING_WINDOW (8)
+#endif
+
+/**
+ * Number of entries in the virtual address resolution cache.
+ *
+ * The cache remembers which label UUID and application key last decrypted a message from a given
+ * source to a virtual address. That pair is tried first, before searching all label UUIDs sharing
+ * the virtual address hash.
+ */
+#ifndef TRANSPORT_VIRTUAL_RESOLUTION_CACHE_SIZE
+#define TRANSPORT_VIRTUAL_RESOLUTION_CACHE_SIZE (8)
+#endif
+
+/**
+ * Number of peers to keep transport statistics for.
+ *
+ * Peers get an entry when segments are sent to or received from them. When all entries are in
+ * use, the oldest entry is reused for the new peer.
+ */
+#ifndef TRANSPORT_PEER_STATS_COUNT
+#define TRANSPORT_PEER_STATS_COUNT (8)
+#endif
+
 /** @} end of MESH_CONFIG_TRANSPORT */
 /**
  * @defgroup MESH_CONFIG_PACMAN Packet manager configuration
@@ -395,6 +537,67 @@
 #define REPLAY_CACHE_ENTRIES 40
 #endif
 
+/**
+ * Number of buckets in the replay protection cache source address hash index. Must be a power of
+ * two. Should be at least the same as @ref REPLAY_CACHE_ENTRIES, to keep the bucket chains short.
+ */
+#ifndef REPLAY_CACHE_HASH_SIZE
+#define REPLAY_CACHE_HASH_SIZE 64
+#endif
+
+/**
+ * Evict the least recently used source from the replay protection cache when it is full, instead
+ * of dropping messages from new sources.
+ *
+ * When disabled, messages from new sources are dropped while the cache is full, and an
+ * @ref NRF_MESH_EVT_RX_FAILED event is sent with reason
+ * @ref NRF_MESH_RX_FAILED_REASON_REPLAY_CACHE_FULL.
+ *
+ * @warning An evicted source loses its replay protection on the RAM tier. Unless the flash overflow
+ * tier (@ref REPLAY_CACHE_FLASH_OVERFLOW_ENABLED) is enabled, previously seen messages from an
+ * evicted source will be accepted again if they are replayed. Only enable this on nodes that must
+ * receive from more sources than the cache can hold, such as gateways.
+ */
+#ifndef REPLAY_CACHE_LRU_EVICTION_ENABLED
+#define REPLAY_CACHE_LRU_EVICTION_ENABLED 0
+#endif
+
+/**
+ * Store sources evicted from the replay protection cache in a dedicated flash area, and look them
+ * up when they are not found in RAM. Requires @ref REPLAY_CACHE_LRU_EVICTION_ENABLED.
+ *
+ * The flash overflow tier is cleared when the replay protection cache is initialized. It requires
+ * @ref REPLAY_CACHE_FLASH_AREA_LOCATION to be set to a page aligned flash area of
+ * @ref REPLAY_CACHE_FLASH_PAGE_COUNT pages, that is not used by any other module.
+ *
+ * A source is only evicted once it has been written to flash. If the write can't be made, because
+ * the flash manager is out of memory or the write rate limit is reached, the cache behaves as if
+ * eviction was disabled, and drops the message from the new source.
+ */
+#ifndef REPLAY_CACHE_FLASH_OVERFLOW_ENABLED
+#define REPLAY_CACHE_FLASH_OVERFLOW_ENABLED 0
+#endif
+
+/** Number of flash pages reserved for the replay protection cache flash overflow tier. */
+#ifndef REPLAY_CACHE_FLASH_PAGE_COUNT
+#define REPLAY_CACHE_FLASH_PAGE_COUNT 1
+#endif
+
+/**
+ * Average interval between writes to the flash overflow tier, in milliseconds.
+ *
+ * Limits the flash wear caused by nodes that hear from more sources than the cache can hold. Evicting
+ * a source takes one write.
+ */
+#ifndef REPLAY_CACHE_FLASH_WRITE_INTERVAL_MS
+#define REPLAY_CACHE_FLASH_WRITE_INTERVAL_MS 1000
+#endif
+
+/** Number of writes to the flash overflow tier that can be made back to back after an idle period. */
+#ifndef REPLAY_CACHE_FLASH_WRITE_BURST
+#define REPLAY_CACHE_FLASH_WRITE_BURST 8
+#endif
+
 /** @} end of MESH_CONFIG_REPLAY_CACHE */
 
 /**
@@ -479,6 +682,56 @@
 #define ACCESS_MODEL_PUBLISH_PERIOD_RESTORE 0
 #endif
 
+/**
+ * Number of entries in the access layer opcode dispatch index.
+ *
+ * Every opcode handler of every model takes one entry. If the models' opcodes don't fit, incoming
+ * messages are dispatched by searching all models instead.
+ */
+#ifndef ACCESS_OPCODE_INDEX_ENTRY_COUNT
+#define ACCESS_OPCODE_INDEX_ENTRY_COUNT (ACCESS_MODEL_COUNT * 16 + 32)
+#endif
+
+/** Number of hash buckets in the access layer opcode dispatch index. Must be a power of two. */
+#ifndef ACCESS_OPCODE_INDEX_BUCKET_COUNT
+#define ACCESS_OPCODE_INDEX_BUCKET_COUNT (32)
+#endif
+
+/**
+ * Write-behind window for the device state manager flash storage, in microseconds.
+ *
+ * Changes to the device state are marked for flashing, and all changes made within the window are
+ * committed to flash in one batch when it expires. Changing the same entry several times within the
+ * window only writes it once. Call @ref dsm_flash_flush before powering down to commit pending
+ * changes immediately.
+ *
+ * Set to 0 to write every change to flash as it happens.
+ */
+#ifndef DSM_FLASH_WRITE_BEHIND_DELAY_US
+#define DSM_FLASH_WRITE_BEHIND_DELAY_US 0
+#endif
+
+/**
+ * Number of device keys the device state manager keeps in RAM.
+ *
+ * When this is lower than @c DSM_DEVICE_MAX, the least recently used device keys are only kept in
+ * flash, and are loaded on demand when they are needed for encryption or decryption. Device key
+ * handles stay valid regardless, but a device key security material pointer is only valid until
+ * <tt>DSM_DEVKEY_CACHE_SIZE - 1</tt> other device keys have been loaded from flash. The transport
+ * layer copies the security material of segmented messages, as they may wait for an earlier message
+ * to the same destination before they're encrypted. Keys that haven't been written to flash yet are
+ * never evicted: if every key in RAM is waiting for its flash write, the keys waiting for the
+ * @ref DSM_FLASH_WRITE_BEHIND_DELAY_US window are handed to the flash manager right away, and
+ * @ref dsm_devkey_add fails with @c NRF_ERROR_NO_MEM until one of them has been written.
+ *
+ * A cache smaller than @c DSM_DEVICE_MAX requires @c PERSISTENT_STORAGE, and must hold at least 2
+ * keys, as the transport layer looks up the device keys of both the source and destination of a
+ * message.
+ */
+#ifndef DSM_DEVKEY_CACHE_SIZE
+#define DSM_DEVKEY_CACHE_SIZE (DSM_DEVICE_MAX)
+#endif
+
 
 /** @} end of MESH_CONFIG_ACCESS */
 
@@ -103,7 +103,7 @@ typedef enum
  */
 typedef struct
 {
-    /** Buffer containing the message data. */
+    /** Buffer containing the message data. Only valid for the duration of the event. */
     const uint8_t * p_buffer;
     /** Message length. */
     uint16_t length;
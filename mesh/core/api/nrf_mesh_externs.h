@@ -70,7 +70,9 @@ extern void nrf_mesh_net_secmat_next_get(uint8_t nid, const nrf_mesh_network_sec
 /**
  * Request of application security material.
  * This function is expected to iterate, starting from the @c pp_app_secmat, if
- * it points to a valid security material.
+ * it points to a valid security material. Only application keys bound to the given network with a
+ * matching AID are returned. During key refresh, both the old and the updated application keys are
+ * returned.
  *
  * @note This function is implemented by the Device State Manager module.
  *
@@ -86,6 +88,10 @@ extern void nrf_mesh_app_secmat_next_get(const nrf_mesh_network_secmat_t * p_net
  * Request of device key security material for a specific device address.
  *
  * @note This function is implemented by the Device State Manager module.
+ * @note Any element address of a node resolves to the device key owned by its primary element, if
+ * the node's element count is known.
+ * @note The returned security material is only valid until <tt>DSM_DEVKEY_CACHE_SIZE - 1</tt> other
+ * device keys have been loaded from flash.
  *
  * @param[in] owner_addr Unicast address of the device to get the device key for.
  * @param[out] pp_devkey_secmat Double pointer that will contain the device key
@@ -46,10 +46,35 @@ typedef nrf_ecb_hal_data_t aes_data_t;
 #define AES_USE_SOFTDEVICE_ECB_WRAPPER SOFTDEVICE_PRESENT
 #endif
 
-#if AES_USE_SOFTDEVICE_ECB_WRAPPER
+/**
+ * Encrypts a single block with AES-128.
+ *
+ * The block is encrypted with the software backend when @ref AES_USE_HARDWARE is 0, through the
+ * SoftDevice when @ref AES_USE_SOFTDEVICE_ECB_WRAPPER is set, and directly with the AES-ECB
+ * peripheral otherwise.
+ *
+ * @param[in,out] p_aes_data Key and cleartext to encrypt. The result is written to its ciphertext.
+ */
+#if !AES_USE_HARDWARE
+void aes_encrypt(aes_data_t * p_aes_data);
+#elif AES_USE_SOFTDEVICE_ECB_WRAPPER
 #define aes_encrypt(data) (void) sd_ecb_block_encrypt((nrf_ecb_hal_data_t *) (data))
 #else
 void aes_encrypt(aes_data_t * p_aes_data);
 #endif
 
+/**
+ * Drops any state the AES backend keeps for the given key.
+ *
+ * The software backend caches expanded keys, which would otherwise stay in RAM until they're
+ * replaced by other keys. Call this when a key is deleted. Safe to call from any context.
+ *
+ * @param[in] p_key Key to drop.
+ */
+#if !AES_USE_HARDWARE
+void aes_key_forget(const uint8_t * p_key);
+#else
+#define aes_key_forget(p_key) ((void) (p_key))
+#endif
+
 #endif
@@ -39,12 +39,67 @@
 
 #include <stdint.h>
 
+#include "aes.h"
+#include "nrf_mesh.h"
+
 /**
  * @defgroup AES_CMAC AES-CMAC software implementation.
  * @ingroup MESH_CORE
  * @{
  */
 
+/**
+ * AES-CMAC context, for authenticating a message in several parts.
+ *
+ * @note The fields are internal to the module, use the aes_cmac_* functions to operate on it.
+ */
+typedef struct
+{
+    /** Key, and the current CBC-MAC value in the ciphertext. */
+    aes_data_t aes_data;
+    /** Subkeys of the key. */
+    const nrf_mesh_cmac_subkeys_t * p_subkeys;
+    /** Message bytes not yet authenticated, as the last block needs special treatment. */
+    uint8_t block[NRF_MESH_KEY_SIZE];
+    /** Number of bytes in @ref block. */
+    uint8_t block_len;
+} aes_cmac_ctx_t;
+
+/**
+ * Generates the AES-CMAC subkeys of a key.
+ *
+ * @param[in]  p_key      Pointer to a 128-bit encryption key.
+ * @param[out] p_subkeys  Subkeys of the key.
+ */
+void aes_cmac_subkeys_generate(const uint8_t * p_key, nrf_mesh_cmac_subkeys_t * p_subkeys);
+
+/**
+ * Starts a new AES-CMAC operation.
+ *
+ * @param[out] p_ctx     Context to initialize.
+ * @param[in]  p_key     Pointer to a 128-bit encryption key.
+ * @param[in]  p_subkeys Subkeys of the key, see @ref aes_cmac_subkeys_generate. Must stay valid
+ *                       until @ref aes_cmac_final is called.
+ */
+void aes_cmac_init(aes_cmac_ctx_t * p_ctx, const uint8_t * p_key, const nrf_mesh_cmac_subkeys_t * p_subkeys);
+
+/**
+ * Adds message data to an AES-CMAC operation.
+ *
+ * @param[in,out] p_ctx   Context of the operation.
+ * @param[in]     p_msg   Next part of the message.
+ * @param[in]     msg_len Length of the message part.
+ */
+void aes_cmac_update(aes_cmac_ctx_t * p_ctx, const uint8_t * p_msg, uint16_t msg_len);
+
+/**
+ * Finishes an AES-CMAC operation.
+ *
+ * @param[in,out] p_ctx Context of the operation.
+ * @param[out]    p_out Pointer to where the 128-bit result should be stored.
+ */
+void aes_cmac_final(aes_cmac_ctx_t * p_ctx, uint8_t * p_out);
+
 /**
  * Performs an AES-CMAC operation.
  * @param p_key         Pointer to a 128-bit encryption key.
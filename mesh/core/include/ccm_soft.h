@@ -87,6 +87,9 @@ void ccm_soft_encrypt(ccm_soft_data_t * p_data);
 /**
  * Decrypts data using the AES-CCM algorithm.
  *
+ * The message can be decrypted in place, by setting @c p_out to @c p_m. If the MIC doesn't match,
+ * the encrypted message is restored, so that the decryption can be retried with another key.
+ *
  * @param p_data       Pointer to structure with parameters for decrypting a message.
  *                     See @ref ccm_soft_data_t.
  * @param p_mic_passed Pointer to bool for storing result of MIC
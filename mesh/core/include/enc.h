@@ -130,6 +130,12 @@ void enc_key_generate(uint8_t * p_key);
  */
 void enc_aes_encrypt(const uint8_t * p_key, const uint8_t * p_plaintext, uint8_t * p_result);
 
+/**
+ * Drops any state kept for a key that's no longer in use, see @ref aes_key_forget.
+ * @param p_key         Pointer to the 128-bit key to drop.
+ */
+void enc_key_forget(const uint8_t * p_key);
+
 /**
  * Performs an AES-CMAC operation.
  * @param p_key         Pointer to a 128-bit encryption key.
@@ -139,6 +145,31 @@ void enc_aes_encrypt(const uint8_t * p_key, const uint8_t * p_plaintext, uint8_t
  */
 void enc_aes_cmac(const uint8_t * p_key, const uint8_t * p_data, uint16_t data_len, uint8_t * p_result);
 
+/**
+ * Generates the AES-CMAC subkeys of a key.
+ *
+ * Keys that authenticate many messages should have their subkeys generated once, and use
+ * @ref enc_aes_cmac_with_subkeys.
+ *
+ * @param p_key         Pointer to a 128-bit encryption key.
+ * @param p_subkeys     Pointer to where the subkeys should be stored.
+ */
+void enc_aes_cmac_subkeys_generate(const uint8_t * p_key, nrf_mesh_cmac_subkeys_t * p_subkeys);
+
+/**
+ * Performs an AES-CMAC operation with precomputed subkeys.
+ * @param p_key         Pointer to a 128-bit encryption key.
+ * @param p_subkeys     Subkeys of the key, see @ref enc_aes_cmac_subkeys_generate.
+ * @param p_data        Pointer to the data that should be hashed.
+ * @param data_len      Length of the input data.
+ * @param p_result      Pointer to where the 128-bit result should be stored.
+ */
+void enc_aes_cmac_with_subkeys(const uint8_t * p_key,
+                               const nrf_mesh_cmac_subkeys_t * p_subkeys,
+                               const uint8_t * p_data,
+                               uint16_t data_len,
+                               uint8_t * p_result);
+
 /**
  * Performs an AES-CCM encryption and authentication operation.
  *
@@ -61,6 +61,15 @@ typedef struct
     uint8_t * p_payload;
 } network_tx_packet_buffer_t;
 
+/** Network layer RX path statistics. */
+typedef struct
+{
+    /** Number of packets to other nodes, passed to the relay without any transport processing. */
+    uint32_t fast_path_packets;
+    /** Number of packets to addresses on this device, passed to the transport layer. */
+    uint32_t slow_path_packets;
+} network_rx_stats_t;
+
 /**
  * @defgroup NETWORK Network Layer
  * @ingroup MESH_CORE
@@ -131,9 +140,11 @@ void network_packet_discard(const network_tx_packet_buffer_t * p_buffer);
 
 /**
  * Function for processing incoming packets. Will attempt to decrypt the packet before passing it to
- * transport, along with extracted metadata.
+ * transport, along with extracted metadata. Packets that are not addressed to this device are only
+ * considered for relaying, and never reach the transport layer.
  *
- * @note Does not perform destination address lookup, but instead fills the raw value.
+ * @note Does not fill the full destination address in the metadata passed to transport, only the
+ * raw value.
  *
  * @param[in] p_packet Network packet to process.
  * @param[in] net_packet_len Length of the network packet.
@@ -145,6 +156,13 @@ void network_packet_discard(const network_tx_packet_buffer_t * p_buffer);
  */
 uint32_t network_packet_in(const uint8_t * p_packet, uint32_t net_packet_len, const nrf_mesh_rx_metadata_t * p_rx_metadata);
 
+/**
+ * Gets the network layer RX path statistics. The statistics are reset by @ref network_init.
+ *
+ * @param[out] p_stats Statistics structure to fill.
+ */
+void network_rx_stats_get(network_rx_stats_t * p_stats);
+
 /** @} */
 
 #endif
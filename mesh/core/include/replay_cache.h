@@ -45,6 +45,11 @@
  * @ingroup MESH_CORE
  * Stores information so that an already processed message originating from one
  * source would not be processed more than once.
+ *
+ * The entries are indexed by source address, and kept in least recently used order for each IV
+ * index bit. When the cache is full, the least recently used entry is evicted (see
+ * @ref REPLAY_CACHE_LRU_EVICTION_ENABLED), optionally into a flash overflow tier (see
+ * @ref REPLAY_CACHE_FLASH_OVERFLOW_ENABLED).
  * @{
  */
 
@@ -60,8 +65,9 @@ void replay_cache_init(void);
  * @param[in] seqno Message sequence number.
  * @param[in] ivi   IV index bit.
  *
- * @retval NRF_SUCCESS      Successfully added element.
- * @retval NRF_ERROR_NO_MEM No more memory available in the cache.
+ * @retval NRF_SUCCESS      Successfully added element. If the cache was full, the least recently
+ *                          used element was evicted to make room for it.
+ * @retval NRF_ERROR_NO_MEM No more memory available in the cache, and eviction is disabled.
  */
 uint32_t replay_cache_add(uint16_t src, uint32_t seqno, uint8_t ivi);
 
@@ -84,6 +90,8 @@ bool replay_cache_has_elem(uint16_t src, uint32_t seqno, uint8_t ivi);
 
 /**
  * Function to call in IV update.
+ *
+ * Clears the entries of the IV index bit that is being reused, in constant time.
  */
 void replay_cache_on_iv_update(void);
 
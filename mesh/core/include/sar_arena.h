@@ -0,0 +1,125 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef SAR_ARENA_H__
+#define SAR_ARENA_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @defgroup SAR_ARENA SAR reassembly buffer arena
+ * @ingroup MESH_CORE
+ * Dedicated memory for transport SAR payload buffers.
+ *
+ * The arena is split into slabs of fixed size blocks. Each slab holds blocks for a power of two
+ * number of segments, from 1 to 32 segments. An allocation is served by the smallest free block
+ * that fits it, so bursts of short and long messages can't fragment the memory for each other.
+ * The number of blocks in each slab is configured with the TRANSPORT_SAR_ARENA_SEG*_BLOCKS
+ * options.
+ *
+ * The arena is the default transport SAR allocator, see @ref transport_sar_mem_funcs_set.
+ * @{
+ */
+
+/** Number of payload bytes in a single segment block. */
+#define SAR_ARENA_SEGMENT_SIZE (12)
+/** Number of block classes, holding 1, 2, 4, 8, 16 and 32 segments. */
+#define SAR_ARENA_CLASS_COUNT  (6)
+/** Size of the largest block in the arena. */
+#define SAR_ARENA_BLOCK_SIZE_MAX (SAR_ARENA_SEGMENT_SIZE << (SAR_ARENA_CLASS_COUNT - 1))
+
+/** Usage statistics for a single block class. */
+typedef struct
+{
+    uint16_t block_size;  /**< Size of the blocks in the class, in bytes. */
+    uint16_t block_count; /**< Number of blocks in the class. */
+    uint16_t in_use;      /**< Number of blocks currently allocated. */
+    uint16_t high_water;  /**< Highest number of blocks allocated at the same time. */
+} sar_arena_class_stats_t;
+
+/** Arena usage statistics. */
+typedef struct
+{
+    sar_arena_class_stats_t classes[SAR_ARENA_CLASS_COUNT]; /**< Statistics for each block class, from the smallest to the largest. */
+    uint32_t bytes_in_use;     /**< Number of bytes in currently allocated blocks. */
+    uint32_t bytes_high_water; /**< Highest number of bytes in allocated blocks at the same time. */
+    uint32_t alloc_failures;   /**< Number of allocations that failed because no block large enough was free. */
+} sar_arena_stats_t;
+
+/**
+ * Initializes the arena, freeing all blocks and resetting the statistics.
+ */
+void sar_arena_init(void);
+
+/**
+ * Allocates a block from the arena. Matches the signature of stdlib's malloc.
+ *
+ * If all blocks of the smallest class that fits @p size are in use, the block is taken from the
+ * next larger class with a free block.
+ *
+ * @param[in] size Number of bytes to allocate.
+ *
+ * @returns A pointer to a block of at least @p size bytes, or NULL if there was no free block large
+ * enough.
+ */
+void * sar_arena_alloc(size_t size);
+
+/**
+ * Returns a block to the arena. Matches the signature of stdlib's free.
+ *
+ * @param[in] p_block Block previously returned by @ref sar_arena_alloc, or NULL.
+ */
+void sar_arena_free(void * p_block);
+
+/**
+ * Gets the usable size of an allocated block.
+ *
+ * @param[in] p_block Block previously returned by @ref sar_arena_alloc.
+ *
+ * @returns The size of the block, which may be larger than the size it was allocated with.
+ */
+size_t sar_arena_block_size_get(const void * p_block);
+
+/**
+ * Gets the arena usage statistics.
+ *
+ * @param[out] p_stats Statistics structure to fill.
+ */
+void sar_arena_stats_get(sar_arena_stats_t * p_stats);
+
+/** @} */
+#endif /* SAR_ARENA_H__ */
@@ -78,6 +78,18 @@
 /** Default number of retries before cancelling SAR TX session. */
 #define TRANSPORT_SAR_TX_RETRIES_DEFAULT (4)
 
+/** Number of SAR session cancel reasons counted in @ref transport_stats_t, one per @ref nrf_mesh_sar_session_cancel_reason_t. */
+#define TRANSPORT_SAR_CANCEL_REASON_COUNT (6)
+
+/** Number of bins in the segment acknowledgment latency histogram of @ref transport_stats_t. */
+#define TRANSPORT_SAR_ACK_LATENCY_BIN_COUNT (8)
+
+/**
+ * Upper bound of the first bin in the segment acknowledgment latency histogram. The upper bound is
+ * doubled for every following bin, and the last bin counts all latencies above the second to last.
+ */
+#define TRANSPORT_SAR_ACK_LATENCY_BIN_BASE_US MS_TO_US(32)
+
 /** Maximum number of control packet consumers. */
 #define TRANSPORT_CONTROL_PACKET_CONSUMERS_MAX   (1)
 
@@ -160,6 +172,75 @@ typedef void* (*transport_sar_alloc_t)(size_t size);
  */
 typedef void (*transport_sar_release_t)(void* ptr);
 
+/** Application key and virtual address trial decryption statistics. */
+typedef struct
+{
+    /** Number of candidate application keys that successfully decrypted a packet. */
+    uint32_t app_key_hits;
+    /** Number of candidate application keys with a matching AID that failed to decrypt a packet. */
+    uint32_t app_key_misses;
+    /** Number of packets to a virtual address decrypted with the cached label UUID and application key. */
+    uint32_t virtual_cache_hits;
+    /** Number of packets to a virtual address that had to search all label UUIDs sharing the address. */
+    uint32_t virtual_cache_misses;
+    /** Number of access messages that went through trial decryption. */
+    uint32_t messages;
+    /** Number of decryption attempts for those messages, with application keys and device keys. */
+    uint32_t attempts;
+} transport_decrypt_stats_t;
+
+/** Control packet receive statistics. */
+typedef struct
+{
+    /** Number of control packets received with each opcode, including segment acknowledgments and opcodes without a handler. */
+    uint32_t rx_count[TRANSPORT_CONTROL_PACKET_OPCODE_MAX + 1];
+} transport_control_stats_t;
+
+/** Aggregate transport statistics. */
+typedef struct
+{
+    /** Number of segments sent, including retransmissions. */
+    uint32_t segments_tx;
+    /** Number of segments received, including duplicates. */
+    uint32_t segments_rx;
+    /** Number of segments sent again after their first transmission. */
+    uint32_t retransmissions;
+    /** Number of received segments dropped for lack of a SAR session or buffer. */
+    uint32_t segments_dropped;
+    /** Number of TX sessions that completed successfully. */
+    uint32_t sessions_tx_completed;
+    /** Number of RX sessions that were completely reassembled. */
+    uint32_t sessions_rx_completed;
+    /** Number of sessions cancelled, indexed by @ref nrf_mesh_sar_session_cancel_reason_t. */
+    uint32_t sessions_cancelled[TRANSPORT_SAR_CANCEL_REASON_COUNT];
+    /**
+     * Histogram of the time from starting a TX session until its first segment acknowledgment.
+     * See @ref TRANSPORT_SAR_ACK_LATENCY_BIN_BASE_US for the bin bounds.
+     */
+    uint32_t ack_latency[TRANSPORT_SAR_ACK_LATENCY_BIN_COUNT];
+    /** Number of packets rejected by the replay protection. */
+    uint32_t replay_rejections;
+} transport_stats_t;
+
+/** Transport statistics for a single peer. */
+typedef struct
+{
+    /** Unicast address of the peer, or @ref NRF_MESH_ADDR_UNASSIGNED if the entry is unused. */
+    uint16_t address;
+    /** Number of segments sent to the peer, including retransmissions. */
+    uint32_t segments_tx;
+    /** Number of segments received from the peer, including duplicates. */
+    uint32_t segments_rx;
+    /** Number of segments sent again to the peer after their first transmission. */
+    uint32_t retransmissions;
+    /** Number of sessions with the peer that completed successfully. */
+    uint32_t sessions_completed;
+    /** Number of sessions with the peer that were cancelled. */
+    uint32_t sessions_cancelled;
+    /** Number of packets from the peer rejected by the replay protection. */
+    uint32_t replay_rejections;
+} transport_peer_stats_t;
+
 /**
  * Initializes the transport layer.
  *
@@ -168,13 +249,19 @@ typedef void (*transport_sar_release_t)(void* ptr);
 void transport_init(const nrf_mesh_init_params_t * p_init_params);
 
 /**
- * Set the SAR buffer allocation and release functions. Defaults to stdlib's
- * malloc and free. The transport layer has to allocate a temporary buffer
+ * Set the SAR buffer allocation and release functions. Defaults to @c malloc and
+ * @c free, or to the dedicated SAR arena if @ref TRANSPORT_SAR_ARENA_ENABLED is set,
+ * see @ref SAR_ARENA. The transport layer has to allocate a temporary buffer
  * for transport packets that span multiple network packets, in order to put
  * them together (RX) or split them (TX). The transport module takes no
  * precautions to prevent overlapping memory regions for different buffers,
  * although this will cause undefined behavior.
  *
+ * RX buffers are allocated for a power of two number of segments, covering the
+ * highest segment received so far. When a later segment doesn't fit, a larger
+ * buffer is allocated, the received segments are moved to it and the old
+ * buffer is released.
+ *
  * @note If both parameters are NULL, the function behaves like @ref
  * transport_sar_mem_funcs_reset. If only one of them is NULL, The function
  * does nothing and returns @c NRF_ERROR_NULL.
@@ -189,13 +276,63 @@ void transport_init(const nrf_mesh_init_params_t * p_init_params);
 uint32_t transport_sar_mem_funcs_set(transport_sar_alloc_t alloc_func, transport_sar_release_t release_func);
 
 /**
- * Reset the SAR buffer allocation and release functions to malloc and free.
+ * Reset the SAR buffer allocation and release functions to their defaults, see @ref
+ * transport_sar_mem_funcs_set.
  */
 void transport_sar_mem_funcs_reset(void);
+/**
+ * Gets the application key trial decryption statistics.
+ *
+ * Every application key with an AID matching an incoming packet is a decryption candidate. Each
+ * miss is a wasted decryption attempt. For packets to virtual addresses, every label UUID sharing
+ * the address is a candidate as well, unless the cached resolution for the source succeeds.
+ *
+ * @param[out] p_stats Statistics structure to fill.
+ */
+void transport_decrypt_stats_get(transport_decrypt_stats_t * p_stats);
+
+/**
+ * Gets the control packet receive statistics.
+ *
+ * Every control packet addressed to this device is counted once, after reassembly, whether there's
+ * a handler for its opcode or not. The statistics are reset by @ref transport_init.
+ *
+ * @param[out] p_stats Statistics structure to fill.
+ */
+void transport_control_stats_get(transport_control_stats_t * p_stats);
+
+/**
+ * Gets the aggregate transport statistics.
+ *
+ * The statistics are reset by @ref transport_init.
+ *
+ * @param[out] p_stats Statistics structure to fill.
+ */
+void transport_stats_get(transport_stats_t * p_stats);
+
+/**
+ * Gets the transport statistics of a peer.
+ *
+ * Statistics are kept for the @ref TRANSPORT_PEER_STATS_COUNT peers that most recently started
+ * exchanging segments with this device. Replay rejections are only counted for peers that already
+ * have an entry.
+ *
+ * @param[in]  index   Index of the entry to get, from 0 to @ref TRANSPORT_PEER_STATS_COUNT - 1.
+ * @param[out] p_stats Statistics structure to fill.
+ *
+ * @retval NRF_SUCCESS         The statistics were copied to @p p_stats.
+ * @retval NRF_ERROR_NULL      @p p_stats was NULL.
+ * @retval NRF_ERROR_NOT_FOUND There's no peer with the given index.
+ */
+uint32_t transport_peer_stats_get(uint32_t index, transport_peer_stats_t * p_stats);
+
 /**
  * Function for passing packets from the network layer to the transport layer.
  *
- * @param[in] p_packet Pointer to the transport packet.
+ * Unsegmented access messages are decrypted in place, and passed to the application without
+ * copying them. The content of @p p_packet is undefined after the call.
+ *
+ * @param[in,out] p_packet Pointer to the transport packet.
  * @param[in] trs_packet_len Length of the transport packet.
  * @param[in] p_net_metadata Pre-filled network metadata structure. Note that the transport layer
  * expects the destination address to have its value field set, and will fill in the rest of the
@@ -207,7 +344,7 @@ void transport_sar_mem_funcs_reset(void);
  * @retval NRF_ERROR_NULL         One or more of the input parameters was NULL.
  * @retval NRF_SUCCESS            The packet was successfully decrypted and sent up the stack.
  */
-uint32_t transport_packet_in(const packet_mesh_trs_packet_t * p_packet,
+uint32_t transport_packet_in(packet_mesh_trs_packet_t * p_packet,
                              uint32_t trs_packet_len,
                              const network_packet_metadata_t * p_net_metadata,
                              const nrf_mesh_rx_metadata_t * p_rx_metadata);
@@ -294,6 +431,9 @@ uint32_t transport_opt_get(nrf_mesh_opt_id_t id, nrf_mesh_opt_t * const p_opt);
 /**
  * Add a control packet consumer to the list of consumers.
  *
+ * The handlers are copied into a dispatch table indexed by opcode, so @p p_handlers doesn't have to
+ * stay valid after the call.
+ *
  * @param[in] p_handlers An array of control packet handlers.
  * @param[in] handler_count The number of handlers in @p p_handlers.
  *
@@ -304,7 +444,7 @@ uint32_t transport_opt_get(nrf_mesh_opt_id_t id, nrf_mesh_opt_t * const p_opt);
  * TRANSPORT_CONTROL_PACKET_CONSUMERS_MAX to avoid this.
  * @retval NRF_ERROR_NULL One or more of the callbacks in the handler array is NULL.
  * @retval NRF_ERROR_FORBIDDEN One or more of the handlers have opcodes covered by existing
- * consumers.
+ * consumers, or by other handlers in @p p_handlers.
  * @retval NRF_ERROR_INVALID_DATA One or more of the handlers have opcodes higher than @ref
  * TRANSPORT_CONTROL_PACKET_OPCODE_MAX.
  */
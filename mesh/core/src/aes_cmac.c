@@ -42,90 +42,96 @@
 #include "utils.h"
 #include "nrf_mesh_assert.h"
 
-typedef enum
-{
-    CMAC_SUBKEY_INDEX_K1 = 1,
-    CMAC_SUBKEY_INDEX_K2 = 2,
-} cmac_subkey_index_t;
-
 static inline void xor_Rb(uint8_t * p_key)
 {
     /* Rb is all zeros except the last byte, which is 0x87. */
     p_key[NRF_MESH_KEY_SIZE - 1] ^= 0x87;
 }
 
-
-/**
- * Generates AES-CMAC Subkey K1 or K2.
- *
- * @param[in,out] p_aes_data An AES data structure with the correct key set.
- * Returns the correct subkey in its ciphertext.
- * @param[in] subkey_index Index of the subkey to generate.
- */
-static void aes_cmac_subkey_generate(aes_data_t * p_aes_data, cmac_subkey_index_t subkey_index)
+/* K_i+1 = (K_i << 1) xor (Rb && msb); */
+static void subkey_next(uint8_t * p_dst, const uint8_t * p_src)
 {
-    NRF_MESH_ASSERT(subkey_index == CMAC_SUBKEY_INDEX_K1 ||
-                    subkey_index == CMAC_SUBKEY_INDEX_K2);
-    memset(p_aes_data->cleartext, 0x00, sizeof(p_aes_data->cleartext));
-
-    /* Step 1: L = AES(K, zero) */
-    aes_encrypt(p_aes_data);
-
-    /* Calculate K1 or K2 */
-    for (cmac_subkey_index_t i = CMAC_SUBKEY_INDEX_K1; i <= subkey_index; ++i)
+    uint8_t msb = !!(p_src[0] & 0x80);
+    utils_lshift(p_dst, p_src, NRF_MESH_KEY_SIZE);
+    if (msb)
     {
-        /* K_i+1 = (K_i << 1) xor (Rb && msb); */
-        uint8_t msb = !!(p_aes_data->ciphertext[0] & 0x80);
-        utils_lshift(p_aes_data->ciphertext, p_aes_data->ciphertext, NRF_MESH_KEY_SIZE);
-        if (msb)
-        {
-            xor_Rb(p_aes_data->ciphertext);
-        }
+        xor_Rb(p_dst);
     }
 }
 
-
-void aes_cmac(const uint8_t * const p_key, const uint8_t * const p_msg, uint16_t msg_len, uint8_t * const p_out)
+static void block_authenticate(aes_cmac_ctx_t * p_ctx, const uint8_t * p_block)
 {
-    uint16_t num_blocks = (msg_len + 15)/16;
+    /* Y := X XOR M_i     */
+    /* X := AES-128(K, Y) */
+    utils_xor(p_ctx->aes_data.cleartext, p_ctx->aes_data.ciphertext, p_block, NRF_MESH_KEY_SIZE);
+    aes_encrypt(&p_ctx->aes_data);
+}
 
+void aes_cmac_subkeys_generate(const uint8_t * p_key, nrf_mesh_cmac_subkeys_t * p_subkeys)
+{
     aes_data_t aes_data;
     memcpy(aes_data.key, p_key, NRF_MESH_KEY_SIZE);
+    memset(aes_data.cleartext, 0x00, sizeof(aes_data.cleartext));
 
-    /* Last block */
-    uint8_t last[NRF_MESH_KEY_SIZE];
-    uint8_t remainder = (msg_len % 16);
-    bool flag = (num_blocks > 0 && remainder == 0);
-    cmac_subkey_index_t subkey_index = (flag ?
-                                        CMAC_SUBKEY_INDEX_K1 :
-                                        CMAC_SUBKEY_INDEX_K2);
+    /* L = AES(K, zero) */
+    aes_encrypt(&aes_data);
 
-    /* Generate the subkey we need */
-    aes_cmac_subkey_generate(&aes_data, subkey_index);
+    subkey_next(p_subkeys->k1, aes_data.ciphertext);
+    subkey_next(p_subkeys->k2, p_subkeys->k1);
+}
 
-    if (flag)
+void aes_cmac_init(aes_cmac_ctx_t * p_ctx, const uint8_t * p_key, const nrf_mesh_cmac_subkeys_t * p_subkeys)
+{
+    memcpy(p_ctx->aes_data.key, p_key, NRF_MESH_KEY_SIZE);
+    /* First X is zero */
+    memset(p_ctx->aes_data.ciphertext, 0x00, sizeof(p_ctx->aes_data.ciphertext));
+    p_ctx->p_subkeys = p_subkeys;
+    p_ctx->block_len = 0;
+}
+
+void aes_cmac_update(aes_cmac_ctx_t * p_ctx, const uint8_t * p_msg, uint16_t msg_len)
+{
+    while (msg_len > 0)
+    {
+        /* A full block can only be authenticated once we know it isn't the last one. */
+        if (p_ctx->block_len == NRF_MESH_KEY_SIZE)
+        {
+            block_authenticate(p_ctx, p_ctx->block);
+            p_ctx->block_len = 0;
+        }
+
+        uint16_t length = MIN(msg_len, NRF_MESH_KEY_SIZE - p_ctx->block_len);
+        memcpy(&p_ctx->block[p_ctx->block_len], p_msg, length);
+        p_ctx->block_len += length;
+        p_msg += length;
+        msg_len -= length;
+    }
+}
+
+void aes_cmac_final(aes_cmac_ctx_t * p_ctx, uint8_t * p_out)
+{
+    uint8_t last[NRF_MESH_KEY_SIZE];
+    if (p_ctx->block_len == NRF_MESH_KEY_SIZE)
     {
-        utils_xor(last, &p_msg[(num_blocks-1)*NRF_MESH_KEY_SIZE], aes_data.ciphertext, NRF_MESH_KEY_SIZE);
+        utils_xor(last, p_ctx->block, p_ctx->p_subkeys->k1, NRF_MESH_KEY_SIZE);
     }
     else
     {
-        utils_pad(last, &p_msg[(num_blocks-1)*NRF_MESH_KEY_SIZE], remainder);
-        utils_xor(last, last, aes_data.ciphertext, NRF_MESH_KEY_SIZE);
+        utils_pad(last, p_ctx->block, p_ctx->block_len);
+        utils_xor(last, last, p_ctx->p_subkeys->k2, NRF_MESH_KEY_SIZE);
     }
 
-    /* First X is zero */
-    memset(aes_data.ciphertext, 0x00, sizeof(aes_data.ciphertext));
+    block_authenticate(p_ctx, last);
+    memcpy(p_out, p_ctx->aes_data.ciphertext, NRF_MESH_KEY_SIZE);
+}
 
-    /* num_blocks may be zero! */
-    for (int i = 0; i < num_blocks - 1; ++i)
-    {
-        /* Y := X XOR M_i     */
-        /* X := AES-128(K, Y) */
-        utils_xor(aes_data.cleartext, aes_data.ciphertext, &p_msg[i*NRF_MESH_KEY_SIZE], NRF_MESH_KEY_SIZE);
-        aes_encrypt(&aes_data);
-    }
+void aes_cmac(const uint8_t * const p_key, const uint8_t * const p_msg, uint16_t msg_len, uint8_t * const p_out)
+{
+    nrf_mesh_cmac_subkeys_t subkeys;
+    aes_cmac_subkeys_generate(p_key, &subkeys);
 
-    utils_xor(aes_data.cleartext, last, aes_data.ciphertext, NRF_MESH_KEY_SIZE);
-    aes_encrypt(&aes_data);
-    memcpy(p_out, aes_data.ciphertext, NRF_MESH_KEY_SIZE);
+    aes_cmac_ctx_t ctx;
+    aes_cmac_init(&ctx, p_key, &subkeys);
+    aes_cmac_update(&ctx, p_msg, msg_len);
+    aes_cmac_final(&ctx, p_out);
 }
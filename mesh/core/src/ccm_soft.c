@@ -75,7 +75,8 @@
  * T in the spec and code.
  *
  * To decrypt, we first calculate data = (S[1..N] xor enc_data), then insert this clear text data
- * into B, calculate the MIC, and compare it.
+ * into B, calculate the MIC, and compare it. When decrypting in place and the MIC doesn't match,
+ * S[1..N] is applied once more to restore the encrypted data, so that the caller can try another key.
  */
 
 /* All multibyte numbers are in big endian. Nonces, keys and data are represented as byte streams,
@@ -238,6 +239,11 @@ void ccm_soft_decrypt(ccm_soft_data_t * p_data, bool * p_mic_passed)
     __LOG_XB(LOG_SRC_CCM, LOG_LEVEL_INFO, "ccm_soft_decrypt: IN",  p_data->p_m, p_data->m_len);
 #endif
 
+    /* Message blocks are decrypted as they're read, so the output can't be offset from the input. */
+    NRF_MESH_ASSERT(p_data->p_out == p_data->p_m ||
+                    p_data->p_out + p_data->m_len <= p_data->p_m ||
+                    p_data->p_m + p_data->m_len <= p_data->p_out);
+
     aes_data_t aes_data;
 
     memcpy(aes_data.key, p_data->p_key, CCM_BLOCK_SIZE);
@@ -265,6 +271,12 @@ void ccm_soft_decrypt(ccm_soft_data_t * p_data, bool * p_mic_passed)
 #endif
 
     *p_mic_passed = memcmp(mic_out, p_data->p_mic, p_data->mic_len) == 0;
+    if (!*p_mic_passed && p_data->p_out == p_data->p_m && p_data->m_len > 0)
+    {
+        /* Restore the encrypted data. */
+        build_a_block(p_data->p_nonce, aes_data.cleartext, 0);
+        ccm_soft_crypt(p_data, &aes_data);
+    }
 #if CCM_DEBUG_MODE_ENABLED
     if (!*p_mic_passed)
     {
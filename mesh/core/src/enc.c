@@ -58,6 +58,13 @@
 #define ENC_K4_KEY_DATA    { 'i', 'd', '6', 0x01 }
 #define ENC_K4_OUTPUT_MASK 0x3f
 
+/* AES-CMAC subkeys of the all-zero key used by s1. */
+static const nrf_mesh_cmac_subkeys_t m_s1_subkeys =
+{
+    .k1 = {0xcd, 0xd2, 0x97, 0xa9, 0xdf, 0x14, 0x58, 0x77, 0x10, 0x99, 0xf4, 0xb3, 0x94, 0x68, 0x56, 0x5c},
+    .k2 = {0x9b, 0xa5, 0x2f, 0x53, 0xbe, 0x28, 0xb0, 0xee, 0x21, 0x33, 0xe9, 0x67, 0x28, 0xd0, 0xac, 0x3f}
+};
+
 /********************/
 /* Public functions */
 /********************/
@@ -76,11 +83,33 @@ void enc_aes_encrypt(const uint8_t * p_key, const uint8_t * p_plaintext, uint8_t
     memcpy(p_result, aes_data.ciphertext, NRF_MESH_KEY_SIZE);
 }
 
+void enc_key_forget(const uint8_t * p_key)
+{
+    aes_key_forget(p_key);
+}
+
 void enc_aes_cmac(const uint8_t * p_key, const uint8_t * p_data, uint16_t data_len, uint8_t * p_result)
 {
     aes_cmac(p_key, p_data, data_len, p_result);
 }
 
+void enc_aes_cmac_subkeys_generate(const uint8_t * p_key, nrf_mesh_cmac_subkeys_t * p_subkeys)
+{
+    aes_cmac_subkeys_generate(p_key, p_subkeys);
+}
+
+void enc_aes_cmac_with_subkeys(const uint8_t * p_key,
+                               const nrf_mesh_cmac_subkeys_t * p_subkeys,
+                               const uint8_t * p_data,
+                               uint16_t data_len,
+                               uint8_t * p_result)
+{
+    aes_cmac_ctx_t ctx;
+    aes_cmac_init(&ctx, p_key, p_subkeys);
+    aes_cmac_update(&ctx, p_data, data_len);
+    aes_cmac_final(&ctx, p_result);
+}
+
 void enc_aes_ccm_encrypt(ccm_soft_data_t * const p_ccm_data)
 {
     ccm_soft_encrypt(p_ccm_data);
@@ -149,8 +178,8 @@ void enc_s1(const uint8_t * p_in, uint16_t in_length, uint8_t * p_out)
 {
     NRF_MESH_ASSERT(p_in != NULL && p_out != NULL);
 
-    uint8_t key[16] = {0};
-    enc_aes_cmac(key, p_in, in_length, p_out);
+    const uint8_t key[NRF_MESH_KEY_SIZE] = {0};
+    enc_aes_cmac_with_subkeys(key, &m_s1_subkeys, p_in, in_length, p_out);
 }
 
 void enc_k1(const uint8_t * p_ikm, const uint8_t ikm_length, const uint8_t * p_salt,
@@ -176,22 +205,26 @@ void enc_k2(const uint8_t * p_netkey, const uint8_t * p_p, uint16_t length_p,
     uint8_t key[NRF_MESH_KEY_SIZE];
     enc_aes_cmac(tmp, p_netkey, NRF_MESH_KEY_SIZE, key);
 
+    /* The same key is used for T1, T2 and T3. */
+    nrf_mesh_cmac_subkeys_t subkeys;
+    enc_aes_cmac_subkeys_generate(key, &subkeys);
+
     /* T0 = zero length input */
     /* T1 = AES-CMAC(key, T0 || P || 0x01) */
     memcpy(tmp, p_p, length_p);
     tmp[length_p] = 0x01;
-    enc_aes_cmac(key, tmp, length_p + 1, tmp);
+    enc_aes_cmac_with_subkeys(key, &subkeys, tmp, length_p + 1, tmp);
     p_output->nid = tmp[NRF_MESH_KEY_SIZE - 1] & ENC_K2_NID_MASK;
 
     /* T2 = AES-CMAC(key, T1 || P || 0x02) */
     memcpy(tmp + NRF_MESH_KEY_SIZE, p_p, length_p);
     tmp[NRF_MESH_KEY_SIZE + length_p] = 0x02;
-    enc_aes_cmac(key, tmp, NRF_MESH_KEY_SIZE + length_p + 1, p_output->encryption_key);
+    enc_aes_cmac_with_subkeys(key, &subkeys, tmp, NRF_MESH_KEY_SIZE + length_p + 1, p_output->encryption_key);
 
     /* T3 = AES-CMAC(key, T2 || P || 0x03) */
     memcpy(tmp, p_output->encryption_key, NRF_MESH_KEY_SIZE);
     tmp[NRF_MESH_KEY_SIZE + length_p] = 0x03;
-    enc_aes_cmac(key, tmp, NRF_MESH_KEY_SIZE + length_p + 1, p_output->privacy_key);
+    enc_aes_cmac_with_subkeys(key, &subkeys, tmp, NRF_MESH_KEY_SIZE + length_p + 1, p_output->privacy_key);
 }
 
 void enc_k3(const uint8_t * p_in, uint8_t * p_out)
@@ -35,13 +35,28 @@
  * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include <stdbool.h>
+#include <string.h>
 
 #include "msg_cache.h"
 #include "transport.h"
 #include "nrf_error.h"
+#include "nrf_mesh_assert.h"
+#include "utils.h"
 
 #include "log.h"
 
+/*****************************************************************************
+* Local defines
+*****************************************************************************/
+/** Marker for an unused slot in the hash index. */
+#define HASH_SLOT_EMPTY     (0xFFFF)
+/** Mask for wrapping hash index slot numbers. */
+#define HASH_SLOT_MASK      (MSG_CACHE_HASH_TABLE_SIZE - 1)
+
+NRF_MESH_STATIC_ASSERT(IS_POWER_OF_2(MSG_CACHE_HASH_TABLE_SIZE));
+NRF_MESH_STATIC_ASSERT(MSG_CACHE_HASH_TABLE_SIZE > MSG_CACHE_ENTRY_COUNT);
+NRF_MESH_STATIC_ASSERT(MSG_CACHE_ENTRY_COUNT < HASH_SLOT_EMPTY);
+
 /*****************************************************************************
 * Local type definitions
 *****************************************************************************/
@@ -56,12 +71,73 @@ typedef struct
 /*****************************************************************************
 * Static globals
 *****************************************************************************/
-/** Message cache buffer */
+/** Message cache buffer, keeping the entries in eviction order. */
 static msg_cache_entry_t m_msg_cache[MSG_CACHE_ENTRY_COUNT];
 
 /** Message cache head index */
 static uint32_t m_msg_cache_head = 0;
 
+/**
+ * Open addressed hash index into the message cache buffer, using linear probing. Each slot holds
+ * the index of a cache entry, or @ref HASH_SLOT_EMPTY.
+ */
+static uint16_t m_hash_index[MSG_CACHE_HASH_TABLE_SIZE];
+
+/*****************************************************************************
+* Static functions
+*****************************************************************************/
+static inline uint32_t hash_slot_get(uint16_t src, uint32_t seq)
+{
+    uint32_t hash = (seq ^ ((uint32_t) src << 16) ^ src) * 0x9E3779B1UL;
+    return (hash ^ (hash >> 16)) & HASH_SLOT_MASK;
+}
+
+static inline uint32_t hash_slot_next(uint32_t slot)
+{
+    return (slot + 1) & HASH_SLOT_MASK;
+}
+
+static void hash_index_insert(uint16_t entry_index)
+{
+    uint32_t slot = hash_slot_get(m_msg_cache[entry_index].src, m_msg_cache[entry_index].seq);
+    while (m_hash_index[slot] != HASH_SLOT_EMPTY)
+    {
+        slot = hash_slot_next(slot);
+    }
+    m_hash_index[slot] = entry_index;
+}
+
+/**
+ * Removes the given entry from the hash index.
+ *
+ * The entries following the removed slot in the same probe sequence are shifted back to fill the
+ * hole, so the index never needs tombstones and lookups stay short as the cache wraps around.
+ */
+static void hash_index_remove(uint16_t entry_index)
+{
+    uint32_t hole = hash_slot_get(m_msg_cache[entry_index].src, m_msg_cache[entry_index].seq);
+    while (m_hash_index[hole] != entry_index)
+    {
+        NRF_MESH_ASSERT(m_hash_index[hole] != HASH_SLOT_EMPTY);
+        hole = hash_slot_next(hole);
+    }
+
+    for (uint32_t slot = hash_slot_next(hole); m_hash_index[slot] != HASH_SLOT_EMPTY; slot = hash_slot_next(slot))
+    {
+        const msg_cache_entry_t * p_entry = &m_msg_cache[m_hash_index[slot]];
+        uint32_t home = hash_slot_get(p_entry->src, p_entry->seq);
+
+        /* The entry may only fill the hole if the hole is part of its probe sequence. */
+        if (((slot - home) & HASH_SLOT_MASK) >= ((slot - hole) & HASH_SLOT_MASK))
+        {
+            m_hash_index[hole] = m_hash_index[slot];
+            hole = slot;
+        }
+    }
+
+    m_hash_index[hole] = HASH_SLOT_EMPTY;
+}
+
 /*****************************************************************************
 * Interface functions
 *****************************************************************************/
@@ -73,28 +149,20 @@ void msg_cache_init(void)
         m_msg_cache[i].seq = 0;
         m_msg_cache[i].allocated = 0;
     }
+    memset(m_hash_index, 0xFF, sizeof(m_hash_index));
 
     m_msg_cache_head = 0;
 }
 
 bool msg_cache_entry_exists(uint16_t src_addr, uint32_t sequence_number)
 {
-    /* Search backwards from head */
-    uint32_t entry_index = m_msg_cache_head;
-    for (uint32_t i = 0; i < MSG_CACHE_ENTRY_COUNT; ++i)
+    for (uint32_t slot = hash_slot_get(src_addr, sequence_number);
+         m_hash_index[slot] != HASH_SLOT_EMPTY;
+         slot = hash_slot_next(slot))
     {
-        if (entry_index-- == 0) /* compare before subtraction */
-        {
-            entry_index = MSG_CACHE_ENTRY_COUNT - 1;
-        }
-
-        if (!m_msg_cache[entry_index].allocated)
-        {
-            return false; /* Gone past the last valid entry. */
-        }
-
-        if (m_msg_cache[entry_index].src == src_addr &&
-            m_msg_cache[entry_index].seq == sequence_number)
+        const msg_cache_entry_t * p_entry = &m_msg_cache[m_hash_index[slot]];
+        if (p_entry->src == src_addr &&
+            p_entry->seq == sequence_number)
         {
             return true;
         }
@@ -105,9 +173,15 @@ bool msg_cache_entry_exists(uint16_t src_addr, uint32_t sequence_number)
 
 void msg_cache_entry_add(uint16_t src, uint32_t seq)
 {
+    if (m_msg_cache[m_msg_cache_head].allocated)
+    {
+        hash_index_remove(m_msg_cache_head);
+    }
+
     m_msg_cache[m_msg_cache_head].src = src;
     m_msg_cache[m_msg_cache_head].seq = seq;
     m_msg_cache[m_msg_cache_head].allocated = true;
+    hash_index_insert(m_msg_cache_head);
 
     if ((++m_msg_cache_head) == MSG_CACHE_ENTRY_COUNT)
     {
@@ -121,5 +195,5 @@ void msg_cache_clear(void)
     {
         m_msg_cache[i].allocated = 0;
     }
+    memset(m_hash_index, 0xFF, sizeof(m_hash_index));
 }
-
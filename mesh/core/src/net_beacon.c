@@ -127,8 +127,8 @@ static void make_network_beacon_cmac(const net_beacon_t* p_beacon, const nrf_mes
     /* We only want a subset of the cmac in the beacon - push it to a temporary
      * buffer that can fit everything, then paste it in its right place. */
     uint8_t temp[NRF_MESH_KEY_SIZE];
-    enc_aes_cmac(p_beacon_secmat->key, (const uint8_t *) &p_beacon->payload,
-            sizeof(net_beacon_payload_t), temp);
+    enc_aes_cmac_with_subkeys(p_beacon_secmat->key, &p_beacon_secmat->key_cmac_subkeys,
+                              (const uint8_t *) &p_beacon->payload, sizeof(net_beacon_payload_t), temp);
     memcpy(p_cmac, temp, NET_BEACON_CMAC_SIZE);
 }
 
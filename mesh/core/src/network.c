@@ -67,6 +67,7 @@
  * Static variables *
  ********************/
 static nrf_mesh_relay_check_cb_t m_relay_check_cb;
+static network_rx_stats_t m_rx_stats;
 /********************
  * Static functions *
  ********************/
@@ -160,13 +161,12 @@ static bool metadata_is_valid(const network_packet_metadata_t * p_net_metadata)
 /**
  * Decide whether to relay based on rules in Mesh Profile Specification v1.0, section 3.4.6.3.
  *
- * @note Assumes that the message has been accepted for transport processing.
- *
  * @param[in] p_metadata Metadata to evaluate
+ * @param[in] dst_is_rx Whether the destination address is in the RX address list of this device.
  *
  * @returns Whether or not the packet represented by the metadata should be relayed.
  */
-static bool should_relay(const network_packet_metadata_t * p_metadata)
+static bool should_relay(const network_packet_metadata_t * p_metadata, bool dst_is_rx)
 {
     /* Relay feature must be enabled */
 #if EXPERIMENTAL_INSTABURST_ENABLED
@@ -183,13 +183,9 @@ static bool should_relay(const network_packet_metadata_t * p_metadata)
         return false;
     }
     /* Should not be directed to a unicast address on this device */
-    if (p_metadata->dst.type == NRF_MESH_ADDRESS_TYPE_UNICAST)
+    if (p_metadata->dst.type == NRF_MESH_ADDRESS_TYPE_UNICAST && dst_is_rx)
     {
-        nrf_mesh_address_t dummy_addr;
-        if (nrf_mesh_rx_address_get(p_metadata->dst.value, &dummy_addr))
-        {
-            return false;
-        }
+        return false;
     }
     /* Relay check callback function approves of the relay */
     if (m_relay_check_cb != NULL)
@@ -215,6 +211,7 @@ void network_init(const nrf_mesh_init_params_t * p_init_params)
     {
         m_relay_check_cb = p_init_params->relay_cb;
     }
+    memset(&m_rx_stats, 0, sizeof(m_rx_stats));
 
     net_state_init();
     net_state_recover_from_flash();
@@ -295,18 +292,41 @@ uint32_t network_packet_in(const uint8_t * p_packet, uint32_t net_packet_len, co
         proxy_net_packet_processed(&net_metadata, p_rx_metadata);
 #endif
 
-        const uint8_t * p_net_payload = packet_mesh_net_payload_get(&net_decrypted_packet);
+        uint8_t * p_net_payload = &net_decrypted_packet.pdu[PACKET_MESH_NET_PDU_OFFSET];
 
         uint8_t payload_len = net_packet_payload_len_get(&net_metadata, net_packet_len);
 
         __INTERNAL_EVENT_PUSH(INTERNAL_EVENT_NET_PACKET_RECEIVED, 0, net_packet_len, &net_decrypted_packet);
 
-        status = transport_packet_in((const packet_mesh_trs_packet_t *) p_net_payload,
-                                     payload_len,
-                                     &net_metadata,
-                                     p_rx_metadata);
+        /* Packets to other nodes can only be relayed, and don't need any transport processing. */
+        nrf_mesh_address_t dst_addr;
+        memset(&dst_addr, 0, sizeof(dst_addr));
+        bool dst_is_rx = nrf_mesh_rx_address_get(net_metadata.dst.value, &dst_addr);
+        if (dst_is_rx)
+        {
+            m_rx_stats.slow_path_packets++;
+
+            /* The transport layer decrypts the packet in place. Packets that may also be relayed
+             * are passed up as a copy, so the relayed packet keeps the original transport PDU. */
+            packet_mesh_trs_packet_t trs_packet_copy;
+            packet_mesh_trs_packet_t * p_trs_packet = (packet_mesh_trs_packet_t *) p_net_payload;
+            if (net_metadata.dst.type != NRF_MESH_ADDRESS_TYPE_UNICAST && net_metadata.ttl >= 2)
+            {
+                memcpy(&trs_packet_copy, p_net_payload, payload_len);
+                p_trs_packet = &trs_packet_copy;
+            }
+
+            status = transport_packet_in(p_trs_packet,
+                                         payload_len,
+                                         &net_metadata,
+                                         p_rx_metadata);
+        }
+        else
+        {
+            m_rx_stats.fast_path_packets++;
+        }
 
-        if (should_relay(&net_metadata))
+        if (should_relay(&net_metadata, dst_is_rx))
         {
             packet_relay(&net_metadata, p_net_payload, payload_len);
         }
@@ -315,6 +335,12 @@ uint32_t network_packet_in(const uint8_t * p_packet, uint32_t net_packet_len, co
     return status;
 }
 
+void network_rx_stats_get(network_rx_stats_t * p_stats)
+{
+    NRF_MESH_ASSERT(p_stats != NULL);
+    *p_stats = m_rx_stats;
+}
+
 uint32_t network_opt_set(nrf_mesh_opt_id_t id, const nrf_mesh_opt_t * p_opt)
 {
     if (p_opt == NULL)
@@ -173,49 +173,57 @@ static void nrf_mesh_listen(const uint8_t * p_packet,
     }
 }
 
-static bool scanner_packet_process_cb(void)
+static void scanner_packet_process(const scanner_packet_t * p_scanner_packet)
 {
-    /* Process all incoming packets: */
-    const scanner_packet_t * p_scanner_packet = scanner_rx();
+    nrf_mesh_rx_metadata_t metadata;
 
-    if (p_scanner_packet != NULL)
-    {
-        nrf_mesh_rx_metadata_t metadata;
+    metadata.source = NRF_MESH_RX_SOURCE_SCANNER;
+    metadata.params.scanner = p_scanner_packet->metadata;
 
-        metadata.source = NRF_MESH_RX_SOURCE_SCANNER;
-        metadata.params.scanner = p_scanner_packet->metadata;
+    /* Adv Ext packets in the advertising channels don't have regular advertising data */
+    if (p_scanner_packet->packet.header.length >= BLE_ADV_PACKET_OVERHEAD &&
+        p_scanner_packet->packet.header.type != BLE_PACKET_TYPE_ADV_EXT)
+    {
+        ad_listener_process((ble_packet_type_t) p_scanner_packet->packet.header.type,
+                            p_scanner_packet->packet.payload,
+                            p_scanner_packet->packet.header.length - BLE_ADV_PACKET_OVERHEAD,
+                            &metadata);
+    }
 
-        /* Adv Ext packets in the advertising channels don't have regular advertising data */
-        if (p_scanner_packet->packet.header.length >= BLE_ADV_PACKET_OVERHEAD &&
-            p_scanner_packet->packet.header.type != BLE_PACKET_TYPE_ADV_EXT)
+    /* Notify the application */
+    if (m_rx_cb)
+    {
+        nrf_mesh_adv_packet_rx_data_t rx_data;
+        rx_data.p_metadata = &metadata;
+        rx_data.adv_type = p_scanner_packet->packet.header.type;
+        if (p_scanner_packet->packet.header.length > BLE_ADV_PACKET_OVERHEAD)
         {
-            ad_listener_process((ble_packet_type_t) p_scanner_packet->packet.header.type,
-                                p_scanner_packet->packet.payload,
-                                p_scanner_packet->packet.header.length - BLE_ADV_PACKET_OVERHEAD,
-                                &metadata);
+            rx_data.length = p_scanner_packet->packet.header.length - BLE_ADV_PACKET_OVERHEAD;
+            rx_data.p_payload = p_scanner_packet->packet.payload;
         }
-
-        /* Notify the application */
-        if (m_rx_cb)
+        else
         {
-            nrf_mesh_adv_packet_rx_data_t rx_data;
-            rx_data.p_metadata = &metadata;
-            rx_data.adv_type = p_scanner_packet->packet.header.type;
-            if (p_scanner_packet->packet.header.length > BLE_ADV_PACKET_OVERHEAD)
-            {
-                rx_data.length = p_scanner_packet->packet.header.length - BLE_ADV_PACKET_OVERHEAD;
-                rx_data.p_payload = p_scanner_packet->packet.payload;
-            }
-            else
-            {
-                rx_data.length = 0;
-                rx_data.p_payload = NULL;
-            }
-
-            m_rx_cb(&rx_data);
+            rx_data.length = 0;
+            rx_data.p_payload = NULL;
         }
 
-        scanner_packet_release(p_scanner_packet);
+        m_rx_cb(&rx_data);
+    }
+
+    scanner_packet_release(p_scanner_packet);
+}
+
+static bool scanner_packet_process_cb(void)
+{
+    /* Process a batch of incoming packets, saving bearer event round trips on a busy scanner: */
+    for (uint32_t i = 0; i < SCANNER_RX_BATCH_SIZE; ++i)
+    {
+        const scanner_packet_t * p_scanner_packet = scanner_rx();
+        if (p_scanner_packet == NULL)
+        {
+            break;
+        }
+        scanner_packet_process(p_scanner_packet);
     }
 
     return !scanner_rx_pending();
@@ -81,6 +81,8 @@ uint32_t nrf_mesh_keygen_beacon_secmat(const uint8_t * p_netkey, nrf_mesh_beacon
     enc_s1(salt_input, sizeof(salt_input), salt);
     enc_k1(p_netkey, NRF_MESH_KEY_SIZE, salt, key_info,
            sizeof(key_info), p_secmat->key);
+    /* The beacon key authenticates every secure network beacon. */
+    enc_aes_cmac_subkeys_generate(p_secmat->key, &p_secmat->key_cmac_subkeys);
     return NRF_SUCCESS;
 }
 
@@ -39,64 +39,537 @@
 
 #include "nrf_mesh_defines.h"
 #include "nrf_mesh_config_core.h"
+#include "nrf_mesh_assert.h"
 #include "replay_cache.h"
+#include "utils.h"
+
+#if REPLAY_CACHE_FLASH_OVERFLOW_ENABLED
+#include "flash_manager.h"
+#include "timer.h"
+#endif
+
+/** Invalid entry index, used to terminate the bucket chains and lists. */
+#define ENTRY_INDEX_INVALID (0xFFFF)
+/** Epoch number that never matches the epoch of an IV index. */
+#define EPOCH_INVALID       (0)
+/** Index of the list of unused entries. Lists 0 and 1 hold the entries of each IV index bit. */
+#define LIST_FREE           (2)
+/** Number of entry lists. */
+#define LIST_COUNT          (3)
+/** Total number of entries, shared by both IV index bits. */
+#define ENTRY_POOL_SIZE     (2 * REPLAY_CACHE_ENTRIES)
+
+NRF_MESH_STATIC_ASSERT(IS_POWER_OF_2(REPLAY_CACHE_HASH_SIZE));
+NRF_MESH_STATIC_ASSERT(ENTRY_POOL_SIZE < ENTRY_INDEX_INVALID);
 
 typedef struct
 {
     uint32_t seqno : NETWORK_SEQNUM_BITS;
+    uint32_t ivi   : 1;
     uint16_t src;
+    uint16_t epoch;     /**< Epoch of the IV index bit when the entry was added. The entry is stale if it differs. */
+    uint16_t hash_next; /**< Next entry in the same hash bucket. */
+    uint16_t prev;      /**< Previous (more recently used) entry in the same list. */
+    uint16_t next;      /**< Next (less recently used) entry in the same list. */
 } replay_cache_entry_t;
 
+/** Doubly linked list of entries, ordered from most to least recently used. */
+typedef struct
+{
+    uint16_t head;
+    uint16_t tail;
+    uint16_t count;
+} entry_list_t;
+
 /**
+ * Entries for both IV index bits, each IV index bit can use up to @ref REPLAY_CACHE_ENTRIES of them.
  * @todo Get memory from elsewhere...
  */
-static replay_cache_entry_t m_replay_cache[2][REPLAY_CACHE_ENTRIES];
+static replay_cache_entry_t m_replay_cache[ENTRY_POOL_SIZE];
+
+/** Source address hash index, holding the first entry of each bucket chain. */
+static uint16_t m_hash_buckets[REPLAY_CACHE_HASH_SIZE];
+
+/** Least recently used order of the entries of each IV index bit, and the list of unused entries. */
+static entry_list_t m_lists[LIST_COUNT];
+
+/** Current epoch of each IV index bit. Bumped when the entries of the IV index bit are cleared. */
+static uint16_t m_ivi_epoch[2];
+
+/** Most recently assigned epoch. */
+static uint16_t m_epoch;
 
 static uint8_t m_cache_index = 0;
 
-void replay_cache_init(void)
+#if REPLAY_CACHE_FLASH_OVERFLOW_ENABLED
+#ifndef REPLAY_CACHE_FLASH_AREA_LOCATION
+#error "REPLAY_CACHE_FLASH_AREA_LOCATION must be set when REPLAY_CACHE_FLASH_OVERFLOW_ENABLED is enabled."
+#endif
+#if !REPLAY_CACHE_LRU_EVICTION_ENABLED
+#error "REPLAY_CACHE_FLASH_OVERFLOW_ENABLED requires REPLAY_CACHE_LRU_EVICTION_ENABLED."
+#endif
+NRF_MESH_STATIC_ASSERT(IS_PAGE_ALIGNED(REPLAY_CACHE_FLASH_AREA_LOCATION));
+NRF_MESH_STATIC_ASSERT(REPLAY_CACHE_FLASH_WRITE_INTERVAL_MS > 0 && REPLAY_CACHE_FLASH_WRITE_BURST > 0);
+
+/** Average interval between overflow writes, in microseconds. */
+#define FLASH_WRITE_INTERVAL_US (REPLAY_CACHE_FLASH_WRITE_INTERVAL_MS * 1000UL)
+
+/** Overflow entry for a single source address, stored with the source address as its handle. */
+typedef struct
 {
-    replay_cache_clear();
+    uint32_t seqno[2]; /**< Sequence number for each IV index bit. */
+    uint16_t epoch[2]; /**< Epoch of each sequence number, see @ref replay_cache_entry_t. */
+} replay_cache_flash_entry_t;
+
+typedef void (*flash_op_func_t)(void);
+
+/** Flash manager owning the overflow tier flash area. */
+static flash_manager_t m_flash_manager;
+/** Whether the overflow tier flash area can be used. */
+static bool m_flash_is_available;
+/** Number of overflow writes that can be made right away. */
+static uint32_t m_flash_write_budget;
+/** Time at which the write budget was last refilled. */
+static timestamp_t m_flash_write_budget_time;
+
+static void flash_area_build(void);
+#endif
+
+/*****************************************************************************
+* Entry list and hash index management
+*****************************************************************************/
+static inline uint32_t hash_bucket_get(uint16_t src, uint8_t ivi)
+{
+    uint32_t hash = ((uint32_t) src | ((uint32_t) ivi << 16)) * 0x9E3779B1UL;
+    return (hash >> 16) & (REPLAY_CACHE_HASH_SIZE - 1);
 }
 
-uint32_t replay_cache_add(uint16_t src, uint32_t seqno, uint8_t ivi)
+static inline bool entry_is_valid(const replay_cache_entry_t * p_entry)
+{
+    return (p_entry->src != NRF_MESH_ADDR_UNASSIGNED && p_entry->epoch == m_ivi_epoch[p_entry->ivi]);
+}
+
+static void list_remove(entry_list_t * p_list, uint16_t index)
+{
+    replay_cache_entry_t * p_entry = &m_replay_cache[index];
+
+    if (p_entry->prev == ENTRY_INDEX_INVALID)
+    {
+        p_list->head = p_entry->next;
+    }
+    else
+    {
+        m_replay_cache[p_entry->prev].next = p_entry->next;
+    }
+
+    if (p_entry->next == ENTRY_INDEX_INVALID)
+    {
+        p_list->tail = p_entry->prev;
+    }
+    else
+    {
+        m_replay_cache[p_entry->next].prev = p_entry->prev;
+    }
+    p_list->count--;
+}
+
+static void list_push_head(entry_list_t * p_list, uint16_t index)
+{
+    replay_cache_entry_t * p_entry = &m_replay_cache[index];
+    p_entry->prev = ENTRY_INDEX_INVALID;
+    p_entry->next = p_list->head;
+
+    if (p_list->head == ENTRY_INDEX_INVALID)
+    {
+        p_list->tail = index;
+    }
+    else
+    {
+        m_replay_cache[p_list->head].prev = index;
+    }
+    p_list->head = index;
+    p_list->count++;
+}
+
+/** Moves all entries of @p p_src to the end of @p p_dst in constant time. */
+static void list_splice(entry_list_t * p_src, entry_list_t * p_dst)
+{
+    if (p_src->head == ENTRY_INDEX_INVALID)
+    {
+        return;
+    }
+
+    if (p_dst->tail == ENTRY_INDEX_INVALID)
+    {
+        p_dst->head = p_src->head;
+    }
+    else
+    {
+        m_replay_cache[p_dst->tail].next = p_src->head;
+        m_replay_cache[p_src->head].prev = p_dst->tail;
+    }
+    p_dst->tail = p_src->tail;
+    p_dst->count += p_src->count;
+
+    p_src->head = ENTRY_INDEX_INVALID;
+    p_src->tail = ENTRY_INDEX_INVALID;
+    p_src->count = 0;
+}
+
+static uint16_t entry_find(uint16_t src, uint8_t ivi)
 {
-    for (uint_fast8_t i = 0; i < REPLAY_CACHE_ENTRIES; ++i)
+    for (uint16_t index = m_hash_buckets[hash_bucket_get(src, ivi)];
+         index != ENTRY_INDEX_INVALID;
+         index = m_replay_cache[index].hash_next)
     {
-        if (m_replay_cache[ivi][i].src == 0)
+        const replay_cache_entry_t * p_entry = &m_replay_cache[index];
+        if (p_entry->src == src && p_entry->ivi == ivi && entry_is_valid(p_entry))
         {
-            /* Free slot! */
-            m_replay_cache[ivi][i].seqno = seqno;
-            m_replay_cache[ivi][i].src   = src;
-            return NRF_SUCCESS;
+            return index;
         }
+    }
+
+    return ENTRY_INDEX_INVALID;
+}
 
-        if (m_replay_cache[ivi][i].src == src)
+static void hash_unlink(uint16_t index)
+{
+    const replay_cache_entry_t * p_entry = &m_replay_cache[index];
+    uint16_t * p_link = &m_hash_buckets[hash_bucket_get(p_entry->src, p_entry->ivi)];
+    while (*p_link != index)
+    {
+        NRF_MESH_ASSERT(*p_link != ENTRY_INDEX_INVALID);
+        p_link = &m_replay_cache[*p_link].hash_next;
+    }
+    *p_link = p_entry->hash_next;
+}
+
+/*****************************************************************************
+* Flash overflow tier
+*****************************************************************************/
+#if REPLAY_CACHE_FLASH_OVERFLOW_ENABLED
+static void flash_mem_listener_callback(void * p_args)
+{
+    NRF_MESH_ASSERT(p_args != NULL);
+    flash_op_func_t func = (flash_op_func_t) p_args; /*lint !e611 Suspicious cast */
+    func();
+}
+
+static void flash_remove_complete(const flash_manager_t * p_manager)
+{
+    (void) p_manager;
+    flash_area_build();
+}
+
+static void flash_area_build(void)
+{
+    flash_manager_config_t manager_config;
+    manager_config.write_complete_cb      = NULL;
+    manager_config.invalidate_complete_cb = NULL;
+    manager_config.remove_complete_cb     = flash_remove_complete;
+    manager_config.min_available_space    = 0;
+    manager_config.p_area = (const flash_manager_page_t *) REPLAY_CACHE_FLASH_AREA_LOCATION;
+    manager_config.page_count = REPLAY_CACHE_FLASH_PAGE_COUNT;
+
+    if (flash_manager_add(&m_flash_manager, &manager_config) == NRF_SUCCESS)
+    {
+        m_flash_is_available = true;
+    }
+    else
+    {
+        static fm_mem_listener_t mem_listener = {.callback = flash_mem_listener_callback,
+                                                 .p_args = flash_area_build};
+        flash_manager_mem_listener_register(&mem_listener);
+    }
+}
+
+/** Erases the overflow tier, and makes it available again once the removal is complete. */
+static void flash_area_reset(void)
+{
+    if (m_flash_manager.internal.state == FM_STATE_UNINITIALIZED)
+    {
+        flash_area_build();
+        if (m_flash_manager.internal.state == FM_STATE_READY)
         {
-            /* Free slot! */
-            m_replay_cache[ivi][i].seqno = seqno;
-            return NRF_SUCCESS;
+            /* Erase any sequence numbers left over from before the reset, as the epochs start over. */
+            m_flash_is_available = false;
+            flash_area_reset();
         }
     }
+    else if (m_flash_manager.internal.state != FM_STATE_REMOVING)
+    {
+        m_flash_is_available = false;
+        if (flash_manager_remove(&m_flash_manager) != NRF_SUCCESS)
+        {
+            static fm_mem_listener_t mem_listener = {.callback = flash_mem_listener_callback,
+                                                     .p_args = flash_area_reset};
+            flash_manager_mem_listener_register(&mem_listener);
+        }
+    }
+}
+
+static const replay_cache_flash_entry_t * flash_entry_get(uint16_t src)
+{
+    if (!m_flash_is_available || src > FLASH_MANAGER_HANDLE_MAX)
+    {
+        return NULL;
+    }
 
-    return NRF_ERROR_NO_MEM;
+    const fm_entry_t * p_entry = flash_manager_entry_get(&m_flash_manager, src);
+    return (p_entry == NULL) ? NULL : (const replay_cache_flash_entry_t *) p_entry->data;
 }
 
+/** Resets the write budget, allowing a full burst of overflow writes. */
+static void flash_write_budget_reset(void)
+{
+    m_flash_write_budget = REPLAY_CACHE_FLASH_WRITE_BURST;
+    m_flash_write_budget_time = timer_now();
+}
 
-bool replay_cache_has_elem(uint16_t src, uint32_t seqno, uint8_t ivi)
+/**
+ * Takes one overflow write from the budget, which is refilled with one write every
+ * @ref REPLAY_CACHE_FLASH_WRITE_INTERVAL_MS, up to @ref REPLAY_CACHE_FLASH_WRITE_BURST writes.
+ */
+static bool flash_write_budget_take(void)
+{
+    timestamp_t now = timer_now();
+    uint32_t refills = (now - m_flash_write_budget_time) / FLASH_WRITE_INTERVAL_US;
+    if (refills >= REPLAY_CACHE_FLASH_WRITE_BURST - m_flash_write_budget)
+    {
+        m_flash_write_budget = REPLAY_CACHE_FLASH_WRITE_BURST;
+        m_flash_write_budget_time = now;
+    }
+    else
+    {
+        m_flash_write_budget += refills;
+        m_flash_write_budget_time += refills * FLASH_WRITE_INTERVAL_US;
+    }
+
+    if (m_flash_write_budget == 0)
+    {
+        return false;
+    }
+    m_flash_write_budget--;
+    return true;
+}
+
+/**
+ * Writes an entry that is about to be evicted from RAM to the overflow tier.
+ *
+ * @returns Whether the entry was handed to the flash manager, and can be evicted.
+ */
+static bool overflow_store(const replay_cache_entry_t * p_evicted)
 {
-    for (uint_fast8_t i = 0; i < REPLAY_CACHE_ENTRIES; ++i)
+    if (!m_flash_is_available || p_evicted->src > FLASH_MANAGER_HANDLE_MAX ||
+        !flash_write_budget_take())
+    {
+        return false;
+    }
+
+    const replay_cache_flash_entry_t * p_old = flash_entry_get(p_evicted->src);
+    fm_entry_t * p_entry = flash_manager_entry_alloc(&m_flash_manager,
+                                                     p_evicted->src,
+                                                     sizeof(replay_cache_flash_entry_t));
+    if (p_entry == NULL)
     {
-        if (m_replay_cache[ivi][i].src == src)
+        /* The write was never made, give it back. */
+        m_flash_write_budget++;
+        return false;
+    }
+
+    replay_cache_flash_entry_t * p_data = (replay_cache_flash_entry_t *) p_entry->data;
+    if (p_old != NULL)
+    {
+        /* Keep the sequence number of the other IV index bit. */
+        memcpy(p_data, p_old, sizeof(replay_cache_flash_entry_t));
+    }
+    else
+    {
+        memset(p_data, 0, sizeof(replay_cache_flash_entry_t));
+    }
+    p_data->seqno[p_evicted->ivi] = p_evicted->seqno;
+    p_data->epoch[p_evicted->ivi] = p_evicted->epoch;
+    flash_manager_entry_commit(p_entry);
+    return true;
+}
+
+/**
+ * Renumbers the epochs of the overflow tier like @ref epoch_wrap renumbers the RAM entries. Erases
+ * the overflow tier instead if an entry can't be rewritten, as its old epochs could match the new
+ * ones.
+ */
+static void overflow_epoch_wrap(uint8_t old_index)
+{
+    if (!m_flash_is_available)
+    {
+        flash_area_reset();
+        return;
+    }
+
+    for (const fm_entry_t * p_entry = flash_manager_entry_next_get(&m_flash_manager, NULL, NULL);
+         p_entry != NULL;
+         p_entry = flash_manager_entry_next_get(&m_flash_manager, NULL, p_entry))
+    {
+        const replay_cache_flash_entry_t * p_old = (const replay_cache_flash_entry_t *) p_entry->data;
+        bool success;
+        if (p_old->epoch[old_index] == m_ivi_epoch[old_index])
         {
-            if (m_replay_cache[ivi][i].seqno < seqno)
+            fm_entry_t * p_new = flash_manager_entry_alloc(&m_flash_manager,
+                                                           p_entry->header.handle,
+                                                           sizeof(replay_cache_flash_entry_t));
+            success = (p_new != NULL);
+            if (success)
             {
-                return false;
+                replay_cache_flash_entry_t * p_data = (replay_cache_flash_entry_t *) p_new->data;
+                memset(p_data, 0, sizeof(replay_cache_flash_entry_t));
+                p_data->seqno[old_index] = p_old->seqno[old_index];
+                p_data->epoch[old_index] = 1;
+                flash_manager_entry_commit(p_new);
             }
+        }
+        else
+        {
+            success = (flash_manager_entry_invalidate(&m_flash_manager, p_entry->header.handle) == NRF_SUCCESS);
+        }
+
+        if (!success)
+        {
+            flash_area_reset();
+            return;
+        }
+    }
+}
+
+static bool overflow_seqno_get(uint16_t src, uint8_t ivi, uint32_t * p_seqno)
+{
+    const replay_cache_flash_entry_t * p_data = flash_entry_get(src);
+    if (p_data != NULL && p_data->epoch[ivi] == m_ivi_epoch[ivi])
+    {
+        *p_seqno = p_data->seqno[ivi];
+        return true;
+    }
+    return false;
+}
+#endif /* REPLAY_CACHE_FLASH_OVERFLOW_ENABLED */
+
+/*****************************************************************************
+* Static functions
+*****************************************************************************/
+/**
+ * Gets an unused entry for the given IV index bit, evicting its least recently used entry if the IV
+ * index bit already has @ref REPLAY_CACHE_ENTRIES entries.
+ *
+ * @returns The entry index, or @ref ENTRY_INDEX_INVALID if the IV index bit is full and its least
+ * recently used entry can't be evicted without losing its replay protection.
+ */
+static uint16_t entry_alloc(uint8_t ivi)
+{
+    entry_list_t * p_list = &m_lists[LIST_FREE];
+    if (m_lists[ivi].count == REPLAY_CACHE_ENTRIES)
+    {
+#if REPLAY_CACHE_LRU_EVICTION_ENABLED
+        p_list = &m_lists[ivi];
+#if REPLAY_CACHE_FLASH_OVERFLOW_ENABLED
+        if (!overflow_store(&m_replay_cache[p_list->tail]))
+        {
+            return ENTRY_INDEX_INVALID;
+        }
+#endif
+#else
+        return ENTRY_INDEX_INVALID;
+#endif
+    }
+    NRF_MESH_ASSERT(p_list->tail != ENTRY_INDEX_INVALID);
 
-            return true;
+    uint16_t index = p_list->tail;
+    list_remove(p_list, index);
+    if (m_replay_cache[index].src != NRF_MESH_ADDR_UNASSIGNED)
+    {
+        hash_unlink(index);
+        m_replay_cache[index].src = NRF_MESH_ADDR_UNASSIGNED;
+    }
+    return index;
+}
+
+/**
+ * Restarts the epoch numbering when the epoch counter wraps around, so that stale entries can never
+ * be mistaken for valid ones. Only runs once every 65535 IV updates.
+ */
+static void epoch_wrap(void)
+{
+    uint8_t old_index = m_cache_index ^ 0x01;
+#if REPLAY_CACHE_FLASH_OVERFLOW_ENABLED
+    overflow_epoch_wrap(old_index);
+#endif
+    for (uint32_t i = 0; i < ENTRY_POOL_SIZE; ++i)
+    {
+        replay_cache_entry_t * p_entry = &m_replay_cache[i];
+        if (p_entry->ivi == old_index && entry_is_valid(p_entry))
+        {
+            p_entry->epoch = 1;
+        }
+        else
+        {
+            p_entry->epoch = EPOCH_INVALID;
         }
     }
+    m_ivi_epoch[old_index] = 1;
+    m_epoch = 2;
+}
+
+/*****************************************************************************
+* Interface functions
+*****************************************************************************/
+void replay_cache_init(void)
+{
+    replay_cache_clear();
+}
+
+uint32_t replay_cache_add(uint16_t src, uint32_t seqno, uint8_t ivi)
+{
+    uint16_t index = entry_find(src, ivi);
+    if (index == ENTRY_INDEX_INVALID)
+    {
+        index = entry_alloc(ivi);
+        if (index == ENTRY_INDEX_INVALID)
+        {
+            return NRF_ERROR_NO_MEM;
+        }
+
+        replay_cache_entry_t * p_entry = &m_replay_cache[index];
+        p_entry->src = src;
+        p_entry->ivi = ivi;
+        p_entry->epoch = m_ivi_epoch[ivi];
+
+        uint32_t bucket = hash_bucket_get(src, ivi);
+        p_entry->hash_next = m_hash_buckets[bucket];
+        m_hash_buckets[bucket] = index;
+    }
+    else
+    {
+        list_remove(&m_lists[ivi], index);
+    }
+
+    m_replay_cache[index].seqno = seqno;
+    list_push_head(&m_lists[ivi], index);
+    return NRF_SUCCESS;
+}
+
+bool replay_cache_has_elem(uint16_t src, uint32_t seqno, uint8_t ivi)
+{
+    uint16_t index = entry_find(src, ivi);
+    if (index != ENTRY_INDEX_INVALID)
+    {
+        return (m_replay_cache[index].seqno >= seqno);
+    }
+
+#if REPLAY_CACHE_FLASH_OVERFLOW_ENABLED
+    uint32_t stored_seqno;
+    if (overflow_seqno_get(src, ivi, &stored_seqno))
+    {
+        return (stored_seqno >= seqno);
+    }
+#endif
 
     /* Not to be added to cache unless successful application decrypt! */
     return false;
@@ -104,13 +577,42 @@ bool replay_cache_has_elem(uint16_t src, uint32_t seqno, uint8_t ivi)
 
 void replay_cache_on_iv_update(void)
 {
-    /* Clear old index */
+    /* Clear old index by releasing all its entries and starting a new epoch for it. The released
+     * entries are removed from the hash index when they are reused. */
     m_cache_index = (m_cache_index + 1) & 0x01;
-    memset(m_replay_cache[m_cache_index], 0, sizeof(m_replay_cache[0]));
+    list_splice(&m_lists[m_cache_index], &m_lists[LIST_FREE]);
+
+    if (++m_epoch == EPOCH_INVALID)
+    {
+        epoch_wrap();
+    }
+    m_ivi_epoch[m_cache_index] = m_epoch;
 }
 
 void replay_cache_clear(void)
 {
-    memset(m_replay_cache, 0, sizeof(m_replay_cache));
+    memset(m_hash_buckets, 0xFF, sizeof(m_hash_buckets));
+    for (uint32_t i = 0; i < LIST_COUNT; ++i)
+    {
+        m_lists[i].head = ENTRY_INDEX_INVALID;
+        m_lists[i].tail = ENTRY_INDEX_INVALID;
+        m_lists[i].count = 0;
+    }
+
+    for (uint16_t i = 0; i < ENTRY_POOL_SIZE; ++i)
+    {
+        m_replay_cache[i].src = NRF_MESH_ADDR_UNASSIGNED;
+        m_replay_cache[i].epoch = EPOCH_INVALID;
+        list_push_head(&m_lists[LIST_FREE], i);
+    }
+
+    m_epoch = 1;
+    m_ivi_epoch[0] = m_epoch;
+    m_ivi_epoch[1] = m_epoch;
     m_cache_index = 0;
+
+#if REPLAY_CACHE_FLASH_OVERFLOW_ENABLED
+    flash_write_budget_reset();
+    flash_area_reset();
+#endif
 }
@@ -0,0 +1,231 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "sar_arena.h"
+
+#include <string.h>
+
+#include "nrf_mesh_config_core.h"
+#include "nrf_mesh_assert.h"
+#include "packet_mesh.h"
+#include "toolchain.h"
+#include "utils.h"
+
+/** Number of blocks in the arena. */
+#define BLOCK_COUNT (TRANSPORT_SAR_ARENA_SEG1_BLOCKS + TRANSPORT_SAR_ARENA_SEG2_BLOCKS + \
+                     TRANSPORT_SAR_ARENA_SEG4_BLOCKS + TRANSPORT_SAR_ARENA_SEG8_BLOCKS + \
+                     TRANSPORT_SAR_ARENA_SEG16_BLOCKS + TRANSPORT_SAR_ARENA_SEG32_BLOCKS)
+/** Size of the arena, in bytes. */
+#define ARENA_SIZE  (SAR_ARENA_SEGMENT_SIZE *                   \
+                     (TRANSPORT_SAR_ARENA_SEG1_BLOCKS * 1 +     \
+                      TRANSPORT_SAR_ARENA_SEG2_BLOCKS * 2 +     \
+                      TRANSPORT_SAR_ARENA_SEG4_BLOCKS * 4 +     \
+                      TRANSPORT_SAR_ARENA_SEG8_BLOCKS * 8 +     \
+                      TRANSPORT_SAR_ARENA_SEG16_BLOCKS * 16 +   \
+                      TRANSPORT_SAR_ARENA_SEG32_BLOCKS * 32))
+
+/** End marker for the free lists. */
+#define BLOCK_INDEX_INVALID (0xFF)
+/** Marker for allocated blocks, which are in no free list. */
+#define BLOCK_INDEX_IN_USE  (0xFE)
+
+/* A segment block must fit the largest segment of both access and control messages. */
+NRF_MESH_STATIC_ASSERT(SAR_ARENA_SEGMENT_SIZE == PACKET_MESH_TRS_SEG_ACCESS_PDU_MAX_SIZE);
+NRF_MESH_STATIC_ASSERT(SAR_ARENA_SEGMENT_SIZE >= PACKET_MESH_TRS_SEG_CONTROL_PDU_MAX_SIZE);
+/* Blocks are linked by 8-bit indexes. */
+NRF_MESH_STATIC_ASSERT(BLOCK_COUNT > 0 && BLOCK_COUNT < BLOCK_INDEX_IN_USE);
+
+typedef struct
+{
+    uint32_t offset;      /**< Offset of the first block of the class in the arena. */
+    uint8_t first_block;  /**< Index of the first block of the class. */
+    uint8_t free_head;    /**< First free block of the class. */
+} block_class_t;
+
+static const uint16_t m_class_block_counts[SAR_ARENA_CLASS_COUNT] =
+{
+    TRANSPORT_SAR_ARENA_SEG1_BLOCKS,
+    TRANSPORT_SAR_ARENA_SEG2_BLOCKS,
+    TRANSPORT_SAR_ARENA_SEG4_BLOCKS,
+    TRANSPORT_SAR_ARENA_SEG8_BLOCKS,
+    TRANSPORT_SAR_ARENA_SEG16_BLOCKS,
+    TRANSPORT_SAR_ARENA_SEG32_BLOCKS
+};
+
+/** Arena memory, word aligned so the blocks can hold any payload. */
+static uint32_t m_arena[CEIL_DIV(ARENA_SIZE, sizeof(uint32_t))];
+static block_class_t m_classes[SAR_ARENA_CLASS_COUNT];
+/** Next free block in the same class for each block, or @ref BLOCK_INDEX_IN_USE. */
+static uint8_t m_block_next[BLOCK_COUNT];
+static sar_arena_stats_t m_stats;
+
+static inline uint32_t class_block_size(uint32_t class_index)
+{
+    return SAR_ARENA_SEGMENT_SIZE << class_index;
+}
+
+static inline uint8_t * block_get(uint32_t class_index, uint8_t block)
+{
+    return (uint8_t *) m_arena + m_classes[class_index].offset +
+           (block - m_classes[class_index].first_block) * class_block_size(class_index);
+}
+
+static uint32_t class_index_get(const uint8_t * p_block)
+{
+    NRF_MESH_ASSERT(p_block >= (const uint8_t *) m_arena &&
+                    p_block < (const uint8_t *) m_arena + ARENA_SIZE);
+    uint32_t offset = p_block - (const uint8_t *) m_arena;
+    uint32_t class_index = SAR_ARENA_CLASS_COUNT - 1;
+    while (offset < m_classes[class_index].offset)
+    {
+        class_index--;
+    }
+    return class_index;
+}
+
+static void block_take(uint32_t class_index, uint8_t block)
+{
+    block_class_t * p_class = &m_classes[class_index];
+    sar_arena_class_stats_t * p_class_stats = &m_stats.classes[class_index];
+
+    p_class->free_head = m_block_next[block];
+    m_block_next[block] = BLOCK_INDEX_IN_USE;
+
+    p_class_stats->in_use++;
+    if (p_class_stats->in_use > p_class_stats->high_water)
+    {
+        p_class_stats->high_water = p_class_stats->in_use;
+    }
+    m_stats.bytes_in_use += p_class_stats->block_size;
+    if (m_stats.bytes_in_use > m_stats.bytes_high_water)
+    {
+        m_stats.bytes_high_water = m_stats.bytes_in_use;
+    }
+}
+
+void sar_arena_init(void)
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+
+    uint32_t offset = 0;
+    uint8_t block = 0;
+    for (uint32_t i = 0; i < SAR_ARENA_CLASS_COUNT; ++i)
+    {
+        m_classes[i].offset = offset;
+        m_classes[i].first_block = block;
+        m_classes[i].free_head = (m_class_block_counts[i] > 0) ? block : BLOCK_INDEX_INVALID;
+        for (uint32_t j = 0; j < m_class_block_counts[i]; ++j, ++block)
+        {
+            m_block_next[block] = (j + 1 < m_class_block_counts[i]) ? block + 1 : BLOCK_INDEX_INVALID;
+        }
+        offset += m_class_block_counts[i] * class_block_size(i);
+
+        m_stats.classes[i].block_size = class_block_size(i);
+        m_stats.classes[i].block_count = m_class_block_counts[i];
+    }
+}
+
+void * sar_arena_alloc(size_t size)
+{
+    if (size == 0 || size > SAR_ARENA_BLOCK_SIZE_MAX)
+    {
+        return NULL;
+    }
+
+    uint32_t class_index = 0;
+    while (class_block_size(class_index) < size)
+    {
+        class_index++;
+    }
+
+    void * p_block = NULL;
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    for (; class_index < SAR_ARENA_CLASS_COUNT; ++class_index)
+    {
+        uint8_t block = m_classes[class_index].free_head;
+        if (block != BLOCK_INDEX_INVALID)
+        {
+            block_take(class_index, block);
+            p_block = block_get(class_index, block);
+            break;
+        }
+    }
+    if (p_block == NULL)
+    {
+        m_stats.alloc_failures++;
+    }
+    _ENABLE_IRQS(was_masked);
+    return p_block;
+}
+
+void sar_arena_free(void * p_block)
+{
+    if (p_block == NULL)
+    {
+        return;
+    }
+
+    uint32_t class_index = class_index_get(p_block);
+    block_class_t * p_class = &m_classes[class_index];
+    uint32_t class_offset = (uint8_t *) p_block - block_get(class_index, p_class->first_block);
+    NRF_MESH_ASSERT(class_offset % class_block_size(class_index) == 0);
+    uint8_t block = p_class->first_block + class_offset / class_block_size(class_index);
+    NRF_MESH_ASSERT(m_block_next[block] == BLOCK_INDEX_IN_USE);
+
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    m_block_next[block] = p_class->free_head;
+    p_class->free_head = block;
+    m_stats.classes[class_index].in_use--;
+    m_stats.bytes_in_use -= class_block_size(class_index);
+    _ENABLE_IRQS(was_masked);
+}
+
+size_t sar_arena_block_size_get(const void * p_block)
+{
+    NRF_MESH_ASSERT(p_block != NULL);
+    return class_block_size(class_index_get(p_block));
+}
+
+void sar_arena_stats_get(sar_arena_stats_t * p_stats)
+{
+    NRF_MESH_ASSERT(p_stats != NULL);
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    *p_stats = m_stats;
+    _ENABLE_IRQS(was_masked);
+}
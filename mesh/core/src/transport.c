@@ -59,6 +59,7 @@
 #include "nrf_mesh_utils.h"
 #include "nrf_mesh_externs.h"
 #include "packet_mesh.h"
+#include "sar_arena.h"
 
 /*********************
  * Local definitions *
@@ -72,8 +73,28 @@
 #define TRANSPORT_UNSEG_PDU_LEN(control) ((control) ? PACKET_MESH_TRS_UNSEG_CONTROL_PDU_MAX_SIZE : PACKET_MESH_TRS_UNSEG_ACCESS_PDU_MAX_SIZE)
 
 #define TRANSPORT_SAR_RX_CACHE_LEN_MASK    (TRANSPORT_SAR_RX_CACHE_LEN - 1)
+/** End marker for SAR RX cache hash bucket chains. */
+#define SAR_RX_CACHE_INDEX_INVALID         (0xFFFF)
+
+/** Mask for SAR session hash bucket indexes. */
+#define TRANSPORT_SAR_SESSION_HASH_MASK    (TRANSPORT_SAR_SESSION_HASH_SIZE - 1)
+/** End marker for SAR session hash bucket chains and the free session list. */
+#define SAR_SESSION_INDEX_INVALID          (0xFF)
+/** Number of full segment acknowledgments to completed RX sessions to remember. */
+#define SAR_ACK_HISTORY_SIZE               (TRANSPORT_SAR_SESSIONS_MAX)
+/** Maximum number of times the adaptive retransmission timeout is doubled. */
+#define TRANSPORT_SAR_TX_RTO_BACKOFF_MAX   (6)
+
+/** Maximum number of segments of a TX session handed to the network layer at a time. */
+#if TRANSPORT_SAR_TX_ADAPTIVE_RETRY_ENABLED
+#define TRANSPORT_SAR_TX_BURST_SIZE        (TRANSPORT_SAR_TX_PACING_WINDOW)
+#else
+#define TRANSPORT_SAR_TX_BURST_SIZE        (TRANSPORT_SAR_SEGMENT_COUNT_MAX)
+#endif
 
 NRF_MESH_STATIC_ASSERT(IS_POWER_OF_2(TRANSPORT_SAR_RX_CACHE_LEN));
+/* Cache entries are linked by 16-bit indexes. */
+NRF_MESH_STATIC_ASSERT(TRANSPORT_SAR_RX_CACHE_LEN < SAR_RX_CACHE_INDEX_INVALID);
 /* The SEQZERO mask must be (power of two - 1) to work as a mask (ie if a bit in the mask is set to
  * 1, all lower bits must also be 1). */
 NRF_MESH_STATIC_ASSERT(IS_POWER_OF_2(TRANSPORT_SAR_SEQZERO_MASK + 1));
@@ -82,6 +103,16 @@ NRF_MESH_STATIC_ASSERT(NRF_MESH_SEG_PAYLOAD_SIZE_MAX == TRANSPORT_SAR_SEGMENT_CO
                        PACKET_MESH_TRS_TRANSMIC_SMALL_SIZE);
 /* Checks whether the maximum unsegmented access payload is according to 3.7.3 Access payload */
 NRF_MESH_STATIC_ASSERT(NRF_MESH_UNSEG_PAYLOAD_SIZE_MAX == PACKET_MESH_TRS_UNSEG_ACCESS_PDU_MAX_SIZE - PACKET_MESH_TRS_TRANSMIC_SMALL_SIZE);
+NRF_MESH_STATIC_ASSERT(TRANSPORT_VIRTUAL_RESOLUTION_CACHE_SIZE > 0);
+NRF_MESH_STATIC_ASSERT(IS_POWER_OF_2(TRANSPORT_SAR_SESSION_HASH_SIZE));
+/* Sessions are linked by 8-bit indexes. */
+NRF_MESH_STATIC_ASSERT(TRANSPORT_SAR_SESSIONS_MAX > 0 && TRANSPORT_SAR_SESSIONS_MAX < SAR_SESSION_INDEX_INVALID);
+NRF_MESH_STATIC_ASSERT(TRANSPORT_SAR_CANCEL_REASON_COUNT == NRF_MESH_SAR_CANCEL_PEER_STARTED_ANOTHER_SESSION + 1);
+NRF_MESH_STATIC_ASSERT(TRANSPORT_PEER_STATS_COUNT > 0);
+#if TRANSPORT_SAR_TX_ADAPTIVE_RETRY_ENABLED
+NRF_MESH_STATIC_ASSERT(TRANSPORT_SAR_RTT_CACHE_SIZE > 0);
+NRF_MESH_STATIC_ASSERT(TRANSPORT_SAR_TX_PACING_WINDOW > 0);
+#endif
 
 /*********************
  * Local types *
@@ -166,6 +197,7 @@ typedef struct
     {
         trs_sar_session_t session_type; /**< SAR session type. */
         uint16_t length;                /**< Total length of the session data (payload + mic). */
+        uint16_t capacity;              /**< Size of the payload buffer. */
         uint32_t block_ack;             /**< Bit-field of the acknowledged segments. */
         union
         {
@@ -176,7 +208,19 @@ typedef struct
                 uint8_t  retries;               /**< Number of retries left. */
                 bool payload_encrypted;         /**< Flag indicating whether the payload has been encrypted. */
                 bool seqzero_is_set;         /**< Flag indicating whether the seqzero has been set. */
+                bool waiting;                   /**< Flag indicating whether the session waits for an earlier session to the same destination to end. */
+                uint32_t queue_index;           /**< Order in which the session was queued, used to start waiting sessions in order. */
                 nrf_mesh_tx_token_t token;      /**< TX Token set by the user. */
+                /** Copy of the application security material. The payload is encrypted when the
+                 * session starts, and the device state manager may have reused the original for
+                 * another device key by then. */
+                nrf_mesh_application_secmat_t app_secmat;
+                uint32_t sent_segments;         /**< Bit-field of the segments that have been sent at least once. */
+                timestamp_t start_time;         /**< Time the first round of segments was sent. */
+#if TRANSPORT_SAR_TX_ADAPTIVE_RETRY_ENABLED
+                bool rtt_sample_pending;        /**< Flag indicating whether the next acknowledgment is a valid round trip time sample. */
+                uint8_t backoff;                /**< Number of times the retransmission timeout has been doubled. */
+#endif
             } tx;
             /** Fields that are only valid for RX-sessions */
             struct
@@ -191,41 +235,104 @@ typedef struct
     * Re-segmented SAR payload with 4 byte MIC at the end.
     */
     uint8_t * payload;
+    /** Index of the next session in the same hash bucket, or in the free list if the session is inactive. */
+    uint8_t hash_next;
 } trs_sar_ctx_t;
 
 /** Completed SAR session, used to cache previous sessions. */
 typedef struct
 {
-    bool successful;
-    uint8_t ivi;
-    uint16_t src;
-    uint32_t seqauth_seqnum;
+    uint16_t src;                   /**< Source address of the session, or @ref NRF_MESH_ADDR_UNASSIGNED if the entry is unused. */
+    uint16_t hash_next;             /**< Index of the next (older) entry in the same hash bucket. */
+    uint32_t seqauth_seqnum : 24;   /**< Sequence number part of the session's SeqAuth. */
+    uint32_t ivi : 1;               /**< IV index bit of the session's SeqAuth. */
+    uint32_t successful : 1;        /**< Whether the session was successfully reassembled. */
+    timestamp_t completed_at;       /**< Time the session was completed. */
 } completed_sar_session_t;
 
-/** A consumer of control packets. */
+/** Full segment acknowledgment sent for a completed RX session. */
 typedef struct
 {
-    const transport_control_packet_handler_t * p_handlers; /**< List of opcodes and their handler functions. */
-    uint32_t handler_count; /**< Number of handlers. */
-} control_packet_consumer_t;
+    uint16_t src;           /**< Source address of the session, or @ref NRF_MESH_ADDR_UNASSIGNED if the entry is unused. */
+    uint16_t seq_zero;      /**< SeqZero of the session. */
+    timestamp_t sent_at;    /**< Time the acknowledgment was sent. */
+} sar_ack_history_t;
+
+/** Label UUID and application key that last decrypted a message from a source to a virtual address. */
+typedef struct
+{
+    uint16_t src; /**< Source address of the message. */
+    uint16_t dst; /**< Virtual address the message was sent to. */
+    const uint8_t * p_virtual_uuid; /**< Label UUID that authenticated the message. */
+    const nrf_mesh_application_secmat_t * p_app_secmat; /**< Application key that decrypted the message, or NULL if the entry is unused. */
+} virtual_resolution_t;
+
+#if TRANSPORT_SAR_TX_ADAPTIVE_RETRY_ENABLED
+/** Round trip time estimate for segment acknowledgments from a destination. */
+typedef struct
+{
+    uint16_t dst;       /**< Unicast address of the destination, or @ref NRF_MESH_ADDR_UNASSIGNED if the entry is unused. */
+    timestamp_t srtt;   /**< Smoothed round trip time. */
+    timestamp_t rttvar; /**< Round trip time variation. */
+} sar_rtt_estimate_t;
+#endif
 /********************
  * Static variables *
  ********************/
 
 static transport_config_t m_trs_config;
 static trs_sar_ctx_t m_trs_sar_sessions[TRANSPORT_SAR_SESSIONS_MAX];
+/** Active RX sessions, hashed by source address. */
+static uint8_t m_sar_rx_buckets[TRANSPORT_SAR_SESSION_HASH_SIZE];
+/** Active TX sessions with a SeqZero, hashed by source address and SeqZero. */
+static uint8_t m_sar_tx_buckets[TRANSPORT_SAR_SESSION_HASH_SIZE];
+/** Head of the list of inactive sessions. */
+static uint8_t m_sar_free_head;
+/** Queue index of the next TX session. */
+static uint32_t m_sar_tx_queue_index;
+/** TX session to send the first segment of the next interleaved round from. */
+static uint32_t m_sar_tx_next;
 
 static transport_sar_alloc_t    m_sar_alloc;   /**< Allocation function for SAR packets. */
 static transport_sar_release_t  m_sar_release; /**< Release function for SAR packets. */
 
 static uint32_t m_sar_session_cache_head;
 static completed_sar_session_t m_sar_session_cache[TRANSPORT_SAR_RX_CACHE_LEN];
+/** Completed RX sessions, hashed by source address and SeqAuth. */
+static uint16_t m_sar_session_cache_buckets[TRANSPORT_SAR_RX_CACHE_LEN];
+/** Last full segment acknowledgments sent, replaced in round-robin order. */
+static sar_ack_history_t m_sar_ack_history[SAR_ACK_HISTORY_SIZE];
+static uint32_t m_sar_ack_history_next;
 
 /** Flag used to trigger SAR processing. */
 static bearer_event_flag_t m_sar_process_flag;
 
-static control_packet_consumer_t m_control_packet_consumers[TRANSPORT_CONTROL_PACKET_CONSUMERS_MAX];
+/** Control packet handler callbacks, indexed by opcode. */
+static transport_control_packet_callback_t m_control_packet_callbacks[TRANSPORT_CONTROL_PACKET_OPCODE_MAX + 1];
 static uint32_t m_control_packet_consumer_count;
+
+/** Control packet receive statistics. */
+static transport_control_stats_t m_control_stats;
+
+/** Application key trial decryption statistics. */
+static transport_decrypt_stats_t m_decrypt_stats;
+
+/** Aggregate transport statistics. */
+static transport_stats_t m_stats;
+
+/** Transport statistics per peer, replaced in round-robin order. */
+static transport_peer_stats_t m_peer_stats[TRANSPORT_PEER_STATS_COUNT];
+static uint32_t m_peer_stats_next;
+
+/** Virtual address resolution cache, replaced in round-robin order. */
+static virtual_resolution_t m_virtual_resolutions[TRANSPORT_VIRTUAL_RESOLUTION_CACHE_SIZE];
+static uint32_t m_virtual_resolution_next;
+
+#if TRANSPORT_SAR_TX_ADAPTIVE_RETRY_ENABLED
+/** Round trip time estimates per destination, replaced in round-robin order. */
+static sar_rtt_estimate_t m_sar_rtt_estimates[TRANSPORT_SAR_RTT_CACHE_SIZE];
+static uint32_t m_sar_rtt_estimate_next;
+#endif
 /********************
  * Static functions *
  ********************/
@@ -233,13 +340,15 @@ static uint32_t m_control_packet_consumer_count;
 static void ack_timeout(timestamp_t timestamp, void * p_context);
 static void retry_timeout(timestamp_t timestamp, void * p_context);
 static void abort_timeout(timestamp_t timestamp, void * p_context);
+static void sar_tx_session_next_start(uint16_t dst);
 
-static inline uint32_t block_ack_full(transport_packet_metadata_t * p_metadata)
+static inline uint32_t block_ack_full(const transport_packet_metadata_t * p_metadata)
 {
     NRF_MESH_ASSERT(p_metadata->segmented);
-    return ((1u << (p_metadata->segmentation.last_segment + 1)) - 1);
+    /* Shifting down avoids shifting by 32 for 32 segment messages. */
+    return (0xFFFFFFFFu >> (TRANSPORT_SAR_SEGMENT_COUNT_MAX - 1 - p_metadata->segmentation.last_segment));
 }
-static void upper_transport_packet_in(const uint8_t * p_upper_trs_packet,
+static void upper_transport_packet_in(uint8_t * p_upper_trs_packet,
                                       uint32_t upper_trs_packet_len,
                                       transport_packet_metadata_t * p_metadata,
                                       const nrf_mesh_rx_metadata_t * p_rx_metadata);
@@ -289,9 +398,153 @@ static inline uint32_t tx_retry_timer_delay_get(uint8_t ttl)
     return m_trs_config.tx_retry_base_timeout + m_trs_config.tx_retry_per_hop_addition * ttl;
 }
 
+#if TRANSPORT_SAR_TX_ADAPTIVE_RETRY_ENABLED
+static sar_rtt_estimate_t * sar_rtt_estimate_get(uint16_t dst)
+{
+    for (uint32_t i = 0; i < TRANSPORT_SAR_RTT_CACHE_SIZE; ++i)
+    {
+        if (m_sar_rtt_estimates[i].dst == dst)
+        {
+            return &m_sar_rtt_estimates[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Adds a round trip time sample to the estimate for a destination, using the smoothing factors of
+ * RFC 6298 (1/8 for the round trip time, 1/4 for its variation).
+ *
+ * @param[in] dst Unicast address the sample was measured for.
+ * @param[in] rtt Time from sending the first segment until the first acknowledgment.
+ */
+static void sar_rtt_sample_add(uint16_t dst, timestamp_t rtt)
+{
+    sar_rtt_estimate_t * p_estimate = sar_rtt_estimate_get(dst);
+    if (p_estimate == NULL)
+    {
+        p_estimate = &m_sar_rtt_estimates[m_sar_rtt_estimate_next];
+        m_sar_rtt_estimate_next = (m_sar_rtt_estimate_next + 1) % TRANSPORT_SAR_RTT_CACHE_SIZE;
+        p_estimate->dst = dst;
+        p_estimate->srtt = rtt;
+        p_estimate->rttvar = rtt / 2;
+    }
+    else
+    {
+        timestamp_t deviation = (p_estimate->srtt > rtt) ? (p_estimate->srtt - rtt) : (rtt - p_estimate->srtt);
+        p_estimate->rttvar = p_estimate->rttvar - p_estimate->rttvar / 4 + deviation / 4;
+        p_estimate->srtt = p_estimate->srtt - p_estimate->srtt / 8 + rtt / 8;
+    }
+}
+#endif
+
+/**
+ * Gets the statistics entry of a peer.
+ *
+ * @param[in] address Address of the peer. Only unicast addresses have an entry.
+ * @param[in] create  Whether to take over the oldest entry if the peer doesn't have one.
+ *
+ * @returns The peer's statistics entry, or NULL if it doesn't have one.
+ */
+static transport_peer_stats_t * peer_stats_get(uint16_t address, bool create)
+{
+    if (nrf_mesh_address_type_get(address) != NRF_MESH_ADDRESS_TYPE_UNICAST)
+    {
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < TRANSPORT_PEER_STATS_COUNT; ++i)
+    {
+        if (m_peer_stats[i].address == address)
+        {
+            return &m_peer_stats[i];
+        }
+    }
+
+    if (!create)
+    {
+        return NULL;
+    }
+
+    transport_peer_stats_t * p_peer_stats = &m_peer_stats[m_peer_stats_next];
+    m_peer_stats_next = (m_peer_stats_next + 1) % TRANSPORT_PEER_STATS_COUNT;
+    memset(p_peer_stats, 0, sizeof(transport_peer_stats_t));
+    p_peer_stats->address = address;
+    return p_peer_stats;
+}
+
+/** Gets the statistics entry of the peer on the other end of a SAR session, creating it if necessary. */
+static transport_peer_stats_t * sar_peer_stats_get(const trs_sar_ctx_t * p_sar_ctx)
+{
+    return peer_stats_get((p_sar_ctx->session.session_type == TRS_SAR_SESSION_RX)
+                              ? p_sar_ctx->metadata.net.src
+                              : p_sar_ctx->metadata.net.dst.value,
+                          true);
+}
+
 /**
- * Check whether the RX SAR session has been handled before. As the sessions are stored in a FIFO
- * cache manner, getting a pointer to the completed session.
+ * Adds a sample to the segment acknowledgment latency histogram.
+ *
+ * @param[in] latency Time from starting a TX session until its first acknowledgment.
+ */
+static void sar_ack_latency_sample_add(timestamp_t latency)
+{
+    uint32_t bin = 0;
+    while (bin < TRANSPORT_SAR_ACK_LATENCY_BIN_COUNT - 1 &&
+           latency >= ((timestamp_t) TRANSPORT_SAR_ACK_LATENCY_BIN_BASE_US << bin))
+    {
+        bin++;
+    }
+    m_stats.ack_latency[bin]++;
+}
+
+/**
+ * Gets the time to wait for an acknowledgment before retransmitting the unacknowledged segments.
+ *
+ * With @ref TRANSPORT_SAR_TX_ADAPTIVE_RETRY_ENABLED, unicast destinations with a round trip time
+ * estimate get a retransmission timeout of SRTT + 4 * RTTVAR, doubled for every unanswered round.
+ *
+ * @param[in] p_sar_ctx TX session to get the retransmission timeout of.
+ *
+ * @returns The retransmission timeout in microseconds.
+ */
+static uint32_t tx_retry_interval_get(const trs_sar_ctx_t * p_sar_ctx)
+{
+    if (p_sar_ctx->metadata.net.dst.type != NRF_MESH_ADDRESS_TYPE_UNICAST)
+    {
+        /* For non-unicast addresses, we're not going to get any acknowledgements, so there's no
+         * point in scaling the retry interval according to TTL. */
+        return tx_retry_timer_delay_get(0);
+    }
+
+#if TRANSPORT_SAR_TX_ADAPTIVE_RETRY_ENABLED
+    const sar_rtt_estimate_t * p_estimate = sar_rtt_estimate_get(p_sar_ctx->metadata.net.dst.value);
+    if (p_estimate != NULL)
+    {
+        uint64_t rto = ((uint64_t) p_estimate->srtt + 4 * (uint64_t) p_estimate->rttvar) << p_sar_ctx->session.params.tx.backoff;
+        return (uint32_t) MAX(TRANSPORT_SAR_TX_RETRY_TIMEOUT_BASE_MIN, MIN(TRANSPORT_SAR_TX_RETRY_TIMEOUT_BASE_MAX, rto));
+    }
+#endif
+    return tx_retry_timer_delay_get(p_sar_ctx->metadata.net.ttl);
+}
+
+static inline uint32_t sar_rx_cache_hash(uint16_t src, uint32_t seqauth_seqnum)
+{
+    uint32_t hash = ((uint32_t) src ^ (seqauth_seqnum << 16) ^ (seqauth_seqnum >> 16)) * 0x9E3779B1u;
+    return (hash >> 16) & TRANSPORT_SAR_RX_CACHE_LEN_MASK;
+}
+
+static inline bool sar_rx_cache_entry_expired(const completed_sar_session_t * p_completed_session, timestamp_t now)
+{
+    return (now - p_completed_session->completed_at > MS_TO_US(TRANSPORT_SAR_RX_CACHE_TIMEOUT_MS));
+}
+
+/**
+ * Check whether the RX SAR session has been handled before, and get a pointer to the completed
+ * session.
+ *
+ * Entries are linked into their hash bucket from the newest to the oldest, so the first expired
+ * entry in a bucket ends the search, and the expired tail of the bucket is dropped.
  *
  * @param[in] p_metadata Metadata to check for.
  *
@@ -305,22 +558,53 @@ static completed_sar_session_t * sar_rx_session_previously_handled(const transpo
     uint8_t ivi = p_metadata->net.internal.iv_index & NETWORK_IVI_MASK;
     uint32_t seqauth_seqnum = seqauth_sequence_number_get(p_metadata->net.internal.sequence_number,
                                                           p_metadata->segmentation.seq_zero);
+    timestamp_t now = timer_now();
 
-    for (uint32_t i = 0; i < TRANSPORT_SAR_RX_CACHE_LEN; ++i)
+    uint16_t * p_link = &m_sar_session_cache_buckets[sar_rx_cache_hash(src, seqauth_seqnum)];
+    while (*p_link != SAR_RX_CACHE_INDEX_INVALID)
     {
-        if (seqauth_seqnum == m_sar_session_cache[i].seqauth_seqnum &&
-            src == m_sar_session_cache[i].src &&
-            ivi == m_sar_session_cache[i].ivi)
+        completed_sar_session_t * p_completed_session = &m_sar_session_cache[*p_link];
+        if (sar_rx_cache_entry_expired(p_completed_session, now))
         {
-            return &m_sar_session_cache[i];
+            *p_link = SAR_RX_CACHE_INDEX_INVALID;
+            break;
+        }
+
+        if (seqauth_seqnum == p_completed_session->seqauth_seqnum &&
+            src == p_completed_session->src &&
+            ivi == p_completed_session->ivi)
+        {
+            return p_completed_session;
         }
+        p_link = &p_completed_session->hash_next;
     }
     return NULL;
 }
 
+/**
+ * Removes the oldest entry of the SAR RX cache from its hash bucket. As it's the oldest entry, it's
+ * always last in its bucket, unless it has been dropped from the bucket already.
+ *
+ * @param[in] index Index of the entry to remove.
+ */
+static void sar_rx_cache_entry_unlink(uint16_t index)
+{
+    const completed_sar_session_t * p_completed_session = &m_sar_session_cache[index];
+    uint16_t * p_link = &m_sar_session_cache_buckets[sar_rx_cache_hash(p_completed_session->src,
+                                                                      p_completed_session->seqauth_seqnum)];
+    while (*p_link != SAR_RX_CACHE_INDEX_INVALID)
+    {
+        if (*p_link == index)
+        {
+            *p_link = SAR_RX_CACHE_INDEX_INVALID;
+            return;
+        }
+        p_link = &m_sar_session_cache[*p_link].hash_next;
+    }
+}
 
 /**
- * Places completed SAR session into the session cache.
+ * Places completed SAR session into the session cache, replacing the oldest entry.
  *
  * @param[in] p_metadata SAR metadata handled.
  * @param[in] succeeded  The session has been succeeded or not.
@@ -329,14 +613,135 @@ static void sar_rx_session_mark_as_handled(const transport_packet_metadata_t * p
 {
     NRF_MESH_ASSERT(p_metadata->segmented);
 
-    completed_sar_session_t * p_completed_session = &m_sar_session_cache[m_sar_session_cache_head++ &
-                                                                         TRANSPORT_SAR_RX_CACHE_LEN_MASK];
+    uint16_t index = (uint16_t) (m_sar_session_cache_head++ & TRANSPORT_SAR_RX_CACHE_LEN_MASK);
+    completed_sar_session_t * p_completed_session = &m_sar_session_cache[index];
+    if (p_completed_session->src != NRF_MESH_ADDR_UNASSIGNED)
+    {
+        sar_rx_cache_entry_unlink(index);
+    }
 
     p_completed_session->src = p_metadata->net.src;
     p_completed_session->seqauth_seqnum = seqauth_sequence_number_get(p_metadata->net.internal.sequence_number,
                                                                       p_metadata->segmentation.seq_zero);
     p_completed_session->ivi = p_metadata->net.internal.iv_index & NETWORK_IVI_MASK;
     p_completed_session->successful = succeeded;
+    p_completed_session->completed_at = timer_now();
+
+    uint16_t * p_bucket = &m_sar_session_cache_buckets[sar_rx_cache_hash(p_completed_session->src,
+                                                                        p_completed_session->seqauth_seqnum)];
+    p_completed_session->hash_next = *p_bucket;
+    *p_bucket = index;
+}
+
+static inline uint32_t sar_session_hash(uint16_t address, uint16_t seq_zero)
+{
+    uint32_t hash = ((uint32_t) address | ((uint32_t) seq_zero << 16)) * 0x9E3779B1u;
+    return (hash >> 16) & TRANSPORT_SAR_SESSION_HASH_MASK;
+}
+
+static inline uint8_t sar_session_index(const trs_sar_ctx_t * p_sar_ctx)
+{
+    return (uint8_t) (p_sar_ctx - &m_trs_sar_sessions[0]);
+}
+
+/**
+ * Gets the hash bucket a session belongs in.
+ *
+ * RX sessions are hashed by the source address alone, as there can only be one session per source
+ * (Mesh Profile Specification v1.0, section 3.5.3.4). TX sessions are hashed by source address and
+ * SeqZero, which is what a segment acknowledgment identifies them by.
+ *
+ * @param[in] p_sar_ctx Session to get the bucket of.
+ *
+ * @returns A pointer to the head of the bucket.
+ */
+static uint8_t * sar_session_bucket_get(const trs_sar_ctx_t * p_sar_ctx)
+{
+    if (p_sar_ctx->session.session_type == TRS_SAR_SESSION_RX)
+    {
+        return &m_sar_rx_buckets[sar_session_hash(p_sar_ctx->metadata.net.src, 0)];
+    }
+    else
+    {
+        return &m_sar_tx_buckets[sar_session_hash(p_sar_ctx->metadata.net.src,
+                                                  p_sar_ctx->metadata.segmentation.seq_zero)];
+    }
+}
+
+static void sar_session_hash_add(trs_sar_ctx_t * p_sar_ctx)
+{
+    uint8_t * p_bucket = sar_session_bucket_get(p_sar_ctx);
+    p_sar_ctx->hash_next = *p_bucket;
+    *p_bucket = sar_session_index(p_sar_ctx);
+}
+
+static void sar_session_hash_remove(trs_sar_ctx_t * p_sar_ctx)
+{
+    uint8_t * p_index = sar_session_bucket_get(p_sar_ctx);
+    while (*p_index != sar_session_index(p_sar_ctx))
+    {
+        NRF_MESH_ASSERT(*p_index != SAR_SESSION_INDEX_INVALID);
+        p_index = &m_trs_sar_sessions[*p_index].hash_next;
+    }
+    *p_index = p_sar_ctx->hash_next;
+}
+
+/**
+ * Takes an inactive session from the free list.
+ *
+ * @returns A pointer to an inactive session, or NULL if all sessions are in use.
+ */
+static trs_sar_ctx_t * sar_session_take(void)
+{
+    trs_sar_ctx_t * p_sar_ctx = NULL;
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    if (m_sar_free_head != SAR_SESSION_INDEX_INVALID)
+    {
+        p_sar_ctx = &m_trs_sar_sessions[m_sar_free_head];
+        m_sar_free_head = p_sar_ctx->hash_next;
+        p_sar_ctx->hash_next = SAR_SESSION_INDEX_INVALID;
+    }
+    _ENABLE_IRQS(was_masked);
+    return p_sar_ctx;
+}
+
+/** Returns an inactive session to the free list. */
+static void sar_session_put(trs_sar_ctx_t * p_sar_ctx)
+{
+    NRF_MESH_ASSERT(p_sar_ctx->session.session_type == TRS_SAR_SESSION_INACTIVE);
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    p_sar_ctx->hash_next = m_sar_free_head;
+    m_sar_free_head = sar_session_index(p_sar_ctx);
+    _ENABLE_IRQS(was_masked);
+}
+
+static void sar_sessions_reset(void)
+{
+    memset(&m_trs_sar_sessions[0], 0, sizeof(m_trs_sar_sessions));
+    memset(m_sar_rx_buckets, SAR_SESSION_INDEX_INVALID, sizeof(m_sar_rx_buckets));
+    memset(m_sar_tx_buckets, SAR_SESSION_INDEX_INVALID, sizeof(m_sar_tx_buckets));
+    for (uint32_t i = 0; i < TRANSPORT_SAR_SESSIONS_MAX - 1; ++i)
+    {
+        m_trs_sar_sessions[i].hash_next = i + 1;
+    }
+    m_trs_sar_sessions[TRANSPORT_SAR_SESSIONS_MAX - 1].hash_next = SAR_SESSION_INDEX_INVALID;
+    m_sar_free_head = 0;
+}
+
+/**
+ * Gets the usable size of a SAR buffer. Buffers from the SAR arena may be larger than requested, and
+ * an RX session must not ask for a new buffer while its current one can hold the next segment.
+ */
+static uint32_t sar_buffer_capacity_get(const uint8_t * p_buffer, uint32_t requested_size)
+{
+#if TRANSPORT_SAR_ARENA_ENABLED
+    return (m_sar_alloc == sar_arena_alloc) ? sar_arena_block_size_get(p_buffer) : requested_size;
+#else
+    (void) p_buffer;
+    return requested_size;
+#endif
 }
 
 /**
@@ -346,18 +751,20 @@ static void sar_rx_session_mark_as_handled(const transport_packet_metadata_t * p
  * @param[in] p_metadata Metadata to use in the context.
  * @param[in] session_type Type of session.
  * @param[in] length Length of SAR data, including MIC.
+ * @param[in] capacity Size of the payload buffer to allocate.
  *
  * @returns Whether the allocation was successful.
  */
 static bool sar_ctx_alloc(trs_sar_ctx_t * p_sar_ctx,
                           const transport_packet_metadata_t * p_metadata,
                           trs_sar_session_t session_type,
-                          uint32_t length)
+                          uint32_t length,
+                          uint32_t capacity)
 {
     NRF_MESH_ASSERT(session_type == TRS_SAR_SESSION_RX ||
                     session_type == TRS_SAR_SESSION_TX);
     NRF_MESH_ASSERT(p_sar_ctx->payload == NULL);
-    p_sar_ctx->payload = m_sar_alloc(length);
+    p_sar_ctx->payload = m_sar_alloc(capacity);
     if (p_sar_ctx->payload == NULL)
     {
         return false;
@@ -365,6 +772,7 @@ static bool sar_ctx_alloc(trs_sar_ctx_t * p_sar_ctx,
     memcpy(&p_sar_ctx->metadata, p_metadata, sizeof(transport_packet_metadata_t));
     p_sar_ctx->session.block_ack = 0;
     p_sar_ctx->session.length = length;
+    p_sar_ctx->session.capacity = sar_buffer_capacity_get(p_sar_ctx->payload, capacity);
     /* Set the network metadata sequence number and IV index to the values in the first segment in
      * the session. */
     p_sar_ctx->metadata.net.internal.sequence_number =
@@ -377,11 +785,22 @@ static bool sar_ctx_alloc(trs_sar_ctx_t * p_sar_ctx,
         p_sar_ctx->session.params.tx.payload_encrypted = false;
         p_sar_ctx->session.params.tx.seqzero_is_set = false;
         p_sar_ctx->session.params.tx.start_index = 0;
+        /* The session doesn't send anything until it's started. */
+        p_sar_ctx->session.params.tx.waiting = true;
+#if TRANSPORT_SAR_TX_ADAPTIVE_RETRY_ENABLED
+        p_sar_ctx->session.params.tx.rtt_sample_pending = true;
+        p_sar_ctx->session.params.tx.backoff = 0;
+#endif
         /* Set the TX token to indicate a SAR packet, use the SAR-TX token to keep the user-token.
          * This way we'll know that we got a TX complete on a SAR packet, so we can forward the TX
          * complete when the entire SAR packet is done. */
         p_sar_ctx->session.params.tx.token = p_metadata->token;
         p_sar_ctx->metadata.token = NRF_MESH_SAR_TOKEN;
+        if (p_metadata->p_security_material != NULL)
+        {
+            p_sar_ctx->session.params.tx.app_secmat = *p_metadata->p_security_material;
+            p_sar_ctx->metadata.p_security_material = &p_sar_ctx->session.params.tx.app_secmat;
+        }
         p_sar_ctx->timer_event.cb = retry_timeout;
         p_sar_ctx->timer_event.p_context = p_sar_ctx;
     }
@@ -402,6 +821,15 @@ static bool sar_ctx_alloc(trs_sar_ctx_t * p_sar_ctx,
 
 static void sar_ctx_free(trs_sar_ctx_t * p_sar_ctx)
 {
+    bool tx_session_ended = (p_sar_ctx->session.session_type == TRS_SAR_SESSION_TX &&
+                             !p_sar_ctx->session.params.tx.waiting);
+    uint16_t dst = p_sar_ctx->metadata.net.dst.value;
+
+    if (p_sar_ctx->session.session_type == TRS_SAR_SESSION_RX ||
+        p_sar_ctx->session.params.tx.seqzero_is_set)
+    {
+        sar_session_hash_remove(p_sar_ctx);
+    }
     m_sar_release(p_sar_ctx->payload);
     timer_sch_abort(&p_sar_ctx->timer_event);
     if (p_sar_ctx->session.session_type == TRS_SAR_SESSION_RX)
@@ -410,16 +838,30 @@ static void sar_ctx_free(trs_sar_ctx_t * p_sar_ctx)
     }
     memset(p_sar_ctx, 0, sizeof(trs_sar_ctx_t));
     p_sar_ctx->session.session_type = TRS_SAR_SESSION_INACTIVE;
+    sar_session_put(p_sar_ctx);
 
     net_state_iv_index_lock(false);
+
+    if (tx_session_ended)
+    {
+        sar_tx_session_next_start(dst);
+    }
 }
 
 static void sar_ctx_cancel(trs_sar_ctx_t * p_sar_ctx, nrf_mesh_sar_session_cancel_reason_t reason)
 {
     NRF_MESH_ASSERT(p_sar_ctx != NULL);
+    NRF_MESH_ASSERT(reason < TRANSPORT_SAR_CANCEL_REASON_COUNT);
 
     __INTERNAL_EVENT_PUSH(INTERNAL_EVENT_SAR_CANCELLED, reason, 0, NULL);
 
+    m_stats.sessions_cancelled[reason]++;
+    transport_peer_stats_t * p_peer_stats = sar_peer_stats_get(p_sar_ctx);
+    if (p_peer_stats != NULL)
+    {
+        p_peer_stats->sessions_cancelled++;
+    }
+
     sar_rx_session_mark_as_handled(&p_sar_ctx->metadata, false);
     m_send_sar_cancel_event(p_sar_ctx->session.params.tx.token, reason);
     sar_ctx_free(p_sar_ctx);
@@ -430,6 +872,12 @@ static void sar_ctx_cancel(trs_sar_ctx_t * p_sar_ctx, nrf_mesh_sar_session_cance
 
 static void sar_ctx_rx_complete(trs_sar_ctx_t * p_sar_ctx)
 {
+    m_stats.sessions_rx_completed++;
+    transport_peer_stats_t * p_peer_stats = sar_peer_stats_get(p_sar_ctx);
+    if (p_peer_stats != NULL)
+    {
+        p_peer_stats->sessions_completed++;
+    }
     sar_rx_session_mark_as_handled(&p_sar_ctx->metadata, true);
     sar_ctx_free(p_sar_ctx);
 }
@@ -437,6 +885,13 @@ static void sar_ctx_rx_complete(trs_sar_ctx_t * p_sar_ctx)
 static void sar_ctx_tx_complete(trs_sar_ctx_t * p_sar_ctx)
 {
     NRF_MESH_ASSERT(p_sar_ctx->session.session_type == TRS_SAR_SESSION_TX);
+    m_stats.sessions_tx_completed++;
+    transport_peer_stats_t * p_peer_stats = sar_peer_stats_get(p_sar_ctx);
+    if (p_peer_stats != NULL)
+    {
+        p_peer_stats->sessions_completed++;
+    }
+
     nrf_mesh_evt_t evt;
     evt.type = NRF_MESH_EVT_TX_COMPLETE;
     evt.params.tx_complete.token = p_sar_ctx->session.params.tx.token;
@@ -464,16 +919,7 @@ static void tx_retry_timer_reset(trs_sar_ctx_t * p_sar_ctx)
 {
     NRF_MESH_ASSERT(p_sar_ctx->session.session_type == TRS_SAR_SESSION_TX);
 
-    if (p_sar_ctx->metadata.net.dst.type == NRF_MESH_ADDRESS_TYPE_UNICAST)
-    {
-        p_sar_ctx->timer_event.interval = tx_retry_timer_delay_get(p_sar_ctx->metadata.net.ttl);
-    }
-    else
-    {
-        /* For non-unicast addresses, we're not going to get any acknowledgements, so there's no
-         * point in scaling the retry interval according to TTL. */
-        p_sar_ctx->timer_event.interval = tx_retry_timer_delay_get(0);
-    }
+    p_sar_ctx->timer_event.interval = tx_retry_interval_get(p_sar_ctx);
     timer_sch_reschedule(&p_sar_ctx->timer_event, timer_now() + p_sar_ctx->timer_event.interval);
 }
 
@@ -572,12 +1018,85 @@ static uint32_t sar_ack_send(const transport_packet_metadata_t * p_metadata, uin
     return status;
 }
 
+static sar_ack_history_t * sar_ack_history_get(const transport_packet_metadata_t * p_metadata)
+{
+    for (uint32_t i = 0; i < SAR_ACK_HISTORY_SIZE; ++i)
+    {
+        if (m_sar_ack_history[i].src == p_metadata->net.src &&
+            m_sar_ack_history[i].seq_zero == p_metadata->segmentation.seq_zero)
+        {
+            return &m_sar_ack_history[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Sends a full segment acknowledgment for a completed RX session, unless one was sent within the
+ * acknowledgment delay of an active session.
+ *
+ * A peer that missed the acknowledgment retransmits all its unacknowledged segments at once, and
+ * a single acknowledgment covers all of them.
+ *
+ * @param[in] p_metadata Metadata of a segment of the completed session.
+ *
+ * @returns The status of the acknowledgment, or @c NRF_SUCCESS if it was suppressed.
+ */
+static uint32_t sar_full_ack_send(const transport_packet_metadata_t * p_metadata)
+{
+    timestamp_t now = timer_now();
+    sar_ack_history_t * p_history = sar_ack_history_get(p_metadata);
+    if (p_history != NULL && now - p_history->sent_at < rx_ack_timer_delay_get(m_trs_config.segack_ttl))
+    {
+        return NRF_SUCCESS;
+    }
+
+    uint32_t status = sar_ack_send(p_metadata, block_ack_full(p_metadata));
+    if (status == NRF_SUCCESS)
+    {
+        if (p_history == NULL)
+        {
+            p_history = &m_sar_ack_history[m_sar_ack_history_next];
+            m_sar_ack_history_next = (m_sar_ack_history_next + 1) % SAR_ACK_HISTORY_SIZE;
+            p_history->src = p_metadata->net.src;
+            p_history->seq_zero = p_metadata->segmentation.seq_zero;
+        }
+        p_history->sent_at = now;
+    }
+    return status;
+}
+
+/**
+ * Sends a segment acknowledgment with the current block ack of an RX session. Acknowledgments that
+ * can't be sent are left pending for the SAR processing.
+ *
+ * @param[in,out] p_sar_ctx RX session to acknowledge.
+ *
+ * @returns Whether the acknowledgment was sent.
+ */
+static bool sar_rx_ack_send(trs_sar_ctx_t * p_sar_ctx)
+{
+    uint32_t status;
+    if (p_sar_ctx->session.block_ack == block_ack_full(&p_sar_ctx->metadata))
+    {
+        status = sar_full_ack_send(&p_sar_ctx->metadata);
+    }
+    else
+    {
+        status = sar_ack_send(&p_sar_ctx->metadata, p_sar_ctx->session.block_ack);
+    }
+
+    p_sar_ctx->session.params.rx.ack_state = (status == NRF_SUCCESS) ? SAR_ACK_STATE_IDLE : SAR_ACK_STATE_PENDING;
+    return (status == NRF_SUCCESS);
+}
+
 static trs_sar_ctx_t * sar_active_tx_ctx_get(transport_packet_metadata_t * p_metadata, uint16_t seq_zero)
 {
-    for (int i = 0; i < TRANSPORT_SAR_SESSIONS_MAX; i++)
+    for (uint8_t i = m_sar_tx_buckets[sar_session_hash(p_metadata->net.dst.value, seq_zero)];
+         i != SAR_SESSION_INDEX_INVALID;
+         i = m_trs_sar_sessions[i].hash_next)
     {
-        if (m_trs_sar_sessions[i].session.session_type == TRS_SAR_SESSION_TX &&
-            m_trs_sar_sessions[i].metadata.net.src == p_metadata->net.dst.value &&
+        if (m_trs_sar_sessions[i].metadata.net.src == p_metadata->net.dst.value &&
             m_trs_sar_sessions[i].metadata.segmentation.seq_zero == seq_zero)
         {
             return &m_trs_sar_sessions[i];
@@ -589,10 +1108,11 @@ static trs_sar_ctx_t * sar_active_tx_ctx_get(transport_packet_metadata_t * p_met
 
 static trs_sar_ctx_t * sar_active_rx_ctx_get(transport_packet_metadata_t * p_metadata)
 {
-    for (int i = 0; i < TRANSPORT_SAR_SESSIONS_MAX; i++)
+    for (uint8_t i = m_sar_rx_buckets[sar_session_hash(p_metadata->net.src, 0)];
+         i != SAR_SESSION_INDEX_INVALID;
+         i = m_trs_sar_sessions[i].hash_next)
     {
-        if (m_trs_sar_sessions[i].session.session_type == TRS_SAR_SESSION_RX &&
-            m_trs_sar_sessions[i].metadata.net.src == p_metadata->net.src)
+        if (m_trs_sar_sessions[i].metadata.net.src == p_metadata->net.src)
         {
             return &m_trs_sar_sessions[i];
         }
@@ -601,6 +1121,49 @@ static trs_sar_ctx_t * sar_active_rx_ctx_get(transport_packet_metadata_t * p_met
     return NULL;
 }
 
+/**
+ * Gets the RX payload buffer size needed to hold the given segment. The size is rounded up to a power
+ * of two number of segments, so that a buffer grows a logarithmic number of times.
+ */
+static uint32_t sar_rx_capacity_get(const transport_packet_metadata_t * p_metadata, uint8_t segment_offset)
+{
+    uint32_t segments = 1;
+    while (segments <= segment_offset)
+    {
+        segments <<= 1;
+    }
+    segments = MIN(segments, p_metadata->segmentation.last_segment + 1u);
+    return segments * TRANSPORT_SAR_PDU_LEN(p_metadata->net.control_packet);
+}
+
+/**
+ * Makes room for the given segment in the RX session's payload buffer.
+ *
+ * @param[in,out] p_sar_ctx RX session.
+ * @param[in] segment_offset Segment to make room for.
+ *
+ * @returns Whether the payload buffer can hold the segment.
+ */
+static bool sar_rx_buffer_reserve(trs_sar_ctx_t * p_sar_ctx, uint8_t segment_offset)
+{
+    uint32_t capacity = sar_rx_capacity_get(&p_sar_ctx->metadata, segment_offset);
+    if (capacity <= p_sar_ctx->session.capacity)
+    {
+        return true;
+    }
+
+    uint8_t * p_payload = m_sar_alloc(capacity);
+    if (p_payload == NULL)
+    {
+        return false;
+    }
+    memcpy(p_payload, p_sar_ctx->payload, p_sar_ctx->session.capacity);
+    m_sar_release(p_sar_ctx->payload);
+    p_sar_ctx->payload = p_payload;
+    p_sar_ctx->session.capacity = sar_buffer_capacity_get(p_payload, capacity);
+    return true;
+}
+
 static trs_sar_ctx_t * sar_rx_ctx_create(transport_packet_metadata_t * p_metadata)
 {
     uint32_t total_length = (p_metadata->segmentation.last_segment + 1) *
@@ -612,22 +1175,24 @@ static trs_sar_ctx_t * sar_rx_ctx_create(transport_packet_metadata_t * p_metadat
         return NULL;
     }
 
-
-    /* Check if the packet is part of an ongoing transaction. */
-    for (int i = 0; i < TRANSPORT_SAR_SESSIONS_MAX; ++i)
+    trs_sar_ctx_t * p_sar_ctx = sar_session_take();
+    if (p_sar_ctx == NULL)
     {
-        if (m_trs_sar_sessions[i].session.session_type == TRS_SAR_SESSION_INACTIVE)
-        {
-            if (!sar_ctx_alloc(&m_trs_sar_sessions[i], p_metadata, TRS_SAR_SESSION_RX, total_length))
-            {
-                break;
-            }
+        return NULL;
+    }
 
-            return &m_trs_sar_sessions[i];
-        }
+    if (!sar_ctx_alloc(p_sar_ctx,
+                       p_metadata,
+                       TRS_SAR_SESSION_RX,
+                       total_length,
+                       sar_rx_capacity_get(p_metadata, p_metadata->segmentation.segment_offset)))
+    {
+        sar_session_put(p_sar_ctx);
+        return NULL;
     }
 
-    return NULL;
+    sar_session_hash_add(p_sar_ctx);
+    return p_sar_ctx;
 }
 
 static void trs_sar_seg_packet_in(const uint8_t * p_segment_payload,
@@ -635,6 +1200,13 @@ static void trs_sar_seg_packet_in(const uint8_t * p_segment_payload,
                                   transport_packet_metadata_t * p_metadata,
                                   const nrf_mesh_rx_metadata_t * p_rx_metadata)
 {
+    m_stats.segments_rx++;
+    transport_peer_stats_t * p_peer_stats = peer_stats_get(p_metadata->net.src, true);
+    if (p_peer_stats != NULL)
+    {
+        p_peer_stats->segments_rx++;
+    }
+
     /* Find ongoing session by src. */
     trs_sar_ctx_t * p_sar_ctx = sar_active_rx_ctx_get(p_metadata);
     if (NULL != p_sar_ctx)
@@ -658,7 +1230,7 @@ static void trs_sar_seg_packet_in(const uint8_t * p_segment_payload,
         if (p_completed_session->successful)
         {
             /* Already successfully processed this session. */
-            (void) sar_ack_send(p_metadata, block_ack_full(p_metadata));
+            (void) sar_full_ack_send(p_metadata);
         }
         return;
     }
@@ -669,9 +1241,11 @@ static void trs_sar_seg_packet_in(const uint8_t * p_segment_payload,
         p_sar_ctx = sar_rx_ctx_create(p_metadata);
         if (p_sar_ctx == NULL)
         {
-            /* Send block ack=0 to indicate failure to receive. Transport is out of resources. */
-            (void) sar_ack_send(p_metadata, 0);
-            m_send_sar_cancel_event(NRF_MESH_INITIAL_TOKEN, NRF_MESH_SAR_CANCEL_REASON_NO_MEM);
+            /* Transport is out of resources. Back off by dropping the segment without acknowledging
+             * it, instead of cancelling the peer's session with a block ack of 0. The peer will
+             * retransmit the segment, and may find a free session when it does. */
+            __LOG(LOG_SRC_TRANSPORT, LOG_LEVEL_WARN, "No SAR session available for 0x%04x\n", p_metadata->net.src);
+            m_stats.segments_dropped++;
             return;
         }
     }
@@ -694,6 +1268,14 @@ static void trs_sar_seg_packet_in(const uint8_t * p_segment_payload,
         return;
     }
 
+    if (!sar_rx_buffer_reserve(p_sar_ctx, p_metadata->segmentation.segment_offset))
+    {
+        /* Back off like when there's no session available, the peer will retransmit the segment. */
+        __LOG(LOG_SRC_TRANSPORT, LOG_LEVEL_WARN, "No SAR buffer available for 0x%04x\n", p_metadata->net.src);
+        m_stats.segments_dropped++;
+        return;
+    }
+
     p_sar_ctx->session.block_ack |= (1u << p_metadata->segmentation.segment_offset);
 
     if (p_metadata->segmentation.segment_offset == p_sar_ctx->metadata.segmentation.last_segment)
@@ -717,19 +1299,19 @@ static void trs_sar_seg_packet_in(const uint8_t * p_segment_payload,
 
     if (p_sar_ctx->session.block_ack == block_ack_full(&p_sar_ctx->metadata))
     {
-        /* Release and ack regardless of whether upper layer succeeds */
-        p_sar_ctx->session.params.rx.ack_state = SAR_ACK_STATE_PENDING;
-        uint32_t ack_status = sar_ack_send(&p_sar_ctx->metadata, p_sar_ctx->session.block_ack);
+        /* Release and ack regardless of whether upper layer succeeds. The acknowledgment
+         * supersedes any acknowledgment pending for the session. */
+        bool acked = sar_rx_ack_send(p_sar_ctx);
 
-        /* All packets have arrived */
+        /* All packets have arrived. The payload is decrypted in place, as it's not needed after
+         * this. */
         upper_transport_packet_in(p_sar_ctx->payload,
                                 p_sar_ctx->session.length,
                                 &p_sar_ctx->metadata,
                                 p_rx_metadata);
 
-        if (ack_status == NRF_SUCCESS)
+        if (acked)
         {
-            p_sar_ctx->session.params.rx.ack_state = SAR_ACK_STATE_IDLE;
             sar_ctx_rx_complete(p_sar_ctx);
         }
     }
@@ -740,6 +1322,7 @@ static bool test_transport_decrypt(const nrf_mesh_application_secmat_t * p_app_s
     bool mic_passed = false;
     if (p_app_security_material != NULL)
     {
+        m_decrypt_stats.attempts++;
         p_ccm_data->p_key = p_app_security_material->key;
         enc_aes_ccm_decrypt(p_ccm_data, &mic_passed);
         if (mic_passed)
@@ -923,6 +1506,8 @@ static bool sar_segment_send(trs_sar_ctx_t * p_sar_ctx, uint32_t segment_index)
             p_sar_ctx->metadata.segmentation.seq_zero =
                 (p_sar_ctx->metadata.net.internal.sequence_number & TRANSPORT_SAR_SEQZERO_MASK);
             p_sar_ctx->session.params.tx.seqzero_is_set = true;
+            /* The session can only be acknowledged once it has a SeqZero. */
+            sar_session_hash_add(p_sar_ctx);
         }
         /* The payload couldn't be encrypted before we allocated the first packet, as we needed to
          * allocate a seqnum and iv index for the nonce. */
@@ -940,6 +1525,17 @@ static bool sar_segment_send(trs_sar_ctx_t * p_sar_ctx, uint32_t segment_index)
         trs_packet_header_build(&p_sar_ctx->metadata, (packet_mesh_trs_packet_t *) net_buf.p_payload);
         memcpy(p_segment_payload, &p_sar_ctx->payload[payload_offset], segment_len);
         network_packet_send(&net_buf);
+
+        bool retransmission = ((p_sar_ctx->session.params.tx.sent_segments & (1u << segment_index)) != 0);
+        p_sar_ctx->session.params.tx.sent_segments |= (1u << segment_index);
+        m_stats.segments_tx++;
+        m_stats.retransmissions += retransmission;
+        transport_peer_stats_t * p_peer_stats = sar_peer_stats_get(p_sar_ctx);
+        if (p_peer_stats != NULL)
+        {
+            p_peer_stats->segments_tx++;
+            p_peer_stats->retransmissions += retransmission;
+        }
     }
 
     return (status == NRF_SUCCESS);
@@ -948,11 +1544,15 @@ static bool sar_segment_send(trs_sar_ctx_t * p_sar_ctx, uint32_t segment_index)
 /**
  * Send SAR segments.
  *
- * @param[in,out] p_sar_ctx SAR context to send segments of.
+ * Segments that aren't sent are picked up by @ref trs_sar_tx_process as the sent segments
+ * complete.
+ *
+ * @param[in,out] p_sar_ctx    SAR context to send segments of.
+ * @param[in]     segments_max Maximum number of segments to send.
  *
  * @returns Number of segments sent.
  */
-static uint32_t trs_sar_packet_out(trs_sar_ctx_t * p_sar_ctx)
+static uint32_t trs_sar_packet_out(trs_sar_ctx_t * p_sar_ctx, uint32_t segments_max)
 {
     uint32_t sent_segments = 0;
     /* Starts at start_index if, e.g., there was no memory available last round. */
@@ -960,6 +1560,10 @@ static uint32_t trs_sar_packet_out(trs_sar_ctx_t * p_sar_ctx)
          i <= p_sar_ctx->metadata.segmentation.last_segment;
          ++i)
     {
+        if (sent_segments == segments_max)
+        {
+            break;
+        }
         if ((p_sar_ctx->session.block_ack & (1u << i)) == 0)
         {
             /* packet hasn't been acked yet */
@@ -978,6 +1582,61 @@ static uint32_t trs_sar_packet_out(trs_sar_ctx_t * p_sar_ctx)
     return sent_segments;
 }
 
+/**
+ * Gets the TX session that is sending segments to a destination.
+ *
+ * @param[in] dst Destination address.
+ *
+ * @returns The active TX session to the destination, or NULL if there is none.
+ */
+static trs_sar_ctx_t * sar_tx_session_active_get(uint16_t dst)
+{
+    for (uint32_t i = 0; i < TRANSPORT_SAR_SESSIONS_MAX; ++i)
+    {
+        if (m_trs_sar_sessions[i].session.session_type == TRS_SAR_SESSION_TX &&
+            !m_trs_sar_sessions[i].session.params.tx.waiting &&
+            m_trs_sar_sessions[i].metadata.net.dst.value == dst)
+        {
+            return &m_trs_sar_sessions[i];
+        }
+    }
+    return NULL;
+}
+
+static void sar_tx_session_start(trs_sar_ctx_t * p_sar_ctx)
+{
+    p_sar_ctx->session.params.tx.waiting = false;
+    p_sar_ctx->session.params.tx.start_time = timer_now();
+    (void) trs_sar_packet_out(p_sar_ctx, TRANSPORT_SAR_TX_BURST_SIZE);/* Ignore return, as we'll reset the retry timer regardless. */
+    tx_retry_timer_reset(p_sar_ctx);
+}
+
+/**
+ * Starts the TX session to a destination that has been waiting the longest, if any.
+ *
+ * @param[in] dst Destination address of a TX session that just ended.
+ */
+static void sar_tx_session_next_start(uint16_t dst)
+{
+    trs_sar_ctx_t * p_next = NULL;
+    for (uint32_t i = 0; i < TRANSPORT_SAR_SESSIONS_MAX; ++i)
+    {
+        if (m_trs_sar_sessions[i].session.session_type == TRS_SAR_SESSION_TX &&
+            m_trs_sar_sessions[i].session.params.tx.waiting &&
+            m_trs_sar_sessions[i].metadata.net.dst.value == dst &&
+            (p_next == NULL ||
+             (int32_t) (m_trs_sar_sessions[i].session.params.tx.queue_index - p_next->session.params.tx.queue_index) < 0))
+        {
+            p_next = &m_trs_sar_sessions[i];
+        }
+    }
+
+    if (p_next != NULL)
+    {
+        sar_tx_session_start(p_next);
+    }
+}
+
 static uint32_t segmented_packet_tx(const transport_packet_metadata_t * p_metadata,
                                     const uint8_t * p_payload,
                                     uint32_t payload_len)
@@ -987,24 +1646,12 @@ static uint32_t segmented_packet_tx(const transport_packet_metadata_t * p_metada
     {
         return NRF_ERROR_INVALID_LENGTH;
     }
-    trs_sar_ctx_t * p_sar_ctx = NULL;
-    uint32_t was_masked;
-    _DISABLE_IRQS(was_masked); //TODO: Can this be changed to bearer_event_critical_section, or removed all-together?
-    for (int i = 0; i < TRANSPORT_SAR_SESSIONS_MAX; ++i)
-    {
-        if (m_trs_sar_sessions[i].session.session_type == TRS_SAR_SESSION_INACTIVE)
-        {
-            p_sar_ctx = &m_trs_sar_sessions[i];
-            break;
-        }
-    }
-    _ENABLE_IRQS(was_masked);
-
+    trs_sar_ctx_t * p_sar_ctx = sar_session_take();
     if (p_sar_ctx == NULL)
     {
         return NRF_ERROR_NO_MEM;
     }
-    if (sar_ctx_alloc(p_sar_ctx, p_metadata, TRS_SAR_SESSION_TX, packet_length))
+    if (sar_ctx_alloc(p_sar_ctx, p_metadata, TRS_SAR_SESSION_TX, packet_length, packet_length))
     {
         memcpy(p_sar_ctx->payload, p_payload, payload_len);
 
@@ -1014,31 +1661,65 @@ static uint32_t segmented_packet_tx(const transport_packet_metadata_t * p_metada
                 p_sar_ctx->payload,
                 p_sar_ctx->session.length);
 
-        (void) trs_sar_packet_out(p_sar_ctx);/* Ignore return, as we'll reset the retry timer regardless. */
-        tx_retry_timer_reset(p_sar_ctx);
+        /* Mesh Profile Specification v1.0, section 3.5.3.3: "The lower transport layer shall not
+         * transmit segmented messages for more than one Upper Transport PDU to the same destination
+         * at the same time." Later sessions are queued, and started when the earlier ones end. */
+        p_sar_ctx->session.params.tx.queue_index = m_sar_tx_queue_index++;
+        if (sar_tx_session_active_get(p_sar_ctx->metadata.net.dst.value) == NULL)
+        {
+            sar_tx_session_start(p_sar_ctx);
+        }
 
         return NRF_SUCCESS;
     }
     else
     {
+        sar_session_put(p_sar_ctx);
         return NRF_ERROR_NO_MEM;
     }
 }
 
 
-/** Process ongoing SAR TX sessions. */
+/**
+ * Process ongoing SAR TX sessions.
+ *
+ * The remaining segments of the sessions are sent one session at a time in round-robin order, so
+ * that the sessions share the available network packet buffers. The session that gets the first
+ * buffer changes with every call.
+ */
 static void trs_sar_tx_process(void)
 {
-    /* Loop through all active sessions and (re-)transmit remaining packets. */
-    for (uint32_t i = 0; i < TRANSPORT_SAR_SESSIONS_MAX; ++i)
+    bool segments_sent[TRANSPORT_SAR_SESSIONS_MAX] = {false};
+    uint32_t first = m_sar_tx_next;
+    m_sar_tx_next = (m_sar_tx_next + 1) % TRANSPORT_SAR_SESSIONS_MAX;
+
+    for (uint32_t round = 0; round < TRANSPORT_SAR_TX_BURST_SIZE; ++round)
     {
-        if (m_trs_sar_sessions[i].session.session_type == TRS_SAR_SESSION_TX)
+        bool round_sent = false;
+        for (uint32_t j = 0; j < TRANSPORT_SAR_SESSIONS_MAX; ++j)
         {
-            if (trs_sar_packet_out(&m_trs_sar_sessions[i]) != 0)
+            uint32_t i = (first + j) % TRANSPORT_SAR_SESSIONS_MAX;
+            if (m_trs_sar_sessions[i].session.session_type == TRS_SAR_SESSION_TX &&
+                !m_trs_sar_sessions[i].session.params.tx.waiting &&
+                trs_sar_packet_out(&m_trs_sar_sessions[i], 1) != 0)
             {
-                tx_retry_timer_reset(&m_trs_sar_sessions[i]);
+                segments_sent[i] = true;
+                round_sent = true;
             }
         }
+
+        if (!round_sent)
+        {
+            break;
+        }
+    }
+
+    for (uint32_t i = 0; i < TRANSPORT_SAR_SESSIONS_MAX; ++i)
+    {
+        if (segments_sent[i])
+        {
+            tx_retry_timer_reset(&m_trs_sar_sessions[i]);
+        }
     }
 }
 
@@ -1049,9 +1730,8 @@ static void trs_sar_rx_process(void)
         if (m_trs_sar_sessions[i].session.session_type == TRS_SAR_SESSION_RX &&
             m_trs_sar_sessions[i].session.params.rx.ack_state == SAR_ACK_STATE_PENDING)
         {
-            if (sar_ack_send(&m_trs_sar_sessions[i].metadata, m_trs_sar_sessions[i].session.block_ack) == NRF_SUCCESS)
+            if (sar_rx_ack_send(&m_trs_sar_sessions[i]))
             {
-                m_trs_sar_sessions[i].session.params.rx.ack_state = SAR_ACK_STATE_IDLE;
                 if (m_trs_sar_sessions[i].session.block_ack == block_ack_full(&m_trs_sar_sessions[i].metadata))
                 {
                     sar_ctx_rx_complete(&m_trs_sar_sessions[i]);
@@ -1063,16 +1743,116 @@ static void trs_sar_rx_process(void)
 
 static bool transport_sar_process(void)
 {
-    trs_sar_tx_process();
+    /* Pending segment acknowledgments go before new segments, so that peers aren't kept waiting
+     * for them while the TX sessions fill the network buffers. */
     trs_sar_rx_process();
+    trs_sar_tx_process();
     return true;
 }
 
+static virtual_resolution_t * virtual_resolution_get(uint16_t src, uint16_t dst)
+{
+    for (uint32_t i = 0; i < TRANSPORT_VIRTUAL_RESOLUTION_CACHE_SIZE; ++i)
+    {
+        if (m_virtual_resolutions[i].p_app_secmat != NULL &&
+            m_virtual_resolutions[i].src == src &&
+            m_virtual_resolutions[i].dst == dst)
+        {
+            return &m_virtual_resolutions[i];
+        }
+    }
+    return NULL;
+}
+
+static void virtual_resolution_store(const transport_packet_metadata_t * p_metadata)
+{
+    virtual_resolution_t * p_resolution = virtual_resolution_get(p_metadata->net.src, p_metadata->net.dst.value);
+    if (p_resolution == NULL)
+    {
+        p_resolution = &m_virtual_resolutions[m_virtual_resolution_next];
+        m_virtual_resolution_next = (m_virtual_resolution_next + 1) % TRANSPORT_VIRTUAL_RESOLUTION_CACHE_SIZE;
+        p_resolution->src = p_metadata->net.src;
+        p_resolution->dst = p_metadata->net.dst.value;
+    }
+    p_resolution->p_virtual_uuid = p_metadata->net.dst.p_virtual_uuid;
+    p_resolution->p_app_secmat = p_metadata->p_security_material;
+}
+
+/**
+ * Checks that a cached resolution is still a decryption candidate for the packet. The keys and
+ * subscriptions may have changed since the resolution was stored, so the application key must
+ * still be bound to the network with the packet's AID, and the label UUID must still be in the RX
+ * address list. Neither check requires a decryption.
+ */
+static bool virtual_resolution_is_valid(const transport_packet_metadata_t * p_metadata,
+                                        const virtual_resolution_t * p_resolution)
+{
+    const nrf_mesh_application_secmat_t * p_app_secmat = NULL;
+    do
+    {
+        nrf_mesh_app_secmat_next_get(p_metadata->net.p_security_material,
+                                     p_metadata->type.access.app_key_id,
+                                     &p_app_secmat);
+    } while (p_app_secmat != NULL && p_app_secmat != p_resolution->p_app_secmat);
+
+    if (p_app_secmat == NULL)
+    {
+        return false;
+    }
+
+    nrf_mesh_address_t address = {.p_virtual_uuid = NULL};
+    while (nrf_mesh_rx_address_get(p_resolution->dst, &address))
+    {
+        if (address.p_virtual_uuid == p_resolution->p_virtual_uuid)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Tries to decrypt a packet to a virtual address with the cached resolution for its source.
+ *
+ * @param[in,out] p_metadata Metadata of the packet.
+ * @param[in,out] p_ccm_data Decryption parameters for the packet.
+ * @param[out]    p_tried    Label UUID and application key that were tried without success, so
+ *                           that the full search can skip them. The application key is NULL if
+ *                           nothing was tried.
+ *
+ * @returns Whether the cached resolution decrypted the packet.
+ */
+static bool virtual_resolution_decrypt(transport_packet_metadata_t * p_metadata,
+                                       ccm_soft_data_t * p_ccm_data,
+                                       virtual_resolution_t * p_tried)
+{
+    p_tried->p_app_secmat = NULL;
+    const virtual_resolution_t * p_resolution = virtual_resolution_get(p_metadata->net.src, p_metadata->net.dst.value);
+    if (p_resolution != NULL && virtual_resolution_is_valid(p_metadata, p_resolution))
+    {
+        p_ccm_data->p_a = p_resolution->p_virtual_uuid;
+        if (test_transport_decrypt(p_resolution->p_app_secmat, p_ccm_data))
+        {
+            p_metadata->net.dst.p_virtual_uuid = p_resolution->p_virtual_uuid;
+            p_metadata->p_security_material = p_resolution->p_app_secmat;
+            m_decrypt_stats.app_key_hits++;
+            m_decrypt_stats.virtual_cache_hits++;
+            return true;
+        }
+        m_decrypt_stats.app_key_misses++;
+        *p_tried = *p_resolution;
+    }
+    m_decrypt_stats.virtual_cache_misses++;
+    return false;
+}
+
 static uint32_t upper_trs_packet_decrypt(transport_packet_metadata_t * p_metadata,
                                          const uint8_t * p_upper_trs_packet,
                                          uint32_t upper_trs_packet_len,
                                          uint8_t * p_upper_trs_packet_out)
 {
+    m_decrypt_stats.messages++;
+
     /* Use seq_zero network sequence number if this is a segmented message */
     uint32_t old_network_seqnum = p_metadata->net.internal.sequence_number;
     if (p_metadata->segmented)
@@ -1106,6 +1886,13 @@ static uint32_t upper_trs_packet_decrypt(transport_packet_metadata_t * p_metadat
 
     if (p_metadata->type.access.using_app_key)
     {
+        virtual_resolution_t tried = {.p_app_secmat = NULL};
+        if (p_metadata->net.dst.type == NRF_MESH_ADDRESS_TYPE_VIRTUAL &&
+            virtual_resolution_decrypt(p_metadata, &ccm_data, &tried))
+        {
+            return NRF_SUCCESS;
+        }
+
         do {
             if (p_metadata->net.dst.type == NRF_MESH_ADDRESS_TYPE_VIRTUAL)
             {
@@ -1122,10 +1909,23 @@ static uint32_t upper_trs_packet_decrypt(transport_packet_metadata_t * p_metadat
                                               p_metadata->type.access.app_key_id,
                                               &p_metadata->p_security_material))
             {
+                if (p_metadata->p_security_material == tried.p_app_secmat &&
+                    ccm_data.p_a == tried.p_virtual_uuid)
+                {
+                    /* Already tried with the cached resolution. */
+                    continue;
+                }
+
                 if (test_transport_decrypt(p_metadata->p_security_material, &ccm_data))
                 {
+                    m_decrypt_stats.app_key_hits++;
+                    if (p_metadata->net.dst.type == NRF_MESH_ADDRESS_TYPE_VIRTUAL)
+                    {
+                        virtual_resolution_store(p_metadata);
+                    }
                     return NRF_SUCCESS;
                 }
+                m_decrypt_stats.app_key_misses++;
             }
         } while (p_metadata->net.dst.type == NRF_MESH_ADDRESS_TYPE_VIRTUAL &&
                  nrf_mesh_rx_address_get(p_metadata->net.dst.value, &p_metadata->net.dst));
@@ -1212,6 +2012,25 @@ static void segack_packet_in(const packet_mesh_trs_control_packet_t * p_trs_cont
     {
         __INTERNAL_EVENT_PUSH(INTERNAL_EVENT_TRS_ACK_RECEIVED, 0, control_packet_len, p_trs_control_packet);
 
+        if (p_sar_ctx->session.block_ack == 0 && block_ack != 0)
+        {
+            sar_ack_latency_sample_add(TIMER_DIFF(timer_now(), p_sar_ctx->session.params.tx.start_time));
+        }
+
+#if TRANSPORT_SAR_TX_ADAPTIVE_RETRY_ENABLED
+        if ((block_ack & ~p_sar_ctx->session.block_ack) != 0)
+        {
+            /* Only the first acknowledgment of a session that hasn't been retransmitted can be
+             * matched to a transmission (Karn's algorithm). */
+            if (p_sar_ctx->session.params.tx.rtt_sample_pending)
+            {
+                sar_rtt_sample_add(p_sar_ctx->metadata.net.dst.value,
+                                   TIMER_DIFF(timer_now(), p_sar_ctx->session.params.tx.start_time));
+                p_sar_ctx->session.params.tx.rtt_sample_pending = false;
+            }
+            p_sar_ctx->session.params.tx.backoff = 0;
+        }
+#endif
         p_sar_ctx->session.block_ack |= block_ack;
         if (block_ack == 0)
         {
@@ -1229,34 +2048,20 @@ static void segack_packet_in(const packet_mesh_trs_control_packet_t * p_trs_cont
              * shall reset the segment transmission timer and retransmit all unacknowledged Lower
              * Transport PDUs." */
              p_sar_ctx->session.params.tx.start_index = 0;
-             (void) trs_sar_packet_out(p_sar_ctx); /* Ignore return, as we'll reset the retry timer regardless. */
+             (void) trs_sar_packet_out(p_sar_ctx, TRANSPORT_SAR_TX_BURST_SIZE); /* Ignore return, as we'll reset the retry timer regardless. */
              tx_retry_timer_reset(p_sar_ctx);
         }
     }
 }
 
-static transport_control_packet_callback_t control_packet_callback_get(transport_control_opcode_t opcode)
-{
-    for (uint32_t consumer = 0; consumer < m_control_packet_consumer_count; ++consumer)
-    {
-        const control_packet_consumer_t * p_consumer = &m_control_packet_consumers[consumer];
-        for (uint32_t handler = 0; handler < p_consumer->handler_count; ++handler)
-        {
-            const transport_control_packet_handler_t * p_handler = &p_consumer->p_handlers[handler];
-            if (p_handler->opcode == opcode)
-            {
-                return p_handler->callback;
-            }
-        }
-    }
-    return NULL;
-}
-
 static void transport_control_packet_in(const packet_mesh_trs_control_packet_t * p_trs_control_packet,
                                         uint32_t control_packet_len,
                                         transport_packet_metadata_t * p_metadata,
                                         const nrf_mesh_rx_metadata_t * p_rx_metadata)
 {
+    NRF_MESH_ASSERT((uint32_t) p_metadata->type.control.opcode <= TRANSPORT_CONTROL_PACKET_OPCODE_MAX);
+    m_control_stats.rx_count[p_metadata->type.control.opcode]++;
+
     switch (p_metadata->type.control.opcode)
     {
         /* The Segack handler is internal to the lower transport layer, and is handled inline. */
@@ -1266,7 +2071,7 @@ static void transport_control_packet_in(const packet_mesh_trs_control_packet_t *
 
         default:
         {
-            transport_control_packet_callback_t callback = control_packet_callback_get(p_metadata->type.control.opcode);
+            transport_control_packet_callback_t callback = m_control_packet_callbacks[p_metadata->type.control.opcode];
             if (callback != NULL)
             {
                 transport_control_packet_t control_packet;
@@ -1285,14 +2090,23 @@ static void transport_control_packet_in(const packet_mesh_trs_control_packet_t *
     }
 }
 
-static void upper_transport_access_packet_in(const uint8_t * p_upper_trs_packet,
+/**
+ * Decrypts an access message in place and passes it to the application.
+ *
+ * The application gets a pointer into the PDU buffer, which is either the network layer's decrypt
+ * buffer or the SAR reassembly buffer. It's only valid until the event handler returns.
+ *
+ * @param[in,out] p_upper_trs_packet   Encrypted upper transport PDU, with the MIC at the end.
+ * @param[in]     upper_trs_packet_len Length of the PDU, including the MIC.
+ * @param[in,out] p_metadata           Metadata of the message.
+ * @param[in]     p_rx_metadata        RX metadata of the last network packet of the message.
+ */
+static void upper_transport_access_packet_in(uint8_t * p_upper_trs_packet,
                                              uint32_t upper_trs_packet_len,
                                              transport_packet_metadata_t * p_metadata,
                                              const nrf_mesh_rx_metadata_t * p_rx_metadata)
 {
-    uint8_t decrypt_buffer[TRANSPORT_SAR_PACKET_MAX_SIZE(false)]; /* 382 bytes! */
-
-    uint32_t status = upper_trs_packet_decrypt(p_metadata, p_upper_trs_packet, upper_trs_packet_len, decrypt_buffer);
+    uint32_t status = upper_trs_packet_decrypt(p_metadata, p_upper_trs_packet, upper_trs_packet_len, p_upper_trs_packet);
     if (status == NRF_SUCCESS)
     {
         __INTERNAL_EVENT_PUSH(INTERNAL_EVENT_DECRYPT_TRS,
@@ -1305,7 +2119,7 @@ static void upper_transport_access_packet_in(const uint8_t * p_upper_trs_packet,
                                         .p_virtual_uuid = NULL};
         nrf_mesh_evt_t rx_event;
         rx_event.type = NRF_MESH_EVT_MESSAGE_RECEIVED;
-        rx_event.params.message.p_buffer = decrypt_buffer;
+        rx_event.params.message.p_buffer = p_upper_trs_packet;
         rx_event.params.message.length = upper_trs_packet_len - p_metadata->mic_size;
         rx_event.params.message.src = src_address;
         rx_event.params.message.dst = p_metadata->net.dst;
@@ -1327,7 +2141,7 @@ static void upper_transport_access_packet_in(const uint8_t * p_upper_trs_packet,
     }
 }
 
-static void upper_transport_packet_in(const uint8_t * p_upper_trs_packet,
+static void upper_transport_packet_in(uint8_t * p_upper_trs_packet,
                                       uint32_t upper_trs_packet_len,
                                       transport_packet_metadata_t * p_metadata,
                                       const nrf_mesh_rx_metadata_t * p_rx_metadata)
@@ -1349,11 +2163,10 @@ static void ack_timeout(timestamp_t timestamp, void * p_context)
 {
     trs_sar_ctx_t * p_sar_ctx = p_context;
     NRF_MESH_ASSERT(p_sar_ctx->session.session_type == TRS_SAR_SESSION_RX);
+    /* The acknowledgment is sent by the SAR processing, so it covers the segments received until
+     * then, and gets ahead of new TX segments. */
     p_sar_ctx->session.params.rx.ack_state = SAR_ACK_STATE_PENDING;
-    if (sar_ack_send(&p_sar_ctx->metadata, p_sar_ctx->session.block_ack) == NRF_SUCCESS)
-    {
-        p_sar_ctx->session.params.rx.ack_state = SAR_ACK_STATE_IDLE;
-    }
+    bearer_event_flag_set(m_sar_process_flag);
 }
 
 static void retry_timeout(timestamp_t timestamp, void * p_context)
@@ -1378,7 +2191,16 @@ static void retry_timeout(timestamp_t timestamp, void * p_context)
     {
         p_sar_ctx->session.params.tx.retries--;
         p_sar_ctx->session.params.tx.start_index = 0;
-        (void) trs_sar_packet_out(p_sar_ctx);/* Ignore return, as the timer will be rescheduled regardless. */
+        (void) trs_sar_packet_out(p_sar_ctx, TRANSPORT_SAR_TX_BURST_SIZE);/* Ignore return, as the timer will be rescheduled regardless. */
+#if TRANSPORT_SAR_TX_ADAPTIVE_RETRY_ENABLED
+        p_sar_ctx->session.params.tx.rtt_sample_pending = false;
+        if (p_sar_ctx->session.params.tx.backoff < TRANSPORT_SAR_TX_RTO_BACKOFF_MAX)
+        {
+            p_sar_ctx->session.params.tx.backoff++;
+        }
+        /* The timer is rescheduled with the interval after the callback returns. */
+        p_sar_ctx->timer_event.interval = tx_retry_interval_get(p_sar_ctx);
+#endif
     }
 }
 
@@ -1428,14 +2250,22 @@ static uint32_t upper_transport_tx(transport_packet_metadata_t * p_metadata, con
  **************/
 void transport_init(const nrf_mesh_init_params_t * p_init_params)
 {
+#if TRANSPORT_SAR_ARENA_ENABLED
+    sar_arena_init();
+#endif
     transport_sar_mem_funcs_reset();
 
-    memset(&m_trs_sar_sessions[0], 0, sizeof(m_trs_sar_sessions));
+    sar_sessions_reset();
+    m_sar_tx_queue_index = 0;
+    m_sar_tx_next = 0;
 
     replay_cache_init();
 
     m_sar_session_cache_head = 0;
     memset(m_sar_session_cache, 0, sizeof(m_sar_session_cache));
+    memset(m_sar_session_cache_buckets, 0xFF, sizeof(m_sar_session_cache_buckets));
+    memset(m_sar_ack_history, 0, sizeof(m_sar_ack_history));
+    m_sar_ack_history_next = 0;
 
     m_trs_config.rx_timeout                = TRANSPORT_SAR_RX_TIMEOUT_DEFAULT_US;
     m_trs_config.rx_ack_base_timeout       = TRANSPORT_SAR_RX_ACK_BASE_TIMEOUT_DEFAULT_US;
@@ -1447,11 +2277,59 @@ void transport_init(const nrf_mesh_init_params_t * p_init_params)
     m_trs_config.segack_ttl                = TRANSPORT_SAR_SEGACK_TTL_DEFAULT;
     m_sar_process_flag = bearer_event_flag_add(transport_sar_process);
     m_control_packet_consumer_count = 0;
+    memset(m_control_packet_callbacks, 0, sizeof(m_control_packet_callbacks));
+    memset(&m_control_stats, 0, sizeof(m_control_stats));
+    memset(&m_decrypt_stats, 0, sizeof(m_decrypt_stats));
+    memset(&m_stats, 0, sizeof(m_stats));
+    memset(m_peer_stats, 0, sizeof(m_peer_stats));
+    m_peer_stats_next = 0;
+    memset(m_virtual_resolutions, 0, sizeof(m_virtual_resolutions));
+    m_virtual_resolution_next = 0;
+#if TRANSPORT_SAR_TX_ADAPTIVE_RETRY_ENABLED
+    memset(m_sar_rtt_estimates, 0, sizeof(m_sar_rtt_estimates));
+    m_sar_rtt_estimate_next = 0;
+#endif
 
     core_tx_complete_cb_set(tx_complete);
 
 }
 
+void transport_decrypt_stats_get(transport_decrypt_stats_t * p_stats)
+{
+    NRF_MESH_ASSERT(p_stats != NULL);
+    *p_stats = m_decrypt_stats;
+}
+
+void transport_control_stats_get(transport_control_stats_t * p_stats)
+{
+    NRF_MESH_ASSERT(p_stats != NULL);
+    *p_stats = m_control_stats;
+}
+
+void transport_stats_get(transport_stats_t * p_stats)
+{
+    NRF_MESH_ASSERT(p_stats != NULL);
+    bearer_event_critical_section_begin();
+    *p_stats = m_stats;
+    bearer_event_critical_section_end();
+}
+
+uint32_t transport_peer_stats_get(uint32_t index, transport_peer_stats_t * p_stats)
+{
+    if (p_stats == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    if (index >= TRANSPORT_PEER_STATS_COUNT || m_peer_stats[index].address == NRF_MESH_ADDR_UNASSIGNED)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+    bearer_event_critical_section_begin();
+    *p_stats = m_peer_stats[index];
+    bearer_event_critical_section_end();
+    return NRF_SUCCESS;
+}
+
 uint32_t transport_sar_mem_funcs_set(transport_sar_alloc_t alloc_func, transport_sar_release_t release_func)
 {
     if ((alloc_func == NULL) != (release_func == NULL)) /*lint !e731 Boolean arguments to equal/not equal operator */
@@ -1474,10 +2352,14 @@ uint32_t transport_sar_mem_funcs_set(transport_sar_alloc_t alloc_func, transport
 
 void transport_sar_mem_funcs_reset(void)
 {
+#if TRANSPORT_SAR_ARENA_ENABLED
+    NRF_MESH_ERROR_CHECK(transport_sar_mem_funcs_set(sar_arena_alloc, sar_arena_free));
+#else
     NRF_MESH_ERROR_CHECK(transport_sar_mem_funcs_set(malloc, free));
+#endif
 }
 
-uint32_t transport_packet_in(const packet_mesh_trs_packet_t * p_packet,
+uint32_t transport_packet_in(packet_mesh_trs_packet_t * p_packet,
                              uint32_t trs_packet_len,
                              const network_packet_metadata_t * p_net_metadata,
                              const nrf_mesh_rx_metadata_t * p_rx_metadata)
@@ -1510,6 +2392,14 @@ uint32_t transport_packet_in(const packet_mesh_trs_packet_t * p_packet,
                               PACKET_DROPPED_REPLAY_CACHE,
                               trs_packet_len,
                               p_packet);
+        bearer_event_critical_section_begin();
+        m_stats.replay_rejections++;
+        transport_peer_stats_t * p_peer_stats = peer_stats_get(p_net_metadata->src, false);
+        if (p_peer_stats != NULL)
+        {
+            p_peer_stats->replay_rejections++;
+        }
+        bearer_event_critical_section_end();
         return status;
     }
 
@@ -1542,7 +2432,7 @@ uint32_t transport_packet_in(const packet_mesh_trs_packet_t * p_packet,
     }
     else
     {
-        upper_transport_packet_in(packet_mesh_trs_unseg_payload_get(p_packet),
+        upper_transport_packet_in((uint8_t *) packet_mesh_trs_unseg_payload_get(p_packet),
                                   trs_packet_len - PACKET_MESH_TRS_UNSEG_PDU_OFFSET,
                                   &trs_metadata,
                                   p_rx_metadata);
@@ -1757,15 +2647,25 @@ uint32_t transport_control_packet_consumer_add(const transport_control_packet_ha
             return NRF_ERROR_INVALID_DATA;
         }
         if (p_handlers[i].opcode == TRANSPORT_CONTROL_OPCODE_SEGACK ||
-            control_packet_callback_get(p_handlers[i].opcode) != NULL)
+            m_control_packet_callbacks[p_handlers[i].opcode] != NULL)
         {
             /* duplicate */
             return NRF_ERROR_FORBIDDEN;
         }
+        for (uint32_t j = 0; j < i; ++j)
+        {
+            if (p_handlers[j].opcode == p_handlers[i].opcode)
+            {
+                /* duplicate within the consumer */
+                return NRF_ERROR_FORBIDDEN;
+            }
+        }
     }
 
-    m_control_packet_consumers[m_control_packet_consumer_count].p_handlers = p_handlers;
-    m_control_packet_consumers[m_control_packet_consumer_count].handler_count = handler_count;
+    for (uint32_t i = 0; i < handler_count; ++i)
+    {
+        m_control_packet_callbacks[p_handlers[i].opcode] = p_handlers[i].callback;
+    }
     m_control_packet_consumer_count++;
     return NRF_SUCCESS;
 }
@@ -152,6 +152,8 @@
 #define SERIAL_OPCODE_CMD_MESH_ADDR_VIRTUAL_COUNT_MAX_GET     (0xAA) /**< Params: None. */
 #define SERIAL_OPCODE_CMD_MESH_PACKET_SEND                    (0xAB) /**< Params: @ref serial_cmd_mesh_packet_send_t */
 #define SERIAL_OPCODE_CMD_MESH_STATE_CLEAR                    (0xAC) /**< Params: None. */
+#define SERIAL_OPCODE_CMD_MESH_TRANSPORT_STATS_GET            (0xAD) /**< Params: None. */
+#define SERIAL_OPCODE_CMD_MESH_TRANSPORT_PEER_STATS_GET       (0xAE) /**< Params: @ref serial_cmd_mesh_transport_peer_stats_get_t */
 
 #define SERIAL_OPCODE_CMD_RANGE_MESH_END                      (0xAF) /**< MESH range end. */
 
@@ -500,6 +502,12 @@ typedef struct __attribute((packed))
 
 NRF_MESH_STATIC_ASSERT(sizeof(serial_cmd_mesh_packet_send_t) == NRF_MESH_SERIAL_PAYLOAD_MAXLEN);
 
+/** Mesh transport peer statistics get command parameters. */
+typedef struct __attribute((packed))
+{
+    uint8_t index; /**< Index of the peer statistics entry to get. */
+} serial_cmd_mesh_transport_peer_stats_get_t;
+
 
 /** Mesh command parameters. */
 typedef union __attribute((packed))
@@ -530,6 +538,8 @@ typedef union __attribute((packed))
     serial_cmd_mesh_addr_publication_remove_t       addr_publication_remove;       /**< Publication address remove parameters. */
 
     serial_cmd_mesh_packet_send_t                   packet_send;                   /**< Packet send parameters. */
+
+    serial_cmd_mesh_transport_peer_stats_get_t      transport_peer_stats_get;      /**< Transport peer statistics get parameters. */
 } serial_cmd_mesh_t;
 
 /* **** PB-MESH Client **** */
@@ -46,6 +46,7 @@
 #include "nrf_mesh_prov.h"
 #include "access.h"
 #include "device_state_manager.h"
+#include "transport.h"
 
 
 /**
@@ -60,6 +61,13 @@
 #define SERIAL_EVT_CMD_RSP_LEN_OVERHEAD     (NRF_MESH_SERIAL_PACKET_OVERHEAD + SERIAL_EVT_CMD_RSP_OVERHEAD)
 /** Max length of the command response data field. */
 #define SERIAL_EVT_CMD_RSP_DATA_MAXLEN      (NRF_MESH_SERIAL_PAYLOAD_MAXLEN  - SERIAL_EVT_CMD_RSP_OVERHEAD)
+/** Number of SAR session cancel reasons in the transport statistics response. */
+#define SERIAL_EVT_CMD_RSP_TRANSPORT_CANCEL_REASON_COUNT    (6)
+/** Number of acknowledgment latency bins in the transport statistics response. */
+#define SERIAL_EVT_CMD_RSP_TRANSPORT_ACK_LATENCY_BIN_COUNT  (8)
+
+NRF_MESH_STATIC_ASSERT(SERIAL_EVT_CMD_RSP_TRANSPORT_CANCEL_REASON_COUNT == TRANSPORT_SAR_CANCEL_REASON_COUNT);
+NRF_MESH_STATIC_ASSERT(SERIAL_EVT_CMD_RSP_TRANSPORT_ACK_LATENCY_BIN_COUNT == TRANSPORT_SAR_ACK_LATENCY_BIN_COUNT);
 
 /*lint -align_max(push) -align_max(1) */
 
@@ -135,6 +143,34 @@ typedef struct __attribute((packed))
     uint16_t list_size; /**< Size of the list requested by the command. */
 } serial_evt_cmd_rsp_data_list_size_t;
 
+/** Transport statistics response data. */
+typedef struct __attribute((packed))
+{
+    uint32_t segments_tx;           /**< Number of segments sent, including retransmissions. */
+    uint32_t segments_rx;           /**< Number of segments received, including duplicates. */
+    uint32_t retransmissions;       /**< Number of segments sent again after their first transmission. */
+    uint32_t segments_dropped;      /**< Number of received segments dropped for lack of a SAR session or buffer. */
+    uint32_t sessions_tx_completed; /**< Number of TX sessions that completed successfully. */
+    uint32_t sessions_rx_completed; /**< Number of RX sessions that were completely reassembled. */
+    uint32_t sessions_cancelled[SERIAL_EVT_CMD_RSP_TRANSPORT_CANCEL_REASON_COUNT];   /**< Number of sessions cancelled, indexed by @ref nrf_mesh_sar_session_cancel_reason_t. */
+    uint32_t ack_latency[SERIAL_EVT_CMD_RSP_TRANSPORT_ACK_LATENCY_BIN_COUNT];  /**< Histogram of the time until the first segment acknowledgment of TX sessions. */
+    uint32_t replay_rejections;     /**< Number of packets rejected by the replay protection. */
+    uint32_t decrypt_messages;      /**< Number of access messages that went through trial decryption. */
+    uint32_t decrypt_attempts;      /**< Number of decryption attempts for those messages. */
+} serial_evt_cmd_rsp_data_transport_stats_t;
+
+/** Transport peer statistics response data. */
+typedef struct __attribute((packed))
+{
+    uint16_t address;            /**< Unicast address of the peer. */
+    uint32_t segments_tx;        /**< Number of segments sent to the peer, including retransmissions. */
+    uint32_t segments_rx;        /**< Number of segments received from the peer, including duplicates. */
+    uint32_t retransmissions;    /**< Number of segments sent again to the peer after their first transmission. */
+    uint32_t sessions_completed; /**< Number of sessions with the peer that completed successfully. */
+    uint32_t sessions_cancelled; /**< Number of sessions with the peer that were cancelled. */
+    uint32_t replay_rejections;  /**< Number of packets from the peer rejected by the replay protection. */
+} serial_evt_cmd_rsp_data_transport_peer_stats_t;
+
 /** Command response data with context information. */
 typedef struct __attribute((packed))
 {
@@ -310,6 +346,8 @@ typedef struct __attribute((packed))
         serial_evt_cmd_rsp_data_addr_local_unicast_t   local_unicast;  /**< Local unicast addresses. */
         serial_evt_cmd_rsp_data_addr_t                 addr;           /**< Address response. */
         serial_evt_cmd_rsp_data_list_size_t            list_size;      /**< List size. */
+        serial_evt_cmd_rsp_data_transport_stats_t      transport_stats; /**< Transport statistics. */
+        serial_evt_cmd_rsp_data_transport_peer_stats_t transport_peer_stats; /**< Transport peer statistics. */
         serial_evt_cmd_rsp_data_adv_addr_t             adv_addr;       /**< Advertisement address. */
         serial_evt_cmd_rsp_data_prov_ctx_t             prov_ctx;       /**< Provisioning context. */
         serial_evt_cmd_rsp_data_firmware_info_t        firmware_info;  /**< Firmware information. */
@@ -44,6 +44,7 @@
 #include "device_state_manager.h"
 #include "access.h"
 #include "net_state.h"
+#include "transport.h"
 #include "nrf_mesh_events.h"
 #include "nrf_mesh_utils.h"
 #include "nrf_mesh_assert.h"
@@ -407,6 +408,47 @@ static void handle_cmd_clear(const serial_packet_t * p_cmd)
     serial_cmd_rsp_send(p_cmd->opcode, SERIAL_STATUS_SUCCESS, NULL, 0);
 }
 
+static void handle_cmd_transport_stats_get(const serial_packet_t * p_cmd)
+{
+    transport_stats_t stats;
+    transport_decrypt_stats_t decrypt_stats;
+    transport_stats_get(&stats);
+    transport_decrypt_stats_get(&decrypt_stats);
+
+    serial_evt_cmd_rsp_data_transport_stats_t rsp;
+    rsp.segments_tx           = stats.segments_tx;
+    rsp.segments_rx           = stats.segments_rx;
+    rsp.retransmissions       = stats.retransmissions;
+    rsp.segments_dropped      = stats.segments_dropped;
+    rsp.sessions_tx_completed = stats.sessions_tx_completed;
+    rsp.sessions_rx_completed = stats.sessions_rx_completed;
+    memcpy(rsp.sessions_cancelled, stats.sessions_cancelled, sizeof(rsp.sessions_cancelled));
+    memcpy(rsp.ack_latency, stats.ack_latency, sizeof(rsp.ack_latency));
+    rsp.replay_rejections     = stats.replay_rejections;
+    rsp.decrypt_messages      = decrypt_stats.messages;
+    rsp.decrypt_attempts      = decrypt_stats.attempts;
+    serial_handler_common_cmd_rsp_nodata_on_error(p_cmd->opcode, NRF_SUCCESS, (uint8_t *) &rsp, sizeof(rsp));
+}
+
+static void handle_cmd_transport_peer_stats_get(const serial_packet_t * p_cmd)
+{
+    transport_peer_stats_t stats;
+    uint32_t status = transport_peer_stats_get(p_cmd->payload.cmd.mesh.transport_peer_stats_get.index, &stats);
+
+    serial_evt_cmd_rsp_data_transport_peer_stats_t rsp = {0};
+    if (status == NRF_SUCCESS)
+    {
+        rsp.address            = stats.address;
+        rsp.segments_tx        = stats.segments_tx;
+        rsp.segments_rx        = stats.segments_rx;
+        rsp.retransmissions    = stats.retransmissions;
+        rsp.sessions_completed = stats.sessions_completed;
+        rsp.sessions_cancelled = stats.sessions_cancelled;
+        rsp.replay_rejections  = stats.replay_rejections;
+    }
+    serial_handler_common_cmd_rsp_nodata_on_error(p_cmd->opcode, status, (uint8_t *) &rsp, sizeof(rsp));
+}
+
 /*****************************************************************************
 * Static functions
 *****************************************************************************/
@@ -443,7 +485,9 @@ static const mesh_serial_cmd_handler_t m_handlers[] =
     {SERIAL_OPCODE_CMD_MESH_ADDR_NONVIRTUAL_COUNT_MAX_GET,  0,                                                       0,  handle_cmd_addr_nonvirtual_count_max_get},
     {SERIAL_OPCODE_CMD_MESH_ADDR_VIRTUAL_COUNT_MAX_GET,     0,                                                       0,  handle_cmd_addr_virtual_count_max_get},
     {SERIAL_OPCODE_CMD_MESH_PACKET_SEND, SERIAL_CMD_MESH_PACKET_SEND_OVERHEAD, sizeof(serial_cmd_mesh_packet_send_t) - SERIAL_CMD_MESH_PACKET_SEND_OVERHEAD,  handle_cmd_packet_send},
-    {SERIAL_OPCODE_CMD_MESH_STATE_CLEAR,                    0,                                                       0,  handle_cmd_clear}
+    {SERIAL_OPCODE_CMD_MESH_STATE_CLEAR,                    0,                                                       0,  handle_cmd_clear},
+    {SERIAL_OPCODE_CMD_MESH_TRANSPORT_STATS_GET,            0,                                                       0,  handle_cmd_transport_stats_get},
+    {SERIAL_OPCODE_CMD_MESH_TRANSPORT_PEER_STATS_GET,       sizeof(serial_cmd_mesh_transport_peer_stats_get_t),      0,  handle_cmd_transport_peer_stats_get}
 };
 
 static void serial_handler_mesh_evt_handle(const nrf_mesh_evt_t* p_evt)
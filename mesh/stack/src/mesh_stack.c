@@ -176,7 +176,8 @@ uint32_t mesh_stack_provisioning_data_store(const nrf_mesh_prov_provisioning_dat
         return status;
     }
 
-    /* Store new config server binding. */
+    /* Store the provisioning data and the new config server binding right away. */
+    dsm_flash_flush();
     access_flash_config_store();
     return status;
 }
@@ -0,0 +1,70 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef AES_SOFT_H__
+#define AES_SOFT_H__
+
+#include <stdint.h>
+
+/**
+ * @defgroup AES_SOFT Reference AES-128 implementation
+ * Byte oriented AES-128 used as a reference for the mesh AES implementations in host tests. Expands
+ * the key for every block.
+ * @{
+ */
+
+/**
+ * Encrypts a single block.
+ *
+ * @param[in]  input  16 byte block to encrypt.
+ * @param[in]  key    16 byte key.
+ * @param[out] output 16 byte buffer for the encrypted block.
+ */
+void AES128_ECB_encrypt(const uint8_t * const input, const uint8_t * const key, uint8_t * const output);
+
+/**
+ * Decrypts a single block.
+ *
+ * @param[in]  input  16 byte block to decrypt.
+ * @param[in]  key    16 byte key.
+ * @param[out] output 16 byte buffer for the decrypted block.
+ */
+void AES128_ECB_decrypt(const uint8_t * const input, const uint8_t * const key, uint8_t * const output);
+
+/** @} */
+
+#endif /* AES_SOFT_H__ */
@@ -0,0 +1,81 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BENCHMARK_H__
+#define BENCHMARK_H__
+
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * @defgroup BENCHMARK Host benchmark helpers
+ * Timing helpers shared by the host side benchmarks (bm_*.c).
+ * @{
+ */
+
+/** Prevents the compiler from optimizing away a value computed in a benchmark loop. */
+#define BENCHMARK_KEEP(value) __asm__ volatile("" : : "g"(value) : "memory")
+
+/**
+ * Gets a monotonic timestamp.
+ *
+ * @returns The current time in nanoseconds.
+ */
+static inline uint64_t benchmark_time_ns(void)
+{
+    struct timespec ts;
+    (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+/**
+ * Gets the average time per operation.
+ *
+ * @param[in] start_ns   Timestamp at the start of the measurement.
+ * @param[in] end_ns     Timestamp at the end of the measurement.
+ * @param[in] operations Number of operations performed in the measurement.
+ *
+ * @returns The average time per operation in nanoseconds.
+ */
+static inline double benchmark_ns_per_op(uint64_t start_ns, uint64_t end_ns, uint32_t operations)
+{
+    return (double) (end_ns - start_ns) / (double) operations;
+}
+
+/** @} */
+
+#endif /* BENCHMARK_H__ */
@@ -35,7 +35,7 @@ NOTE:   String length must be evenly divisible by 16byte (str_len % 16 == 0)
 /*****************************************************************************/
 #include <stdint.h>
 #include <string.h> // CBC mode, for memset
-#include "aes.h"
+#include "aes_soft.h"
 
 /*****************************************************************************/
 /* Defines:                                                                  */
@@ -469,13 +469,3 @@ void AES128_ECB_decrypt(const uint8_t * const input, const uint8_t * const key,
   InvCipher();
 }
 
-
-
-void aes_encrypt(aes_data_t * p_data)
-{
-    /* Caching the key here allows the result of this function to overwrite the key. */
-    uint8_t key_buffer[KEYLEN];
-    memcpy(key_buffer, p_data->key, KEYLEN);
-
-    AES128_ECB_encrypt(p_data->cleartext, key_buffer, p_data->ciphertext);
-}
@@ -0,0 +1,208 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * Host benchmark for the software AES implementation.
+ *
+ * Runs the AES block encryptions of a stream of unsegmented access messages through the byte
+ * oriented reference implementation, which expands the key for every block, and through the
+ * T-table implementation with its key schedule cache, checking that they produce the same result.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "benchmark.h"
+#include "aes.h"
+#include "aes_soft.h"
+#include "ccm_soft.h"
+#include "log.h"
+
+/** Number of packets to encrypt. */
+#define BM_PACKET_COUNT         (50000)
+/** Number of application keys in use on the network. */
+#define BM_APPKEY_COUNT         (2)
+/** Upper transport encryption of an 11 byte access PDU: B0, one data block, S0 and one cipher block. */
+#define BM_APP_BLOCKS           (4)
+/** Network encryption of the 17 byte DST + transport PDU: B0, two data blocks, S0 and two cipher blocks. */
+#define BM_NET_BLOCKS           (6)
+/** Size of the largest segmented access message. */
+#define BM_SEGMENTED_MESSAGE_SIZE   (380)
+/** Number of segmented messages to encrypt. */
+#define BM_SEGMENTED_MESSAGE_COUNT  (5000)
+/** Privacy obfuscation block. */
+#define BM_PRIVACY_BLOCKS       (1)
+#define BM_BLOCKS_PER_PACKET    (BM_APP_BLOCKS + BM_NET_BLOCKS + BM_PRIVACY_BLOCKS)
+#define BM_BLOCK_COUNT          (BM_PACKET_COUNT * BM_BLOCKS_PER_PACKET)
+
+static uint8_t m_appkeys[BM_APPKEY_COUNT][NRF_MESH_KEY_SIZE];
+static uint8_t m_encryption_key[NRF_MESH_KEY_SIZE];
+static uint8_t m_privacy_key[NRF_MESH_KEY_SIZE];
+
+static const uint8_t * mp_block_keys[BM_BLOCK_COUNT];
+static uint8_t m_cleartext[BM_BLOCK_COUNT][NRF_MESH_KEY_SIZE];
+static uint8_t m_reference_ciphertext[BM_BLOCK_COUNT][NRF_MESH_KEY_SIZE];
+
+void mesh_assertion_handler(uint32_t pc)
+{
+    __LOG(LOG_SRC_TEST, LOG_LEVEL_ERROR, "Assertion at PC = %.08x\n", pc);
+    exit(1);
+}
+
+static void random_fill(uint8_t * p_data, uint32_t length)
+{
+    for (uint32_t i = 0; i < length; ++i)
+    {
+        p_data[i] = (uint8_t) rand();
+    }
+}
+
+static void traffic_generate(void)
+{
+    srand(0x5EED);
+    random_fill(&m_appkeys[0][0], sizeof(m_appkeys));
+    random_fill(m_encryption_key, sizeof(m_encryption_key));
+    random_fill(m_privacy_key, sizeof(m_privacy_key));
+    random_fill(&m_cleartext[0][0], sizeof(m_cleartext));
+
+    uint32_t block = 0;
+    for (uint32_t packet = 0; packet < BM_PACKET_COUNT; ++packet)
+    {
+        const uint8_t * p_appkey = m_appkeys[(uint32_t) rand() % BM_APPKEY_COUNT];
+        for (uint32_t i = 0; i < BM_APP_BLOCKS; ++i)
+        {
+            mp_block_keys[block++] = p_appkey;
+        }
+        for (uint32_t i = 0; i < BM_NET_BLOCKS; ++i)
+        {
+            mp_block_keys[block++] = m_encryption_key;
+        }
+        for (uint32_t i = 0; i < BM_PRIVACY_BLOCKS; ++i)
+        {
+            mp_block_keys[block++] = m_privacy_key;
+        }
+    }
+}
+
+int main(void)
+{
+    __LOG_INIT(LOG_SRC_TEST, LOG_LEVEL_INFO, LOG_CALLBACK_DEFAULT);
+
+    traffic_generate();
+
+    uint64_t start = benchmark_time_ns();
+    for (uint32_t i = 0; i < BM_BLOCK_COUNT; ++i)
+    {
+        AES128_ECB_encrypt(m_cleartext[i], mp_block_keys[i], m_reference_ciphertext[i]);
+    }
+    uint64_t reference_end = benchmark_time_ns();
+
+    uint32_t mismatches = 0;
+    aes_data_t aes_data;
+    uint64_t cached_start = benchmark_time_ns();
+    for (uint32_t i = 0; i < BM_BLOCK_COUNT; ++i)
+    {
+        memcpy(aes_data.key, mp_block_keys[i], NRF_MESH_KEY_SIZE);
+        memcpy(aes_data.cleartext, m_cleartext[i], NRF_MESH_KEY_SIZE);
+        aes_encrypt(&aes_data);
+        mismatches += (memcmp(aes_data.ciphertext, m_reference_ciphertext[i], NRF_MESH_KEY_SIZE) != 0);
+    }
+    uint64_t cached_end = benchmark_time_ns();
+
+    /* Full network layer CCM of the same packets, for reference. */
+    uint8_t nonce[CCM_NONCE_LENGTH] = {0};
+    uint8_t pdu[17];
+    uint8_t mic[4];
+    random_fill(pdu, sizeof(pdu));
+    ccm_soft_data_t ccm_data =
+    {
+        .p_key = m_encryption_key,
+        .p_nonce = nonce,
+        .p_m = pdu,
+        .m_len = sizeof(pdu),
+        .p_out = pdu,
+        .p_mic = mic,
+        .mic_len = sizeof(mic)
+    };
+    uint64_t ccm_start = benchmark_time_ns();
+    for (uint32_t i = 0; i < BM_PACKET_COUNT; ++i)
+    {
+        nonce[CCM_NONCE_LENGTH - 1] = (uint8_t) i;
+        ccm_soft_encrypt(&ccm_data);
+        BENCHMARK_KEEP(mic[0]);
+    }
+    uint64_t ccm_end = benchmark_time_ns();
+
+    static uint8_t segmented[BM_SEGMENTED_MESSAGE_SIZE];
+    uint8_t segmented_mic[8];
+    random_fill(segmented, sizeof(segmented));
+    ccm_data.p_key = m_appkeys[0];
+    ccm_data.p_m = segmented;
+    ccm_data.m_len = sizeof(segmented);
+    ccm_data.p_out = segmented;
+    ccm_data.p_mic = segmented_mic;
+    ccm_data.mic_len = sizeof(segmented_mic);
+    uint64_t segmented_start = benchmark_time_ns();
+    for (uint32_t i = 0; i < BM_SEGMENTED_MESSAGE_COUNT; ++i)
+    {
+        nonce[CCM_NONCE_LENGTH - 1] = (uint8_t) i;
+        ccm_soft_encrypt(&ccm_data);
+        BENCHMARK_KEEP(segmented_mic[0]);
+    }
+    uint64_t segmented_end = benchmark_time_ns();
+
+    __LOG(LOG_SRC_TEST, LOG_LEVEL_INFO, "AES-128 with %u keys, %u packets (%u blocks per packet):\n",
+          BM_APPKEY_COUNT + 2, BM_PACKET_COUNT, BM_BLOCKS_PER_PACKET);
+    __LOG(LOG_SRC_TEST, LOG_LEVEL_INFO, "  reference, key expansion per block: %8.1f ns/block\n",
+          benchmark_ns_per_op(start, reference_end, BM_BLOCK_COUNT));
+    __LOG(LOG_SRC_TEST, LOG_LEVEL_INFO, "  T-table, cached key schedule:       %8.1f ns/block\n",
+          benchmark_ns_per_op(cached_start, cached_end, BM_BLOCK_COUNT));
+    __LOG(LOG_SRC_TEST, LOG_LEVEL_INFO, "  network PDU CCM:                    %8.1f ns/packet\n",
+          benchmark_ns_per_op(ccm_start, ccm_end, BM_PACKET_COUNT));
+    __LOG(LOG_SRC_TEST, LOG_LEVEL_INFO, "  %u byte message CCM:                %8.1f ns/message\n",
+          BM_SEGMENTED_MESSAGE_SIZE,
+          benchmark_ns_per_op(segmented_start, segmented_end, BM_SEGMENTED_MESSAGE_COUNT));
+
+    if (mismatches != 0)
+    {
+        __LOG(LOG_SRC_TEST, LOG_LEVEL_ERROR, "%u blocks differ from the reference implementation\n", mismatches);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,284 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * Host benchmark for the device state manager RX address lookup.
+ *
+ * Compares the sorted, prefiltered subscription lookup with the linear address table scan it
+ * replaced, by running the same stream of destination addresses through both and checking that
+ * they agree on every lookup.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "benchmark.h"
+#include "device_state_manager.h"
+#include "nrf_mesh_externs.h"
+#include "nrf_mesh_utils.h"
+#include "nrf_mesh_keygen.h"
+#include "enc.h"
+#include "nrf_mesh_events.h"
+#include "net_state.h"
+#include "mesh_opt_core.h"
+#include "rand.h"
+#include "log.h"
+
+/** Number of subscribed group addresses. */
+#define BM_SUBSCRIPTION_COUNT   (DSM_NONVIRTUAL_ADDR_MAX - 16)
+/** Number of subscribed virtual addresses. */
+#define BM_VIRTUAL_COUNT        (DSM_VIRTUAL_ADDR_MAX)
+/** Number of destination addresses looked up. */
+#define BM_LOOKUP_COUNT         (1000000)
+/** First local unicast address. */
+#define BM_LOCAL_ADDRESS        (0x0100)
+
+typedef struct
+{
+    uint16_t address;
+    uint8_t subscription_count;
+} linear_address_t;
+
+/** Copy of the DSM address table, laid out like the DSM stores it. */
+static linear_address_t m_linear_addresses[DSM_ADDR_MAX];
+
+/** Subscribed addresses, in the order they were added to the DSM. */
+static uint16_t m_subscriptions[BM_SUBSCRIPTION_COUNT + BM_VIRTUAL_COUNT];
+static uint16_t m_destinations[BM_LOOKUP_COUNT];
+
+void mesh_assertion_handler(uint32_t pc)
+{
+    __LOG(LOG_SRC_TEST, LOG_LEVEL_ERROR, "Assertion at PC = %.08x\n", pc);
+    exit(1);
+}
+
+/* The DSM's dependencies, which aren't used by the address lookups. */
+void nrf_mesh_evt_handler_add(nrf_mesh_evt_handler_t * p_handler_params)
+{
+}
+
+void nrf_mesh_subnet_added(uint16_t net_key_index, const uint8_t * p_network_id)
+{
+}
+
+void net_state_key_refresh_phase_changed(uint16_t subnet_index,
+                                         const uint8_t * p_network_id,
+                                         nrf_mesh_key_refresh_phase_t new_phase)
+{
+}
+
+uint32_t mesh_opt_core_adv_get(core_tx_role_t role, mesh_opt_core_adv_t * p_entry)
+{
+    memset(p_entry, 0, sizeof(*p_entry));
+    return NRF_SUCCESS;
+}
+
+void rand_hw_rng_get(uint8_t * p_result, uint16_t len)
+{
+    memset(p_result, 0, len);
+}
+
+uint32_t nrf_mesh_keygen_aid(const uint8_t * p_appkey, uint8_t * p_aid)
+{
+    return NRF_SUCCESS;
+}
+
+uint32_t nrf_mesh_keygen_network_secmat(const uint8_t * p_netkey, nrf_mesh_network_secmat_t * p_secmat)
+{
+    return NRF_SUCCESS;
+}
+
+uint32_t nrf_mesh_keygen_beacon_secmat(const uint8_t * p_netkey, nrf_mesh_beacon_secmat_t * p_secmat)
+{
+    return NRF_SUCCESS;
+}
+
+void enc_key_forget(const uint8_t * p_key)
+{
+}
+
+uint32_t nrf_mesh_keygen_virtual_address(const uint8_t * p_virtual_uuid, uint16_t * p_address)
+{
+    uint16_t hash;
+    memcpy(&hash, p_virtual_uuid, sizeof(hash));
+    *p_address = 0x8000 | (hash & 0x3FFF);
+    return NRF_SUCCESS;
+}
+
+/* Reference implementation: the linear scan of the address table used before the lookup index. */
+static bool linear_rx_address_get(uint16_t address)
+{
+    nrf_mesh_address_type_t type = nrf_mesh_address_type_get(address);
+    if (type == NRF_MESH_ADDRESS_TYPE_UNICAST)
+    {
+        return (address == BM_LOCAL_ADDRESS);
+    }
+    else if (type == NRF_MESH_ADDRESS_TYPE_GROUP && address >= NRF_MESH_ALL_PROXIES_ADDR)
+    {
+        return (address == NRF_MESH_ALL_NODES_ADDR);
+    }
+
+    uint32_t start = (type == NRF_MESH_ADDRESS_TYPE_VIRTUAL ? DSM_NONVIRTUAL_ADDR_MAX : 0);
+    uint32_t end = (type == NRF_MESH_ADDRESS_TYPE_VIRTUAL ? DSM_ADDR_MAX : DSM_NONVIRTUAL_ADDR_MAX);
+    for (uint32_t i = start; i < end; ++i)
+    {
+        if (m_linear_addresses[i].address == address && m_linear_addresses[i].subscription_count > 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void linear_addresses_copy(void)
+{
+    for (dsm_handle_t i = 0; i < DSM_ADDR_MAX; ++i)
+    {
+        nrf_mesh_address_t address;
+        uint16_t count;
+        if (dsm_address_get(i, &address) == NRF_SUCCESS &&
+            dsm_address_subscription_count_get(i, &count) == NRF_SUCCESS)
+        {
+            m_linear_addresses[i].address = address.value;
+            m_linear_addresses[i].subscription_count = count;
+        }
+    }
+}
+
+static uint16_t random_group_address(void)
+{
+    return 0xC000 + (uint16_t) ((uint32_t) rand() % 0x3F00);
+}
+
+static void subscriptions_add(void)
+{
+    dsm_handle_t handle;
+    for (uint32_t i = 0; i < BM_SUBSCRIPTION_COUNT; ++i)
+    {
+        do
+        {
+            m_subscriptions[i] = random_group_address();
+        } while (dsm_address_handle_get(&(nrf_mesh_address_t) {NRF_MESH_ADDRESS_TYPE_GROUP, m_subscriptions[i], NULL},
+                                        &handle) == NRF_SUCCESS);
+        NRF_MESH_ERROR_CHECK(dsm_address_subscription_add(m_subscriptions[i], &handle));
+    }
+
+    for (uint32_t i = 0; i < BM_VIRTUAL_COUNT; ++i)
+    {
+        uint8_t uuid[NRF_MESH_UUID_SIZE];
+        for (uint32_t j = 0; j < sizeof(uuid); ++j)
+        {
+            uuid[j] = (uint8_t) rand();
+        }
+        NRF_MESH_ERROR_CHECK(dsm_address_subscription_virtual_add(uuid, &handle));
+        nrf_mesh_address_t address;
+        NRF_MESH_ERROR_CHECK(dsm_address_get(handle, &address));
+        m_subscriptions[BM_SUBSCRIPTION_COUNT + i] = address.value;
+    }
+}
+
+static void traffic_generate(void)
+{
+    for (uint32_t i = 0; i < BM_LOOKUP_COUNT; ++i)
+    {
+        uint32_t kind = (uint32_t) rand() % 10;
+        if (kind < 4)
+        {
+            /* Traffic to one of our groups. */
+            m_destinations[i] = m_subscriptions[(uint32_t) rand() % ARRAY_SIZE(m_subscriptions)];
+        }
+        else if (kind < 8)
+        {
+            /* Relayed traffic to other groups. */
+            m_destinations[i] = random_group_address();
+        }
+        else
+        {
+            /* Relayed unicast traffic, occasionally for us. */
+            m_destinations[i] = BM_LOCAL_ADDRESS + (uint16_t) ((uint32_t) rand() % 64);
+        }
+    }
+}
+
+int main(void)
+{
+    __LOG_INIT(LOG_SRC_TEST, LOG_LEVEL_INFO, LOG_CALLBACK_DEFAULT);
+    srand(0x5EED);
+
+    dsm_init();
+    dsm_local_unicast_address_t local_address = {BM_LOCAL_ADDRESS, 1};
+    NRF_MESH_ERROR_CHECK(dsm_local_unicast_addresses_set(&local_address));
+    subscriptions_add();
+    linear_addresses_copy();
+    traffic_generate();
+
+    static bool linear_result[BM_LOOKUP_COUNT];
+    uint64_t start = benchmark_time_ns();
+    for (uint32_t i = 0; i < BM_LOOKUP_COUNT; ++i)
+    {
+        linear_result[i] = linear_rx_address_get(m_destinations[i]);
+    }
+    uint64_t linear_end = benchmark_time_ns();
+
+    uint32_t mismatches = 0;
+    uint32_t hits = 0;
+    uint64_t indexed_start = benchmark_time_ns();
+    for (uint32_t i = 0; i < BM_LOOKUP_COUNT; ++i)
+    {
+        nrf_mesh_address_t address = {.p_virtual_uuid = NULL};
+        bool is_rx = nrf_mesh_rx_address_get(m_destinations[i], &address);
+        hits += is_rx;
+        mismatches += (is_rx != linear_result[i]);
+    }
+    uint64_t indexed_end = benchmark_time_ns();
+
+    __LOG(LOG_SRC_TEST, LOG_LEVEL_INFO, "RX address lookup with %u group and %u virtual subscriptions, %u lookups (%u hits):\n",
+          BM_SUBSCRIPTION_COUNT, BM_VIRTUAL_COUNT, BM_LOOKUP_COUNT, hits);
+    __LOG(LOG_SRC_TEST, LOG_LEVEL_INFO, "  linear scan:   %8.1f ns/lookup\n",
+          benchmark_ns_per_op(start, linear_end, BM_LOOKUP_COUNT));
+    __LOG(LOG_SRC_TEST, LOG_LEVEL_INFO, "  sorted lookup: %8.1f ns/lookup\n",
+          benchmark_ns_per_op(indexed_start, indexed_end, BM_LOOKUP_COUNT));
+
+    if (mismatches != 0)
+    {
+        __LOG(LOG_SRC_TEST, LOG_LEVEL_ERROR, "%u lookups differ from the linear scan\n", mismatches);
+        return 1;
+    }
+    return 0;
+}
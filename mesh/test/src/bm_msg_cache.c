@@ -0,0 +1,197 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * Host benchmark for the message cache.
+ *
+ * Compares the hash indexed message cache with the linear ring buffer scan it replaced, by running
+ * the same relay-like traffic pattern through both and checking that they agree on every lookup.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "benchmark.h"
+#include "msg_cache.h"
+#include "log.h"
+
+/** Number of unique packets in the generated traffic. */
+#define BM_PACKET_COUNT     (200000)
+/** Number of times each packet is heard from neighbouring relays. */
+#define BM_PACKET_REPEATS   (3)
+/** Number of active source addresses in the traffic. */
+#define BM_SOURCE_COUNT     (250)
+/** Distance (in unique packets) between the repeats of a packet. */
+#define BM_REPEAT_DISTANCE  (MSG_CACHE_ENTRY_COUNT / 4)
+
+typedef struct
+{
+    bool allocated;
+    uint16_t src;
+    uint32_t seq;
+} linear_cache_entry_t;
+
+static linear_cache_entry_t m_linear_cache[MSG_CACHE_ENTRY_COUNT];
+static uint32_t m_linear_cache_head;
+
+static uint16_t m_src[BM_PACKET_COUNT];
+static uint32_t m_seq[BM_PACKET_COUNT];
+static uint32_t m_order[BM_PACKET_COUNT * BM_PACKET_REPEATS];
+
+void mesh_assertion_handler(uint32_t pc)
+{
+    __LOG(LOG_SRC_TEST, LOG_LEVEL_ERROR, "Assertion at PC = %.08x\n", pc);
+    exit(1);
+}
+
+/* Reference implementation: the message cache before it got its hash index. */
+static bool linear_cache_entry_exists(uint16_t src_addr, uint32_t sequence_number)
+{
+    uint32_t entry_index = m_linear_cache_head;
+    for (uint32_t i = 0; i < MSG_CACHE_ENTRY_COUNT; ++i)
+    {
+        if (entry_index-- == 0)
+        {
+            entry_index = MSG_CACHE_ENTRY_COUNT - 1;
+        }
+
+        if (!m_linear_cache[entry_index].allocated)
+        {
+            return false;
+        }
+
+        if (m_linear_cache[entry_index].src == src_addr &&
+            m_linear_cache[entry_index].seq == sequence_number)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void linear_cache_entry_add(uint16_t src, uint32_t seq)
+{
+    m_linear_cache[m_linear_cache_head].src = src;
+    m_linear_cache[m_linear_cache_head].seq = seq;
+    m_linear_cache[m_linear_cache_head].allocated = true;
+
+    if ((++m_linear_cache_head) == MSG_CACHE_ENTRY_COUNT)
+    {
+        m_linear_cache_head = 0;
+    }
+}
+
+static void traffic_generate(void)
+{
+    uint32_t seqnums[BM_SOURCE_COUNT] = {0};
+    srand(0x5EED);
+
+    for (uint32_t i = 0; i < BM_PACKET_COUNT; ++i)
+    {
+        uint32_t source = (uint32_t) rand() % BM_SOURCE_COUNT;
+        m_src[i] = 0x0001 + source;
+        m_seq[i] = seqnums[source]++;
+    }
+
+    /* Every packet is first heard directly, and then repeated by relays a while later. */
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < BM_PACKET_COUNT + BM_REPEAT_DISTANCE * BM_PACKET_REPEATS; ++i)
+    {
+        for (uint32_t repeat = 0; repeat < BM_PACKET_REPEATS; ++repeat)
+        {
+            uint32_t offset = repeat * BM_REPEAT_DISTANCE;
+            if (i >= offset && i - offset < BM_PACKET_COUNT)
+            {
+                m_order[count++] = i - offset;
+            }
+        }
+    }
+}
+
+int main(void)
+{
+    __LOG_INIT(LOG_SRC_TEST, LOG_LEVEL_INFO, LOG_CALLBACK_DEFAULT);
+
+    traffic_generate();
+    const uint32_t operations = BM_PACKET_COUNT * BM_PACKET_REPEATS;
+
+    static bool linear_result[BM_PACKET_COUNT * BM_PACKET_REPEATS];
+    uint64_t start = benchmark_time_ns();
+    for (uint32_t i = 0; i < operations; ++i)
+    {
+        uint32_t packet = m_order[i];
+        linear_result[i] = linear_cache_entry_exists(m_src[packet], m_seq[packet]);
+        if (!linear_result[i])
+        {
+            linear_cache_entry_add(m_src[packet], m_seq[packet]);
+        }
+    }
+    uint64_t linear_end = benchmark_time_ns();
+
+    msg_cache_init();
+    uint32_t mismatches = 0;
+    uint32_t duplicates = 0;
+    uint64_t hashed_start = benchmark_time_ns();
+    for (uint32_t i = 0; i < operations; ++i)
+    {
+        uint32_t packet = m_order[i];
+        bool exists = msg_cache_entry_exists(m_src[packet], m_seq[packet]);
+        if (!exists)
+        {
+            msg_cache_entry_add(m_src[packet], m_seq[packet]);
+        }
+        duplicates += exists;
+        mismatches += (exists != linear_result[i]);
+    }
+    uint64_t hashed_end = benchmark_time_ns();
+
+    __LOG(LOG_SRC_TEST, LOG_LEVEL_INFO, "Message cache with %u entries, %u packets (%u duplicates):\n",
+          MSG_CACHE_ENTRY_COUNT, operations, duplicates);
+    __LOG(LOG_SRC_TEST, LOG_LEVEL_INFO, "  linear scan: %8.1f ns/packet\n",
+          benchmark_ns_per_op(start, linear_end, operations));
+    __LOG(LOG_SRC_TEST, LOG_LEVEL_INFO, "  hash index:  %8.1f ns/packet\n",
+          benchmark_ns_per_op(hashed_start, hashed_end, operations));
+
+    if (mismatches != 0)
+    {
+        __LOG(LOG_SRC_TEST, LOG_LEVEL_ERROR, "%u lookups differ from the linear scan\n", mismatches);
+        return 1;
+    }
+    return 0;
+}
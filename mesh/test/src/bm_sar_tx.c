@@ -0,0 +1,627 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * Host benchmark for segmented transmission.
+ *
+ * Runs the transport layer against a simulated advertiser and a set of simulated receivers, and
+ * measures the throughput of a bulk transfer in simulated time. The transfer is run twice: first
+ * with the application waiting for each message to complete before sending the next, and then
+ * with the application keeping several messages in flight. The receivers reassemble every message,
+ * and the benchmark fails if any message is lost or corrupted.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "benchmark.h"
+#include "transport.h"
+#include "bearer_event.h"
+#include "core_tx.h"
+#include "event.h"
+#include "enc.h"
+#include "network.h"
+#include "net_state.h"
+#include "nrf_mesh_externs.h"
+#include "replay_cache.h"
+#include "timer.h"
+#include "timer_scheduler.h"
+#include "packet_mesh.h"
+#include "log.h"
+
+/** Number of destinations in the transfer. */
+#define BM_DST_COUNT            (4)
+/** Number of messages sent to each destination. */
+#define BM_MESSAGES_PER_DST     (32)
+#define BM_MESSAGE_COUNT        (BM_DST_COUNT * BM_MESSAGES_PER_DST)
+/** Number of segments in each message. */
+#define BM_MESSAGE_SEGMENTS     (12)
+#define BM_MESSAGE_SIZE         (BM_MESSAGE_SEGMENTS * PACKET_MESH_TRS_SEG_CONTROL_PDU_MAX_SIZE)
+/** Number of messages the application keeps in flight in the pipelined run. */
+#define BM_PIPELINE_DEPTH       (TRANSPORT_SAR_SESSIONS_MAX)
+
+#define BM_SRC                  (0x0001)
+#define BM_DST_BASE             (0x0100)
+#define BM_TTL                  (2)
+
+/** Time between advertising events. One packet is sent in every event. */
+#define BM_ADV_INTERVAL_US      (10000)
+/** Number of packets the simulated network layer can hold. */
+#define BM_TX_QUEUE_SIZE        (8)
+/** Chance of losing a segment or an acknowledgment. */
+#define BM_LOSS_PERCENT         (10)
+/** Time from a receiver sending an acknowledgment until it arrives. */
+#define BM_ACK_LATENCY_US       (20000)
+/** Time the receivers wait for more segments before acknowledging an incomplete message. */
+#define BM_RX_ACK_DELAY_US      (150000 + 50000 * BM_TTL)
+/** Simulated time after which the transfer is considered stuck. */
+#define BM_TIME_LIMIT_US        (3600ull * 1000000ull)
+
+#define BM_TIMER_COUNT          (2 * TRANSPORT_SAR_SESSIONS_MAX)
+
+typedef struct
+{
+    bool committed;
+    uint16_t dst;
+    uint32_t length;
+    uint8_t pdu[PACKET_MESH_TRS_SEG_PDU_OFFSET + PACKET_MESH_TRS_SEG_CONTROL_PDU_MAX_SIZE];
+} bm_tx_packet_t;
+
+typedef struct
+{
+    bool active;
+    bool complete;
+    uint16_t seq_zero;
+    uint32_t block_ack;
+    uint8_t last_segment;
+    uint8_t data[BM_MESSAGE_SIZE];
+    bool ack_pending;
+    uint64_t ack_time;
+    uint32_t segack_seqnum;
+} bm_receiver_t;
+
+static uint64_t m_now;
+static uint32_t m_prng_state;
+
+static timer_event_t * mp_timers[BM_TIMER_COUNT];
+static timer_event_t * mp_timer_firing;
+static bool m_timer_firing_done;
+
+static bearer_event_flag_callback_t m_sar_process;
+static bool m_sar_process_pending;
+static core_tx_complete_cb_t m_tx_complete_cb;
+
+static bm_tx_packet_t m_tx_queue[BM_TX_QUEUE_SIZE];
+static uint32_t m_tx_queue_head;
+static uint32_t m_tx_queue_count;
+static uint32_t m_seqnum;
+static uint32_t m_segments_sent;
+
+static bm_receiver_t m_receivers[BM_DST_COUNT];
+static uint32_t m_delivered[BM_MESSAGE_COUNT];
+static uint32_t m_corrupted;
+
+static uint32_t m_next_message;
+static uint32_t m_retry_messages[BM_MESSAGE_COUNT];
+static uint32_t m_retry_count;
+static uint32_t m_in_flight;
+static uint32_t m_completed;
+
+void mesh_assertion_handler(uint32_t pc)
+{
+    __LOG(LOG_SRC_TEST, LOG_LEVEL_ERROR, "Assertion at PC = %.08x\n", pc);
+    exit(1);
+}
+
+static bool packet_lost(void)
+{
+    m_prng_state = m_prng_state * 1103515245u + 12345u;
+    return ((m_prng_state >> 16) % 100) < BM_LOSS_PERCENT;
+}
+
+static uint8_t message_data_get(uint32_t message, uint32_t index)
+{
+    switch (index)
+    {
+        case 0:
+            return (uint8_t) message;
+        case 1:
+            return (uint8_t) (message >> 8);
+        default:
+            return (uint8_t) (message * 31 + index);
+    }
+}
+
+/******************************************************************************
+ * Simulated environment of the transport layer
+ ******************************************************************************/
+
+timestamp_t timer_now(void)
+{
+    return (timestamp_t) m_now;
+}
+
+void timer_sch_reschedule(timer_event_t * p_timer_evt, timestamp_t new_timestamp)
+{
+    p_timer_evt->timestamp = new_timestamp;
+    if (p_timer_evt == mp_timer_firing)
+    {
+        m_timer_firing_done = true;
+    }
+    for (uint32_t i = 0; i < BM_TIMER_COUNT; ++i)
+    {
+        if (mp_timers[i] == p_timer_evt)
+        {
+            return;
+        }
+    }
+    for (uint32_t i = 0; i < BM_TIMER_COUNT; ++i)
+    {
+        if (mp_timers[i] == NULL)
+        {
+            mp_timers[i] = p_timer_evt;
+            return;
+        }
+    }
+    NRF_MESH_ASSERT(false);
+}
+
+void timer_sch_abort(timer_event_t * p_timer_evt)
+{
+    if (p_timer_evt == mp_timer_firing)
+    {
+        m_timer_firing_done = true;
+    }
+    for (uint32_t i = 0; i < BM_TIMER_COUNT; ++i)
+    {
+        if (mp_timers[i] == p_timer_evt)
+        {
+            mp_timers[i] = NULL;
+        }
+    }
+}
+
+void bearer_event_critical_section_begin(void)
+{
+}
+
+void bearer_event_critical_section_end(void)
+{
+}
+
+bearer_event_flag_t bearer_event_flag_add(bearer_event_flag_callback_t callback)
+{
+    m_sar_process = callback;
+    return 0;
+}
+
+void bearer_event_flag_set(bearer_event_flag_t flag)
+{
+    m_sar_process_pending = true;
+}
+
+void core_tx_complete_cb_set(core_tx_complete_cb_t tx_complete_callback)
+{
+    m_tx_complete_cb = tx_complete_callback;
+}
+
+void net_state_iv_index_lock(bool lock)
+{
+}
+
+void replay_cache_init(void)
+{
+}
+
+uint32_t replay_cache_add(uint16_t src, uint32_t seqno, uint8_t ivi)
+{
+    return NRF_SUCCESS;
+}
+
+bool replay_cache_has_elem(uint16_t src, uint32_t seqno, uint8_t ivi)
+{
+    return false;
+}
+
+bool nrf_mesh_rx_address_get(uint16_t raw_address, nrf_mesh_address_t * p_address)
+{
+    p_address->type = NRF_MESH_ADDRESS_TYPE_UNICAST;
+    p_address->value = raw_address;
+    p_address->p_virtual_uuid = NULL;
+    return (raw_address == BM_SRC);
+}
+
+/* Only control messages are sent, so nothing is encrypted. */
+void enc_aes_ccm_encrypt(ccm_soft_data_t * const p_ccm_data)
+{
+    NRF_MESH_ASSERT(false);
+}
+
+void enc_aes_ccm_decrypt(ccm_soft_data_t * const p_ccm_data, bool * const p_mic_passed)
+{
+    NRF_MESH_ASSERT(false);
+}
+
+void enc_nonce_generate(const network_packet_metadata_t * p_net_metadata,
+                        enc_nonce_t type,
+                        uint8_t aszmic,
+                        uint8_t * p_nonce)
+{
+    NRF_MESH_ASSERT(false);
+}
+
+void nrf_mesh_app_secmat_next_get(const nrf_mesh_network_secmat_t * p_network_secmat,
+                                  uint8_t aid,
+                                  const nrf_mesh_application_secmat_t ** pp_app_secmat)
+{
+    *pp_app_secmat = NULL;
+}
+
+void nrf_mesh_devkey_secmat_get(uint16_t owner_addr, const nrf_mesh_application_secmat_t ** pp_devkey_secmat)
+{
+    *pp_devkey_secmat = NULL;
+}
+
+uint32_t network_packet_alloc(network_tx_packet_buffer_t * p_buffer)
+{
+    if (m_tx_queue_count == BM_TX_QUEUE_SIZE)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+    bm_tx_packet_t * p_packet = &m_tx_queue[(m_tx_queue_head + m_tx_queue_count) % BM_TX_QUEUE_SIZE];
+    NRF_MESH_ASSERT(p_buffer->user_data.payload_len <= sizeof(p_packet->pdu));
+    p_packet->committed = false;
+    p_packet->dst = p_buffer->user_data.p_metadata->dst.value;
+    p_packet->length = p_buffer->user_data.payload_len;
+    p_buffer->user_data.p_metadata->internal.sequence_number = m_seqnum++;
+    p_buffer->user_data.p_metadata->internal.iv_index = 0;
+    p_buffer->role = CORE_TX_ROLE_ORIGINATOR;
+    p_buffer->p_payload = p_packet->pdu;
+    m_tx_queue_count++;
+    return NRF_SUCCESS;
+}
+
+void network_packet_send(const network_tx_packet_buffer_t * p_buffer)
+{
+    bm_tx_packet_t * p_packet = &m_tx_queue[(m_tx_queue_head + m_tx_queue_count - 1) % BM_TX_QUEUE_SIZE];
+    NRF_MESH_ASSERT(p_packet->pdu == p_buffer->p_payload);
+    p_packet->committed = true;
+}
+
+/******************************************************************************
+ * Simulated receivers
+ ******************************************************************************/
+
+static void receiver_segment_in(bm_receiver_t * p_receiver, const packet_mesh_trs_packet_t * p_packet, uint32_t length)
+{
+    uint16_t seq_zero = packet_mesh_trs_seg_seqzero_get(p_packet);
+    uint8_t segment = packet_mesh_trs_seg_sego_get(p_packet);
+
+    if (!p_receiver->active || p_receiver->seq_zero != seq_zero)
+    {
+        p_receiver->active = true;
+        p_receiver->complete = false;
+        p_receiver->seq_zero = seq_zero;
+        p_receiver->block_ack = 0;
+        p_receiver->last_segment = packet_mesh_trs_seg_segn_get(p_packet);
+        p_receiver->ack_pending = false;
+    }
+
+    if (!p_receiver->complete && (p_receiver->block_ack & (1u << segment)) == 0)
+    {
+        memcpy(&p_receiver->data[segment * PACKET_MESH_TRS_SEG_CONTROL_PDU_MAX_SIZE],
+               packet_mesh_trs_seg_payload_get(p_packet),
+               length - PACKET_MESH_TRS_SEG_PDU_OFFSET);
+        p_receiver->block_ack |= (1u << segment);
+
+        if (p_receiver->block_ack == (0xFFFFFFFFu >> (31 - p_receiver->last_segment)))
+        {
+            p_receiver->complete = true;
+            uint32_t message = p_receiver->data[0] | (p_receiver->data[1] << 8);
+            bool intact = (message < BM_MESSAGE_COUNT);
+            for (uint32_t i = 0; intact && i < BM_MESSAGE_SIZE; ++i)
+            {
+                intact = (p_receiver->data[i] == message_data_get(message, i));
+            }
+            if (intact)
+            {
+                m_delivered[message]++;
+            }
+            else
+            {
+                m_corrupted++;
+            }
+        }
+    }
+
+    if (p_receiver->complete)
+    {
+        /* Acknowledge complete messages right away. */
+        p_receiver->ack_pending = true;
+        p_receiver->ack_time = m_now + BM_ACK_LATENCY_US;
+    }
+    else if (!p_receiver->ack_pending)
+    {
+        p_receiver->ack_pending = true;
+        p_receiver->ack_time = m_now + BM_RX_ACK_DELAY_US + BM_ACK_LATENCY_US;
+    }
+}
+
+static void receiver_ack_send(uint32_t index)
+{
+    bm_receiver_t * p_receiver = &m_receivers[index];
+    p_receiver->ack_pending = false;
+    if (packet_lost())
+    {
+        return;
+    }
+
+    network_packet_metadata_t net_meta;
+    memset(&net_meta, 0, sizeof(net_meta));
+    net_meta.dst.type = NRF_MESH_ADDRESS_TYPE_UNICAST;
+    net_meta.dst.value = BM_SRC;
+    net_meta.src = BM_DST_BASE + index;
+    net_meta.ttl = BM_TTL;
+    net_meta.control_packet = true;
+    net_meta.internal.sequence_number = p_receiver->segack_seqnum++;
+
+    packet_mesh_trs_packet_t packet;
+    memset(&packet, 0, sizeof(packet));
+    packet_mesh_trs_common_seg_set(&packet, false);
+    packet_mesh_trs_control_opcode_set(&packet, TRANSPORT_CONTROL_OPCODE_SEGACK);
+    packet_mesh_trs_control_packet_t * p_segack =
+        (packet_mesh_trs_control_packet_t *) packet_mesh_trs_unseg_payload_get(&packet);
+    packet_mesh_trs_control_segack_seqzero_set(p_segack, p_receiver->seq_zero);
+    packet_mesh_trs_control_segack_block_ack_set(p_segack, p_receiver->block_ack);
+    (void) transport_packet_in(&packet,
+                               PACKET_MESH_TRS_UNSEG_PDU_OFFSET + PACKET_MESH_TRS_CONTROL_SEGACK_SIZE,
+                               &net_meta,
+                               NULL);
+}
+
+static void advertising_event(void)
+{
+    bm_tx_packet_t * p_packet = &m_tx_queue[m_tx_queue_head];
+    m_tx_queue_head = (m_tx_queue_head + 1) % BM_TX_QUEUE_SIZE;
+    m_tx_queue_count--;
+    m_segments_sent++;
+
+    if (!packet_lost())
+    {
+        receiver_segment_in(&m_receivers[p_packet->dst - BM_DST_BASE],
+                            (const packet_mesh_trs_packet_t *) p_packet->pdu,
+                            p_packet->length);
+    }
+    m_tx_complete_cb(CORE_TX_ROLE_ORIGINATOR, 0, timer_now(), NRF_MESH_SAR_TOKEN);
+}
+
+static void timer_fire(uint32_t index)
+{
+    timer_event_t * p_timer = mp_timers[index];
+    mp_timers[index] = NULL;
+    mp_timer_firing = p_timer;
+    m_timer_firing_done = false;
+    p_timer->cb(timer_now(), p_timer->p_context);
+    if (!m_timer_firing_done && p_timer->interval != 0)
+    {
+        timer_sch_reschedule(p_timer, p_timer->timestamp + p_timer->interval);
+    }
+    mp_timer_firing = NULL;
+}
+
+/******************************************************************************
+ * Simulated application
+ ******************************************************************************/
+
+void event_handle(const nrf_mesh_evt_t * p_evt)
+{
+    if (p_evt->type == NRF_MESH_EVT_TX_COMPLETE)
+    {
+        m_in_flight--;
+        m_completed++;
+    }
+    else if (p_evt->type == NRF_MESH_EVT_SAR_FAILED)
+    {
+        /* Send the message again. */
+        m_in_flight--;
+        m_retry_messages[m_retry_count++] = p_evt->params.sar_failed.token;
+    }
+}
+
+static void application_send(uint32_t depth)
+{
+    static const nrf_mesh_network_secmat_t net_secmat;
+
+    while (m_in_flight < depth && (m_retry_count > 0 || m_next_message < BM_MESSAGE_COUNT))
+    {
+        uint32_t message = (m_retry_count > 0) ? m_retry_messages[m_retry_count - 1] : m_next_message;
+        uint8_t data[BM_MESSAGE_SIZE];
+        for (uint32_t i = 0; i < BM_MESSAGE_SIZE; ++i)
+        {
+            data[i] = message_data_get(message, i);
+        }
+
+        transport_control_packet_t control_packet;
+        control_packet.opcode = TRANSPORT_CONTROL_OPCODE_HEARTBEAT;
+        control_packet.p_net_secmat = &net_secmat;
+        control_packet.src = BM_SRC;
+        control_packet.dst.type = NRF_MESH_ADDRESS_TYPE_UNICAST;
+        control_packet.dst.value = BM_DST_BASE + (message % BM_DST_COUNT);
+        control_packet.dst.p_virtual_uuid = NULL;
+        control_packet.ttl = BM_TTL;
+        control_packet.reliable = true;
+        control_packet.p_data = (const packet_mesh_trs_control_packet_t *) data;
+        control_packet.data_len = BM_MESSAGE_SIZE;
+        if (transport_control_tx(&control_packet, message) != NRF_SUCCESS)
+        {
+            break;
+        }
+
+        m_in_flight++;
+        if (m_retry_count > 0)
+        {
+            m_retry_count--;
+        }
+        else
+        {
+            m_next_message++;
+        }
+    }
+}
+
+/**
+ * Runs the transfer.
+ *
+ * @param[in] depth Number of messages the application keeps in flight.
+ *
+ * @returns The simulated time it took to complete the transfer in microseconds, or 0 if it got stuck.
+ */
+static uint64_t transfer_run(uint32_t depth)
+{
+    m_now = 0;
+    m_prng_state = 0x5EED;
+    memset(mp_timers, 0, sizeof(mp_timers));
+    m_tx_queue_head = 0;
+    m_tx_queue_count = 0;
+    m_segments_sent = 0;
+    memset(m_receivers, 0, sizeof(m_receivers));
+    memset(m_delivered, 0, sizeof(m_delivered));
+    m_corrupted = 0;
+    m_next_message = 0;
+    m_retry_count = 0;
+    m_in_flight = 0;
+    m_completed = 0;
+    transport_init(NULL);
+
+    while (m_completed < BM_MESSAGE_COUNT)
+    {
+        application_send(depth);
+        if (m_sar_process_pending)
+        {
+            m_sar_process_pending = false;
+            (void) m_sar_process();
+            continue;
+        }
+
+        /* Advance to the next event: */
+        uint64_t next = UINT64_MAX;
+        if (m_tx_queue_count > 0 && m_tx_queue[m_tx_queue_head].committed)
+        {
+            next = (m_now / BM_ADV_INTERVAL_US + 1) * BM_ADV_INTERVAL_US;
+        }
+        for (uint32_t i = 0; i < BM_DST_COUNT; ++i)
+        {
+            if (m_receivers[i].ack_pending && m_receivers[i].ack_time < next)
+            {
+                next = m_receivers[i].ack_time;
+            }
+        }
+        for (uint32_t i = 0; i < BM_TIMER_COUNT; ++i)
+        {
+            if (mp_timers[i] != NULL)
+            {
+                uint64_t timestamp = m_now + (timestamp_t) (mp_timers[i]->timestamp - timer_now());
+                if (timestamp < next)
+                {
+                    next = timestamp;
+                }
+            }
+        }
+        if (next == UINT64_MAX || next > BM_TIME_LIMIT_US)
+        {
+            return 0;
+        }
+        m_now = next;
+
+        for (uint32_t i = 0; i < BM_TIMER_COUNT; ++i)
+        {
+            if (mp_timers[i] != NULL && mp_timers[i]->timestamp == timer_now())
+            {
+                timer_fire(i);
+            }
+        }
+        for (uint32_t i = 0; i < BM_DST_COUNT; ++i)
+        {
+            if (m_receivers[i].ack_pending && m_receivers[i].ack_time == m_now)
+            {
+                receiver_ack_send(i);
+            }
+        }
+        if (m_now % BM_ADV_INTERVAL_US == 0 && m_tx_queue_count > 0 && m_tx_queue[m_tx_queue_head].committed)
+        {
+            advertising_event();
+        }
+    }
+    return m_now;
+}
+
+static bool transfer_report(const char * p_name, uint32_t depth)
+{
+    uint64_t duration = transfer_run(depth);
+    if (duration == 0)
+    {
+        __LOG(LOG_SRC_TEST, LOG_LEVEL_ERROR, "%s: transfer got stuck\n", p_name);
+        return false;
+    }
+
+    __LOG(LOG_SRC_TEST, LOG_LEVEL_INFO, "  %s %8.1f bytes/s, %5u segments sent\n",
+          p_name, (double) (BM_MESSAGE_COUNT * BM_MESSAGE_SIZE) * 1000000.0 / (double) duration, m_segments_sent);
+
+    bool success = (m_corrupted == 0);
+    for (uint32_t i = 0; i < BM_MESSAGE_COUNT; ++i)
+    {
+        success = success && (m_delivered[i] > 0);
+    }
+    if (!success)
+    {
+        __LOG(LOG_SRC_TEST, LOG_LEVEL_ERROR, "%s: messages were lost or corrupted\n", p_name);
+    }
+    return success;
+}
+
+int main(void)
+{
+    __LOG_INIT(LOG_SRC_TEST, LOG_LEVEL_INFO, LOG_CALLBACK_DEFAULT);
+
+    __LOG(LOG_SRC_TEST, LOG_LEVEL_INFO, "SAR TX of %u messages of %u bytes to %u destinations, %u%% loss:\n",
+          BM_MESSAGE_COUNT, BM_MESSAGE_SIZE, BM_DST_COUNT, BM_LOSS_PERCENT);
+    bool success = transfer_report("one at a time:", 1);
+    success = transfer_report("pipelined:     ", BM_PIPELINE_DEPTH) && success;
+    return success ? 0 : 1;
+}
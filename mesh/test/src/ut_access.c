@@ -837,6 +837,115 @@ void test_rx_tx(void)
     TEST_ASSERT_EQUAL(NRF_SUCCESS, access_model_subscription_add(0, ACCESS_ELEMENT_COUNT + ACCESS_MODEL_COUNT));
 }
 
+void test_rx_shared_opcode(void)
+{
+    access_opcode_handler_t handlers[2][3];
+    const access_opcode_t opcodes[][3] = {{ACCESS_OPCODE_SIG(0x8201), ACCESS_OPCODE_SIG(0x02), ACCESS_OPCODE_SIG(0x8201)},
+                                          {ACCESS_OPCODE_VENDOR(0xC1, 0x0059), ACCESS_OPCODE_SIG(0x8201), ACCESS_OPCODE_SIG(0x03)}};
+    access_model_add_params_t init_params;
+    init_params.element_index = 0;
+    init_params.model_id.company_id = ACCESS_COMPANY_ID_NONE;
+    init_params.opcode_count = 3;
+    init_params.publish_timeout_cb = NULL;
+
+    for (access_model_handle_t i = 0; i < 2; ++i)
+    {
+        for (uint32_t j = 0; j < 3; ++j)
+        {
+            handlers[i][j].opcode = opcodes[i][j];
+            handlers[i][j].handler = opcode_handler;
+        }
+        init_params.model_id.model_id = TEST_MODEL_ID + i;
+        init_params.p_opcode_handlers = &handlers[i][0];
+        init_params.p_args = ((uint32_t *)TEST_REFERENCE + i);
+
+        access_model_handle_t handle;
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, access_model_add(&init_params, &handle));
+        TEST_ASSERT_EQUAL(i, handle);
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, access_model_application_bind(handle, 0));
+    }
+    /* Only the first handler for an opcode is called. */
+    handlers[0][2].handler = NULL;
+
+    const uint8_t data[] = "Hello, World!";
+
+    /* Both models handle the opcode, in the order they were added. */
+    for (access_model_handle_t i = 0; i < 2; ++i)
+    {
+        void * p_args = ((uint32_t *)TEST_REFERENCE + i);
+        expect_msg(opcodes[0][0], (uint32_t)p_args, data, sizeof(data));
+        access_reliable_message_rx_cb_Expect(i, NULL, p_args);
+        access_reliable_message_rx_cb_IgnoreArg_p_message();
+        access_reliable_message_rx_cb_IgnoreArg_p_args();
+    }
+    send_msg(opcodes[0][0], data, sizeof(data), 0, 0);
+
+    /* Opcodes handled by a single model. */
+    for (access_model_handle_t i = 0; i < 2; ++i)
+    {
+        void * p_args = ((uint32_t *)TEST_REFERENCE + i);
+        access_opcode_t opcode = (i == 0 ? opcodes[0][1] : opcodes[1][0]);
+        expect_msg(opcode, (uint32_t)p_args, data, sizeof(data));
+        access_reliable_message_rx_cb_Expect(i, NULL, p_args);
+        access_reliable_message_rx_cb_IgnoreArg_p_message();
+        access_reliable_message_rx_cb_IgnoreArg_p_args();
+        send_msg(opcode, data, sizeof(data), 0, 0);
+    }
+
+    /* Same opcode value with a different company ID isn't handled. */
+    const access_opcode_t other_company_opcode = ACCESS_OPCODE_VENDOR(0xC1, 0x005A);
+    send_msg(other_company_opcode, data, sizeof(data), 0, 0);
+    /* Message to an element without models isn't handled. */
+    send_msg(opcodes[0][0], data, sizeof(data), 1, 0);
+}
+
+void test_message_retain(void)
+{
+    uint8_t rx_buffer[] = "Hello, World!";
+    nrf_mesh_rx_metadata_t core_metadata;
+    memset(&core_metadata, 0, sizeof(core_metadata));
+    core_metadata.source = NRF_MESH_RX_SOURCE_SCANNER;
+
+    access_message_rx_t message;
+    memset(&message, 0, sizeof(message));
+    message.opcode.opcode = 0x8201;
+    message.opcode.company_id = ACCESS_COMPANY_ID_NONE;
+    message.p_data = rx_buffer;
+    message.length = sizeof(rx_buffer);
+    message.meta_data.src.value = 0x1234;
+    message.meta_data.p_core_metadata = &core_metadata;
+
+    uint8_t data_buffer[sizeof(rx_buffer)];
+    access_message_retained_t retained;
+
+    TEST_ASSERT_EQUAL(NRF_ERROR_NULL, access_message_retain(NULL, data_buffer, sizeof(data_buffer), &retained));
+    TEST_ASSERT_EQUAL(NRF_ERROR_NULL, access_message_retain(&message, NULL, sizeof(data_buffer), &retained));
+    TEST_ASSERT_EQUAL(NRF_ERROR_NULL, access_message_retain(&message, data_buffer, sizeof(data_buffer), NULL));
+    TEST_ASSERT_EQUAL(NRF_ERROR_DATA_SIZE, access_message_retain(&message, data_buffer, sizeof(data_buffer) - 1, &retained));
+
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, access_message_retain(&message, data_buffer, sizeof(data_buffer), &retained));
+
+    /* The retained message must survive the stack reusing its receive buffers. */
+    memset(rx_buffer, 0, sizeof(rx_buffer));
+    memset(&core_metadata, 0, sizeof(core_metadata));
+
+    TEST_ASSERT_EQUAL_PTR(data_buffer, retained.message.p_data);
+    TEST_ASSERT_EQUAL(sizeof(rx_buffer), retained.message.length);
+    TEST_ASSERT_EQUAL_MEMORY("Hello, World!", retained.message.p_data, retained.message.length);
+    TEST_ASSERT_EQUAL(0x8201, retained.message.opcode.opcode);
+    TEST_ASSERT_EQUAL_HEX16(0x1234, retained.message.meta_data.src.value);
+    TEST_ASSERT_EQUAL_PTR(&retained.core_metadata, retained.message.meta_data.p_core_metadata);
+    TEST_ASSERT_EQUAL(NRF_MESH_RX_SOURCE_SCANNER, retained.message.meta_data.p_core_metadata->source);
+
+    /* Messages without core metadata (e.g. loopback) keep the NULL reference. */
+    message.p_data = NULL;
+    message.length = 0;
+    message.meta_data.p_core_metadata = NULL;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, access_message_retain(&message, NULL, 0, &retained));
+    TEST_ASSERT_EQUAL(0, retained.message.length);
+    TEST_ASSERT_NULL(retained.message.meta_data.p_core_metadata);
+}
+
 void test_unicast_loopback(void)
 {
     build_device_setup(ACCESS_ELEMENT_COUNT, ACCESS_MODEL_COUNT);
@@ -1020,6 +1129,43 @@ void test_group_addressing(void)
     }
 }
 
+void test_group_addressing_subscription_changes(void)
+{
+    build_device_setup(ACCESS_ELEMENT_COUNT, ACCESS_MODEL_COUNT);
+
+    const access_model_handle_t owner = 0;
+    /* The last model has no subscription list of its own. */
+    const access_model_handle_t other = ACCESS_MODEL_COUNT - 1;
+    const dsm_handle_t group = ACCESS_ELEMENT_COUNT;
+    const uint8_t data[] = "Hello, World!";
+    dsm_handle_t address_handles[2];
+    uint16_t count;
+
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, access_model_subscription_add(owner, group));
+    expect_msg(m_opcode_handlers[owner][0].opcode, (uint32_t) ((uint32_t *)TEST_REFERENCE + owner), data, sizeof(data));
+    send_msg(m_opcode_handlers[owner][0].opcode, data, sizeof(data), group, 0);
+    send_msg(m_opcode_handlers[other][0].opcode, data, sizeof(data), group, 0);
+
+    /* Sharing a list with existing subscriptions subscribes the other model too. */
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, access_model_subscription_lists_share(owner, other));
+    expect_msg(m_opcode_handlers[other][0].opcode, (uint32_t) ((uint32_t *)TEST_REFERENCE + other), data, sizeof(data));
+    send_msg(m_opcode_handlers[other][0].opcode, data, sizeof(data), group, 0);
+
+    count = ARRAY_SIZE(address_handles);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, access_model_subscriptions_get(other, address_handles, &count));
+    TEST_ASSERT_EQUAL(1, count);
+    TEST_ASSERT_EQUAL(group, address_handles[0]);
+
+    /* Removing the subscription through either model removes it for both. */
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, access_model_subscription_remove(other, group));
+    send_msg(m_opcode_handlers[owner][0].opcode, data, sizeof(data), group, 0);
+    send_msg(m_opcode_handlers[other][0].opcode, data, sizeof(data), group, 0);
+
+    count = ARRAY_SIZE(address_handles);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, access_model_subscriptions_get(owner, address_handles, &count));
+    TEST_ASSERT_EQUAL(0, count);
+}
+
 void test_model_publish(void)
 {
     access_message_tx_t message;
@@ -0,0 +1,178 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+#include "aes.h"
+#include "aes_soft.h"
+
+/** Number of different keys to cycle through, enough to make the key schedule cache evict entries. */
+#define KEY_COUNT   (AES_KEY_SCHEDULE_CACHE_SIZE * 2 + 1)
+/** Number of blocks to encrypt in the randomized tests. */
+#define BLOCK_COUNT (1000)
+
+/* FIPS-197, Appendix C.1 */
+static const uint8_t m_fips_key[]        = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
+static const uint8_t m_fips_plaintext[]  = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+static const uint8_t m_fips_ciphertext[] = {0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a};
+
+static void random_fill(uint8_t * p_data, uint32_t length)
+{
+    for (uint32_t i = 0; i < length; ++i)
+    {
+        p_data[i] = (uint8_t) rand();
+    }
+}
+
+static void encrypt_and_verify(aes_data_t * p_aes_data)
+{
+    uint8_t expected[NRF_MESH_KEY_SIZE];
+    AES128_ECB_encrypt(p_aes_data->cleartext, p_aes_data->key, expected);
+
+    aes_encrypt(p_aes_data);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, p_aes_data->ciphertext, NRF_MESH_KEY_SIZE);
+}
+
+void setUp(void)
+{
+    srand(0x5EED);
+}
+
+void tearDown(void)
+{
+}
+
+void test_fips_vector(void)
+{
+    aes_data_t aes_data;
+    memcpy(aes_data.key, m_fips_key, sizeof(m_fips_key));
+    memcpy(aes_data.cleartext, m_fips_plaintext, sizeof(m_fips_plaintext));
+
+    /* Encrypt twice, to go through both a key schedule cache miss and a hit. */
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        memset(aes_data.ciphertext, 0, sizeof(aes_data.ciphertext));
+        aes_encrypt(&aes_data);
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(m_fips_ciphertext, aes_data.ciphertext, sizeof(m_fips_ciphertext));
+    }
+}
+
+void test_key_schedule_cache(void)
+{
+    uint8_t keys[KEY_COUNT][NRF_MESH_KEY_SIZE];
+    random_fill(&keys[0][0], sizeof(keys));
+
+    aes_data_t aes_data;
+
+    /* Bursts of blocks with the same key, as when encrypting a packet. */
+    for (uint32_t i = 0; i < BLOCK_COUNT; ++i)
+    {
+        memcpy(aes_data.key, keys[(i / 4) % KEY_COUNT], NRF_MESH_KEY_SIZE);
+        random_fill(aes_data.cleartext, NRF_MESH_KEY_SIZE);
+        encrypt_and_verify(&aes_data);
+    }
+
+    /* Random key order, hitting and evicting cache entries. */
+    for (uint32_t i = 0; i < BLOCK_COUNT; ++i)
+    {
+        memcpy(aes_data.key, keys[(uint32_t) rand() % KEY_COUNT], NRF_MESH_KEY_SIZE);
+        random_fill(aes_data.cleartext, NRF_MESH_KEY_SIZE);
+        encrypt_and_verify(&aes_data);
+    }
+}
+
+void test_key_change_in_place(void)
+{
+    aes_data_t aes_data;
+    random_fill(aes_data.key, NRF_MESH_KEY_SIZE);
+    random_fill(aes_data.cleartext, NRF_MESH_KEY_SIZE);
+    encrypt_and_verify(&aes_data);
+
+    /* Keys that differ from a cached key in a single bit must not reuse its key schedule. */
+    for (uint32_t i = 0; i < NRF_MESH_KEY_SIZE; ++i)
+    {
+        aes_data.key[i] ^= 0x01;
+        encrypt_and_verify(&aes_data);
+    }
+}
+
+void test_key_forget(void)
+{
+    uint8_t keys[KEY_COUNT][NRF_MESH_KEY_SIZE];
+    random_fill(&keys[0][0], sizeof(keys));
+
+    aes_data_t aes_data;
+
+    /* Forgetting keys that were never used is harmless. */
+    aes_key_forget(keys[0]);
+
+    /* Forget keys as they're used, both while they're cached and after they've been evicted. */
+    for (uint32_t i = 0; i < BLOCK_COUNT; ++i)
+    {
+        memcpy(aes_data.key, keys[(uint32_t) rand() % KEY_COUNT], NRF_MESH_KEY_SIZE);
+        random_fill(aes_data.cleartext, NRF_MESH_KEY_SIZE);
+        encrypt_and_verify(&aes_data);
+        if ((rand() % 3) == 0)
+        {
+            aes_key_forget(keys[(uint32_t) rand() % KEY_COUNT]);
+        }
+    }
+
+    /* A forgotten key is expanded again the next time it's used. */
+    for (uint32_t i = 0; i < KEY_COUNT; ++i)
+    {
+        aes_key_forget(keys[i]);
+    }
+    memcpy(aes_data.key, m_fips_key, sizeof(m_fips_key));
+    memcpy(aes_data.cleartext, m_fips_plaintext, sizeof(m_fips_plaintext));
+    aes_encrypt(&aes_data);
+    aes_key_forget(m_fips_key);
+    memset(aes_data.ciphertext, 0, sizeof(aes_data.ciphertext));
+    aes_encrypt(&aes_data);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(m_fips_ciphertext, aes_data.ciphertext, sizeof(m_fips_ciphertext));
+
+    /* Wiped entries don't pass for the all-zero key, not even the most recently used one. */
+    memcpy(aes_data.key, keys[0], NRF_MESH_KEY_SIZE);
+    encrypt_and_verify(&aes_data);
+    memcpy(aes_data.key, keys[1], NRF_MESH_KEY_SIZE);
+    encrypt_and_verify(&aes_data);
+    aes_key_forget(keys[1]);
+    memset(aes_data.key, 0, NRF_MESH_KEY_SIZE);
+    encrypt_and_verify(&aes_data);
+}
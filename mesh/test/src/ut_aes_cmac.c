@@ -52,6 +52,10 @@ static uint8_t m_cmac1[] = {0x07, 0x0a, 0x16, 0xb4, 0x6b, 0x4d, 0x41, 0x44, 0xf7
 static uint8_t m_cmac2[] = {0xdf, 0xa6, 0x67, 0x47, 0xde, 0x9a, 0xe6, 0x30, 0x30, 0xca, 0x32, 0x61, 0x14, 0x97, 0xc8, 0x27};
 static uint8_t m_cmac3[] = {0x51, 0xf0, 0xbe, 0xbf, 0x7e, 0x3b, 0x9d, 0x92, 0xfc, 0x49, 0x74, 0x17, 0x79, 0x36, 0x3c, 0xfe};
 
+/* RFC subkeys for m_key */
+static uint8_t m_k1[] = {0xfb, 0xee, 0xd6, 0x18, 0x35, 0x71, 0x33, 0x66, 0x7c, 0x85, 0xe0, 0x8f, 0x72, 0x36, 0xa8, 0xde};
+static uint8_t m_k2[] = {0xf7, 0xdd, 0xac, 0x30, 0x6a, 0xe2, 0x66, 0xcc, 0xf9, 0x0b, 0xc1, 0x1e, 0xe4, 0x6d, 0x51, 0x3b};
+
 static uint8_t m_result[16];
 
 
@@ -91,3 +95,50 @@ void test_aes_cmac3(void)
     TEST_ASSERT_EQUAL_HEX8_ARRAY(m_cmac3, m_result, 16);
 }
 
+
+void test_aes_cmac_subkeys(void)
+{
+    nrf_mesh_cmac_subkeys_t subkeys;
+    aes_cmac_subkeys_generate(m_key, &subkeys);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(m_k1, subkeys.k1, 16);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(m_k2, subkeys.k2, 16);
+}
+
+void test_aes_cmac_streaming(void)
+{
+    nrf_mesh_cmac_subkeys_t subkeys;
+    aes_cmac_ctx_t ctx;
+    aes_cmac_subkeys_generate(m_key, &subkeys);
+
+    aes_cmac_init(&ctx, m_key, &subkeys);
+    aes_cmac_final(&ctx, m_result);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(m_cmac0, m_result, 16);
+
+    /* A single full block must be finalized with K1, not processed as an intermediate block. */
+    aes_cmac_init(&ctx, m_key, &subkeys);
+    aes_cmac_update(&ctx, m_msg1, 16);
+    aes_cmac_update(&ctx, m_msg1, 0);
+    aes_cmac_final(&ctx, m_result);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(m_cmac1, m_result, 16);
+
+    /* Uneven chunks crossing block boundaries. */
+    static const uint8_t chunks[] = {1, 15, 16, 7, 1};
+    aes_cmac_init(&ctx, m_key, &subkeys);
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < sizeof(chunks); ++i)
+    {
+        aes_cmac_update(&ctx, &m_msg2[offset], chunks[i]);
+        offset += chunks[i];
+    }
+    TEST_ASSERT_EQUAL(sizeof(m_msg2), offset);
+    aes_cmac_final(&ctx, m_result);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(m_cmac2, m_result, 16);
+
+    aes_cmac_init(&ctx, m_key, &subkeys);
+    for (uint32_t i = 0; i < sizeof(m_msg3); ++i)
+    {
+        aes_cmac_update(&ctx, &m_msg3[i], 1);
+    }
+    aes_cmac_final(&ctx, m_result);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(m_cmac3, m_result, 16);
+}
@@ -262,3 +262,120 @@ void test_ccm_soft_data_authenticate(void)
     ccm_soft_decrypt(&enc_data, &authenticated);
     TEST_ASSERT(authenticated);
 }
+
+
+void test_ccm_soft_segmented_message(void)
+{
+    /* Maximum size segmented access message, with a virtual address label as additional data.
+     * Encrypted/decrypted both in place and out of place. */
+    static const uint8_t expected[] =
+    {
+        0x49, 0xB1, 0x7D, 0x8D, 0x3E, 0xA4, 0xE6, 0x17, 0x4A, 0x48, 0xE2, 0xB6, 0x5E, 0x6D, 0x8B, 0x41,
+        0x7A, 0xC0, 0xDD, 0x3F, 0x8E, 0xE4, 0x6C, 0xE4, 0xA4, 0xA2, 0xA5, 0x09, 0x66, 0x1C, 0xEF, 0x52,
+        0x52, 0x8C, 0x1C, 0xD9, 0x80, 0x53, 0x33, 0xA5, 0xCF, 0xD4, 0x82, 0xFA, 0x3F, 0x09, 0x5A, 0x3C,
+        0x2F, 0xDD, 0x1C, 0xC4, 0x77, 0x71, 0xC5, 0xE5, 0x5F, 0xDD, 0xD6, 0x0B, 0x5C, 0x8D, 0x6D, 0x3F,
+        0xA5, 0xC8, 0xDD, 0x79, 0xD0, 0x8B, 0x16, 0x24, 0x2B, 0x66, 0x42, 0x10, 0x6E, 0x7C, 0x0C, 0x28,
+        0xBD, 0x10, 0x64, 0xB3, 0x1E, 0x6D, 0x7C, 0x98, 0x00, 0xC8, 0x39, 0x7D, 0xBC, 0x3F, 0xA8, 0x07,
+        0x1E, 0x6A, 0x38, 0x27, 0x8B, 0x38, 0x6C, 0x18, 0xD6, 0x5D, 0x39, 0xC6, 0xAD, 0x1E, 0xF9, 0x50,
+        0x1A, 0x5C, 0x8F, 0x68, 0xD3, 0x8E, 0xB6, 0x47, 0x47, 0x99, 0xF3, 0xCC, 0x89, 0x8B, 0x4B, 0x9B,
+        0x97, 0xE8, 0x7F, 0x9C, 0x95, 0xCE, 0x5C, 0x51, 0xBC, 0x9D, 0x75, 0x8F, 0x17, 0x11, 0x95, 0x86,
+        0x66, 0x3A, 0x56, 0x84, 0xE0, 0xA0, 0xDA, 0xF6, 0x52, 0x0E, 0xC5, 0x72, 0xB8, 0x74, 0x73, 0xEB,
+        0x14, 0x1D, 0x10, 0x47, 0x1E, 0x47, 0x99, 0xDE, 0xD9, 0xE6, 0x07, 0x65, 0x54, 0x02, 0xEC, 0xA5,
+        0x17, 0x6B, 0xBF, 0x79, 0x2E, 0xF3, 0x9D, 0xD1, 0x35, 0xAC, 0x8D, 0x71, 0x0D, 0xA8, 0xE9, 0xE8,
+        0x54, 0xFD, 0x3B, 0x95, 0xC6, 0x81, 0x02, 0x3F, 0x36, 0xB5, 0xEB, 0xE2, 0xFB, 0x21, 0x3D, 0x0B,
+        0x62, 0xDD, 0x6E, 0x9E, 0x3C, 0xFE, 0x19, 0x0B, 0x79, 0x2C, 0xCB, 0x20, 0xC5, 0x34, 0x23, 0xB2,
+        0xDC, 0xA1, 0x28, 0xF8, 0x61, 0xA6, 0x1D, 0x30, 0x69, 0x10, 0xE1, 0xAF, 0x41, 0x88, 0x39, 0x46,
+        0x7E, 0x46, 0x6F, 0x0E, 0xC3, 0x61, 0xD2, 0x53, 0x9E, 0xED, 0xD9, 0x9D, 0x47, 0x24, 0xF1, 0xB5,
+        0x72, 0x7F, 0x18, 0x89, 0x37, 0x9E, 0x21, 0xFB, 0xA5, 0x9B, 0xF7, 0x6F, 0x11, 0xCE, 0x71, 0x53,
+        0x16, 0x24, 0xEE, 0xCC, 0x9E, 0xA9, 0x2C, 0x16, 0x7A, 0x59, 0xFB, 0x37, 0xC5, 0x6C, 0xD0, 0x3A,
+        0x40, 0x25, 0x2E, 0xB6, 0x75, 0xA5, 0x27, 0x89, 0xB2, 0xE6, 0x2F, 0xFC, 0x4E, 0x95, 0xFF, 0x89,
+        0x1D, 0x2D, 0x83, 0x17, 0x1C, 0xB8, 0x06, 0x90, 0x53, 0xED, 0xAE, 0x06, 0x18, 0x7C, 0x11, 0xE6,
+        0xA1, 0xA6, 0xE8, 0x00, 0x58, 0x9B, 0xBA, 0x93, 0xC6, 0x35, 0x2B, 0xA5, 0x08, 0x96, 0xF8, 0x71,
+        0x7E, 0x53, 0x31, 0x31, 0x64, 0xB0, 0x8E, 0x79, 0x23, 0x3E, 0x3C, 0x69, 0x10, 0xCC, 0x56, 0xBF,
+        0xCD, 0x96, 0x35, 0xD2, 0x6D, 0x23, 0x48, 0xE2, 0xE5, 0x1D, 0xE7, 0x23, 0x6B, 0x7A, 0xB4, 0xDB,
+        0x81, 0x1F, 0x7A, 0x4A, 0x65, 0xDA, 0x22, 0x0F, 0x40, 0x36, 0x44, 0x69
+    };
+    static const uint8_t expected_mic[] = {0x67, 0x79, 0x0D, 0xE9, 0x17, 0xDE, 0xBD, 0x0A};
+    uint8_t key[16];
+    uint8_t label[16];
+    uint8_t nonce[13];
+    uint8_t message[sizeof(expected)];
+    uint8_t buffer[sizeof(expected)];
+    uint8_t output[sizeof(expected)];
+    uint8_t mic[sizeof(expected_mic)];
+
+    for (uint32_t i = 0; i < sizeof(key); ++i)
+    {
+        key[i] = 0x40 + i;
+        label[i] = 0xA0 + i;
+    }
+    for (uint32_t i = 0; i < sizeof(nonce); ++i)
+    {
+        nonce[i] = 0x10 + i;
+    }
+    for (uint32_t i = 0; i < sizeof(message); ++i)
+    {
+        message[i] = (uint8_t) i;
+    }
+
+    ccm_soft_data_t ccm_data =
+    {
+        .p_key   = key,
+        .p_nonce = nonce,
+        .p_m     = message,
+        .p_a     = label,
+        .m_len   = sizeof(message),
+        .a_len   = sizeof(label),
+        .mic_len = sizeof(mic),
+        .p_mic   = mic,
+        .p_out   = output
+    };
+    ccm_soft_encrypt(&ccm_data);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, output, sizeof(expected));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected_mic, mic, sizeof(expected_mic));
+
+    memcpy(buffer, message, sizeof(buffer));
+    memset(mic, 0, sizeof(mic));
+    ccm_data.p_m = buffer;
+    ccm_data.p_out = buffer;
+    ccm_soft_encrypt(&ccm_data);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, buffer, sizeof(expected));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected_mic, mic, sizeof(expected_mic));
+
+    bool mic_passed = false;
+    ccm_data.p_m = expected;
+    ccm_data.p_out = output;
+    ccm_soft_decrypt(&ccm_data, &mic_passed);
+    TEST_ASSERT_TRUE(mic_passed);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(message, output, sizeof(message));
+
+    mic_passed = false;
+    ccm_data.p_m = buffer;
+    ccm_data.p_out = buffer;
+    ccm_soft_decrypt(&ccm_data, &mic_passed);
+    TEST_ASSERT_TRUE(mic_passed);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(message, buffer, sizeof(message));
+
+    /* Any change to the message must be caught by the MIC, and the encrypted message is left as it
+     * was: */
+    memcpy(buffer, expected, sizeof(buffer));
+    buffer[sizeof(buffer) - 1] ^= 0x01;
+    memcpy(output, buffer, sizeof(output));
+    ccm_soft_decrypt(&ccm_data, &mic_passed);
+    TEST_ASSERT_FALSE(mic_passed);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(output, buffer, sizeof(buffer));
+
+    /* Failing to decrypt in place with the wrong key doesn't prevent decrypting with the right one: */
+    uint8_t wrong_key[16];
+    memcpy(wrong_key, key, sizeof(wrong_key));
+    wrong_key[0] ^= 0x01;
+    memcpy(buffer, expected, sizeof(buffer));
+    ccm_data.p_key = wrong_key;
+    ccm_soft_decrypt(&ccm_data, &mic_passed);
+    TEST_ASSERT_FALSE(mic_passed);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, buffer, sizeof(buffer));
+    ccm_data.p_key = key;
+    ccm_soft_decrypt(&ccm_data, &mic_passed);
+    TEST_ASSERT_TRUE(mic_passed);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(message, buffer, sizeof(message));
+}
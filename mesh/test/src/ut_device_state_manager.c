@@ -37,6 +37,7 @@
 
 #include <unity.h>
 #include <cmock.h>
+#include <stddef.h>
 #include <string.h>
 #include <stdlib.h>
 
@@ -50,6 +51,7 @@
 #include "nrf_mesh_externs.h"
 #include "nrf_mesh_events_mock.h"
 #include "nrf_mesh_keygen_mock.h"
+#include "enc_mock.h"
 #include "net_state_mock.h"
 #include "flash_manager_mock.h"
 #include "proxy_mock.h"
@@ -104,6 +106,8 @@ void setUp(void)
     m_flash_expect_calls = 0;
     nrf_mesh_mock_Init();
     nrf_mesh_keygen_mock_Init();
+    enc_mock_Init();
+    enc_key_forget_Ignore();
     flash_manager_mock_Init();
     net_state_mock_Init();
     nrf_mesh_events_mock_Init();
@@ -137,6 +141,8 @@ void tearDown(void)
     nrf_mesh_mock_Destroy();
     nrf_mesh_keygen_mock_Verify();
     nrf_mesh_keygen_mock_Destroy();
+    enc_mock_Verify();
+    enc_mock_Destroy();
     flash_manager_mock_Verify();
     flash_manager_mock_Destroy();
     net_state_mock_Verify();
@@ -344,6 +350,7 @@ static void flash_expect_devkey(const uint8_t * p_key, uint16_t key_owner, dsm_h
     memcpy(data.key, p_key, sizeof(data.key));
     memcpy(&data.key_owner, &key_owner, sizeof(data.key_owner));
     memcpy(&data.subnet_handle, &subnet_handle, sizeof(data.subnet_handle));
+    data.element_count = 1;
     m_expected_flash_data.flash_group = DSM_FLASH_GROUP_DEVKEYS;
     flash_expect(&data, sizeof(data));
 }
@@ -1086,15 +1093,30 @@ void test_net(void)
     TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_devkey_handle_get(0x0001, &test_devkey_handle));
     TEST_ASSERT_EQUAL(test_devkey_handle, devkey_handle);
 
+    /* Deleting the keys should drop them from the encryption module: */
+    enc_mock_Verify();
+    enc_mock_Destroy();
+    enc_mock_Init();
+
     /* Delete the app */
     flash_invalidate_expect(DSM_HANDLE_TO_FLASH_HANDLE(DSM_FLASH_GROUP_APPKEYS, app_handle));
+    enc_key_forget_ExpectWithArray(dummy_key, NRF_MESH_KEY_SIZE);
     TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_appkey_delete(app_handle));
     /* Delete the devkey */
     flash_invalidate_expect(DSM_HANDLE_TO_FLASH_HANDLE(DSM_FLASH_GROUP_DEVKEYS, devkey_handle - DSM_APP_MAX));
+    enc_key_forget_ExpectWithArray(dummy_key, NRF_MESH_KEY_SIZE);
     TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_devkey_delete(devkey_handle));
     /* Delete the network and the keys. */
     flash_invalidate_expect(DSM_HANDLE_TO_FLASH_HANDLE(DSM_FLASH_GROUP_SUBNETS, net[1].handle));
+    enc_key_forget_ExpectWithArray(net_secmat.encryption_key, NRF_MESH_KEY_SIZE);
+    enc_key_forget_ExpectWithArray(net_secmat.privacy_key, NRF_MESH_KEY_SIZE);
+    enc_key_forget_ExpectWithArray(beacon_secmat.key, NRF_MESH_KEY_SIZE);
+#if GATT_PROXY
+    enc_key_forget_ExpectWithArray(identity_key, NRF_MESH_KEY_SIZE);
+#endif
     TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_subnet_delete(net[1].handle));
+    enc_mock_Verify();
+    enc_key_forget_Ignore();
 
     /* Check that the appkey and the devkey were actually deleted: */
     TEST_ASSERT_EQUAL(NRF_ERROR_NOT_FOUND, dsm_appkey_delete(app_handle));
@@ -1489,6 +1511,69 @@ void test_devkey(void)
     }
 }
 
+void test_devkey_lookup(void)
+{
+    dsm_handle_t subnet_handle;
+    uint8_t key[NRF_MESH_KEY_SIZE] = {};
+    nrf_mesh_keygen_network_secmat_IgnoreAndReturn(NRF_SUCCESS);
+    nrf_mesh_keygen_beacon_secmat_IgnoreAndReturn(NRF_SUCCESS);
+    flash_expect_subnet(key, 0);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_subnet_add(0, key, &subnet_handle));
+
+    /* Owners that all hash to the same bucket. */
+    uint16_t owners[DSM_DEVICE_MAX];
+    dsm_handle_t handles[DSM_DEVICE_MAX];
+    for (uint32_t i = 0; i < DSM_DEVICE_MAX; ++i)
+    {
+        owners[i] = 0x0100 + i * DSM_DEVICE_MAX;
+        key[0] = i;
+        flash_expect_devkey(key, owners[i], subnet_handle);
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_devkey_add(owners[i], subnet_handle, key, &handles[i]));
+    }
+
+    for (uint32_t i = 0; i < DSM_DEVICE_MAX; ++i)
+    {
+        dsm_handle_t handle;
+        const nrf_mesh_application_secmat_t * p_secmat = NULL;
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_devkey_handle_get(owners[i], &handle));
+        TEST_ASSERT_EQUAL(handles[i], handle);
+        nrf_mesh_devkey_secmat_get(owners[i], &p_secmat);
+        TEST_ASSERT_NOT_NULL(p_secmat);
+        TEST_ASSERT_EQUAL(i, p_secmat->key[0]);
+    }
+
+    /* Removing a key from the middle of the chain keeps the others. */
+    flash_invalidate_expect(DSM_HANDLE_TO_FLASH_HANDLE(DSM_FLASH_GROUP_DEVKEYS, handles[1] - DSM_APP_MAX));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_devkey_delete(handles[1]));
+    for (uint32_t i = 0; i < DSM_DEVICE_MAX; ++i)
+    {
+        dsm_handle_t handle;
+        TEST_ASSERT_EQUAL((i == 1 ? NRF_ERROR_NOT_FOUND : NRF_SUCCESS), dsm_devkey_handle_get(owners[i], &handle));
+    }
+
+    /* The freed slot is reused. */
+    key[0] = 0xAA;
+    flash_expect_devkey(key, 0x0200, subnet_handle);
+    dsm_handle_t handle;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_devkey_add(0x0200, subnet_handle, key, &handle));
+    TEST_ASSERT_EQUAL(handles[1], handle);
+
+    /* The device key of this node is found through any of its element addresses. */
+    dsm_local_unicast_address_t local = {owners[0], 3};
+    flash_expect_unicast(&local);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_local_unicast_addresses_set(&local));
+    for (uint16_t i = 0; i < local.count; ++i)
+    {
+        const nrf_mesh_application_secmat_t * p_secmat = NULL;
+        nrf_mesh_devkey_secmat_get(local.address_start + i, &p_secmat);
+        TEST_ASSERT_NOT_NULL(p_secmat);
+        TEST_ASSERT_EQUAL(0, p_secmat->key[0]);
+    }
+    const nrf_mesh_application_secmat_t * p_secmat = NULL;
+    nrf_mesh_devkey_secmat_get(local.address_start + local.count, &p_secmat);
+    TEST_ASSERT_NULL(p_secmat);
+}
+
 void test_secmat(void)
 {
     nrf_mesh_secmat_t secmat;
@@ -1758,6 +1843,58 @@ void test_address_subcount_regular(void)
     TEST_ASSERT_EQUAL(NRF_ERROR_NOT_FOUND, dsm_address_subscription_remove(address_handle));
 }
 
+void test_rx_addr_group_lookup(void)
+{
+    /* Add subscriptions out of order, with gaps between them. */
+    dsm_handle_t handles[DSM_NONVIRTUAL_ADDR_MAX];
+    uint16_t addresses[DSM_NONVIRTUAL_ADDR_MAX];
+    nrf_mesh_address_t addr;
+    for (uint32_t i = 0; i < DSM_NONVIRTUAL_ADDR_MAX; ++i)
+    {
+        addresses[i] = 0xC000 + ((i * 5) % DSM_NONVIRTUAL_ADDR_MAX) * 2;
+        flash_expect_addr_nonvirtual(addresses[i]);
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_address_subscription_add(addresses[i], &handles[i]));
+    }
+
+    for (uint32_t i = 0; i < DSM_NONVIRTUAL_ADDR_MAX; ++i)
+    {
+        TEST_ASSERT_TRUE(nrf_mesh_rx_address_get(0xC000 + i * 2, &addr));
+        TEST_ASSERT_EQUAL_HEX16(0xC000 + i * 2, addr.value);
+        TEST_ASSERT_EQUAL(NRF_MESH_ADDRESS_TYPE_GROUP, addr.type);
+        TEST_ASSERT_FALSE(nrf_mesh_rx_address_get(0xC000 + i * 2 + 1, &addr));
+    }
+    TEST_ASSERT_FALSE(nrf_mesh_rx_address_get(0xC000 + DSM_NONVIRTUAL_ADDR_MAX * 2, &addr));
+
+    /* A second subscription keeps the address after removing the first one. */
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_address_subscription_add_handle(handles[0]));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_address_subscription_remove(handles[0]));
+    TEST_ASSERT_TRUE(nrf_mesh_rx_address_get(addresses[0], &addr));
+
+    /* Remove every other subscription. */
+    for (uint32_t i = 0; i < DSM_NONVIRTUAL_ADDR_MAX; i += 2)
+    {
+        flash_invalidate_expect(DSM_HANDLE_TO_FLASH_HANDLE(DSM_FLASH_GROUP_ADDR_NONVIRTUAL, handles[i]));
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_address_subscription_remove(handles[i]));
+    }
+    for (uint32_t i = 0; i < DSM_NONVIRTUAL_ADDR_MAX; ++i)
+    {
+        TEST_ASSERT_EQUAL((i % 2) != 0, nrf_mesh_rx_address_get(addresses[i], &addr));
+    }
+
+    /* Publish addresses aren't RX addresses. */
+    flash_expect_addr_nonvirtual(addresses[0]);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_address_publish_add(addresses[0], &handles[0]));
+    TEST_ASSERT_FALSE(nrf_mesh_rx_address_get(addresses[0], &addr));
+
+    /* The lookup is cleared with the rest of the DSM. */
+    flash_manager_remove_IgnoreAndReturn(NRF_SUCCESS);
+    dsm_clear();
+    for (uint32_t i = 0; i < DSM_NONVIRTUAL_ADDR_MAX; ++i)
+    {
+        TEST_ASSERT_FALSE(nrf_mesh_rx_address_get(addresses[i], &addr));
+    }
+}
+
 void test_address_subcount_virtual(void)
 {
     const uint8_t virtual_uuid[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
@@ -1984,6 +2121,25 @@ void test_key_refresh_all_phases(void)
         TEST_ASSERT_EQUAL_HEX8(old_secmat.nid, secmat.p_net->nid);
     }
 
+    /* Both the old and the updated application keys are candidates when receiving packets: */
+    nrf_mesh_secmat_t rx_secmat;
+    const nrf_mesh_application_secmat_t * p_app_secmat = NULL;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_tx_secmat_get(DSM_HANDLE_INVALID, app[0].handle, &rx_secmat));
+    nrf_mesh_app_secmat_next_get(rx_secmat.p_net, app[0].aid, &p_app_secmat);
+    TEST_ASSERT_NOT_NULL(p_app_secmat);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(app[0].key, p_app_secmat->key, NRF_MESH_KEY_SIZE);
+    nrf_mesh_app_secmat_next_get(rx_secmat.p_net, app[0].aid, &p_app_secmat);
+    TEST_ASSERT_NULL(p_app_secmat);
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        nrf_mesh_app_secmat_next_get(rx_secmat.p_net, new_aid, &p_app_secmat);
+        TEST_ASSERT_NOT_NULL(p_app_secmat);
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(new_appkey, p_app_secmat->key, NRF_MESH_KEY_SIZE);
+        TEST_ASSERT_EQUAL(app[i].handle, dsm_appkey_handle_get(p_app_secmat));
+    }
+    nrf_mesh_app_secmat_next_get(rx_secmat.p_net, new_aid, &p_app_secmat);
+    TEST_ASSERT_NULL(p_app_secmat);
+
     /* Both the old and the new security materials should be used when receiving packets: */
     uint8_t expected_key[NRF_MESH_KEY_SIZE];
     const nrf_mesh_network_secmat_t * p_primary = NULL, * p_secondary = NULL;
@@ -2209,6 +2365,135 @@ void test_key_refresh_1_to_3(void)
     TEST_ASSERT_EQUAL(NRF_MESH_KEY_REFRESH_PHASE_0, current_phase);
 }
 
+static dsm_handle_t subnet_add_with_nid(mesh_key_index_t key_index, const uint8_t * p_key, uint8_t nid)
+{
+    nrf_mesh_network_secmat_t secmat;
+    memset(&secmat, 0, sizeof(secmat));
+    secmat.nid = nid;
+    nrf_mesh_beacon_secmat_t beacon_secmat;
+    memset(&beacon_secmat, 0, sizeof(beacon_secmat));
+
+    nrf_mesh_keygen_network_secmat_ExpectAndReturn(p_key, NULL, NRF_SUCCESS);
+    nrf_mesh_keygen_network_secmat_IgnoreArg_p_secmat();
+    nrf_mesh_keygen_network_secmat_ReturnMemThruPtr_p_secmat(&secmat, sizeof(secmat));
+    nrf_mesh_keygen_beacon_secmat_ExpectAndReturn(p_key, NULL, NRF_SUCCESS);
+    nrf_mesh_keygen_beacon_secmat_IgnoreArg_p_secmat();
+    nrf_mesh_keygen_beacon_secmat_ReturnMemThruPtr_p_secmat(&beacon_secmat, sizeof(beacon_secmat));
+#if GATT_PROXY
+    nrf_mesh_keygen_identitykey_ExpectAndReturn(p_key, NULL, NRF_SUCCESS);
+    nrf_mesh_keygen_identitykey_IgnoreArg_p_key();
+#endif
+    flash_expect_subnet(p_key, key_index);
+
+    dsm_handle_t handle;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_subnet_add(key_index, p_key, &handle));
+    return handle;
+}
+
+/* Checks that iterating over a NID yields exactly the given secmats, in order. */
+static void nid_lookup_verify(uint8_t nid, const nrf_mesh_network_secmat_t ** pp_expected, uint32_t count)
+{
+    const nrf_mesh_network_secmat_t * p_secmat = NULL;
+    const nrf_mesh_network_secmat_t * p_secondary = NULL;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        nrf_mesh_net_secmat_next_get(nid, &p_secmat, &p_secondary);
+        TEST_ASSERT_EQUAL_PTR(pp_expected[i], p_secmat);
+        TEST_ASSERT_NULL(p_secondary);
+    }
+    nrf_mesh_net_secmat_next_get(nid, &p_secmat, &p_secondary);
+    TEST_ASSERT_NULL(p_secmat);
+    TEST_ASSERT_NULL(p_secondary);
+}
+
+void test_net_secmat_nid_lookup(void)
+{
+    const uint8_t keys[3][NRF_MESH_KEY_SIZE] = {{1}, {2}, {3}};
+    const uint8_t new_key[NRF_MESH_KEY_SIZE] = {4};
+    dsm_handle_t handles[3];
+    nrf_mesh_network_secmat_t new_secmat;
+    nrf_mesh_beacon_secmat_t new_beacon_secmat;
+    memset(&new_secmat, 0, sizeof(new_secmat));
+    memset(&new_beacon_secmat, 0, sizeof(new_beacon_secmat));
+
+    handles[0] = subnet_add_with_nid(0, keys[0], 0x11);
+    handles[1] = subnet_add_with_nid(1, keys[1], 0x22);
+    handles[2] = subnet_add_with_nid(2, keys[2], 0x11);
+
+    const nrf_mesh_network_secmat_t * p_secmat = NULL;
+    const nrf_mesh_network_secmat_t * p_secondary = NULL;
+
+    /* Only the subnets with a matching NID are returned, in handle order: */
+    nrf_mesh_net_secmat_next_get(0x11, &p_secmat, &p_secondary);
+    TEST_ASSERT_EQUAL(handles[0], dsm_subnet_handle_get(p_secmat));
+    const nrf_mesh_network_secmat_t * p_first = p_secmat;
+    nrf_mesh_net_secmat_next_get(0x11, &p_secmat, &p_secondary);
+    TEST_ASSERT_EQUAL(handles[2], dsm_subnet_handle_get(p_secmat));
+    const nrf_mesh_network_secmat_t * p_third = p_secmat;
+    nrf_mesh_net_secmat_next_get(0x11, &p_secmat, &p_secondary);
+    TEST_ASSERT_NULL(p_secmat);
+    nrf_mesh_net_secmat_next_get(0x22, &p_secmat, &p_secondary);
+    TEST_ASSERT_EQUAL(handles[1], dsm_subnet_handle_get(p_secmat));
+    const nrf_mesh_network_secmat_t * p_second = p_secmat;
+
+    /* The NID is masked to 7 bits: */
+    nid_lookup_verify(0x11 | PACKET_MESH_NET_NID_MASK_INV, (const nrf_mesh_network_secmat_t *[]) {p_first, p_third}, 2);
+    nid_lookup_verify(0x33, NULL, 0);
+
+    /* Start a key refresh on the second subnet with a new key sharing the NID of the others: */
+    new_secmat.nid = 0x11;
+    nrf_mesh_keygen_network_secmat_ExpectAndReturn(new_key, NULL, NRF_SUCCESS);
+    nrf_mesh_keygen_network_secmat_IgnoreArg_p_secmat();
+    nrf_mesh_keygen_network_secmat_ReturnMemThruPtr_p_secmat(&new_secmat, sizeof(new_secmat));
+    nrf_mesh_keygen_beacon_secmat_ExpectAndReturn(new_key, NULL, NRF_SUCCESS);
+    nrf_mesh_keygen_beacon_secmat_IgnoreArg_p_secmat();
+    nrf_mesh_keygen_beacon_secmat_ReturnMemThruPtr_p_secmat(&new_beacon_secmat, sizeof(new_beacon_secmat));
+#if GATT_PROXY
+    nrf_mesh_keygen_identitykey_ExpectAndReturn(new_key, NULL, NRF_SUCCESS);
+    nrf_mesh_keygen_identitykey_IgnoreArg_p_key();
+#endif
+    net_state_key_refresh_phase_changed_Expect(1, new_beacon_secmat.net_id, NRF_MESH_KEY_REFRESH_PHASE_1);
+    flash_expect_subnet_update(keys[1], new_key, 1, NRF_MESH_KEY_REFRESH_PHASE_1, handles[1]);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_subnet_update(handles[1], new_key));
+
+    /* The updated secmat is inserted between the other subnets, while the old one keeps its NID: */
+    p_secmat = NULL;
+    nrf_mesh_net_secmat_next_get(0x11, &p_secmat, &p_secondary);
+    TEST_ASSERT_EQUAL_PTR(p_first, p_secmat);
+    nrf_mesh_net_secmat_next_get(0x11, &p_secmat, &p_secondary);
+    TEST_ASSERT_NOT_EQUAL(p_second, p_secmat);
+    TEST_ASSERT_EQUAL(handles[1], dsm_subnet_handle_get(p_secmat));
+    TEST_ASSERT_EQUAL_HEX8(0x11, p_secmat->nid);
+    const nrf_mesh_network_secmat_t * p_second_updated = p_secmat;
+    nrf_mesh_net_secmat_next_get(0x11, &p_secmat, &p_secondary);
+    TEST_ASSERT_EQUAL_PTR(p_third, p_secmat);
+    nrf_mesh_net_secmat_next_get(0x11, &p_secmat, &p_secondary);
+    TEST_ASSERT_NULL(p_secmat);
+    nid_lookup_verify(0x22, (const nrf_mesh_network_secmat_t *[]) {p_second}, 1);
+
+    /* Committing the key refresh drops the old NID: */
+    net_state_key_refresh_phase_changed_Expect(1, new_beacon_secmat.net_id, NRF_MESH_KEY_REFRESH_PHASE_0);
+    flash_expect_subnet(new_key, 1);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_subnet_update_commit(handles[1]));
+    nid_lookup_verify(0x11, (const nrf_mesh_network_secmat_t *[]) {p_first, p_second, p_third}, 3);
+    nid_lookup_verify(0x22, NULL, 0);
+    TEST_ASSERT_EQUAL(DSM_HANDLE_INVALID, dsm_subnet_handle_get(p_second_updated));
+
+    /* Deleted subnets are removed from the lookup: */
+    flash_invalidate_expect(DSM_HANDLE_TO_FLASH_HANDLE(DSM_FLASH_GROUP_SUBNETS, handles[0]));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_subnet_delete(handles[0]));
+    nid_lookup_verify(0x11, (const nrf_mesh_network_secmat_t *[]) {p_second, p_third}, 2);
+
+    /* Re-adding the subnet reuses its handle, and puts it back in order: */
+    TEST_ASSERT_EQUAL(handles[0], subnet_add_with_nid(0, keys[0], 0x11));
+    nid_lookup_verify(0x11, (const nrf_mesh_network_secmat_t *[]) {p_first, p_second, p_third}, 3);
+
+    /* Clearing the DSM empties the lookup: */
+    flash_manager_remove_IgnoreAndReturn(NRF_SUCCESS);
+    dsm_clear();
+    nid_lookup_verify(0x11, NULL, 0);
+}
+
 /** Helper macro for flash load testing */
 #define FLASH_ENTRY_GET_EXPECT(HANDLE, RETVAL)                                          \
     do                                                                                  \
@@ -2389,12 +2674,16 @@ void test_flash_load(void)
     dsm_entry_t devkeys[ENTRY_COUNT];
     for (uint32_t i = 0; i < ENTRY_COUNT; ++i)
     {
+        /* Half the entries are stored without an element count, as by earlier versions: */
         fm_header_t header = {.handle = DSM_HANDLE_TO_FLASH_HANDLE(DSM_FLASH_GROUP_DEVKEYS, i),
-                              .len_words    = (sizeof(dsm_flash_entry_devkey_t) + 3) / 4 + 1};
+                              .len_words    = (i < ENTRY_COUNT / 2) ?
+                                              (sizeof(dsm_flash_entry_devkey_t) + 3) / 4 + 1 :
+                                              (offsetof(dsm_flash_entry_devkey_t, element_count) + 3) / 4 + 1};
         memcpy(&devkeys[i].header, &header, sizeof(header));
         memset(devkeys[i].entry.devkey.key, i, NRF_MESH_KEY_SIZE);
-        devkeys[i].entry.devkey.key_owner     = i + 0x100;
+        devkeys[i].entry.devkey.key_owner     = i * 0x10 + 0x100;
         devkeys[i].entry.devkey.subnet_handle = i;
+        devkeys[i].entry.devkey.element_count = (i < ENTRY_COUNT / 2) ? 2 : 0xFFFF;
     };
 
 
@@ -2419,6 +2708,11 @@ void test_flash_load(void)
         TEST_ASSERT_EQUAL_HEX8_ARRAY(devkeys[i].entry.devkey.key,
                                      secmat.p_app->key,
                                      NRF_MESH_KEY_SIZE);
+
+        /* The element counts are restored: */
+        const nrf_mesh_application_secmat_t * p_secmat = NULL;
+        nrf_mesh_devkey_secmat_get(devkeys[i].entry.devkey.key_owner + 1, &p_secmat);
+        TEST_ASSERT_EQUAL_PTR((i < ENTRY_COUNT / 2) ? secmat.p_app : NULL, p_secmat);
     }
     for (uint32_t i = 0; i < ENTRY_COUNT; ++i)
     {
@@ -2435,6 +2729,15 @@ void test_flash_load(void)
 }
 #undef FLASH_ENTRY_GET_EXPECT
 
+void test_flash_invalidate_not_found(void)
+{
+    /* Entries are written before they can be invalidated, so the flash manager must find them. */
+    TEST_ASSERT_NOT_NULL(mp_flash_manager);
+    TEST_NRF_MESH_ASSERT_EXPECT(mp_flash_manager->config.invalidate_complete_cb(mp_flash_manager,
+                                                                                DSM_FLASH_GROUP_ADDR_NONVIRTUAL,
+                                                                                FM_RESULT_ERROR_NOT_FOUND));
+}
+
 void test_flash_insufficient_resources(void)
 {
     /* setup the flash functions to fail, so we have to retry flashing later */
@@ -0,0 +1,435 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <unity.h>
+#include <cmock.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "utils.h"
+#include "test_assert.h"
+
+#include "bearer_event_mock.h"
+#include "device_state_manager.h"
+#include "device_state_manager_flash.h"
+#include "nrf_mesh_mock.h"
+#include "nrf_mesh_events_mock.h"
+#include "nrf_mesh_keygen_mock.h"
+#include "enc_mock.h"
+#include "nrf_mesh_externs.h"
+#include "net_state_mock.h"
+#include "flash_manager_mock.h"
+#include "proxy_mock.h"
+#include "mesh_opt_core_mock.h"
+#include "timer_mock.h"
+#include "timer_scheduler_mock.h"
+
+#if DSM_DEVKEY_CACHE_SIZE != 2 || DSM_DEVICE_MAX != 4
+#error "The devkey cache tests must be built with room for 2 of 4 device keys in RAM"
+#endif
+
+/** Maximum number of entries in the simulated flash area. */
+#define FLASH_ENTRY_MAX 16
+
+static flash_manager_t * mp_flash_manager;
+static flash_manager_page_t m_flash_area[2];
+/** Entries in the simulated flash area. */
+static fm_entry_t * mp_flash_entries[FLASH_ENTRY_MAX];
+/** Entries allocated and committed, but not written to flash yet. */
+static fm_entry_t * mp_pending_entries[FLASH_ENTRY_MAX];
+static uint32_t m_pending_count;
+/** Whether committed entries are written to flash right away. */
+static bool m_flash_write_immediately;
+
+static void flash_entry_remove(fm_handle_t handle)
+{
+    for (uint32_t i = 0; i < FLASH_ENTRY_MAX; ++i)
+    {
+        if (mp_flash_entries[i] != NULL && mp_flash_entries[i]->header.handle == handle)
+        {
+            free(mp_flash_entries[i]);
+            mp_flash_entries[i] = NULL;
+        }
+    }
+}
+
+static void flash_entry_store(fm_entry_t * p_entry)
+{
+    flash_entry_remove(p_entry->header.handle);
+    for (uint32_t i = 0; i < FLASH_ENTRY_MAX; ++i)
+    {
+        if (mp_flash_entries[i] == NULL)
+        {
+            mp_flash_entries[i] = p_entry;
+            return;
+        }
+    }
+    TEST_FAIL_MESSAGE("Simulated flash area is full");
+}
+
+/** Writes all committed entries to the simulated flash area. */
+static void flash_pending_write(void)
+{
+    for (uint32_t i = 0; i < m_pending_count; ++i)
+    {
+        flash_entry_store(mp_pending_entries[i]);
+    }
+    m_pending_count = 0;
+}
+
+static uint32_t flash_manager_add_cb(flash_manager_t * p_manager, const flash_manager_config_t * p_config, int calls)
+{
+    mp_flash_manager = p_manager;
+    memcpy(&p_manager->config, p_config, sizeof(flash_manager_config_t));
+    p_manager->internal.state = FM_STATE_READY;
+    return NRF_SUCCESS;
+}
+
+static fm_entry_t * flash_manager_entry_alloc_cb(flash_manager_t * p_manager,
+                                                 fm_handle_t handle,
+                                                 uint32_t data_length,
+                                                 int calls)
+{
+    fm_entry_t * p_entry = calloc(1, sizeof(fm_header_t) + ALIGN_VAL(data_length, WORD_SIZE));
+    TEST_ASSERT_NOT_NULL(p_entry);
+    p_entry->header.len_words = ALIGN_VAL(data_length, WORD_SIZE) / WORD_SIZE + FLASH_MANAGER_ENTRY_LEN_OVERHEAD;
+    p_entry->header.handle = handle;
+    return p_entry;
+}
+
+static void flash_manager_entry_commit_cb(const fm_entry_t * p_entry, int calls)
+{
+    TEST_ASSERT_TRUE(m_pending_count < FLASH_ENTRY_MAX);
+    mp_pending_entries[m_pending_count++] = (fm_entry_t *) p_entry;
+    if (m_flash_write_immediately)
+    {
+        flash_pending_write();
+    }
+}
+
+static uint32_t flash_manager_entry_invalidate_cb(flash_manager_t * p_manager, fm_handle_t handle, int calls)
+{
+    flash_entry_remove(handle);
+    return NRF_SUCCESS;
+}
+
+static const fm_entry_t * flash_manager_entry_get_cb(const flash_manager_t * p_manager, fm_handle_t handle, int calls)
+{
+    if (p_manager->internal.state != FM_STATE_READY)
+    {
+        return NULL;
+    }
+    for (uint32_t i = 0; i < FLASH_ENTRY_MAX; ++i)
+    {
+        if (mp_flash_entries[i] != NULL && mp_flash_entries[i]->header.handle == handle)
+        {
+            return mp_flash_entries[i];
+        }
+    }
+    return NULL;
+}
+
+/** Checks that the key is the one @ref devkey_add() added for the given owner. */
+static void key_check(uint16_t owner, const uint8_t * p_key)
+{
+    uint8_t expected_key[NRF_MESH_KEY_SIZE];
+    memset(expected_key, owner >> 8, sizeof(expected_key));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected_key, p_key, NRF_MESH_KEY_SIZE);
+}
+
+static dsm_handle_t subnet_add(void)
+{
+    dsm_handle_t subnet_handle;
+    uint8_t key[NRF_MESH_KEY_SIZE] = {};
+    nrf_mesh_keygen_network_secmat_IgnoreAndReturn(NRF_SUCCESS);
+    nrf_mesh_keygen_beacon_secmat_IgnoreAndReturn(NRF_SUCCESS);
+    nrf_mesh_subnet_added_Ignore();
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_subnet_add(0, key, &subnet_handle));
+    return subnet_handle;
+}
+
+static dsm_handle_t devkey_add(uint16_t owner, dsm_handle_t subnet_handle)
+{
+    uint8_t key[NRF_MESH_KEY_SIZE];
+    memset(key, owner >> 8, sizeof(key));
+    dsm_handle_t handle;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_devkey_add(owner, subnet_handle, key, &handle));
+    return handle;
+}
+
+/** Checks that the device key of the given owner is found, and returns its security material. */
+static const nrf_mesh_application_secmat_t * devkey_check(uint16_t owner, dsm_handle_t handle)
+{
+    const nrf_mesh_application_secmat_t * p_secmat = NULL;
+    nrf_mesh_devkey_secmat_get(owner, &p_secmat);
+    TEST_ASSERT_NOT_NULL(p_secmat);
+    TEST_ASSERT_TRUE(p_secmat->is_device_key);
+    key_check(owner, p_secmat->key);
+    TEST_ASSERT_EQUAL(handle, dsm_appkey_handle_get(p_secmat));
+    return p_secmat;
+}
+
+void setUp(void)
+{
+    nrf_mesh_mock_Init();
+    nrf_mesh_events_mock_Init();
+    nrf_mesh_keygen_mock_Init();
+    enc_mock_Init();
+    enc_key_forget_Ignore();
+    net_state_mock_Init();
+    flash_manager_mock_Init();
+    proxy_mock_Init();
+    mesh_opt_core_mock_Init();
+    timer_mock_Init();
+    timer_scheduler_mock_Init();
+
+    m_pending_count = 0;
+    m_flash_write_immediately = true;
+
+    bearer_event_critical_section_begin_Ignore();
+    bearer_event_critical_section_end_Ignore();
+    /* Only used by the write-behind build: */
+    timer_now_IgnoreAndReturn(0);
+    timer_sch_schedule_Ignore();
+    timer_sch_abort_Ignore();
+    flash_manager_recovery_page_get_IgnoreAndReturn(&m_flash_area[1]);
+    flash_manager_add_StubWithCallback(flash_manager_add_cb);
+    flash_manager_entry_alloc_StubWithCallback(flash_manager_entry_alloc_cb);
+    flash_manager_entry_commit_StubWithCallback(flash_manager_entry_commit_cb);
+    flash_manager_entry_invalidate_StubWithCallback(flash_manager_entry_invalidate_cb);
+    flash_manager_entry_get_StubWithCallback(flash_manager_entry_get_cb);
+
+    net_state_flash_area_get_ExpectAndReturn((void *)(PAGE_SIZE + (uint32_t)m_flash_area));
+    nrf_mesh_evt_handler_add_ExpectAnyArgs();
+    dsm_init();
+}
+
+void tearDown(void)
+{
+    flash_manager_remove_IgnoreAndReturn(NRF_SUCCESS);
+    dsm_clear();
+
+    flash_pending_write();
+    for (uint32_t i = 0; i < FLASH_ENTRY_MAX; ++i)
+    {
+        free(mp_flash_entries[i]);
+        mp_flash_entries[i] = NULL;
+    }
+
+    nrf_mesh_mock_Verify();
+    nrf_mesh_mock_Destroy();
+    nrf_mesh_events_mock_Verify();
+    nrf_mesh_events_mock_Destroy();
+    nrf_mesh_keygen_mock_Verify();
+    nrf_mesh_keygen_mock_Destroy();
+    enc_mock_Verify();
+    enc_mock_Destroy();
+    net_state_mock_Verify();
+    net_state_mock_Destroy();
+    flash_manager_mock_Verify();
+    flash_manager_mock_Destroy();
+    proxy_mock_Verify();
+    proxy_mock_Destroy();
+    mesh_opt_core_mock_Verify();
+    mesh_opt_core_mock_Destroy();
+    timer_mock_Verify();
+    timer_mock_Destroy();
+    timer_scheduler_mock_Verify();
+    timer_scheduler_mock_Destroy();
+}
+
+/*****************************************************************************
+* Tests
+*****************************************************************************/
+
+void test_devkey_cache_load(void)
+{
+    dsm_handle_t subnet_handle = subnet_add();
+    const uint16_t owners[DSM_DEVICE_MAX] = {0x0100, 0x0200, 0x0300, 0x0400};
+    dsm_handle_t handles[DSM_DEVICE_MAX];
+
+    /* There's room for all the keys, even if only two of them fit in RAM. */
+    for (uint32_t i = 0; i < DSM_DEVICE_MAX; ++i)
+    {
+        handles[i] = devkey_add(owners[i], subnet_handle);
+    }
+
+    /* Every key is loaded on demand, with the handle it was added with. */
+    for (uint32_t round = 0; round < 2; ++round)
+    {
+        for (uint32_t i = 0; i < DSM_DEVICE_MAX; ++i)
+        {
+            dsm_handle_t handle;
+            TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_devkey_handle_get(owners[i], &handle));
+            TEST_ASSERT_EQUAL(handles[i], handle);
+            (void) devkey_check(owners[i], handles[i]);
+
+            nrf_mesh_secmat_t secmat;
+            TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_tx_secmat_get(DSM_HANDLE_INVALID, handles[i], &secmat));
+            key_check(owners[i], secmat.p_app->key);
+        }
+    }
+
+    /* The most recently used key stays in RAM while another one is loaded. */
+    const nrf_mesh_application_secmat_t * p_dst_secmat = devkey_check(owners[0], handles[0]);
+    (void) devkey_check(owners[1], handles[1]);
+    TEST_ASSERT_EQUAL(handles[0], dsm_appkey_handle_get(p_dst_secmat));
+    key_check(owners[0], p_dst_secmat->key);
+
+    /* Keys that are only in flash can be deleted, and their handles reused. */
+    (void) devkey_check(owners[2], handles[2]);
+    (void) devkey_check(owners[3], handles[3]);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_devkey_delete(handles[0]));
+    const nrf_mesh_application_secmat_t * p_secmat = NULL;
+    nrf_mesh_devkey_secmat_get(owners[0], &p_secmat);
+    TEST_ASSERT_NULL(p_secmat);
+    TEST_ASSERT_EQUAL(handles[0], devkey_add(0x0500, subnet_handle));
+    (void) devkey_check(0x0500, handles[0]);
+    for (uint32_t i = 1; i < DSM_DEVICE_MAX; ++i)
+    {
+        (void) devkey_check(owners[i], handles[i]);
+    }
+}
+
+void test_devkey_cache_unflashed(void)
+{
+    dsm_handle_t subnet_handle = subnet_add();
+    uint8_t key[NRF_MESH_KEY_SIZE] = {};
+    dsm_handle_t handles[3];
+
+    /* Keys that haven't been written to flash yet are never evicted. */
+    m_flash_write_immediately = false;
+    handles[0] = devkey_add(0x0100, subnet_handle);
+    handles[1] = devkey_add(0x0200, subnet_handle);
+    TEST_ASSERT_EQUAL(NRF_ERROR_NO_MEM, dsm_devkey_add(0x0300, subnet_handle, key, &handles[2]));
+    (void) devkey_check(0x0100, handles[0]);
+    (void) devkey_check(0x0200, handles[1]);
+
+    /* Once the flash manager has written them, they make room for new keys. */
+    flash_pending_write();
+    handles[2] = devkey_add(0x0300, subnet_handle);
+    flash_pending_write();
+    (void) devkey_check(0x0100, handles[0]);
+    (void) devkey_check(0x0200, handles[1]);
+    (void) devkey_check(0x0300, handles[2]);
+}
+
+void test_devkey_cache_flash_busy(void)
+{
+    dsm_handle_t subnet_handle = subnet_add();
+    dsm_handle_t handles[3];
+    handles[0] = devkey_add(0x0100, subnet_handle);
+    handles[1] = devkey_add(0x0200, subnet_handle);
+    handles[2] = devkey_add(0x0300, subnet_handle);
+
+    /* Keys that are only in flash can't be loaded while the flash manager is busy. */
+    mp_flash_manager->internal.state = FM_STATE_DEFRAG;
+    const nrf_mesh_application_secmat_t * p_secmat = NULL;
+    nrf_mesh_devkey_secmat_get(0x0100, &p_secmat);
+    TEST_ASSERT_NULL(p_secmat);
+    nrf_mesh_secmat_t secmat;
+    TEST_ASSERT_EQUAL(NRF_ERROR_BUSY, dsm_tx_secmat_get(DSM_HANDLE_INVALID, handles[0], &secmat));
+    TEST_ASSERT_EQUAL(NRF_ERROR_BUSY, dsm_devkey_element_count_set(handles[0], 2));
+
+    /* Keys in RAM are still available. */
+    (void) devkey_check(0x0300, handles[2]);
+
+    mp_flash_manager->internal.state = FM_STATE_READY;
+    (void) devkey_check(0x0100, handles[0]);
+}
+
+void test_devkey_element_range(void)
+{
+    dsm_handle_t subnet_handle = subnet_add();
+    dsm_handle_t handles[3];
+    handles[0] = devkey_add(0x0100, subnet_handle);
+    handles[1] = devkey_add(0x0104, subnet_handle);
+
+    TEST_ASSERT_EQUAL(NRF_ERROR_NOT_FOUND, dsm_devkey_element_count_set(DSM_HANDLE_INVALID, 2));
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_PARAM, dsm_devkey_element_count_set(handles[0], 0));
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_PARAM, dsm_devkey_element_count_set(handles[0], 0x8000));
+    /* The range would cover the next node: */
+    TEST_ASSERT_EQUAL(NRF_ERROR_FORBIDDEN, dsm_devkey_element_count_set(handles[0], 5));
+
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_devkey_element_count_set(handles[0], 4));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_devkey_element_count_set(handles[1], 2));
+    for (uint16_t i = 0; i < 4; ++i)
+    {
+        (void) devkey_check(0x0100 + i, handles[0]);
+    }
+    (void) devkey_check(0x0104, handles[1]);
+    (void) devkey_check(0x0105, handles[1]);
+    const nrf_mesh_application_secmat_t * p_secmat = NULL;
+    nrf_mesh_devkey_secmat_get(0x0106, &p_secmat);
+    TEST_ASSERT_NULL(p_secmat);
+    nrf_mesh_devkey_secmat_get(0x00FF, &p_secmat);
+    TEST_ASSERT_NULL(p_secmat);
+
+    /* The element count is stored with the key, and is kept when the key is loaded from flash. */
+    handles[2] = devkey_add(0x0300, subnet_handle);
+    (void) devkey_check(0x0104, handles[1]);
+    (void) devkey_check(0x0300, handles[2]);
+    (void) devkey_check(0x0103, handles[0]);
+}
+
+void test_devkey_cache_write_behind(void)
+{
+#if DSM_FLASH_WRITE_BEHIND_DELAY_US == 0
+    TEST_IGNORE_MESSAGE("Only runs in the write-behind build");
+#else
+    dsm_handle_t subnet_handle = subnet_add();
+    const uint16_t owners[DSM_DEVICE_MAX] = {0x0100, 0x0200, 0x0300, 0x0400};
+    dsm_handle_t handles[DSM_DEVICE_MAX];
+
+    /* Keys waiting for the write-behind window are written when their slots are needed: */
+    handles[0] = devkey_add(owners[0], subnet_handle);
+    handles[1] = devkey_add(owners[1], subnet_handle);
+    TEST_ASSERT_EQUAL(0, m_pending_count);
+    for (uint32_t i = 2; i < DSM_DEVICE_MAX; ++i)
+    {
+        handles[i] = devkey_add(owners[i], subnet_handle);
+    }
+    for (uint32_t i = 0; i < DSM_DEVICE_MAX; ++i)
+    {
+        (void) devkey_check(owners[i], handles[i]);
+    }
+    /* The rest are written when the window expires: */
+    TEST_ASSERT_TRUE(dsm_has_unflashed_data());
+    dsm_flash_flush();
+    TEST_ASSERT_FALSE(dsm_has_unflashed_data());
+#endif
+}
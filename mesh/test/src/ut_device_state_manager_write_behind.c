@@ -0,0 +1,295 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <unity.h>
+#include <cmock.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "utils.h"
+#include "test_assert.h"
+
+#include "bearer_event_mock.h"
+#include "device_state_manager.h"
+#include "device_state_manager_flash.h"
+#include "nrf_mesh_mock.h"
+#include "nrf_mesh_events_mock.h"
+#include "nrf_mesh_keygen_mock.h"
+#include "enc_mock.h"
+#include "net_state_mock.h"
+#include "flash_manager_mock.h"
+#include "proxy_mock.h"
+#include "mesh_opt_core_mock.h"
+#include "timer_mock.h"
+#include "timer_scheduler_mock.h"
+
+#if DSM_FLASH_WRITE_BEHIND_DELAY_US == 0
+#error "The write-behind tests must be built with a nonzero DSM_FLASH_WRITE_BEHIND_DELAY_US"
+#endif
+
+#define TIME_NOW 1000
+
+static flash_manager_t * mp_flash_manager;
+static flash_manager_page_t m_flash_area[2];
+static timer_event_t * mp_timer;
+static uint32_t m_timer_schedule_calls;
+/** Flash handles written and invalidated since the last call to flash_ops_reset(). */
+static fm_handle_t m_written_handles[DSM_NONVIRTUAL_ADDR_MAX];
+static uint32_t m_written_count;
+static fm_handle_t m_invalidated_handles[DSM_NONVIRTUAL_ADDR_MAX];
+static uint32_t m_invalidated_count;
+
+static uint32_t flash_manager_add_cb(flash_manager_t * p_manager, const flash_manager_config_t * p_config, int calls)
+{
+    mp_flash_manager = p_manager;
+    memcpy(&p_manager->config, p_config, sizeof(flash_manager_config_t));
+    p_manager->internal.state = FM_STATE_READY;
+    return NRF_SUCCESS;
+}
+
+static fm_entry_t * flash_manager_entry_alloc_cb(flash_manager_t * p_manager,
+                                                 fm_handle_t handle,
+                                                 uint32_t data_length,
+                                                 int calls)
+{
+    TEST_ASSERT_EQUAL_PTR(mp_flash_manager, p_manager);
+    TEST_ASSERT_TRUE(m_written_count < ARRAY_SIZE(m_written_handles));
+    m_written_handles[m_written_count++] = handle;
+
+    fm_entry_t * p_entry = malloc(sizeof(fm_header_t) + ALIGN_VAL(data_length, 4));
+    TEST_ASSERT_NOT_NULL(p_entry);
+    p_entry->header.len_words = ALIGN_VAL(sizeof(fm_header_t) + data_length, 4);
+    p_entry->header.handle = handle;
+    return p_entry;
+}
+
+static void flash_manager_entry_commit_cb(const fm_entry_t * p_entry, int calls)
+{
+    free((fm_entry_t *) p_entry);
+}
+
+static uint32_t flash_manager_entry_invalidate_cb(flash_manager_t * p_manager, fm_handle_t handle, int calls)
+{
+    TEST_ASSERT_EQUAL_PTR(mp_flash_manager, p_manager);
+    TEST_ASSERT_TRUE(m_invalidated_count < ARRAY_SIZE(m_invalidated_handles));
+    m_invalidated_handles[m_invalidated_count++] = handle;
+    return NRF_SUCCESS;
+}
+
+static void timer_sch_schedule_cb(timer_event_t * p_timer_evt, int calls)
+{
+    TEST_ASSERT_NOT_NULL(p_timer_evt->cb);
+    TEST_ASSERT_EQUAL(0, p_timer_evt->interval);
+    TEST_ASSERT_EQUAL(TIME_NOW + DSM_FLASH_WRITE_BEHIND_DELAY_US, p_timer_evt->timestamp);
+    mp_timer = p_timer_evt;
+    m_timer_schedule_calls++;
+}
+
+static void flash_ops_reset(void)
+{
+    m_written_count = 0;
+    m_invalidated_count = 0;
+}
+
+static void timer_fire(void)
+{
+    TEST_ASSERT_NOT_NULL(mp_timer);
+    mp_timer->cb(mp_timer->timestamp, mp_timer->p_context);
+}
+
+void setUp(void)
+{
+    nrf_mesh_mock_Init();
+    nrf_mesh_events_mock_Init();
+    nrf_mesh_keygen_mock_Init();
+    enc_mock_Init();
+    enc_key_forget_Ignore();
+    net_state_mock_Init();
+    flash_manager_mock_Init();
+    proxy_mock_Init();
+    mesh_opt_core_mock_Init();
+    timer_mock_Init();
+    timer_scheduler_mock_Init();
+
+    mp_timer = NULL;
+    m_timer_schedule_calls = 0;
+    flash_ops_reset();
+
+    bearer_event_critical_section_begin_Ignore();
+    bearer_event_critical_section_end_Ignore();
+    flash_manager_recovery_page_get_IgnoreAndReturn(&m_flash_area[1]);
+    flash_manager_add_StubWithCallback(flash_manager_add_cb);
+    flash_manager_entry_alloc_StubWithCallback(flash_manager_entry_alloc_cb);
+    flash_manager_entry_commit_StubWithCallback(flash_manager_entry_commit_cb);
+    flash_manager_entry_invalidate_StubWithCallback(flash_manager_entry_invalidate_cb);
+    timer_now_IgnoreAndReturn(TIME_NOW);
+    timer_sch_schedule_StubWithCallback(timer_sch_schedule_cb);
+
+    net_state_flash_area_get_ExpectAndReturn((void *)(PAGE_SIZE + (uint32_t)m_flash_area));
+    nrf_mesh_evt_handler_add_ExpectAnyArgs();
+    dsm_init();
+}
+
+void tearDown(void)
+{
+    flash_manager_remove_IgnoreAndReturn(NRF_SUCCESS);
+    timer_sch_abort_Ignore();
+    dsm_clear();
+
+    nrf_mesh_mock_Verify();
+    nrf_mesh_mock_Destroy();
+    nrf_mesh_events_mock_Verify();
+    nrf_mesh_events_mock_Destroy();
+    nrf_mesh_keygen_mock_Verify();
+    nrf_mesh_keygen_mock_Destroy();
+    enc_mock_Verify();
+    enc_mock_Destroy();
+    net_state_mock_Verify();
+    net_state_mock_Destroy();
+    flash_manager_mock_Verify();
+    flash_manager_mock_Destroy();
+    proxy_mock_Verify();
+    proxy_mock_Destroy();
+    mesh_opt_core_mock_Verify();
+    mesh_opt_core_mock_Destroy();
+    timer_mock_Verify();
+    timer_mock_Destroy();
+    timer_scheduler_mock_Verify();
+    timer_scheduler_mock_Destroy();
+}
+
+/*****************************************************************************
+* Tests
+*****************************************************************************/
+
+void test_write_behind_coalesce(void)
+{
+    dsm_handle_t handles[3];
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_address_subscription_add(0xC001, &handles[0]));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_address_subscription_add(0xC002, &handles[1]));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_address_subscription_add(0xC003, &handles[2]));
+    /* Added and removed within the same window: */
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_address_subscription_remove(handles[1]));
+
+    /* Nothing is written until the window expires, and the window is only started once. */
+    TEST_ASSERT_EQUAL(0, m_written_count);
+    TEST_ASSERT_EQUAL(0, m_invalidated_count);
+    TEST_ASSERT_EQUAL(1, m_timer_schedule_calls);
+    TEST_ASSERT_TRUE(dsm_has_unflashed_data());
+
+    timer_fire();
+
+    TEST_ASSERT_FALSE(dsm_has_unflashed_data());
+    TEST_ASSERT_EQUAL(2, m_written_count);
+    TEST_ASSERT_EQUAL_HEX16(DSM_FLASH_GROUP_ADDR_NONVIRTUAL | handles[0], m_written_handles[0]);
+    TEST_ASSERT_EQUAL_HEX16(DSM_FLASH_GROUP_ADDR_NONVIRTUAL | handles[2], m_written_handles[1]);
+    TEST_ASSERT_EQUAL(1, m_invalidated_count);
+    TEST_ASSERT_EQUAL_HEX16(DSM_FLASH_GROUP_ADDR_NONVIRTUAL | handles[1], m_invalidated_handles[0]);
+
+    /* The next change starts a new window. */
+    flash_ops_reset();
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_address_subscription_remove(handles[0]));
+    TEST_ASSERT_EQUAL(2, m_timer_schedule_calls);
+    TEST_ASSERT_EQUAL(0, m_invalidated_count);
+    timer_fire();
+    TEST_ASSERT_EQUAL(0, m_written_count);
+    TEST_ASSERT_EQUAL(1, m_invalidated_count);
+    TEST_ASSERT_EQUAL_HEX16(DSM_FLASH_GROUP_ADDR_NONVIRTUAL | handles[0], m_invalidated_handles[0]);
+}
+
+void test_write_behind_flush(void)
+{
+    dsm_handle_t handle;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_address_subscription_add(0xC001, &handle));
+    TEST_ASSERT_EQUAL(0, m_written_count);
+
+    /* Flushing commits the pending entries and stops the window. */
+    timer_sch_abort_Expect(mp_timer);
+    dsm_flash_flush();
+    TEST_ASSERT_EQUAL(1, m_written_count);
+    TEST_ASSERT_EQUAL_HEX16(DSM_FLASH_GROUP_ADDR_NONVIRTUAL | handle, m_written_handles[0]);
+    TEST_ASSERT_FALSE(dsm_has_unflashed_data());
+
+    /* Flushing without pending changes does nothing. */
+    flash_ops_reset();
+    dsm_flash_flush();
+    TEST_ASSERT_EQUAL(0, m_written_count);
+    TEST_ASSERT_EQUAL(0, m_invalidated_count);
+}
+
+void test_write_behind_no_mem(void)
+{
+    dsm_handle_t handle;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_address_subscription_add(0xC001, &handle));
+
+    /* The flash manager runs out of memory when the window expires, the entry is committed when
+     * the changes are flushed. */
+    flash_manager_entry_alloc_IgnoreAndReturn(NULL);
+    flash_manager_mem_listener_register_ExpectAnyArgs();
+    timer_fire();
+    TEST_ASSERT_TRUE(dsm_has_unflashed_data());
+
+    flash_manager_mock_Verify();
+    flash_manager_entry_alloc_StubWithCallback(flash_manager_entry_alloc_cb);
+    dsm_flash_flush();
+    TEST_ASSERT_EQUAL(1, m_written_count);
+    TEST_ASSERT_FALSE(dsm_has_unflashed_data());
+}
+
+void test_write_behind_clear(void)
+{
+    dsm_handle_t handle;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, dsm_address_subscription_add(0xC001, &handle));
+
+    /* Clearing the state drops the pending changes along with the window. */
+    timer_sch_abort_Expect(mp_timer);
+    flash_manager_remove_IgnoreAndReturn(NRF_SUCCESS);
+    dsm_clear();
+    TEST_ASSERT_FALSE(dsm_has_unflashed_data());
+    TEST_ASSERT_EQUAL(0, m_written_count);
+}
+
+void test_write_behind_invalidate_not_found(void)
+{
+    /* Entries that were added and removed within the same window were never written, so the flash
+     * manager won't find them when they're invalidated. */
+    TEST_ASSERT_NOT_NULL(mp_flash_manager);
+    mp_flash_manager->config.invalidate_complete_cb(mp_flash_manager,
+                                                    DSM_FLASH_GROUP_ADDR_NONVIRTUAL,
+                                                    FM_RESULT_ERROR_NOT_FOUND);
+    TEST_ASSERT_FALSE(dsm_has_unflashed_data());
+}
@@ -39,6 +39,7 @@
 #include <cmock.h>
 
 #include "nrf_mesh_keygen.h"
+#include "aes_cmac.h"
 
 /*****************************************************************************
 * Test vectors (from the Sample data section in the Mesh Profile Specification v1.0)
@@ -124,6 +125,11 @@ void test_beacon_secmat(void)
     const uint8_t expected_network_id[NRF_MESH_NETID_SIZE] = EXPECTED_NETWORK_ID;
     TEST_ASSERT_EQUAL_HEX8_ARRAY(expected_beacon_key, secmat.key, NRF_MESH_KEY_SIZE);
     TEST_ASSERT_EQUAL_HEX8_ARRAY(expected_network_id, secmat.net_id, NRF_MESH_NETID_SIZE);
+
+    nrf_mesh_cmac_subkeys_t expected_subkeys;
+    aes_cmac_subkeys_generate(expected_beacon_key, &expected_subkeys);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected_subkeys.k1, secmat.key_cmac_subkeys.k1, NRF_MESH_KEY_SIZE);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected_subkeys.k2, secmat.key_cmac_subkeys.k2, NRF_MESH_KEY_SIZE);
 }
 
 void test_identity_key(void)
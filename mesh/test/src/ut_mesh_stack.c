@@ -230,6 +230,7 @@ void test_provisioning_data_store(void)
     dsm_devkey_add_IgnoreArg_p_devkey_handle();
     net_state_iv_index_set_ExpectAndReturn(prov_data.iv_index, prov_data.flags.iv_update, NRF_SUCCESS);
     config_server_bind_IgnoreAndReturn(NRF_SUCCESS);
+    dsm_flash_flush_Expect();
     access_flash_config_store_Expect();
 
     TEST_ASSERT_EQUAL(NRF_SUCCESS, mesh_stack_provisioning_data_store(&prov_data, devkey));
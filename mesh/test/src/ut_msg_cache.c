@@ -181,3 +181,34 @@ void test_clear(void)
     msg_cache_clear();
     TEST_ASSERT_EQUAL(false, msg_cache_entry_exists(src, seq));
 }
+
+void test_msg_cache_wraparound(void)
+{
+    /* Run the cache through several full rounds of eviction, with entries that share source
+     * addresses and sequence numbers, and verify that exactly the newest entries remain. */
+    const uint32_t total = MSG_CACHE_ENTRY_COUNT * 5 + 3;
+    for (uint32_t i = 0; i < total; ++i)
+    {
+        uint16_t src = 0x0001 + (i % 7);
+        uint32_t seq = i / 7;
+        TEST_ASSERT_FALSE(msg_cache_entry_exists(src, seq));
+        msg_cache_entry_add(src, seq);
+        TEST_ASSERT_TRUE(msg_cache_entry_exists(src, seq));
+    }
+
+    for (uint32_t i = 0; i < total; ++i)
+    {
+        uint16_t src = 0x0001 + (i % 7);
+        uint32_t seq = i / 7;
+        TEST_ASSERT_EQUAL(i >= total - MSG_CACHE_ENTRY_COUNT, msg_cache_entry_exists(src, seq));
+    }
+
+    /* The cache must still work after being cleared in the middle of a round. */
+    msg_cache_clear();
+    for (uint32_t i = 0; i < total; ++i)
+    {
+        TEST_ASSERT_FALSE(msg_cache_entry_exists(0x0001 + (i % 7), i / 7));
+    }
+    msg_cache_entry_add(0x1234, 0xAAAA00);
+    TEST_ASSERT_TRUE(msg_cache_entry_exists(0x1234, 0xAAAA00));
+}
@@ -249,11 +249,11 @@ static void tx_complete(void)
     m_tx_complete_cb(mp_adv, 0, m_time_now);
 }
 
-static void expect_tx(const uint8_t * p_key, const uint8_t * p_beacon_data, uint8_t * p_auth, adv_packet_t * p_adv_packet)
+static void expect_tx(const nrf_mesh_beacon_secmat_t * p_secmat, const uint8_t * p_beacon_data, uint8_t * p_auth, adv_packet_t * p_adv_packet)
 {
-    enc_aes_cmac_ExpectWithArray(p_key, NRF_MESH_KEY_SIZE, p_beacon_data, 13, 13, NULL, 0);
-    enc_aes_cmac_IgnoreArg_p_result();
-    enc_aes_cmac_ReturnMemThruPtr_p_result(p_auth, 8);
+    enc_aes_cmac_with_subkeys_ExpectWithArray(p_secmat->key, NRF_MESH_KEY_SIZE, &p_secmat->key_cmac_subkeys, 1, p_beacon_data, 13, 13, NULL, 0);
+    enc_aes_cmac_with_subkeys_IgnoreArg_p_result();
+    enc_aes_cmac_with_subkeys_ReturnMemThruPtr_p_result(p_auth, 8);
     beacon_create_ExpectWithArrayAndReturn(mp_adv, 1, BEACON_TYPE_SEC_NET_BCAST, p_beacon_data, 21, 21, p_adv_packet);
     advertiser_packet_send_Expect(mp_adv, p_adv_packet);
 }
@@ -283,7 +283,7 @@ void test_tx_single(void)
         m_time_now = SEC_TO_US(10);
 
         /* Test packet creation */
-        expect_tx(sample_data.info.secmat.key, sample_data.beacon, sample_data.auth, &adv_packet);
+        expect_tx(&sample_data.info.secmat, sample_data.beacon, sample_data.auth, &adv_packet);
 
         /* Call the timeout */
         net_state_beacon_iv_index_get_ExpectAndReturn(sample_data.iv_index);
@@ -297,9 +297,9 @@ void test_tx_single(void)
         /* Run again, fail bearer_tx */
         m_info_index = 0;
         m_time_now += SEC_TO_US(10);
-        enc_aes_cmac_ExpectWithArray(sample_data.info.secmat.key, NRF_MESH_KEY_SIZE, sample_data.beacon, 13, 13, NULL, 0);
-        enc_aes_cmac_IgnoreArg_p_result();
-        enc_aes_cmac_ReturnMemThruPtr_p_result(sample_data.auth, 16);
+        enc_aes_cmac_with_subkeys_ExpectWithArray(sample_data.info.secmat.key, NRF_MESH_KEY_SIZE, &sample_data.info.secmat.key_cmac_subkeys, 1, sample_data.beacon, 13, 13, NULL, 0);
+        enc_aes_cmac_with_subkeys_IgnoreArg_p_result();
+        enc_aes_cmac_with_subkeys_ReturnMemThruPtr_p_result(sample_data.auth, 16);
         beacon_create_ExpectWithArrayAndReturn(mp_adv, 1, BEACON_TYPE_SEC_NET_BCAST, sample_data.beacon, 21, 21, NULL);
 
         /* Call the timeout */
@@ -360,7 +360,7 @@ void test_tx_multi(void)
     {
         net_state_beacon_iv_index_get_ExpectAndReturn(0x12345678);
         net_state_iv_update_get_ExpectAndReturn(NET_STATE_IV_UPDATE_NORMAL);
-        expect_tx(info[i].secmat.key, &beacon_data[i][0], auth, &adv_packet);
+        expect_tx(&info[i].secmat, &beacon_data[i][0], auth, &adv_packet);
 
         /* On the first run, we call the timer. The next beacons will be sent as the previous one completed its TX */
         if (i == 0)
@@ -406,18 +406,18 @@ void test_packet_in(void)
         evt.params.net_beacon.flags.key_refresh = sample_data.key_refresh;
 
         m_info_index = 0;
-        enc_aes_cmac_ExpectWithArray(sample_data.info.secmat.key, NRF_MESH_KEY_SIZE, sample_data.beacon, 13, 13, NULL, 0);
-        enc_aes_cmac_IgnoreArg_p_result();
-        enc_aes_cmac_ReturnMemThruPtr_p_result(sample_data.auth, 16);
+        enc_aes_cmac_with_subkeys_ExpectWithArray(sample_data.info.secmat.key, NRF_MESH_KEY_SIZE, &sample_data.info.secmat.key_cmac_subkeys, 1, sample_data.beacon, 13, 13, NULL, 0);
+        enc_aes_cmac_with_subkeys_IgnoreArg_p_result();
+        enc_aes_cmac_with_subkeys_ReturnMemThruPtr_p_result(sample_data.auth, 16);
         event_handle_Expect(&evt);
         net_beacon_packet_in(sample_data.beacon, sizeof(sample_data.beacon), NULL);
         TEST_ASSERT_EQUAL(1, sample_data.info.p_tx_info->rx_count[0]);
 
         /* Try again, should bump the tx count */
         m_info_index = 0;
-        enc_aes_cmac_ExpectWithArray(sample_data.info.secmat.key, NRF_MESH_KEY_SIZE, sample_data.beacon, 13, 13, NULL, 0);
-        enc_aes_cmac_IgnoreArg_p_result();
-        enc_aes_cmac_ReturnMemThruPtr_p_result(sample_data.auth, 16);
+        enc_aes_cmac_with_subkeys_ExpectWithArray(sample_data.info.secmat.key, NRF_MESH_KEY_SIZE, &sample_data.info.secmat.key_cmac_subkeys, 1, sample_data.beacon, 13, 13, NULL, 0);
+        enc_aes_cmac_with_subkeys_IgnoreArg_p_result();
+        enc_aes_cmac_with_subkeys_ReturnMemThruPtr_p_result(sample_data.auth, 16);
         event_handle_Expect(&evt);
         net_beacon_packet_in(sample_data.beacon, sizeof(sample_data.beacon), NULL);
         TEST_ASSERT_EQUAL(2, sample_data.info.p_tx_info->rx_count[0]);
@@ -425,9 +425,9 @@ void test_packet_in(void)
         /* Try again without permitting IV update. Should still produce an event, and should count the RX */
         sample_data.info.iv_update_permitted = false;
         m_info_index = 0;
-        enc_aes_cmac_ExpectWithArray(sample_data.info.secmat.key, NRF_MESH_KEY_SIZE, sample_data.beacon, 13, 13, NULL, 0);
-        enc_aes_cmac_IgnoreArg_p_result();
-        enc_aes_cmac_ReturnMemThruPtr_p_result(sample_data.auth, 16);
+        enc_aes_cmac_with_subkeys_ExpectWithArray(sample_data.info.secmat.key, NRF_MESH_KEY_SIZE, &sample_data.info.secmat.key_cmac_subkeys, 1, sample_data.beacon, 13, 13, NULL, 0);
+        enc_aes_cmac_with_subkeys_IgnoreArg_p_result();
+        enc_aes_cmac_with_subkeys_ReturnMemThruPtr_p_result(sample_data.auth, 16);
         event_handle_Expect(&evt);
         net_beacon_packet_in(sample_data.beacon, sizeof(sample_data.beacon), NULL);
         TEST_ASSERT_EQUAL(3, sample_data.info.p_tx_info->rx_count[0]);
@@ -437,9 +437,9 @@ void test_packet_in(void)
         m_info_index = 0;
         sample_data.info.iv_update_permitted = true;
         sample_data.info.p_tx_info->rx_count[0] = 0xFFFF;
-        enc_aes_cmac_ExpectWithArray(sample_data.info.secmat.key, NRF_MESH_KEY_SIZE, sample_data.beacon, 13, 13, NULL, 0);
-        enc_aes_cmac_IgnoreArg_p_result();
-        enc_aes_cmac_ReturnMemThruPtr_p_result(sample_data.auth, 16);
+        enc_aes_cmac_with_subkeys_ExpectWithArray(sample_data.info.secmat.key, NRF_MESH_KEY_SIZE, &sample_data.info.secmat.key_cmac_subkeys, 1, sample_data.beacon, 13, 13, NULL, 0);
+        enc_aes_cmac_with_subkeys_IgnoreArg_p_result();
+        enc_aes_cmac_with_subkeys_ReturnMemThruPtr_p_result(sample_data.auth, 16);
         event_handle_Expect(&evt);
         net_beacon_packet_in(sample_data.beacon, sizeof(sample_data.beacon), NULL);
         TEST_ASSERT_EQUAL(0xFFFF, sample_data.info.p_tx_info->rx_count[0]);
@@ -449,9 +449,9 @@ void test_packet_in(void)
         memset(dummy_auth, 0xDA, NRF_MESH_KEY_SIZE);
         sample_data.info.p_tx_info->rx_count[0] = 0;
         m_info_index = 0;
-        enc_aes_cmac_ExpectWithArray(sample_data.info.secmat.key, NRF_MESH_KEY_SIZE, sample_data.beacon, 13, 13, NULL, 0);
-        enc_aes_cmac_IgnoreArg_p_result();
-        enc_aes_cmac_ReturnMemThruPtr_p_result(dummy_auth, 16);
+        enc_aes_cmac_with_subkeys_ExpectWithArray(sample_data.info.secmat.key, NRF_MESH_KEY_SIZE, &sample_data.info.secmat.key_cmac_subkeys, 1, sample_data.beacon, 13, 13, NULL, 0);
+        enc_aes_cmac_with_subkeys_IgnoreArg_p_result();
+        enc_aes_cmac_with_subkeys_ReturnMemThruPtr_p_result(dummy_auth, 16);
         net_beacon_packet_in(sample_data.beacon, sizeof(sample_data.beacon), NULL);
         TEST_ASSERT_EQUAL(0, sample_data.info.p_tx_info->rx_count[0]);
     }
@@ -499,9 +499,9 @@ void test_pkt_in_multi(void)
     m_info_index = 0;
     for (uint32_t j = 0; j < ARRAY_SIZE(p_info); j++)
     {
-        enc_aes_cmac_ExpectWithArray(p_info[j]->secmat.key, NRF_MESH_KEY_SIZE, sample_data.beacon, 13, 13, NULL, 0);
-        enc_aes_cmac_IgnoreArg_p_result();
-        enc_aes_cmac_ReturnMemThruPtr_p_result(stored_beacons[j].auth, 16);
+        enc_aes_cmac_with_subkeys_ExpectWithArray(p_info[j]->secmat.key, NRF_MESH_KEY_SIZE, &p_info[j]->secmat.key_cmac_subkeys, 1, sample_data.beacon, 13, 13, NULL, 0);
+        enc_aes_cmac_with_subkeys_IgnoreArg_p_result();
+        enc_aes_cmac_with_subkeys_ReturnMemThruPtr_p_result(stored_beacons[j].auth, 16);
 
         /* Only the valid auths should generate an event: */
         if (j != 1)
@@ -605,7 +605,7 @@ void test_redundant_tx(void)
         /* Call the timeout */
         net_state_beacon_iv_index_get_ExpectAndReturn(sample_data.iv_index);
         net_state_iv_update_get_ExpectAndReturn(sample_data.iv_update ? NET_STATE_IV_UPDATE_IN_PROGRESS : NET_STATE_IV_UPDATE_NORMAL);
-        expect_tx(sample_data.info.secmat.key, sample_data.beacon, sample_data.auth, &adv_packet);
+        expect_tx(&sample_data.info.secmat, sample_data.beacon, sample_data.auth, &adv_packet);
         m_timer_cb(m_time_now, NULL);
         tx_complete();
         TEST_ASSERT_EQUAL(m_time_now, sample_data.info.p_tx_info->tx_timestamp); // should be reset on each transmit.
@@ -621,7 +621,7 @@ void test_redundant_tx(void)
         m_info_index = 0;
         net_state_beacon_iv_index_get_ExpectAndReturn(sample_data.iv_index);
         net_state_iv_update_get_ExpectAndReturn(sample_data.iv_update ? NET_STATE_IV_UPDATE_IN_PROGRESS : NET_STATE_IV_UPDATE_NORMAL);
-        expect_tx(sample_data.info.secmat.key, sample_data.beacon, sample_data.auth, &adv_packet);
+        expect_tx(&sample_data.info.secmat, sample_data.beacon, sample_data.auth, &adv_packet);
         m_timer_cb(m_time_now, NULL);
         tx_complete();
         TEST_ASSERT_EQUAL(0, sample_data.info.p_tx_info->rx_count[0]); // should be reset on each interval
@@ -640,7 +640,7 @@ void test_redundant_tx(void)
         m_info_index = 0;
         net_state_beacon_iv_index_get_ExpectAndReturn(sample_data.iv_index);
         net_state_iv_update_get_ExpectAndReturn(sample_data.iv_update ? NET_STATE_IV_UPDATE_IN_PROGRESS : NET_STATE_IV_UPDATE_NORMAL);
-        expect_tx(sample_data.info.secmat.key, sample_data.beacon, sample_data.auth, &adv_packet);
+        expect_tx(&sample_data.info.secmat, sample_data.beacon, sample_data.auth, &adv_packet);
         m_timer_cb(m_time_now, NULL);
         tx_complete();
         TEST_ASSERT_EQUAL(0, sample_data.info.p_tx_info->rx_count[0]); // should be reset on each interval
@@ -673,9 +673,9 @@ void test_beacon_build(void)
         net_beacon_sample_data_t sample_data = sample_datas[i];
 
         /* Test packet creation */
-        enc_aes_cmac_ExpectWithArray(sample_data.info.secmat.key, NRF_MESH_KEY_SIZE, sample_data.beacon, 13, 13, NULL, 0);
-        enc_aes_cmac_IgnoreArg_p_result();
-        enc_aes_cmac_ReturnMemThruPtr_p_result(sample_data.auth, 16);
+        enc_aes_cmac_with_subkeys_ExpectWithArray(sample_data.info.secmat.key, NRF_MESH_KEY_SIZE, &sample_data.info.secmat.key_cmac_subkeys, 1, sample_data.beacon, 13, 13, NULL, 0);
+        enc_aes_cmac_with_subkeys_IgnoreArg_p_result();
+        enc_aes_cmac_with_subkeys_ReturnMemThruPtr_p_result(sample_data.auth, 16);
 
         uint8_t buffer[NET_BEACON_BUFFER_SIZE];
         TEST_ASSERT_EQUAL(NRF_SUCCESS,
@@ -163,7 +163,7 @@ struct
     uint32_t calls;
 } m_transport_packet_in_expect;
 
-static uint32_t transport_packet_in_callback(const packet_mesh_trs_packet_t * p_packet,
+static uint32_t transport_packet_in_callback(packet_mesh_trs_packet_t * p_packet,
                                              uint32_t trs_packet_len,
                                              const network_packet_metadata_t * p_net_metadata,
                                              const nrf_mesh_rx_metadata_t * p_rx_metadata,
@@ -173,6 +173,8 @@ static uint32_t transport_packet_in_callback(const packet_mesh_trs_packet_t * p_
     if (trs_packet_len > 0)
     {
         TEST_ASSERT_EQUAL_HEX8_ARRAY(m_transport_packet_in_expect.p_packet, p_packet, trs_packet_len);
+        /* The transport layer decrypts the packet in place: */
+        memset(p_packet, 0, trs_packet_len);
     }
     /* Metadata has padding, so we have to compare the fields individually */
     TEST_ASSERT_EQUAL(m_transport_packet_in_expect.p_net_metadata->control_packet, p_net_metadata->control_packet);
@@ -382,7 +384,7 @@ void test_discard(void)
  *
  * The packet in procedure works like this:
  * 1: Decrypt the packet
- * 2: Send to transport
+ * 2: Send to transport if the destination is an RX address
  * 3: Relay if possible
  * 4: add to message cache
  *
@@ -402,19 +404,31 @@ void test_packet_in(void)
         network_packet_metadata_t meta;
         uint32_t length;
         step_t fail_step; /**< The step where the packet processing stops, or STEP_SUCCESS if it goes through all the steps */
+        bool rx; /**< Whether the destination is an RX address of this device. */
     } vector[] = {
-        {{{NRF_MESH_ADDRESS_TYPE_GROUP, 0xFFFF}, 0x0001, 5, false, {SEQNUM, IV_INDEX}, &secmat}, 18, STEP_SUCCESS}, /* access packet */
-        {{{NRF_MESH_ADDRESS_TYPE_GROUP, 0xFFFF}, 0x0001, 5, false, {SEQNUM, IV_INDEX}, &secmat}, 18, STEP_DECRYPTION}, /* access packet */
-        {{{NRF_MESH_ADDRESS_TYPE_GROUP, 0xFFFF}, 0x0001, 5, true, {SEQNUM, IV_INDEX}, &secmat}, 18, STEP_SUCCESS}, /* Control packet */
-        {{{NRF_MESH_ADDRESS_TYPE_UNICAST, 0x0002}, 0x0001, 5, false, {SEQNUM, IV_INDEX}, &secmat}, 18, STEP_SUCCESS}, /* Unicast DST */
-        {{{NRF_MESH_ADDRESS_TYPE_UNICAST, 0x0002}, 0x0001, 5, false, {SEQNUM, IV_INDEX}, &secmat}, 9+4, STEP_SUCCESS}, /* just long enough */
-        {{{NRF_MESH_ADDRESS_TYPE_UNICAST, 0x0002}, 0x0001, 5, false, {SEQNUM, IV_INDEX}, &secmat}, 9+7, STEP_SUCCESS}, /* long enough for a data packet */
-        {{{NRF_MESH_ADDRESS_TYPE_UNICAST, 0x0002}, 0x0001, 5, true, {SEQNUM, IV_INDEX}, &secmat}, 9+8, STEP_SUCCESS}, /* just long enough */
-        {{{NRF_MESH_ADDRESS_TYPE_UNICAST, 0x0002}, 0x0001, 5, false, {SEQNUM, IV_INDEX}, &secmat}, 18, STEP_DO_RELAY}, /* Packet is for this device, shouldn't relay */
-        {{{NRF_MESH_ADDRESS_TYPE_UNICAST, 0x0002}, 0x0001, 1, false, {SEQNUM, IV_INDEX}, &secmat}, 18, STEP_DO_RELAY}, /* TTL too low to relay */
-        {{{NRF_MESH_ADDRESS_TYPE_UNICAST, 0x0002}, 0x0001, 5, false, {SEQNUM, IV_INDEX}, &secmat}, 18, STEP_SUCCESS},
+        {{{NRF_MESH_ADDRESS_TYPE_GROUP, 0xFFFF}, 0x0001, 5, false, {SEQNUM, IV_INDEX}, &secmat}, 18, STEP_SUCCESS, true}, /* access packet */
+        {{{NRF_MESH_ADDRESS_TYPE_GROUP, 0xFFFF}, 0x0001, 5, false, {SEQNUM, IV_INDEX}, &secmat}, 18, STEP_DECRYPTION, true}, /* access packet */
+        {{{NRF_MESH_ADDRESS_TYPE_GROUP, 0xFFFF}, 0x0001, 5, true, {SEQNUM, IV_INDEX}, &secmat}, 18, STEP_SUCCESS, true}, /* Control packet */
+        {{{NRF_MESH_ADDRESS_TYPE_GROUP, 0xC001}, 0x0001, 5, false, {SEQNUM, IV_INDEX}, &secmat}, 18, STEP_SUCCESS, false}, /* Group not subscribed to */
+        {{{NRF_MESH_ADDRESS_TYPE_UNICAST, 0x0002}, 0x0001, 5, false, {SEQNUM, IV_INDEX}, &secmat}, 18, STEP_SUCCESS, false}, /* Unicast DST */
+        {{{NRF_MESH_ADDRESS_TYPE_UNICAST, 0x0002}, 0x0001, 5, false, {SEQNUM, IV_INDEX}, &secmat}, 9+4, STEP_SUCCESS, false}, /* just long enough */
+        {{{NRF_MESH_ADDRESS_TYPE_UNICAST, 0x0002}, 0x0001, 5, false, {SEQNUM, IV_INDEX}, &secmat}, 9+7, STEP_SUCCESS, false}, /* long enough for a data packet */
+        {{{NRF_MESH_ADDRESS_TYPE_UNICAST, 0x0002}, 0x0001, 5, true, {SEQNUM, IV_INDEX}, &secmat}, 9+8, STEP_SUCCESS, false}, /* just long enough */
+        {{{NRF_MESH_ADDRESS_TYPE_UNICAST, 0x0002}, 0x0001, 5, false, {SEQNUM, IV_INDEX}, &secmat}, 18, STEP_DO_RELAY, true}, /* Packet is for this device, shouldn't relay */
+        {{{NRF_MESH_ADDRESS_TYPE_UNICAST, 0x0002}, 0x0001, 1, false, {SEQNUM, IV_INDEX}, &secmat}, 18, STEP_DO_RELAY, false}, /* TTL too low to relay */
+        {{{NRF_MESH_ADDRESS_TYPE_UNICAST, 0x0002}, 0x0001, 5, false, {SEQNUM, IV_INDEX}, &secmat}, 18, STEP_SUCCESS, false},
     };
     nrf_mesh_rx_metadata_t rx_meta;
+    network_rx_stats_t expected_stats = {0};
+    network_rx_stats_t stats;
+
+    nrf_mesh_init_params_t init_params = {.relay_cb = relay_callback};
+    net_beacon_init_Expect();
+    net_state_recover_from_flash_Expect();
+    net_state_init_Expect();
+    network_init(&init_params);
+    network_rx_stats_get(&stats);
+    TEST_ASSERT_EQUAL_MEMORY(&expected_stats, &stats, sizeof(stats));
 
     for (uint32_t i = 0; i < ARRAY_SIZE(vector); ++i)
     {
@@ -422,7 +436,9 @@ void test_packet_in(void)
         packet_mesh_net_packet_t * p_relay_packet = &relay_packet;
         packet_mesh_net_packet_t net_packet;
         uint8_t mic_len = vector[i].meta.control_packet ? 8 : 4;
+        bool relayed = false;
         memset(&net_packet, 0xAB, sizeof(net_packet));
+        memset(&relay_packet, 0, sizeof(relay_packet));
 
         net_packet_obfuscation_start_get_ExpectAndReturn(&net_packet, &net_packet.pdu[1]);
 
@@ -444,32 +460,36 @@ void test_packet_in(void)
 
         if (vector[i].fail_step > STEP_DECRYPTION)
         {
-            /* 2: Send to transport */
+            /* 2: Send to transport if the packet is for this device */
             net_packet_payload_len_get_ExpectAndReturn(&vector[i].meta,
                                                        vector[i].length,
                                                        vector[i].length - 9 - mic_len);
-            transport_packet_in_StubWithCallback(transport_packet_in_callback);
-
-            m_transport_packet_in_expect.p_packet = (const packet_mesh_trs_packet_t *) &net_packet.pdu[9];
-            m_transport_packet_in_expect.trs_packet_len =
-                vector[i].length - 9 - mic_len;
-            m_transport_packet_in_expect.p_net_metadata = &vector[i].meta;
-            m_transport_packet_in_expect.p_rx_metadata  = &rx_meta;
-            m_transport_packet_in_expect.calls          = 1;
+            nrf_mesh_rx_address_get_ExpectAndReturn(vector[i].meta.dst.value, NULL, vector[i].rx);
+            nrf_mesh_rx_address_get_IgnoreArg_p_address();
+            if (vector[i].rx)
+            {
+                transport_packet_in_StubWithCallback(transport_packet_in_callback);
+
+                m_transport_packet_in_expect.p_packet = (const packet_mesh_trs_packet_t *) &net_packet.pdu[9];
+                m_transport_packet_in_expect.trs_packet_len =
+                    vector[i].length - 9 - mic_len;
+                m_transport_packet_in_expect.p_net_metadata = &vector[i].meta;
+                m_transport_packet_in_expect.p_rx_metadata  = &rx_meta;
+                m_transport_packet_in_expect.calls          = 1;
+                expected_stats.slow_path_packets++;
+            }
+            else
+            {
+                expected_stats.fast_path_packets++;
+            }
             core_tx_adv_is_enabled_ExpectAndReturn(CORE_TX_ROLE_RELAY, true);
             /* 3: Relay if needed: */
             if (vector[i].meta.ttl >= 2)
             {
-                if (vector[i].meta.dst.type == NRF_MESH_ADDRESS_TYPE_UNICAST)
-                {
-                    nrf_mesh_rx_address_get_ExpectAndReturn(vector[i].meta.dst.value,
-                                                            NULL,
-                                                            (vector[i].fail_step == STEP_DO_RELAY));
-                    nrf_mesh_rx_address_get_IgnoreArg_p_address();
-                }
                 if (vector[i].fail_step > STEP_DO_RELAY)
                 {
                     relay_Expect(&vector[i].meta, vector[i].length, &p_relay_packet);
+                    relayed = true;
                 }
             }
 
@@ -481,9 +501,18 @@ void test_packet_in(void)
 
         TEST_ASSERT_EQUAL(0, m_transport_packet_in_expect.calls);
         TEST_ASSERT_EQUAL(0, m_relay_callback_expect.calls);
+        if (relayed)
+        {
+            /* The relayed packet is unaffected by the transport processing: */
+            TEST_ASSERT_EQUAL_HEX8_ARRAY(&net_packet.pdu[9], &relay_packet.pdu[9], vector[i].length - 9 - mic_len);
+        }
         core_tx_mock_Verify();
         transport_mock_Verify();
         nrf_mesh_externs_mock_Verify();
         net_packet_mock_Verify();
+
+        network_rx_stats_get(&stats);
+        TEST_ASSERT_EQUAL(expected_stats.fast_path_packets, stats.fast_path_packets);
+        TEST_ASSERT_EQUAL(expected_stats.slow_path_packets, stats.slow_path_packets);
     }
 }
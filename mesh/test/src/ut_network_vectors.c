@@ -326,7 +326,7 @@ static struct
     uint32_t calls;
 } m_transport_packet_in;
 
-uint32_t transport_packet_in_mock_cb(const packet_mesh_trs_packet_t * p_packet,
+uint32_t transport_packet_in_mock_cb(packet_mesh_trs_packet_t * p_packet,
                                      uint32_t trs_packet_len,
                                      const network_packet_metadata_t * p_net_metadata,
                                      const nrf_mesh_rx_metadata_t * p_rx_metadata,
@@ -466,6 +466,8 @@ void test_packet_in(void)
         get_test_vector(run_testvectors[i], &test_vector);
         __LOG(LOG_SRC_TEST, LOG_LEVEL_INFO, "Running test vector %d\n", run_testvectors[i]);
 
+        /* Only packets to this device are passed on to the transport layer. */
+        m_rx_address = test_vector.metadata.dst.value;
         msg_cache_entry_exists_IgnoreAndReturn(false);
         msg_cache_entry_add_Expect(test_vector.metadata.src, test_vector.metadata.internal.sequence_number);
 
@@ -497,6 +499,8 @@ void test_packet_in(void)
         get_test_vector(run_testvectors[i], &test_vector);
         __LOG(LOG_SRC_TEST, LOG_LEVEL_INFO, "Running test vector %d\n", run_testvectors[i]);
 
+        /* Only packets to this device are passed on to the transport layer. */
+        m_rx_address = test_vector.metadata.dst.value;
         msg_cache_entry_exists_IgnoreAndReturn(false);
         msg_cache_entry_add_Expect(test_vector.metadata.src, test_vector.metadata.internal.sequence_number);
 
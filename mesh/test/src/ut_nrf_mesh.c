@@ -337,6 +337,7 @@ void test_scanner_packet_process_cb(void)
     network_packet_in_ExpectAndReturn(&mp_ad_data->data[0], 1, &m_metadata, NRF_SUCCESS);
     network_packet_in_IgnoreArg_p_rx_metadata();
     scanner_packet_release_Expect(&m_test_packet);
+    scanner_rx_ExpectAndReturn(NULL);
     scanner_rx_pending_ExpectAndReturn(false);
     TEST_ASSERT_EQUAL(true, m_scanner_packet_process_cb());
 
@@ -352,6 +353,7 @@ void test_scanner_packet_process_cb(void)
     prov_bearer_adv_packet_in_Expect(&mp_ad_data->data[0], 1, &m_metadata);
     prov_bearer_adv_packet_in_IgnoreArg_p_metadata();
     scanner_packet_release_Expect(&m_test_packet);
+    scanner_rx_ExpectAndReturn(NULL);
     scanner_rx_pending_ExpectAndReturn(false);
     TEST_ASSERT_EQUAL(true, m_scanner_packet_process_cb());
 
@@ -367,6 +369,7 @@ void test_scanner_packet_process_cb(void)
     beacon_packet_in_ExpectAndReturn(&mp_ad_data->data[0], 1, &m_metadata, NRF_SUCCESS);
     beacon_packet_in_IgnoreArg_p_packet_meta();
     scanner_packet_release_Expect(&m_test_packet);
+    scanner_rx_ExpectAndReturn(NULL);
     scanner_rx_pending_ExpectAndReturn(false);
     TEST_ASSERT_EQUAL(true, m_scanner_packet_process_cb());
 
@@ -383,6 +386,7 @@ void test_scanner_packet_process_cb(void)
     nrf_mesh_dfu_rx_ExpectAndReturn(&mp_ad_data->data[2], 1, &m_metadata, NRF_SUCCESS);
     nrf_mesh_dfu_rx_IgnoreArg_p_metadata();
     scanner_packet_release_Expect(&m_test_packet);
+    scanner_rx_ExpectAndReturn(NULL);
     scanner_rx_pending_ExpectAndReturn(false);
     TEST_ASSERT_EQUAL(true, m_scanner_packet_process_cb());
 
@@ -413,6 +417,7 @@ void test_scanner_packet_process_cb(void)
                                &m_metadata);
     ad_listener_process_Ignore();
     scanner_packet_release_Expect(&m_test_packet);
+    scanner_rx_ExpectAndReturn(NULL);
     scanner_rx_pending_ExpectAndReturn(false);
     TEST_ASSERT_EQUAL(true, m_scanner_packet_process_cb());
 
@@ -426,8 +431,27 @@ void test_scanner_packet_process_cb(void)
                                &m_metadata);
     ad_listener_process_Ignore();
     scanner_packet_release_Expect(&m_test_packet);
+    scanner_rx_ExpectAndReturn(NULL);
     scanner_rx_pending_ExpectAndReturn(true);
     TEST_ASSERT_EQUAL(false, m_scanner_packet_process_cb());
+
+    /* Several packets are processed in one go, up to the batch size: */
+    for (uint32_t i = 0; i < SCANNER_RX_BATCH_SIZE; ++i)
+    {
+        scanner_rx_ExpectAndReturn(&m_test_packet);
+        scanner_packet_release_Expect(&m_test_packet);
+    }
+    scanner_rx_pending_ExpectAndReturn(true);
+    TEST_ASSERT_EQUAL(false, m_scanner_packet_process_cb());
+
+    for (uint32_t i = 0; i < SCANNER_RX_BATCH_SIZE - 1; ++i)
+    {
+        scanner_rx_ExpectAndReturn(&m_test_packet);
+        scanner_packet_release_Expect(&m_test_packet);
+    }
+    scanner_rx_ExpectAndReturn(NULL);
+    scanner_rx_pending_ExpectAndReturn(false);
+    TEST_ASSERT_EQUAL(true, m_scanner_packet_process_cb());
 }
 
 void test_evt_handler_add(void)
@@ -49,6 +49,15 @@
 #define SEQNO_BASE 0x0000
 #define IVI_BASE   0x0
 
+#if REPLAY_CACHE_LRU_EVICTION_ENABLED
+/* Adding to a full cache evicts the least recently used source. */
+#define CACHE_FULL_STATUS       NRF_SUCCESS
+#define CACHE_FIRST_RETAINED    1
+#else
+#define CACHE_FULL_STATUS       NRF_ERROR_NO_MEM
+#define CACHE_FIRST_RETAINED    0
+#endif
+
 void setUp(void)
 {
     replay_cache_init();
@@ -70,9 +79,9 @@ void test_cache(void)
     }
 
     /* Cache full. */
-    TEST_ASSERT_EQUAL(NRF_ERROR_NO_MEM, replay_cache_add(SRC_BASE + REPLAY_CACHE_ENTRIES,
-                                                         SEQNO_BASE,
-                                                         ivi));
+    TEST_ASSERT_EQUAL(CACHE_FULL_STATUS, replay_cache_add(SRC_BASE + REPLAY_CACHE_ENTRIES,
+                                                          SEQNO_BASE,
+                                                          ivi));
 
     replay_cache_on_iv_update();
 
@@ -86,11 +95,11 @@ void test_cache(void)
     }
 
     /* Cache full. */
-    TEST_ASSERT_EQUAL(NRF_ERROR_NO_MEM, replay_cache_add(SRC_BASE + REPLAY_CACHE_ENTRIES,
-                                                         SEQNO_BASE,
-                                                         ivi));
+    TEST_ASSERT_EQUAL(CACHE_FULL_STATUS, replay_cache_add(SRC_BASE + REPLAY_CACHE_ENTRIES,
+                                                          SEQNO_BASE,
+                                                          ivi));
 
-    for (int i = 0; i < REPLAY_CACHE_ENTRIES; ++i)
+    for (int i = CACHE_FIRST_RETAINED; i < REPLAY_CACHE_ENTRIES; ++i)
     {
         TEST_ASSERT_EQUAL(true, replay_cache_has_elem(SRC_BASE + i,
                                                           SEQNO_BASE,
@@ -103,7 +112,7 @@ void test_cache(void)
 
     /* Update IV index. Should still get matches on old index. */
     replay_cache_on_iv_update();
-    for (int i = 0; i < REPLAY_CACHE_ENTRIES; ++i)
+    for (int i = CACHE_FIRST_RETAINED; i < REPLAY_CACHE_ENTRIES; ++i)
     {
         TEST_ASSERT_EQUAL(true, replay_cache_has_elem(SRC_BASE + i,
                                                       SEQNO_BASE,
@@ -125,3 +134,64 @@ void test_cache(void)
                                                        ivi));
     }
 }
+
+void test_lru_eviction(void)
+{
+    for (int i = 0; i < REPLAY_CACHE_ENTRIES; ++i)
+    {
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, replay_cache_add(SRC_BASE + i, SEQNO_BASE + i, IVI_BASE));
+    }
+
+    /* Refresh the first entry, so that the second one is the least recently used. */
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, replay_cache_add(SRC_BASE, SEQNO_BASE + 100, IVI_BASE));
+    TEST_ASSERT_TRUE(replay_cache_has_elem(SRC_BASE, SEQNO_BASE + 100, IVI_BASE));
+    TEST_ASSERT_FALSE(replay_cache_has_elem(SRC_BASE, SEQNO_BASE + 101, IVI_BASE));
+
+    TEST_ASSERT_EQUAL(CACHE_FULL_STATUS, replay_cache_add(SRC_BASE + REPLAY_CACHE_ENTRIES, SEQNO_BASE, IVI_BASE));
+
+#if REPLAY_CACHE_LRU_EVICTION_ENABLED
+    TEST_ASSERT_TRUE(replay_cache_has_elem(SRC_BASE + REPLAY_CACHE_ENTRIES, SEQNO_BASE, IVI_BASE));
+    TEST_ASSERT_FALSE(replay_cache_has_elem(SRC_BASE + 1, SEQNO_BASE + 1, IVI_BASE));
+    for (int i = 2; i < REPLAY_CACHE_ENTRIES; ++i)
+    {
+        TEST_ASSERT_TRUE(replay_cache_has_elem(SRC_BASE + i, SEQNO_BASE + i, IVI_BASE));
+    }
+
+    /* Keep cycling through more sources than the cache can hold. */
+    for (int i = 0; i < REPLAY_CACHE_ENTRIES * 4; ++i)
+    {
+        uint16_t src = SRC_BASE + 0x1000 + i;
+        TEST_ASSERT_FALSE(replay_cache_has_elem(src, SEQNO_BASE, IVI_BASE));
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, replay_cache_add(src, SEQNO_BASE, IVI_BASE));
+        TEST_ASSERT_TRUE(replay_cache_has_elem(src, SEQNO_BASE, IVI_BASE));
+    }
+    for (int i = 0; i < REPLAY_CACHE_ENTRIES * 4; ++i)
+    {
+        uint16_t src = SRC_BASE + 0x1000 + i;
+        TEST_ASSERT_EQUAL(i >= REPLAY_CACHE_ENTRIES * 3, replay_cache_has_elem(src, SEQNO_BASE, IVI_BASE));
+    }
+#else
+    TEST_ASSERT_FALSE(replay_cache_has_elem(SRC_BASE + REPLAY_CACHE_ENTRIES, SEQNO_BASE, IVI_BASE));
+    TEST_ASSERT_TRUE(replay_cache_has_elem(SRC_BASE + 1, SEQNO_BASE + 1, IVI_BASE));
+#endif
+}
+
+void test_iv_update_reuses_entries(void)
+{
+    /* Run through enough IV updates to wrap the internal bookkeeping around, making sure that the
+     * entries of the previous IV index survive each update, and that the cleared ones don't. */
+    for (uint32_t update = 0; update < 0x10010; ++update)
+    {
+        uint8_t ivi = (IVI_BASE + update) & 0x01;
+        uint16_t src = SRC_BASE + (update % REPLAY_CACHE_ENTRIES);
+
+        TEST_ASSERT_FALSE(replay_cache_has_elem(src, update, ivi));
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, replay_cache_add(src, update, ivi));
+        TEST_ASSERT_TRUE(replay_cache_has_elem(src, update, ivi));
+
+        replay_cache_on_iv_update();
+
+        TEST_ASSERT_TRUE(replay_cache_has_elem(src, update, ivi));
+        TEST_ASSERT_FALSE(replay_cache_has_elem(src, update + 1, ivi));
+    }
+}
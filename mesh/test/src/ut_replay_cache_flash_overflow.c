@@ -0,0 +1,352 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <unity.h>
+
+#include <nrf_error.h>
+
+#include "replay_cache.h"
+#include "nrf_mesh_config_core.h"
+#include "utils.h"
+
+#include "flash_manager_mock.h"
+#include "timer_mock.h"
+
+#define SRC_BASE   0x0100
+#define SEQNO_BASE 0x0000
+#define IVI_BASE   0x0
+
+#define FLASH_ENTRY_COUNT       (REPLAY_CACHE_ENTRIES * 4)
+#define FLASH_WRITE_INTERVAL_US (REPLAY_CACHE_FLASH_WRITE_INTERVAL_MS * 1000UL)
+
+/** Non-VLA version of a flash manager entry, holding the committed entries of the mock. */
+typedef struct
+{
+    fm_header_t header;
+    uint32_t data[4];
+} flash_entry_t;
+
+static flash_manager_t * mp_flash_manager;
+static flash_entry_t m_flash_entries[FLASH_ENTRY_COUNT];
+static uint32_t m_flash_entry_count;
+static uint32_t m_flash_write_count;
+static timestamp_t m_time_now;
+/** Time to advance the clock by on every call to timer_now(). */
+static timestamp_t m_time_step;
+
+static uint32_t flash_manager_add_cb(flash_manager_t * p_manager, const flash_manager_config_t * p_config, int calls)
+{
+    TEST_ASSERT_EQUAL_PTR(REPLAY_CACHE_FLASH_AREA_LOCATION, p_config->p_area);
+    TEST_ASSERT_EQUAL(REPLAY_CACHE_FLASH_PAGE_COUNT, p_config->page_count);
+    mp_flash_manager = p_manager;
+    memcpy(&p_manager->config, p_config, sizeof(flash_manager_config_t));
+    p_manager->internal.state = FM_STATE_READY;
+    return NRF_SUCCESS;
+}
+
+static uint32_t flash_manager_remove_cb(flash_manager_t * p_manager, int calls)
+{
+    m_flash_entry_count = 0;
+    p_manager->internal.state = FM_STATE_UNINITIALIZED;
+    p_manager->config.remove_complete_cb(p_manager);
+    return NRF_SUCCESS;
+}
+
+static flash_entry_t * flash_entry_find(fm_handle_t handle)
+{
+    for (uint32_t i = 0; i < m_flash_entry_count; ++i)
+    {
+        if (m_flash_entries[i].header.handle == handle)
+        {
+            return &m_flash_entries[i];
+        }
+    }
+    return NULL;
+}
+
+static const fm_entry_t * flash_manager_entry_get_cb(const flash_manager_t * p_manager, fm_handle_t handle, int calls)
+{
+    TEST_ASSERT_EQUAL_PTR(mp_flash_manager, p_manager);
+    return (const fm_entry_t *) flash_entry_find(handle);
+}
+
+static fm_entry_t * flash_manager_entry_alloc_cb(flash_manager_t * p_manager, fm_handle_t handle, uint32_t data_length, int calls)
+{
+    TEST_ASSERT_EQUAL_PTR(mp_flash_manager, p_manager);
+    TEST_ASSERT_TRUE(data_length <= sizeof(m_flash_entries[0].data));
+    flash_entry_t * p_entry = malloc(sizeof(flash_entry_t));
+    TEST_ASSERT_NOT_NULL(p_entry);
+    p_entry->header.handle = handle;
+    p_entry->header.len_words = FLASH_MANAGER_ENTRY_LEN_OVERHEAD + ALIGN_VAL(data_length, WORD_SIZE) / WORD_SIZE;
+    return (fm_entry_t *) p_entry;
+}
+
+static void flash_manager_entry_commit_cb(const fm_entry_t * p_entry, int calls)
+{
+    flash_entry_t * p_stored = flash_entry_find(p_entry->header.handle);
+    if (p_stored == NULL)
+    {
+        TEST_ASSERT_TRUE(m_flash_entry_count < FLASH_ENTRY_COUNT);
+        p_stored = &m_flash_entries[m_flash_entry_count++];
+    }
+    memcpy(p_stored, p_entry, sizeof(flash_entry_t));
+    free((void *) p_entry);
+    m_flash_write_count++;
+}
+
+static const fm_entry_t * flash_manager_entry_next_get_cb(const flash_manager_t * p_manager,
+                                                          const fm_handle_filter_t * p_filter,
+                                                          const fm_entry_t * p_start,
+                                                          int calls)
+{
+    TEST_ASSERT_EQUAL_PTR(mp_flash_manager, p_manager);
+    TEST_ASSERT_NULL(p_filter);
+    for (uint32_t i = (p_start == NULL) ? 0 : (uint32_t) ((const flash_entry_t *) p_start - m_flash_entries) + 1;
+         i < m_flash_entry_count;
+         ++i)
+    {
+        if (m_flash_entries[i].header.handle != FLASH_MANAGER_HANDLE_INVALID)
+        {
+            return (const fm_entry_t *) &m_flash_entries[i];
+        }
+    }
+    return NULL;
+}
+
+static uint32_t flash_manager_entry_invalidate_cb(flash_manager_t * p_manager, fm_handle_t handle, int calls)
+{
+    TEST_ASSERT_EQUAL_PTR(mp_flash_manager, p_manager);
+    flash_entry_t * p_stored = flash_entry_find(handle);
+    TEST_ASSERT_NOT_NULL(p_stored);
+    /* Keep the entry in place, so that iterations over the area aren't disturbed. */
+    p_stored->header.handle = FLASH_MANAGER_HANDLE_INVALID;
+    return NRF_SUCCESS;
+}
+
+static timestamp_t timer_now_cb(int calls)
+{
+    m_time_now += m_time_step;
+    return m_time_now;
+}
+
+static void cache_fill(void)
+{
+    for (int i = 0; i < REPLAY_CACHE_ENTRIES; ++i)
+    {
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, replay_cache_add(SRC_BASE + i, SEQNO_BASE + i, IVI_BASE));
+    }
+}
+
+void setUp(void)
+{
+    flash_manager_mock_Init();
+    timer_mock_Init();
+    flash_manager_add_StubWithCallback(flash_manager_add_cb);
+    flash_manager_remove_StubWithCallback(flash_manager_remove_cb);
+    flash_manager_entry_get_StubWithCallback(flash_manager_entry_get_cb);
+    flash_manager_entry_alloc_StubWithCallback(flash_manager_entry_alloc_cb);
+    flash_manager_entry_commit_StubWithCallback(flash_manager_entry_commit_cb);
+    flash_manager_entry_next_get_StubWithCallback(flash_manager_entry_next_get_cb);
+    flash_manager_entry_invalidate_StubWithCallback(flash_manager_entry_invalidate_cb);
+    timer_now_StubWithCallback(timer_now_cb);
+    /* Let the write budget refill between writes, unless the test stops the clock. */
+    m_time_step = FLASH_WRITE_INTERVAL_US;
+
+    replay_cache_init();
+    m_flash_write_count = 0;
+}
+
+void tearDown(void)
+{
+    flash_manager_mock_Verify();
+    flash_manager_mock_Destroy();
+    timer_mock_Verify();
+    timer_mock_Destroy();
+}
+
+void test_evicted_sources_stay_protected(void)
+{
+    cache_fill();
+    TEST_ASSERT_EQUAL(0, m_flash_write_count);
+
+    /* Cycle through more sources than the cache can hold. */
+    for (int i = 0; i < REPLAY_CACHE_ENTRIES * 2; ++i)
+    {
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, replay_cache_add(SRC_BASE + 0x1000 + i, SEQNO_BASE, IVI_BASE));
+    }
+    TEST_ASSERT_EQUAL(REPLAY_CACHE_ENTRIES * 2, m_flash_write_count);
+
+    for (int i = 0; i < REPLAY_CACHE_ENTRIES; ++i)
+    {
+        TEST_ASSERT_TRUE(replay_cache_has_elem(SRC_BASE + i, SEQNO_BASE + i, IVI_BASE));
+        TEST_ASSERT_FALSE(replay_cache_has_elem(SRC_BASE + i, SEQNO_BASE + i + 1, IVI_BASE));
+        TEST_ASSERT_TRUE(replay_cache_has_elem(SRC_BASE + 0x1000 + i, SEQNO_BASE, IVI_BASE));
+    }
+
+    /* The stored sequence numbers of the previous IV index stay valid for one IV update. */
+    replay_cache_on_iv_update();
+    TEST_ASSERT_TRUE(replay_cache_has_elem(SRC_BASE, SEQNO_BASE, IVI_BASE));
+    replay_cache_on_iv_update();
+    TEST_ASSERT_FALSE(replay_cache_has_elem(SRC_BASE, SEQNO_BASE, IVI_BASE));
+}
+
+void test_write_rate_limit(void)
+{
+    cache_fill();
+
+    /* Stop the clock, so that only a single burst of writes can be made. */
+    m_time_step = 0;
+    for (int i = 0; i < REPLAY_CACHE_FLASH_WRITE_BURST; ++i)
+    {
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, replay_cache_add(SRC_BASE + 0x1000 + i, SEQNO_BASE, IVI_BASE));
+    }
+    TEST_ASSERT_EQUAL(REPLAY_CACHE_FLASH_WRITE_BURST, m_flash_write_count);
+
+    /* The budget is spent: the least recently used source is kept, and the new one is dropped. */
+    uint16_t lru_src = SRC_BASE + REPLAY_CACHE_FLASH_WRITE_BURST;
+    TEST_ASSERT_EQUAL(NRF_ERROR_NO_MEM, replay_cache_add(SRC_BASE + 0x2000, SEQNO_BASE, IVI_BASE));
+    TEST_ASSERT_FALSE(replay_cache_has_elem(SRC_BASE + 0x2000, SEQNO_BASE, IVI_BASE));
+    TEST_ASSERT_TRUE(replay_cache_has_elem(lru_src, SEQNO_BASE + REPLAY_CACHE_FLASH_WRITE_BURST, IVI_BASE));
+    TEST_ASSERT_EQUAL(REPLAY_CACHE_FLASH_WRITE_BURST, m_flash_write_count);
+
+    /* One more write is allowed for every write interval. */
+    m_time_now += FLASH_WRITE_INTERVAL_US;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, replay_cache_add(SRC_BASE + 0x2000, SEQNO_BASE, IVI_BASE));
+    TEST_ASSERT_EQUAL(NRF_ERROR_NO_MEM, replay_cache_add(SRC_BASE + 0x2001, SEQNO_BASE, IVI_BASE));
+    TEST_ASSERT_EQUAL(REPLAY_CACHE_FLASH_WRITE_BURST + 1, m_flash_write_count);
+
+    /* The budget refills up to a full burst after an idle period. */
+    m_time_now += FLASH_WRITE_INTERVAL_US * REPLAY_CACHE_FLASH_WRITE_BURST * 4;
+    for (int i = 0; i < REPLAY_CACHE_FLASH_WRITE_BURST; ++i)
+    {
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, replay_cache_add(SRC_BASE + 0x3000 + i, SEQNO_BASE, IVI_BASE));
+    }
+    TEST_ASSERT_EQUAL(NRF_ERROR_NO_MEM, replay_cache_add(SRC_BASE + 0x2001, SEQNO_BASE, IVI_BASE));
+}
+
+void test_flash_alloc_failure(void)
+{
+    cache_fill();
+
+    /* The flash manager is out of memory: nothing is evicted, and the new source is dropped. */
+    flash_manager_entry_alloc_StubWithCallback(NULL);
+    flash_manager_entry_alloc_ExpectAnyArgsAndReturn(NULL);
+    TEST_ASSERT_EQUAL(NRF_ERROR_NO_MEM, replay_cache_add(SRC_BASE + 0x1000, SEQNO_BASE, IVI_BASE));
+    TEST_ASSERT_TRUE(replay_cache_has_elem(SRC_BASE, SEQNO_BASE, IVI_BASE));
+    TEST_ASSERT_FALSE(replay_cache_has_elem(SRC_BASE + 0x1000, SEQNO_BASE, IVI_BASE));
+    TEST_ASSERT_EQUAL(0, m_flash_write_count);
+
+    /* The failed write doesn't count against the budget. */
+    m_time_step = 0;
+    flash_manager_entry_alloc_StubWithCallback(flash_manager_entry_alloc_cb);
+    for (int i = 0; i < REPLAY_CACHE_FLASH_WRITE_BURST; ++i)
+    {
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, replay_cache_add(SRC_BASE + 0x1000 + i, SEQNO_BASE, IVI_BASE));
+    }
+    TEST_ASSERT_EQUAL(REPLAY_CACHE_FLASH_WRITE_BURST, m_flash_write_count);
+}
+
+void test_clear(void)
+{
+    cache_fill();
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, replay_cache_add(SRC_BASE + 0x1000, SEQNO_BASE, IVI_BASE));
+    TEST_ASSERT_EQUAL(1, m_flash_write_count);
+
+    /* The overflow tier is erased along with the cache. */
+    replay_cache_clear();
+    TEST_ASSERT_FALSE(replay_cache_has_elem(SRC_BASE, SEQNO_BASE, IVI_BASE));
+    TEST_ASSERT_EQUAL(0, m_flash_entry_count);
+}
+
+void test_epoch_wrap(void)
+{
+    /* Leave a sequence number in flash that goes stale with the next IV update of its IV index bit. */
+    cache_fill();
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, replay_cache_add(SRC_BASE + 0x1000, SEQNO_BASE, IVI_BASE));
+    TEST_ASSERT_TRUE(replay_cache_has_elem(SRC_BASE, SEQNO_BASE, IVI_BASE));
+
+    /* Run up to the IV update that wraps the epoch numbering around. */
+    for (uint32_t update = 0; update < 0xFFFE; ++update)
+    {
+        replay_cache_on_iv_update();
+    }
+    TEST_ASSERT_FALSE(replay_cache_has_elem(SRC_BASE, SEQNO_BASE, IVI_BASE));
+
+    /* Overflow the current IV index bit into flash right before the wrap. */
+    for (int i = 0; i <= REPLAY_CACHE_ENTRIES; ++i)
+    {
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, replay_cache_add(SRC_BASE + 0x2000 + i, SEQNO_BASE + 5, IVI_BASE));
+    }
+    TEST_ASSERT_TRUE(replay_cache_has_elem(SRC_BASE + 0x2000, SEQNO_BASE + 5, IVI_BASE));
+
+    /* The stored sequence number survives the wrap, and the stale one doesn't come back. */
+    replay_cache_on_iv_update();
+    TEST_ASSERT_TRUE(replay_cache_has_elem(SRC_BASE + 0x2000, SEQNO_BASE + 5, IVI_BASE));
+    TEST_ASSERT_FALSE(replay_cache_has_elem(SRC_BASE + 0x2000, SEQNO_BASE + 6, IVI_BASE));
+    TEST_ASSERT_FALSE(replay_cache_has_elem(SRC_BASE, SEQNO_BASE, IVI_BASE));
+
+    /* Both go stale with the next IV update of their IV index bit. */
+    replay_cache_on_iv_update();
+    replay_cache_on_iv_update();
+    TEST_ASSERT_FALSE(replay_cache_has_elem(SRC_BASE + 0x2000, SEQNO_BASE + 5, IVI_BASE));
+    TEST_ASSERT_FALSE(replay_cache_has_elem(SRC_BASE, SEQNO_BASE, IVI_BASE));
+}
+
+void test_epoch_wrap_flash_busy(void)
+{
+    cache_fill();
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, replay_cache_add(SRC_BASE + 0x1000, SEQNO_BASE, IVI_BASE));
+    for (uint32_t update = 0; update < 0xFFFE; ++update)
+    {
+        replay_cache_on_iv_update();
+    }
+    for (int i = 0; i <= REPLAY_CACHE_ENTRIES; ++i)
+    {
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, replay_cache_add(SRC_BASE + 0x2000 + i, SEQNO_BASE + 5, IVI_BASE));
+    }
+
+    /* The flash manager can't take the rewrites: the overflow tier is erased instead. */
+    flash_manager_entry_alloc_StubWithCallback(NULL);
+    flash_manager_entry_alloc_IgnoreAndReturn(NULL);
+    replay_cache_on_iv_update();
+    TEST_ASSERT_EQUAL(0, m_flash_entry_count);
+    TEST_ASSERT_FALSE(replay_cache_has_elem(SRC_BASE, SEQNO_BASE, IVI_BASE));
+}
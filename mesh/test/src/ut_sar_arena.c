@@ -0,0 +1,177 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <unity.h>
+
+#include "sar_arena.h"
+#include "nrf_mesh_config_core.h"
+#include "test_assert.h"
+#include "utils.h"
+
+static const uint16_t m_block_counts[SAR_ARENA_CLASS_COUNT] =
+{
+    TRANSPORT_SAR_ARENA_SEG1_BLOCKS,
+    TRANSPORT_SAR_ARENA_SEG2_BLOCKS,
+    TRANSPORT_SAR_ARENA_SEG4_BLOCKS,
+    TRANSPORT_SAR_ARENA_SEG8_BLOCKS,
+    TRANSPORT_SAR_ARENA_SEG16_BLOCKS,
+    TRANSPORT_SAR_ARENA_SEG32_BLOCKS
+};
+
+static sar_arena_stats_t m_stats;
+
+void setUp(void)
+{
+    sar_arena_init();
+}
+
+void tearDown(void)
+{
+}
+
+void test_init(void)
+{
+    sar_arena_stats_get(&m_stats);
+    for (uint32_t i = 0; i < SAR_ARENA_CLASS_COUNT; ++i)
+    {
+        TEST_ASSERT_EQUAL(SAR_ARENA_SEGMENT_SIZE << i, m_stats.classes[i].block_size);
+        TEST_ASSERT_EQUAL(m_block_counts[i], m_stats.classes[i].block_count);
+        TEST_ASSERT_EQUAL(0, m_stats.classes[i].in_use);
+        TEST_ASSERT_EQUAL(0, m_stats.classes[i].high_water);
+    }
+    TEST_ASSERT_EQUAL(0, m_stats.bytes_in_use);
+    TEST_ASSERT_EQUAL(0, m_stats.bytes_high_water);
+    TEST_ASSERT_EQUAL(0, m_stats.alloc_failures);
+
+    TEST_ASSERT_NULL(sar_arena_alloc(0));
+    TEST_ASSERT_NULL(sar_arena_alloc(SAR_ARENA_BLOCK_SIZE_MAX + 1));
+    sar_arena_free(NULL);
+}
+
+void test_size_classes(void)
+{
+    /* Each size is served from the smallest class that fits it: */
+    for (uint32_t i = 0; i < SAR_ARENA_CLASS_COUNT; ++i)
+    {
+        uint32_t sizes[] = {(SAR_ARENA_SEGMENT_SIZE << i) / 2 + 1, SAR_ARENA_SEGMENT_SIZE << i};
+        for (uint32_t j = 0; j < ARRAY_SIZE(sizes); ++j)
+        {
+            uint8_t * p_block = sar_arena_alloc(sizes[j]);
+            TEST_ASSERT_NOT_NULL(p_block);
+            memset(p_block, 0xAB, sizes[j]);
+            sar_arena_stats_get(&m_stats);
+            TEST_ASSERT_EQUAL(1, m_stats.classes[i].in_use);
+            TEST_ASSERT_EQUAL(SAR_ARENA_SEGMENT_SIZE << i, m_stats.bytes_in_use);
+            sar_arena_free(p_block);
+        }
+    }
+
+    sar_arena_stats_get(&m_stats);
+    TEST_ASSERT_EQUAL(0, m_stats.bytes_in_use);
+    TEST_ASSERT_EQUAL(SAR_ARENA_BLOCK_SIZE_MAX, m_stats.bytes_high_water);
+    for (uint32_t i = 0; i < SAR_ARENA_CLASS_COUNT; ++i)
+    {
+        TEST_ASSERT_EQUAL(0, m_stats.classes[i].in_use);
+        TEST_ASSERT_EQUAL(1, m_stats.classes[i].high_water);
+    }
+}
+
+void test_fallback_and_exhaustion(void)
+{
+    uint32_t total_blocks = 0;
+    for (uint32_t i = 0; i < SAR_ARENA_CLASS_COUNT; ++i)
+    {
+        total_blocks += m_block_counts[i];
+    }
+
+    /* Single segment allocations spill over into the larger classes until the arena is full: */
+    uint8_t * p_blocks[total_blocks];
+    for (uint32_t i = 0; i < total_blocks; ++i)
+    {
+        p_blocks[i] = sar_arena_alloc(1);
+        TEST_ASSERT_NOT_NULL(p_blocks[i]);
+        /* Blocks don't overlap */
+        memset(p_blocks[i], i, 1);
+        for (uint32_t j = 0; j < i; ++j)
+        {
+            TEST_ASSERT_NOT_EQUAL(p_blocks[j], p_blocks[i]);
+        }
+    }
+    TEST_ASSERT_NULL(sar_arena_alloc(1));
+    TEST_ASSERT_NULL(sar_arena_alloc(SAR_ARENA_BLOCK_SIZE_MAX));
+
+    sar_arena_stats_get(&m_stats);
+    TEST_ASSERT_EQUAL(2, m_stats.alloc_failures);
+    for (uint32_t i = 0; i < SAR_ARENA_CLASS_COUNT; ++i)
+    {
+        TEST_ASSERT_EQUAL(m_block_counts[i], m_stats.classes[i].in_use);
+        TEST_ASSERT_EQUAL(m_block_counts[i], m_stats.classes[i].high_water);
+    }
+
+    /* A freed block is reused, and the high water marks remain: */
+    sar_arena_free(p_blocks[total_blocks - 1]);
+    TEST_ASSERT_NULL(sar_arena_alloc(SAR_ARENA_BLOCK_SIZE_MAX + 1));
+    TEST_ASSERT_EQUAL_PTR(p_blocks[total_blocks - 1], sar_arena_alloc(SAR_ARENA_BLOCK_SIZE_MAX));
+
+    for (uint32_t i = 0; i < total_blocks; ++i)
+    {
+        TEST_ASSERT_EQUAL_HEX8(i, p_blocks[i][0]);
+        sar_arena_free(p_blocks[i]);
+    }
+    sar_arena_stats_get(&m_stats);
+    TEST_ASSERT_EQUAL(0, m_stats.bytes_in_use);
+    for (uint32_t i = 0; i < SAR_ARENA_CLASS_COUNT; ++i)
+    {
+        TEST_ASSERT_EQUAL(0, m_stats.classes[i].in_use);
+        TEST_ASSERT_EQUAL(m_block_counts[i], m_stats.classes[i].high_water);
+    }
+}
+
+void test_invalid_free(void)
+{
+    uint8_t * p_block = sar_arena_alloc(SAR_ARENA_SEGMENT_SIZE * 2);
+    TEST_ASSERT_NOT_NULL(p_block);
+    TEST_NRF_MESH_ASSERT_EXPECT(sar_arena_free(p_block + 1));
+    uint8_t buffer[4];
+    TEST_NRF_MESH_ASSERT_EXPECT(sar_arena_free(buffer));
+    sar_arena_free(p_block);
+    /* Double free */
+    TEST_NRF_MESH_ASSERT_EXPECT(sar_arena_free(p_block));
+}
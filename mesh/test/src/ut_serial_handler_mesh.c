@@ -47,6 +47,7 @@
 #include "device_state_manager_mock.h"
 #include "nrf_mesh_mock.h"
 #include "nrf_mesh_events_mock.h"
+#include "transport_mock.h"
 
 #include "utils.h"
 #include "test_assert.h"
@@ -108,6 +109,7 @@ void setUp(void)
     nrf_mesh_events_mock_Init();
     net_state_mock_Init();
     access_mock_Init();
+    transport_mock_Init();
     m_expected_packet_send = 0;
     m_packet_send_return = 0;
     memset(&m_expected_tx_params, 0, sizeof(m_expected_tx_params));
@@ -128,6 +130,8 @@ void tearDown(void)
     net_state_mock_Destroy();
     access_mock_Verify();
     access_mock_Destroy();
+    transport_mock_Verify();
+    transport_mock_Destroy();
 }
 
 /*****************************************************************************
@@ -173,6 +177,82 @@ void test_stateclear()
     serial_handler_mesh_rx(&cmd);
 }
 
+void test_transport_stats(void)
+{
+    serial_packet_t cmd;
+
+    cmd.opcode = SERIAL_OPCODE_CMD_MESH_TRANSPORT_STATS_GET;
+    cmd.length = SERIAL_PACKET_LENGTH_OVERHEAD;
+    transport_stats_t stats;
+    memset(&stats, 0, sizeof(stats));
+    stats.segments_tx = 10;
+    stats.segments_rx = 20;
+    stats.retransmissions = 3;
+    stats.segments_dropped = 4;
+    stats.sessions_tx_completed = 5;
+    stats.sessions_rx_completed = 6;
+    stats.sessions_cancelled[NRF_MESH_SAR_CANCEL_REASON_RETRY_OVER] = 7;
+    stats.ack_latency[2] = 8;
+    stats.replay_rejections = 9;
+    transport_decrypt_stats_t decrypt_stats;
+    memset(&decrypt_stats, 0, sizeof(decrypt_stats));
+    decrypt_stats.messages = 11;
+    decrypt_stats.attempts = 12;
+
+    serial_evt_cmd_rsp_data_transport_stats_t expected_rsp;
+    memset(&expected_rsp, 0, sizeof(expected_rsp));
+    expected_rsp.segments_tx = 10;
+    expected_rsp.segments_rx = 20;
+    expected_rsp.retransmissions = 3;
+    expected_rsp.segments_dropped = 4;
+    expected_rsp.sessions_tx_completed = 5;
+    expected_rsp.sessions_rx_completed = 6;
+    expected_rsp.sessions_cancelled[NRF_MESH_SAR_CANCEL_REASON_RETRY_OVER] = 7;
+    expected_rsp.ack_latency[2] = 8;
+    expected_rsp.replay_rejections = 9;
+    expected_rsp.decrypt_messages = 11;
+    expected_rsp.decrypt_attempts = 12;
+
+    transport_stats_get_Expect(NULL);
+    transport_stats_get_IgnoreArg_p_stats();
+    transport_stats_get_ReturnThruPtr_p_stats(&stats);
+    transport_decrypt_stats_get_Expect(NULL);
+    transport_decrypt_stats_get_IgnoreArg_p_stats();
+    transport_decrypt_stats_get_ReturnThruPtr_p_stats(&decrypt_stats);
+    serial_translate_error_ExpectAndReturn(NRF_SUCCESS, SERIAL_STATUS_SUCCESS);
+    serial_cmd_rsp_send_ExpectWithArray(cmd.opcode, SERIAL_STATUS_SUCCESS, (uint8_t *) &expected_rsp, sizeof(expected_rsp), sizeof(expected_rsp));
+    serial_handler_mesh_rx(&cmd);
+    CMD_LENGTH_CHECK(cmd.opcode, cmd.length);
+
+    cmd.opcode = SERIAL_OPCODE_CMD_MESH_TRANSPORT_PEER_STATS_GET;
+    cmd.length = SERIAL_PACKET_LENGTH_OVERHEAD + sizeof(serial_cmd_mesh_transport_peer_stats_get_t);
+    cmd.payload.cmd.mesh.transport_peer_stats_get.index = 2;
+    transport_peer_stats_t peer_stats;
+    peer_stats.address = 0x1234;
+    peer_stats.segments_tx = 1;
+    peer_stats.segments_rx = 2;
+    peer_stats.retransmissions = 3;
+    peer_stats.sessions_completed = 4;
+    peer_stats.sessions_cancelled = 5;
+    peer_stats.replay_rejections = 6;
+    serial_evt_cmd_rsp_data_transport_peer_stats_t expected_peer_rsp = {0x1234, 1, 2, 3, 4, 5, 6};
+
+    transport_peer_stats_get_ExpectAndReturn(2, NULL, NRF_SUCCESS);
+    transport_peer_stats_get_IgnoreArg_p_stats();
+    transport_peer_stats_get_ReturnThruPtr_p_stats(&peer_stats);
+    serial_translate_error_ExpectAndReturn(NRF_SUCCESS, SERIAL_STATUS_SUCCESS);
+    serial_cmd_rsp_send_ExpectWithArray(cmd.opcode, SERIAL_STATUS_SUCCESS, (uint8_t *) &expected_peer_rsp, sizeof(expected_peer_rsp), sizeof(expected_peer_rsp));
+    serial_handler_mesh_rx(&cmd);
+
+    /* No peer with the given index: */
+    transport_peer_stats_get_ExpectAndReturn(2, NULL, NRF_ERROR_NOT_FOUND);
+    transport_peer_stats_get_IgnoreArg_p_stats();
+    serial_translate_error_ExpectAndReturn(NRF_ERROR_NOT_FOUND, SERIAL_STATUS_ERROR_INVALID_PARAMETER);
+    serial_cmd_rsp_send_ExpectWithArray(cmd.opcode, SERIAL_STATUS_ERROR_INVALID_PARAMETER, NULL, 0, 0);
+    serial_handler_mesh_rx(&cmd);
+    CMD_LENGTH_CHECK(cmd.opcode, cmd.length);
+}
+
 void test_subnet(void)
 {
     serial_packet_t cmd;
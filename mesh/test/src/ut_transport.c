@@ -41,6 +41,7 @@
 
 #include "utils.h"
 #include "packet_mesh.h"
+#include "sar_arena.h"
 
 #include "bearer_event_mock.h"
 #include "network_mock.h"
@@ -235,6 +236,17 @@ void test_control_handlers(void)
                                         &m_rx_meta));
     TEST_ASSERT_EQUAL(0, m_expected_control_packet_handler);
 
+    /* All packets are counted by opcode, handled or not: */
+    transport_control_stats_t stats;
+    transport_control_stats_get(&stats);
+    for (uint32_t opcode = 0; opcode <= TRANSPORT_CONTROL_PACKET_OPCODE_MAX; ++opcode)
+    {
+        uint32_t expected_count = (opcode == TRANSPORT_CONTROL_OPCODE_HEARTBEAT ||
+                                   opcode == TRANSPORT_CONTROL_OPCODE_FRIEND_SUBSCRIPTION_LIST_REMOVE ||
+                                   opcode == 0x50 ||
+                                   opcode == TRANSPORT_CONTROL_OPCODE_FRIEND_CLEAR) ? 1 : 0;
+        TEST_ASSERT_EQUAL(expected_count, stats.rx_count[opcode]);
+    }
 
     /* Overflow consumer count */
     transport_control_packet_handler_t overflow_handler = {
@@ -246,6 +258,15 @@ void test_control_handlers(void)
     /* reset handler array */
     expect_init();
     transport_init(NULL);
+    transport_control_stats_get(&stats);
+    TEST_ASSERT_EQUAL(0, stats.rx_count[TRANSPORT_CONTROL_OPCODE_HEARTBEAT]);
+
+    /* duplicate within the same consumer: */
+    const transport_control_packet_handler_t duplicate_handlers[] = {
+        {0x60, control_packet_handler},
+        {0x60, control_packet_handler},
+    };
+    TEST_ASSERT_EQUAL(NRF_ERROR_FORBIDDEN, transport_control_packet_consumer_add(duplicate_handlers, ARRAY_SIZE(duplicate_handlers)));
 
     /* builtin opcode, considered duplicate: */
     transport_control_packet_handler_t duplicate_handler = {
@@ -272,6 +293,216 @@ void test_control_handlers(void)
     TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_DATA, transport_control_packet_consumer_add(&out_of_bounds_handler, 1));
 }
 
+static const nrf_mesh_application_secmat_t m_app_secmats[3];
+static uint32_t m_app_secmat_candidates;
+static void app_secmat_next_get_callback(const nrf_mesh_network_secmat_t * p_network_secmat,
+                                         uint8_t aid,
+                                         const nrf_mesh_application_secmat_t ** pp_app_secmat,
+                                         int calls)
+{
+    TEST_ASSERT_EQUAL_PTR(&m_net_secmat, p_network_secmat);
+    TEST_ASSERT_EQUAL_HEX8(0x2A, aid);
+    uint32_t next = (*pp_app_secmat == NULL) ? 0 : (uint32_t) (*pp_app_secmat - &m_app_secmats[0]) + 1;
+    *pp_app_secmat = (next < m_app_secmat_candidates) ? &m_app_secmats[next] : NULL;
+}
+
+static const nrf_mesh_application_secmat_t * mp_decrypting_app_secmat;
+static const uint8_t * mp_decrypting_virtual_uuid;
+static void aes_ccm_decrypt_callback(ccm_soft_data_t * const p_ccm_data, bool * const p_mic_passed, int calls)
+{
+    *p_mic_passed = (mp_decrypting_app_secmat != NULL && p_ccm_data->p_key == mp_decrypting_app_secmat->key);
+    if (p_ccm_data->a_len > 0)
+    {
+        TEST_ASSERT_EQUAL(NRF_MESH_UUID_SIZE, p_ccm_data->a_len);
+        *p_mic_passed = *p_mic_passed && (p_ccm_data->p_a == mp_decrypting_virtual_uuid);
+    }
+}
+
+#define TEST_VIRTUAL_ADDRESS 0x8123
+static const uint8_t m_virtual_uuids[3][NRF_MESH_UUID_SIZE] = {{1}, {2}, {3}};
+static uint32_t m_virtual_uuid_count;
+static bool rx_address_get_callback(uint16_t raw_address, nrf_mesh_address_t * p_address, int calls)
+{
+    TEST_ASSERT_EQUAL_HEX16(TEST_VIRTUAL_ADDRESS, raw_address);
+    uint32_t next = (p_address->p_virtual_uuid == NULL) ? 0 : (uint32_t) ((const uint8_t (*)[NRF_MESH_UUID_SIZE]) p_address->p_virtual_uuid - &m_virtual_uuids[0]) + 1;
+    if (next >= m_virtual_uuid_count)
+    {
+        return false;
+    }
+    p_address->type = NRF_MESH_ADDRESS_TYPE_VIRTUAL;
+    p_address->value = raw_address;
+    p_address->p_virtual_uuid = m_virtual_uuids[next];
+    return true;
+}
+
+static nrf_mesh_evt_t m_rx_evt;
+static void event_handle_callback(const nrf_mesh_evt_t * p_evt, int calls)
+{
+    TEST_ASSERT_EQUAL(NRF_MESH_EVT_MESSAGE_RECEIVED, p_evt->type);
+    m_rx_evt = *p_evt;
+}
+
+void test_app_key_decrypt_stats(void)
+{
+    expect_init();
+    transport_init(NULL);
+    replay_cache_has_elem_IgnoreAndReturn(false);
+    replay_cache_add_IgnoreAndReturn(NRF_SUCCESS);
+    enc_nonce_generate_Ignore();
+    nrf_mesh_app_secmat_next_get_StubWithCallback(app_secmat_next_get_callback);
+    enc_aes_ccm_decrypt_StubWithCallback(aes_ccm_decrypt_callback);
+
+    transport_decrypt_stats_t stats;
+    transport_decrypt_stats_get(&stats);
+    TEST_ASSERT_EQUAL(0, stats.app_key_hits);
+    TEST_ASSERT_EQUAL(0, stats.app_key_misses);
+
+    nrf_mesh_address_t dst = {NRF_MESH_ADDRESS_TYPE_UNICAST, 0x0001, NULL};
+    network_packet_metadata_t net_meta;
+    memset(&net_meta, 0, sizeof(net_meta));
+    net_meta.dst = dst;
+    net_meta.src = 0x0004;
+    net_meta.p_security_material = &m_net_secmat;
+
+    packet_mesh_trs_packet_t transport_packet;
+    memset(&transport_packet, 0, sizeof(transport_packet));
+    packet_mesh_trs_common_seg_set(&transport_packet, false);
+    packet_mesh_trs_access_akf_set(&transport_packet, true);
+    packet_mesh_trs_access_aid_set(&transport_packet, 0x2A);
+
+    /* The last of three candidates decrypts the packet: */
+    m_app_secmat_candidates = 3;
+    mp_decrypting_app_secmat = &m_app_secmats[2];
+    nrf_mesh_rx_address_get_ExpectAndReturn(0x0001, NULL, true);
+    nrf_mesh_rx_address_get_IgnoreArg_p_address();
+    nrf_mesh_rx_address_get_ReturnThruPtr_p_address(&dst);
+    event_handle_ExpectAnyArgs();
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, transport_packet_in(&transport_packet, PACKET_MESH_TRS_UNSEG_PDU_OFFSET + 8, &net_meta, &m_rx_meta));
+    transport_decrypt_stats_get(&stats);
+    TEST_ASSERT_EQUAL(1, stats.app_key_hits);
+    TEST_ASSERT_EQUAL(2, stats.app_key_misses);
+    TEST_ASSERT_EQUAL(1, stats.messages);
+    TEST_ASSERT_EQUAL(3, stats.attempts);
+
+    /* None of the candidates decrypt the packet: */
+    mp_decrypting_app_secmat = NULL;
+    nrf_mesh_rx_address_get_ExpectAndReturn(0x0001, NULL, true);
+    nrf_mesh_rx_address_get_IgnoreArg_p_address();
+    nrf_mesh_rx_address_get_ReturnThruPtr_p_address(&dst);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, transport_packet_in(&transport_packet, PACKET_MESH_TRS_UNSEG_PDU_OFFSET + 8, &net_meta, &m_rx_meta));
+    transport_decrypt_stats_get(&stats);
+    TEST_ASSERT_EQUAL(1, stats.app_key_hits);
+    TEST_ASSERT_EQUAL(5, stats.app_key_misses);
+
+    /* No candidates, no attempts: */
+    m_app_secmat_candidates = 0;
+    nrf_mesh_rx_address_get_ExpectAndReturn(0x0001, NULL, true);
+    nrf_mesh_rx_address_get_IgnoreArg_p_address();
+    nrf_mesh_rx_address_get_ReturnThruPtr_p_address(&dst);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, transport_packet_in(&transport_packet, PACKET_MESH_TRS_UNSEG_PDU_OFFSET + 8, &net_meta, &m_rx_meta));
+    transport_decrypt_stats_get(&stats);
+    TEST_ASSERT_EQUAL(1, stats.app_key_hits);
+    TEST_ASSERT_EQUAL(5, stats.app_key_misses);
+    TEST_ASSERT_EQUAL(3, stats.messages);
+    TEST_ASSERT_EQUAL(6, stats.attempts);
+
+    /* Statistics are reset by init: */
+    expect_init();
+    transport_init(NULL);
+    transport_decrypt_stats_get(&stats);
+    TEST_ASSERT_EQUAL(0, stats.app_key_hits);
+    TEST_ASSERT_EQUAL(0, stats.app_key_misses);
+}
+
+static void virtual_packet_rx_verify(uint16_t src, const uint8_t * p_uuid, const nrf_mesh_application_secmat_t * p_app_secmat,
+                                     uint32_t decryptions, bool cache_hit)
+{
+    transport_decrypt_stats_t old_stats;
+    transport_decrypt_stats_get(&old_stats);
+
+    mp_decrypting_virtual_uuid = p_uuid;
+    mp_decrypting_app_secmat = p_app_secmat;
+    memset(&m_rx_evt, 0, sizeof(m_rx_evt));
+
+    network_packet_metadata_t net_meta;
+    memset(&net_meta, 0, sizeof(net_meta));
+    net_meta.dst.value = TEST_VIRTUAL_ADDRESS;
+    net_meta.src = src;
+    net_meta.p_security_material = &m_net_secmat;
+
+    packet_mesh_trs_packet_t transport_packet;
+    memset(&transport_packet, 0, sizeof(transport_packet));
+    packet_mesh_trs_common_seg_set(&transport_packet, false);
+    packet_mesh_trs_access_akf_set(&transport_packet, true);
+    packet_mesh_trs_access_aid_set(&transport_packet, 0x2A);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, transport_packet_in(&transport_packet, PACKET_MESH_TRS_UNSEG_PDU_OFFSET + 8, &net_meta, &m_rx_meta));
+
+    TEST_ASSERT_EQUAL_PTR(p_uuid, m_rx_evt.params.message.dst.p_virtual_uuid);
+    TEST_ASSERT_EQUAL_PTR(p_app_secmat, m_rx_evt.params.message.secmat.p_app);
+
+    transport_decrypt_stats_t stats;
+    transport_decrypt_stats_get(&stats);
+    TEST_ASSERT_EQUAL(old_stats.app_key_hits + 1, stats.app_key_hits);
+    TEST_ASSERT_EQUAL(old_stats.app_key_misses + decryptions - 1, stats.app_key_misses);
+    TEST_ASSERT_EQUAL(old_stats.virtual_cache_hits + (cache_hit ? 1 : 0), stats.virtual_cache_hits);
+    TEST_ASSERT_EQUAL(old_stats.virtual_cache_misses + (cache_hit ? 0 : 1), stats.virtual_cache_misses);
+}
+
+void test_virtual_resolution_cache(void)
+{
+    expect_init();
+    transport_init(NULL);
+    replay_cache_has_elem_IgnoreAndReturn(false);
+    replay_cache_add_IgnoreAndReturn(NRF_SUCCESS);
+    enc_nonce_generate_Ignore();
+    nrf_mesh_app_secmat_next_get_StubWithCallback(app_secmat_next_get_callback);
+    nrf_mesh_rx_address_get_StubWithCallback(rx_address_get_callback);
+    enc_aes_ccm_decrypt_StubWithCallback(aes_ccm_decrypt_callback);
+    event_handle_StubWithCallback(event_handle_callback);
+
+    m_app_secmat_candidates = 2;
+    m_virtual_uuid_count = 3;
+
+    /* The first packet searches all label UUID and application key pairs: */
+    virtual_packet_rx_verify(0x0004, m_virtual_uuids[2], &m_app_secmats[1], 6, false);
+    /* The next packet from the same source only needs a single decryption: */
+    virtual_packet_rx_verify(0x0004, m_virtual_uuids[2], &m_app_secmats[1], 1, true);
+    /* Other sources have their own resolution: */
+    virtual_packet_rx_verify(0x0005, m_virtual_uuids[0], &m_app_secmats[0], 1, false);
+    virtual_packet_rx_verify(0x0005, m_virtual_uuids[0], &m_app_secmats[0], 1, true);
+    virtual_packet_rx_verify(0x0004, m_virtual_uuids[2], &m_app_secmats[1], 1, true);
+
+    /* The source switches to another label UUID, the stale resolution costs one extra decryption: */
+    virtual_packet_rx_verify(0x0004, m_virtual_uuids[1], &m_app_secmats[1], 5, false);
+    virtual_packet_rx_verify(0x0004, m_virtual_uuids[1], &m_app_secmats[1], 1, true);
+    /* The search skips the pair that was already tried with the stale resolution: */
+    virtual_packet_rx_verify(0x0004, m_virtual_uuids[2], &m_app_secmats[0], 5, false);
+    virtual_packet_rx_verify(0x0004, m_virtual_uuids[2], &m_app_secmats[0], 1, true);
+
+    /* Resolutions for label UUIDs that are no longer subscribed to are not used: */
+    m_virtual_uuid_count = 1;
+    virtual_packet_rx_verify(0x0004, m_virtual_uuids[0], &m_app_secmats[1], 2, false);
+
+    /* Resolutions for application keys that are no longer candidates are not used: */
+    m_app_secmat_candidates = 1;
+    virtual_packet_rx_verify(0x0005, m_virtual_uuids[0], &m_app_secmats[0], 1, true);
+    virtual_packet_rx_verify(0x0004, m_virtual_uuids[0], &m_app_secmats[0], 1, false);
+    virtual_packet_rx_verify(0x0004, m_virtual_uuids[0], &m_app_secmats[0], 1, true);
+
+    /* Filling the cache evicts the oldest resolution: */
+    for (uint16_t src = 0x0100; src < 0x0100 + TRANSPORT_VIRTUAL_RESOLUTION_CACHE_SIZE; ++src)
+    {
+        virtual_packet_rx_verify(src, m_virtual_uuids[0], &m_app_secmats[0], 1, false);
+    }
+    virtual_packet_rx_verify(0x0005, m_virtual_uuids[0], &m_app_secmats[0], 1, false);
+    virtual_packet_rx_verify(0x0100 + TRANSPORT_VIRTUAL_RESOLUTION_CACHE_SIZE - 1, m_virtual_uuids[0], &m_app_secmats[0], 1, true);
+
+    /* The cache is cleared by init: */
+    expect_init();
+    transport_init(NULL);
+    virtual_packet_rx_verify(0x0004, m_virtual_uuids[0], &m_app_secmats[0], 1, false);
+}
+
 void test_control_tx(void)
 {
     expect_init();
@@ -316,3 +547,942 @@ void test_control_tx(void)
     TEST_ASSERT_EQUAL_HEX8(control_packet.opcode, network_packet_buffer[0]); /* opcode */
     TEST_ASSERT_EQUAL_HEX8_ARRAY(control_packet_buffer, &network_packet_buffer[1], control_packet.data_len); /* payload */
 }
+
+#define SAR_TEST_DST 0x0001
+static bool unicast_rx_address_get_callback(uint16_t raw_address, nrf_mesh_address_t * p_address, int calls)
+{
+    TEST_ASSERT_EQUAL_HEX16(SAR_TEST_DST, raw_address);
+    p_address->type = NRF_MESH_ADDRESS_TYPE_UNICAST;
+    p_address->value = raw_address;
+    p_address->p_virtual_uuid = NULL;
+    return true;
+}
+
+static uint8_t m_segack_buffer[64];
+static uint32_t m_segack_count;
+static uint32_t segack_alloc_callback(network_tx_packet_buffer_t * p_buf, int calls)
+{
+    TEST_ASSERT_TRUE(p_buf->user_data.p_metadata->control_packet);
+    TEST_ASSERT_EQUAL_HEX16(SAR_TEST_DST, p_buf->user_data.p_metadata->src);
+    p_buf->role = CORE_TX_ROLE_ORIGINATOR;
+    p_buf->p_payload = m_segack_buffer;
+    m_segack_count++;
+    return NRF_SUCCESS;
+}
+
+static uint32_t last_segack_block_ack_get(void)
+{
+    TEST_ASSERT_EQUAL_HEX8(TRANSPORT_CONTROL_OPCODE_SEGACK, m_segack_buffer[0]);
+    return packet_mesh_trs_control_segack_block_ack_get((const packet_mesh_trs_control_packet_t *) &m_segack_buffer[1]);
+}
+
+/** Receives a segment of a control message with SeqZero equal to the source address. */
+static void sar_control_segment_rx(uint16_t src, uint8_t segment_offset, uint8_t last_segment, const uint8_t * p_data, uint32_t length)
+{
+    network_packet_metadata_t net_meta;
+    memset(&net_meta, 0, sizeof(net_meta));
+    net_meta.dst.type = NRF_MESH_ADDRESS_TYPE_UNICAST;
+    net_meta.dst.value = SAR_TEST_DST;
+    net_meta.src = src;
+    net_meta.ttl = 1;
+    net_meta.control_packet = true;
+    net_meta.internal.sequence_number = src + segment_offset;
+    net_meta.p_security_material = &m_net_secmat;
+
+    packet_mesh_trs_packet_t transport_packet;
+    memset(&transport_packet, 0, sizeof(transport_packet));
+    packet_mesh_trs_common_seg_set(&transport_packet, true);
+    packet_mesh_trs_control_opcode_set(&transport_packet, TRANSPORT_CONTROL_OPCODE_HEARTBEAT);
+    packet_mesh_trs_seg_seqzero_set(&transport_packet, src);
+    packet_mesh_trs_seg_sego_set(&transport_packet, segment_offset);
+    packet_mesh_trs_seg_segn_set(&transport_packet, last_segment);
+    memcpy(packet_mesh_trs_seg_payload_get(&transport_packet), p_data, length);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS,
+                      transport_packet_in(&transport_packet, PACKET_MESH_TRS_SEG_PDU_OFFSET + length, &net_meta, &m_rx_meta));
+}
+
+/** Receives one of the two segments of a control message with SeqZero equal to the source address. */
+static void sar_segment_rx(uint16_t src, uint8_t segment_offset)
+{
+    const uint8_t data[PACKET_MESH_TRS_SEG_CONTROL_PDU_MAX_SIZE] = {0};
+    sar_control_segment_rx(src, segment_offset, 1, data, sizeof(data));
+}
+
+void test_sar_rx_sessions(void)
+{
+    expect_init();
+    transport_init(NULL);
+    replay_cache_has_elem_IgnoreAndReturn(false);
+    replay_cache_add_IgnoreAndReturn(NRF_SUCCESS);
+    nrf_mesh_rx_address_get_StubWithCallback(unicast_rx_address_get_callback);
+    network_packet_alloc_StubWithCallback(segack_alloc_callback);
+    network_packet_send_Ignore();
+    timer_now_IgnoreAndReturn(0);
+    timer_sch_reschedule_Ignore();
+    timer_sch_abort_Ignore();
+    net_state_iv_index_lock_Ignore();
+    m_segack_count = 0;
+
+    /* Occupy all sessions: */
+    for (uint16_t i = 0; i < TRANSPORT_SAR_SESSIONS_MAX; ++i)
+    {
+        sar_segment_rx(0x0100 + i, 0);
+    }
+    TEST_ASSERT_EQUAL(0, m_segack_count);
+
+    /* A new session doesn't fit, and is neither acknowledged nor reported as cancelled. The peer
+     * backs off and retransmits: */
+    sar_segment_rx(0x0200, 0);
+    TEST_ASSERT_EQUAL(0, m_segack_count);
+
+    /* Completing a session makes room for the new one: */
+    sar_segment_rx(0x0101, 1);
+    TEST_ASSERT_EQUAL(1, m_segack_count);
+    TEST_ASSERT_EQUAL_HEX32(0x3, last_segack_block_ack_get());
+
+    sar_segment_rx(0x0200, 0);
+    TEST_ASSERT_EQUAL(1, m_segack_count);
+    sar_segment_rx(0x0200, 1);
+    TEST_ASSERT_EQUAL(2, m_segack_count);
+    TEST_ASSERT_EQUAL_HEX32(0x3, last_segack_block_ack_get());
+
+    /* The remaining sessions are still found by their source: */
+    for (uint16_t i = 0; i < TRANSPORT_SAR_SESSIONS_MAX; ++i)
+    {
+        if (i != 1)
+        {
+            uint32_t segacks = m_segack_count;
+            sar_segment_rx(0x0100 + i, 1);
+            TEST_ASSERT_EQUAL(segacks + 1, m_segack_count);
+            TEST_ASSERT_EQUAL_HEX32(0x3, last_segack_block_ack_get());
+        }
+    }
+
+    /* All sessions are free again: */
+    for (uint16_t i = 0; i < TRANSPORT_SAR_SESSIONS_MAX; ++i)
+    {
+        sar_segment_rx(0x0300 + i, 0);
+    }
+    uint32_t segacks = m_segack_count;
+    for (uint16_t i = 0; i < TRANSPORT_SAR_SESSIONS_MAX; ++i)
+    {
+        sar_segment_rx(0x0300 + i, 1);
+    }
+    TEST_ASSERT_EQUAL(segacks + TRANSPORT_SAR_SESSIONS_MAX, m_segack_count);
+}
+
+#define SAR_TEST_PEER 0x0003
+#define SAR_TX_TEST_TTL 2
+
+static timestamp_t m_time_now;
+static timestamp_t timer_now_callback(int calls)
+{
+    return m_time_now;
+}
+
+static timer_event_t * mp_retry_timer;
+static void retry_timer_reschedule_callback(timer_event_t * p_timer_evt, timestamp_t new_timestamp, int calls)
+{
+    mp_retry_timer = p_timer_evt;
+    p_timer_evt->timestamp = new_timestamp;
+}
+
+static bearer_event_flag_callback_t m_sar_process_cb;
+static bearer_event_flag_t bearer_event_flag_add_callback(bearer_event_flag_callback_t callback, int calls)
+{
+    m_sar_process_cb = callback;
+    return BEARER_FLAG;
+}
+
+static core_tx_complete_cb_t m_tx_complete_cb;
+static void core_tx_complete_cb_set_callback(core_tx_complete_cb_t tx_complete_callback, int calls)
+{
+    m_tx_complete_cb = tx_complete_callback;
+}
+
+static uint32_t m_sar_tx_complete_count;
+static uint32_t m_sar_tx_failed_count;
+static void sar_tx_event_handle_callback(const nrf_mesh_evt_t * p_evt, int calls)
+{
+    if (p_evt->type == NRF_MESH_EVT_SAR_FAILED)
+    {
+        TEST_ASSERT_EQUAL(TX_TOKEN, p_evt->params.sar_failed.token);
+        m_sar_tx_failed_count++;
+    }
+    else
+    {
+        TEST_ASSERT_EQUAL(NRF_MESH_EVT_TX_COMPLETE, p_evt->type);
+        TEST_ASSERT_EQUAL(TX_TOKEN, p_evt->params.tx_complete.token);
+        m_sar_tx_complete_count++;
+    }
+}
+
+static uint8_t m_sar_tx_buffer[64];
+static uint32_t m_sar_tx_seqnum;
+static uint32_t m_sar_tx_segments;
+static uint16_t m_sar_tx_segment_dsts[64];
+static bool m_sar_tx_no_mem;
+static uint32_t sar_tx_alloc_callback(network_tx_packet_buffer_t * p_buf, int calls)
+{
+    TEST_ASSERT_EQUAL_HEX16(SAR_TEST_DST, p_buf->user_data.p_metadata->src);
+    if (m_sar_tx_no_mem)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+    p_buf->role = CORE_TX_ROLE_ORIGINATOR;
+    p_buf->p_payload = m_sar_tx_buffer;
+    p_buf->user_data.p_metadata->internal.sequence_number = m_sar_tx_seqnum++;
+    TEST_ASSERT_TRUE(m_sar_tx_segments < ARRAY_SIZE(m_sar_tx_segment_dsts));
+    m_sar_tx_segment_dsts[m_sar_tx_segments++] = p_buf->user_data.p_metadata->dst.value;
+    return NRF_SUCCESS;
+}
+
+/** Starts sending a reliable control message, and returns its SeqZero if it's sent right away. */
+static uint16_t sar_tx_start(uint16_t dst, uint32_t segment_count)
+{
+    static const uint8_t data[NRF_MESH_SEG_PAYLOAD_SIZE_MAX] = {0};
+    transport_control_packet_t control_packet;
+    control_packet.data_len           = segment_count * PACKET_MESH_TRS_SEG_CONTROL_PDU_MAX_SIZE;
+    control_packet.dst.p_virtual_uuid = NULL;
+    control_packet.dst.value          = dst;
+    control_packet.dst.type           = NRF_MESH_ADDRESS_TYPE_UNICAST;
+    control_packet.opcode             = TRANSPORT_CONTROL_OPCODE_HEARTBEAT;
+    control_packet.p_data             = (const packet_mesh_trs_control_packet_t *) data;
+    control_packet.p_net_secmat       = &m_net_secmat;
+    control_packet.reliable           = true;
+    control_packet.src                = SAR_TEST_DST;
+    control_packet.ttl                = SAR_TX_TEST_TTL;
+
+    uint16_t seq_zero = m_sar_tx_seqnum;
+    m_sar_tx_segments = 0;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, transport_control_tx(&control_packet, TX_TOKEN));
+    return seq_zero;
+}
+
+/** Receives a segment acknowledgment from the peer. */
+static void segack_rx(uint16_t seq_zero, uint32_t block_ack)
+{
+    static uint32_t segack_seqnum;
+    network_packet_metadata_t net_meta;
+    memset(&net_meta, 0, sizeof(net_meta));
+    net_meta.dst.type = NRF_MESH_ADDRESS_TYPE_UNICAST;
+    net_meta.dst.value = SAR_TEST_DST;
+    net_meta.src = SAR_TEST_PEER;
+    net_meta.ttl = 1;
+    net_meta.control_packet = true;
+    net_meta.internal.sequence_number = segack_seqnum++;
+    net_meta.p_security_material = &m_net_secmat;
+
+    packet_mesh_trs_packet_t transport_packet;
+    memset(&transport_packet, 0, sizeof(transport_packet));
+    packet_mesh_trs_common_seg_set(&transport_packet, false);
+    packet_mesh_trs_control_opcode_set(&transport_packet, TRANSPORT_CONTROL_OPCODE_SEGACK);
+    packet_mesh_trs_control_packet_t * p_segack =
+        (packet_mesh_trs_control_packet_t *) packet_mesh_trs_unseg_payload_get(&transport_packet);
+    packet_mesh_trs_control_segack_seqzero_set(p_segack, seq_zero);
+    packet_mesh_trs_control_segack_block_ack_set(p_segack, block_ack);
+    m_sar_tx_segments = 0;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS,
+                      transport_packet_in(&transport_packet,
+                                          PACKET_MESH_TRS_UNSEG_PDU_OFFSET + PACKET_MESH_TRS_CONTROL_SEGACK_SIZE,
+                                          &net_meta,
+                                          &m_rx_meta));
+}
+
+/**
+ * Puts the SAR buffers in the SAR arena. Sessions that are still in progress at the end of a test
+ * are dropped by the next transport_init(), and would leak their buffers from the heap.
+ */
+static void sar_arena_use(void)
+{
+    sar_arena_init();
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, transport_sar_mem_funcs_set(sar_arena_alloc, sar_arena_free));
+}
+
+static void sar_tx_test_init(void)
+{
+    replay_cache_init_Expect();
+    bearer_event_flag_add_StubWithCallback(bearer_event_flag_add_callback);
+    core_tx_complete_cb_set_StubWithCallback(core_tx_complete_cb_set_callback);
+    transport_init(NULL);
+    sar_arena_use();
+    timer_now_StubWithCallback(timer_now_callback);
+    timer_sch_reschedule_StubWithCallback(retry_timer_reschedule_callback);
+    timer_sch_abort_Ignore();
+    net_state_iv_index_lock_Ignore();
+    replay_cache_has_elem_IgnoreAndReturn(false);
+    replay_cache_add_IgnoreAndReturn(NRF_SUCCESS);
+    nrf_mesh_rx_address_get_StubWithCallback(unicast_rx_address_get_callback);
+    network_packet_alloc_StubWithCallback(sar_tx_alloc_callback);
+    network_packet_send_Ignore();
+    event_handle_StubWithCallback(sar_tx_event_handle_callback);
+    bearer_event_flag_set_Ignore();
+    m_sar_tx_complete_count = 0;
+    m_sar_tx_failed_count = 0;
+    m_sar_tx_seqnum = 0x0100;
+    m_sar_tx_no_mem = false;
+    m_time_now = 1000;
+}
+
+void test_sar_tx_retry_timeout(void)
+{
+    sar_tx_test_init();
+
+    const uint32_t fixed_interval = TRANSPORT_SAR_TX_RETRY_BASE_TIMEOUT_DEFAULT_US +
+                                    TRANSPORT_SAR_TX_RETRY_PER_HOP_ADDITION_DEFAULT_US * SAR_TX_TEST_TTL;
+
+    /* Nothing is known about the peer before the first acknowledgment: */
+    uint16_t seq_zero = sar_tx_start(SAR_TEST_PEER, 3);
+    TEST_ASSERT_EQUAL(3, m_sar_tx_segments);
+    TEST_ASSERT_EQUAL(fixed_interval, mp_retry_timer->interval);
+    TEST_ASSERT_EQUAL(m_time_now + fixed_interval, mp_retry_timer->timestamp);
+
+    m_time_now += 300000;
+    segack_rx(seq_zero, 0x7);
+    TEST_ASSERT_EQUAL(0, m_sar_tx_segments);
+    TEST_ASSERT_EQUAL(1, m_sar_tx_complete_count);
+
+    /* The next message uses the first round trip time sample: SRTT + 4 * SRTT / 2. */
+    seq_zero = sar_tx_start(SAR_TEST_PEER, 3);
+#if TRANSPORT_SAR_TX_ADAPTIVE_RETRY_ENABLED
+    TEST_ASSERT_EQUAL(900000, mp_retry_timer->interval);
+#else
+    TEST_ASSERT_EQUAL(fixed_interval, mp_retry_timer->interval);
+#endif
+
+    /* Only the missing segment is retransmitted after a partial acknowledgment, and the second
+     * sample reduces the variation: */
+    m_time_now += 300000;
+    segack_rx(seq_zero, 0x5);
+    TEST_ASSERT_EQUAL(1, m_sar_tx_segments);
+    TEST_ASSERT_EQUAL(1, m_sar_tx_complete_count);
+#if TRANSPORT_SAR_TX_ADAPTIVE_RETRY_ENABLED
+    TEST_ASSERT_EQUAL(750000, mp_retry_timer->interval);
+#else
+    TEST_ASSERT_EQUAL(fixed_interval, mp_retry_timer->interval);
+#endif
+
+    /* Unanswered rounds double the timeout: */
+    for (uint32_t i = 1; i <= 2; ++i)
+    {
+        m_sar_tx_segments = 0;
+        m_time_now = mp_retry_timer->timestamp;
+        mp_retry_timer->cb(m_time_now, mp_retry_timer->p_context);
+        TEST_ASSERT_EQUAL(1, m_sar_tx_segments);
+#if TRANSPORT_SAR_TX_ADAPTIVE_RETRY_ENABLED
+        TEST_ASSERT_EQUAL(750000 << i, mp_retry_timer->interval);
+#else
+        TEST_ASSERT_EQUAL(fixed_interval, mp_retry_timer->interval);
+#endif
+    }
+
+    /* The acknowledgment of a retransmission can't be matched to a transmission, and isn't used as
+     * a sample: */
+    m_time_now += 10;
+    segack_rx(seq_zero, 0x2);
+    TEST_ASSERT_EQUAL(0, m_sar_tx_segments);
+    TEST_ASSERT_EQUAL(2, m_sar_tx_complete_count);
+
+    seq_zero = sar_tx_start(SAR_TEST_PEER, 20);
+#if TRANSPORT_SAR_TX_ADAPTIVE_RETRY_ENABLED
+    TEST_ASSERT_EQUAL(750000, mp_retry_timer->interval);
+
+    /* Long messages are sent in bursts, as the previous segments are transmitted: */
+    TEST_ASSERT_EQUAL(TRANSPORT_SAR_TX_PACING_WINDOW, m_sar_tx_segments);
+    uint32_t sent = m_sar_tx_segments;
+    while (sent < 20)
+    {
+        m_sar_tx_segments = 0;
+        m_tx_complete_cb(CORE_TX_ROLE_ORIGINATOR, 0, m_time_now, NRF_MESH_SAR_TOKEN);
+        TEST_ASSERT_TRUE(m_sar_process_cb());
+        TEST_ASSERT_EQUAL(MIN(TRANSPORT_SAR_TX_PACING_WINDOW, 20 - sent), m_sar_tx_segments);
+        sent += m_sar_tx_segments;
+    }
+    m_sar_tx_segments = 0;
+    m_tx_complete_cb(CORE_TX_ROLE_ORIGINATOR, 0, m_time_now, NRF_MESH_SAR_TOKEN);
+    TEST_ASSERT_TRUE(m_sar_process_cb());
+    TEST_ASSERT_EQUAL(0, m_sar_tx_segments);
+#else
+    TEST_ASSERT_EQUAL(20, m_sar_tx_segments);
+#endif
+
+    m_time_now += 100000;
+    segack_rx(seq_zero, 0xFFFFF);
+    TEST_ASSERT_EQUAL(3, m_sar_tx_complete_count);
+}
+
+void test_sar_tx_pipeline(void)
+{
+    sar_tx_test_init();
+
+    /* Messages to the same destination are sent one at a time, in order: */
+    uint16_t seq_zero = sar_tx_start(SAR_TEST_PEER, 3);
+    TEST_ASSERT_EQUAL(3, m_sar_tx_segments);
+    (void) sar_tx_start(SAR_TEST_PEER, 2);
+    TEST_ASSERT_EQUAL(0, m_sar_tx_segments);
+    (void) sar_tx_start(SAR_TEST_PEER, 4);
+    TEST_ASSERT_EQUAL(0, m_sar_tx_segments);
+
+    segack_rx(seq_zero, 0x7);
+    TEST_ASSERT_EQUAL(1, m_sar_tx_complete_count);
+    TEST_ASSERT_EQUAL(2, m_sar_tx_segments);
+    seq_zero += 3;
+
+    /* Failing sessions also make room for the next one: */
+    segack_rx(seq_zero, 0);
+    TEST_ASSERT_EQUAL(1, m_sar_tx_failed_count);
+    TEST_ASSERT_EQUAL(4, m_sar_tx_segments);
+    seq_zero += 2;
+    segack_rx(seq_zero, 0xF);
+    TEST_ASSERT_EQUAL(2, m_sar_tx_complete_count);
+    TEST_ASSERT_EQUAL(0, m_sar_tx_segments);
+
+    /* Messages to different destinations share the network buffers as they become available: */
+    m_sar_tx_no_mem = true;
+    (void) sar_tx_start(SAR_TEST_PEER, 3);
+    (void) sar_tx_start(SAR_TEST_PEER + 1, 3);
+    m_sar_tx_no_mem = false;
+    m_sar_tx_segments = 0;
+    m_tx_complete_cb(CORE_TX_ROLE_ORIGINATOR, 0, m_time_now, NRF_MESH_SAR_TOKEN);
+    TEST_ASSERT_TRUE(m_sar_process_cb());
+    TEST_ASSERT_EQUAL(6, m_sar_tx_segments);
+    for (uint32_t i = 1; i < m_sar_tx_segments; ++i)
+    {
+        TEST_ASSERT_NOT_EQUAL(m_sar_tx_segment_dsts[i - 1], m_sar_tx_segment_dsts[i]);
+    }
+}
+
+/** Device key cache slots, as in a device state manager built with DSM_DEVKEY_CACHE_SIZE=2. */
+static nrf_mesh_application_secmat_t m_devkey_slots[2];
+static uint8_t m_expected_encryption_key[NRF_MESH_KEY_SIZE];
+static uint32_t m_encryptions;
+static void devkey_encrypt_callback(ccm_soft_data_t * const p_ccm_data, int calls)
+{
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(m_expected_encryption_key, p_ccm_data->p_key, NRF_MESH_KEY_SIZE);
+    m_encryptions++;
+}
+
+/** Starts sending a segmented device key message with the key in the given cache slot. */
+static uint16_t devkey_sar_tx_start(uint16_t dst, uint32_t slot)
+{
+    static const uint8_t data[2 * PACKET_MESH_TRS_SEG_ACCESS_PDU_MAX_SIZE - PACKET_MESH_TRS_TRANSMIC_SMALL_SIZE] = {0};
+    nrf_mesh_tx_params_t tx_params;
+    memset(&tx_params, 0, sizeof(tx_params));
+    tx_params.dst.type                     = NRF_MESH_ADDRESS_TYPE_UNICAST;
+    tx_params.dst.value                    = dst;
+    tx_params.src                          = SAR_TEST_DST;
+    tx_params.ttl                          = SAR_TX_TEST_TTL;
+    tx_params.force_segmented              = true;
+    tx_params.transmic_size                = NRF_MESH_TRANSMIC_SIZE_SMALL;
+    tx_params.p_data                       = data;
+    tx_params.data_len                     = sizeof(data);
+    tx_params.security_material.p_net      = &m_net_secmat;
+    tx_params.security_material.p_app      = &m_devkey_slots[slot];
+    tx_params.tx_token                     = TX_TOKEN;
+
+    uint16_t seq_zero = m_sar_tx_seqnum;
+    m_sar_tx_segments = 0;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, transport_tx(&tx_params, NULL));
+    return seq_zero;
+}
+
+void test_sar_tx_devkey_slot_reuse(void)
+{
+    sar_tx_test_init();
+    enc_nonce_generate_Ignore();
+    enc_aes_ccm_encrypt_StubWithCallback(devkey_encrypt_callback);
+    m_encryptions = 0;
+    for (uint32_t i = 0; i < ARRAY_SIZE(m_devkey_slots); ++i)
+    {
+        memset(m_devkey_slots[i].key, i + 1, NRF_MESH_KEY_SIZE);
+        m_devkey_slots[i].aid = 0;
+        m_devkey_slots[i].is_device_key = true;
+    }
+
+    /* The second message to the peer waits for the first one to end: */
+    memset(m_expected_encryption_key, 1, NRF_MESH_KEY_SIZE);
+    uint16_t seq_zero = devkey_sar_tx_start(SAR_TEST_PEER, 0);
+    TEST_ASSERT_EQUAL(2, m_sar_tx_segments);
+    TEST_ASSERT_EQUAL(1, m_encryptions);
+    (void) devkey_sar_tx_start(SAR_TEST_PEER, 1);
+    TEST_ASSERT_EQUAL(0, m_sar_tx_segments);
+    TEST_ASSERT_EQUAL(1, m_encryptions);
+
+    /* A third device key is loaded into the slot of the waiting message's key: */
+    memset(m_devkey_slots[1].key, 3, NRF_MESH_KEY_SIZE);
+
+    /* The waiting message is still encrypted with its own key when it starts: */
+    memset(m_expected_encryption_key, 2, NRF_MESH_KEY_SIZE);
+    segack_rx(seq_zero, 0x3);
+    TEST_ASSERT_EQUAL(1, m_sar_tx_complete_count);
+    TEST_ASSERT_EQUAL(2, m_sar_tx_segments);
+    TEST_ASSERT_EQUAL(2, m_encryptions);
+    segack_rx(seq_zero + 2, 0x3);
+    TEST_ASSERT_EQUAL(2, m_sar_tx_complete_count);
+}
+
+static uint32_t m_alloc_budget;
+static uint32_t ack_scheduling_alloc_callback(network_tx_packet_buffer_t * p_buf, int calls)
+{
+    if (m_alloc_budget == 0)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+    m_alloc_budget--;
+    if (p_buf->user_data.p_metadata->dst.value == SAR_TEST_PEER)
+    {
+        return sar_tx_alloc_callback(p_buf, calls);
+    }
+    return segack_alloc_callback(p_buf, calls);
+}
+
+void test_sar_ack_scheduling(void)
+{
+    sar_tx_test_init();
+    network_packet_alloc_StubWithCallback(ack_scheduling_alloc_callback);
+    m_alloc_budget = UINT32_MAX;
+    m_segack_count = 0;
+    const uint32_t ack_delay = TRANSPORT_SAR_RX_ACK_BASE_TIMEOUT_DEFAULT_US +
+                               TRANSPORT_SAR_RX_ACK_PER_HOP_ADDITION_DEFAULT_US * TRANSPORT_SAR_SEGACK_TTL_DEFAULT;
+
+    /* The acknowledgment timer of an RX session leaves the acknowledgment to the SAR processing: */
+    sar_segment_rx(0x0100, 0);
+    timer_event_t * p_ack_timer = mp_retry_timer;
+    p_ack_timer->cb(m_time_now, p_ack_timer->p_context);
+    TEST_ASSERT_EQUAL(0, m_segack_count);
+
+    /* Pending acknowledgments get the network buffers before new TX segments: */
+    m_alloc_budget = 0;
+    (void) sar_tx_start(SAR_TEST_PEER, 3);
+    TEST_ASSERT_EQUAL(0, m_sar_tx_segments);
+    m_alloc_budget = 1;
+    TEST_ASSERT_TRUE(m_sar_process_cb());
+    TEST_ASSERT_EQUAL(1, m_segack_count);
+    TEST_ASSERT_EQUAL_HEX32(0x1, last_segack_block_ack_get());
+    TEST_ASSERT_EQUAL(0, m_sar_tx_segments);
+    m_alloc_budget = UINT32_MAX;
+    TEST_ASSERT_TRUE(m_sar_process_cb());
+    TEST_ASSERT_EQUAL(1, m_segack_count);
+    TEST_ASSERT_EQUAL(3, m_sar_tx_segments);
+
+    /* A pending acknowledgment is superseded by the acknowledgment of the completed session: */
+    sar_segment_rx(0x0101, 0);
+    p_ack_timer = mp_retry_timer;
+    p_ack_timer->cb(m_time_now, p_ack_timer->p_context);
+    sar_segment_rx(0x0101, 1);
+    TEST_ASSERT_EQUAL(2, m_segack_count);
+    TEST_ASSERT_EQUAL_HEX32(0x3, last_segack_block_ack_get());
+    TEST_ASSERT_TRUE(m_sar_process_cb());
+    TEST_ASSERT_EQUAL(2, m_segack_count);
+
+    /* A burst of retransmitted segments is covered by the acknowledgment of the completed session: */
+    m_time_now += ack_delay - 1;
+    sar_segment_rx(0x0101, 0);
+    sar_segment_rx(0x0101, 1);
+    TEST_ASSERT_EQUAL(2, m_segack_count);
+
+    /* ...until the peer has had time to receive it, and retransmits again: */
+    m_time_now += 1;
+    sar_segment_rx(0x0101, 0);
+    TEST_ASSERT_EQUAL(3, m_segack_count);
+    TEST_ASSERT_EQUAL_HEX32(0x3, last_segack_block_ack_get());
+    sar_segment_rx(0x0101, 1);
+    TEST_ASSERT_EQUAL(3, m_segack_count);
+}
+
+#define SAR_STRESS_MESSAGES 200
+#define SAR_STRESS_ROUNDS_MAX 100000
+
+static uint32_t m_prng_state = 12345;
+static uint32_t prng_next(void)
+{
+    m_prng_state = m_prng_state * 1103515245u + 12345u;
+    return m_prng_state >> 16;
+}
+
+static uint8_t sar_stress_data_get(uint16_t src, uint32_t index)
+{
+    return (uint8_t) (src * 7 + index);
+}
+
+static uint16_t m_stress_completed_src;
+static void sar_stress_control_packet_handler(const transport_control_packet_t * p_rx_packet, const nrf_mesh_rx_metadata_t * p_rx_metadata)
+{
+    TEST_ASSERT_EQUAL(0, m_stress_completed_src);
+    for (uint32_t i = 0; i < p_rx_packet->data_len; ++i)
+    {
+        TEST_ASSERT_EQUAL_HEX8(sar_stress_data_get(p_rx_packet->src, i), p_rx_packet->p_data->pdu[i]);
+    }
+    m_stress_completed_src = p_rx_packet->src;
+}
+
+/* Reassembles a mix of short and long messages from concurrent sources, with segments arriving in a
+ * random order and duplicated, on an arena that can't hold the largest buffer for every session. */
+void test_sar_rx_stress(void)
+{
+    static const transport_control_packet_handler_t handler = {TRANSPORT_CONTROL_OPCODE_HEARTBEAT, sar_stress_control_packet_handler};
+    expect_init();
+    transport_init(NULL);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, transport_control_packet_consumer_add(&handler, 1));
+    replay_cache_has_elem_IgnoreAndReturn(false);
+    replay_cache_add_IgnoreAndReturn(NRF_SUCCESS);
+    nrf_mesh_rx_address_get_StubWithCallback(unicast_rx_address_get_callback);
+    network_packet_alloc_StubWithCallback(segack_alloc_callback);
+    network_packet_send_Ignore();
+    timer_now_IgnoreAndReturn(0);
+    timer_sch_reschedule_Ignore();
+    timer_sch_abort_Ignore();
+    net_state_iv_index_lock_Ignore();
+
+    struct
+    {
+        uint16_t src;
+        uint8_t last_segment;
+        uint16_t length;
+    } messages[TRANSPORT_SAR_SESSIONS_MAX];
+    uint32_t started = 0;
+    uint32_t completed = 0;
+    memset(messages, 0, sizeof(messages));
+
+    for (uint32_t round = 0; completed < SAR_STRESS_MESSAGES; ++round)
+    {
+        TEST_ASSERT_TRUE(round < SAR_STRESS_ROUNDS_MAX);
+
+        uint32_t slot = prng_next() % TRANSPORT_SAR_SESSIONS_MAX;
+        if (messages[slot].src == 0)
+        {
+            if (started == SAR_STRESS_MESSAGES)
+            {
+                continue;
+            }
+            messages[slot].src = 0x0100 + started++;
+            messages[slot].last_segment = (prng_next() & 1) ? 31 : 1;
+            messages[slot].length = messages[slot].last_segment * PACKET_MESH_TRS_SEG_CONTROL_PDU_MAX_SIZE +
+                                    1 + prng_next() % PACKET_MESH_TRS_SEG_CONTROL_PDU_MAX_SIZE;
+        }
+
+        uint8_t segment_offset = prng_next() % (messages[slot].last_segment + 1);
+        uint32_t data_offset = segment_offset * PACKET_MESH_TRS_SEG_CONTROL_PDU_MAX_SIZE;
+        uint8_t data[PACKET_MESH_TRS_SEG_CONTROL_PDU_MAX_SIZE];
+        uint32_t length = MIN(sizeof(data), messages[slot].length - data_offset);
+        for (uint32_t i = 0; i < length; ++i)
+        {
+            data[i] = sar_stress_data_get(messages[slot].src, data_offset + i);
+        }
+
+        m_stress_completed_src = 0;
+        sar_control_segment_rx(messages[slot].src, segment_offset, messages[slot].last_segment, data, length);
+        if (m_stress_completed_src != 0)
+        {
+            TEST_ASSERT_EQUAL_HEX16(messages[slot].src, m_stress_completed_src);
+            messages[slot].src = 0;
+            completed++;
+        }
+    }
+
+#if TRANSPORT_SAR_ARENA_ENABLED
+    /* All buffers have been returned, and the largest blocks have been in use for every session: */
+    sar_arena_stats_t stats;
+    sar_arena_stats_get(&stats);
+    TEST_ASSERT_EQUAL(0, stats.bytes_in_use);
+    TEST_ASSERT_EQUAL(MIN(TRANSPORT_SAR_ARENA_SEG32_BLOCKS, TRANSPORT_SAR_SESSIONS_MAX), stats.classes[SAR_ARENA_CLASS_COUNT - 1].high_water);
+    for (uint32_t i = 0; i < SAR_ARENA_CLASS_COUNT; ++i)
+    {
+        TEST_ASSERT_EQUAL(0, stats.classes[i].in_use);
+        TEST_ASSERT_TRUE(stats.classes[i].high_water <= stats.classes[i].block_count);
+    }
+    TEST_ASSERT_TRUE(stats.bytes_high_water > 0);
+#endif
+}
+
+static uint16_t m_cache_completed_src;
+static void sar_cache_control_packet_handler(const transport_control_packet_t * p_rx_packet, const nrf_mesh_rx_metadata_t * p_rx_metadata)
+{
+    TEST_ASSERT_EQUAL(0, m_cache_completed_src);
+    m_cache_completed_src = p_rx_packet->src;
+}
+
+/** Receives both segments of a control message with SeqZero equal to the source address, returns whether it was delivered. */
+static bool sar_cache_message_rx(uint16_t src)
+{
+    m_cache_completed_src = 0;
+    sar_segment_rx(src, 0);
+    sar_segment_rx(src, 1);
+    return (m_cache_completed_src == src);
+}
+
+void test_sar_rx_cache(void)
+{
+    static const transport_control_packet_handler_t handler = {TRANSPORT_CONTROL_OPCODE_HEARTBEAT, sar_cache_control_packet_handler};
+    expect_init();
+    transport_init(NULL);
+    sar_arena_use();
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, transport_control_packet_consumer_add(&handler, 1));
+    replay_cache_has_elem_IgnoreAndReturn(false);
+    replay_cache_add_IgnoreAndReturn(NRF_SUCCESS);
+    nrf_mesh_rx_address_get_StubWithCallback(unicast_rx_address_get_callback);
+    network_packet_alloc_StubWithCallback(segack_alloc_callback);
+    network_packet_send_Ignore();
+    timer_now_StubWithCallback(timer_now_callback);
+    timer_sch_reschedule_Ignore();
+    timer_sch_abort_Ignore();
+    net_state_iv_index_lock_Ignore();
+    m_time_now = 0;
+    m_segack_count = 0;
+
+    /* Fill the cache: */
+    for (uint16_t i = 0; i < TRANSPORT_SAR_RX_CACHE_LEN; ++i)
+    {
+        TEST_ASSERT_TRUE(sar_cache_message_rx(0x0100 + i));
+    }
+    TEST_ASSERT_EQUAL(TRANSPORT_SAR_RX_CACHE_LEN, m_segack_count);
+
+    /* Late segments of every cached session are acknowledged, without delivering the message again: */
+    m_cache_completed_src = 0;
+    for (uint16_t i = 0; i < TRANSPORT_SAR_RX_CACHE_LEN; ++i)
+    {
+        sar_segment_rx(0x0100 + i, 0);
+        TEST_ASSERT_EQUAL(TRANSPORT_SAR_RX_CACHE_LEN + i + 1, m_segack_count);
+        TEST_ASSERT_EQUAL_HEX32(0x3, last_segack_block_ack_get());
+    }
+    TEST_ASSERT_EQUAL(0, m_cache_completed_src);
+
+    /* A new session replaces the oldest one, which is reassembled again: */
+    TEST_ASSERT_TRUE(sar_cache_message_rx(0x0100 + TRANSPORT_SAR_RX_CACHE_LEN));
+    TEST_ASSERT_TRUE(sar_cache_message_rx(0x0100));
+    /* ...replacing the next one, that starts a new session without an acknowledgment: */
+    m_segack_count = 0;
+    m_cache_completed_src = 0;
+    sar_segment_rx(0x0101, 1);
+    TEST_ASSERT_EQUAL(0, m_cache_completed_src);
+    TEST_ASSERT_EQUAL(0, m_segack_count);
+
+    /* Sessions are forgotten once they have been in the cache for too long: */
+    m_time_now += MS_TO_US(TRANSPORT_SAR_RX_CACHE_TIMEOUT_MS) / 2;
+    TEST_ASSERT_TRUE(sar_cache_message_rx(0x1000));
+    m_time_now += MS_TO_US(TRANSPORT_SAR_RX_CACHE_TIMEOUT_MS) / 2 + 1;
+    m_segack_count = 0;
+    sar_segment_rx(0x0102, 0);
+    TEST_ASSERT_EQUAL(0, m_segack_count);
+    sar_segment_rx(0x1000, 0);
+    TEST_ASSERT_EQUAL(1, m_segack_count);
+    TEST_ASSERT_EQUAL_HEX32(0x3, last_segack_block_ack_get());
+
+    /* The cache is cleared by init: */
+    expect_init();
+    transport_init(NULL);
+    sar_arena_use();
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, transport_control_packet_consumer_add(&handler, 1));
+    TEST_ASSERT_TRUE(sar_cache_message_rx(0x1000));
+}
+
+static const nrf_mesh_application_secmat_t m_devkey_secmat;
+static void devkey_secmat_get_callback(uint16_t owner_addr, const nrf_mesh_application_secmat_t ** pp_devkey_secmat, int calls)
+{
+    TEST_ASSERT_EQUAL_HEX16(SAR_TEST_DST, owner_addr);
+    *pp_devkey_secmat = &m_devkey_secmat;
+}
+
+static const uint8_t * mp_in_place_decrypt_out;
+static void in_place_decrypt_callback(ccm_soft_data_t * const p_ccm_data, bool * const p_mic_passed, int calls)
+{
+    TEST_ASSERT_EQUAL_PTR(p_ccm_data->p_m, p_ccm_data->p_out);
+    TEST_ASSERT_EQUAL_PTR(p_ccm_data->p_m + p_ccm_data->m_len, p_ccm_data->p_mic);
+    for (uint32_t i = 0; i < p_ccm_data->m_len; ++i)
+    {
+        p_ccm_data->p_out[i] ^= 0xFF;
+    }
+    mp_in_place_decrypt_out = p_ccm_data->p_out;
+    *p_mic_passed = true;
+}
+
+/* The message buffer is only valid during the event, and is copied out for verification. */
+static uint8_t m_rx_message[16];
+static void in_place_event_handle_callback(const nrf_mesh_evt_t * p_evt, int calls)
+{
+    event_handle_callback(p_evt, calls);
+    TEST_ASSERT_TRUE(p_evt->params.message.length <= sizeof(m_rx_message));
+    memcpy(m_rx_message, p_evt->params.message.p_buffer, p_evt->params.message.length);
+}
+
+/* Reassembled access messages are decrypted in the SAR buffer, and delivered from there. */
+void test_sar_access_rx_in_place(void)
+{
+    expect_init();
+    transport_init(NULL);
+    replay_cache_has_elem_IgnoreAndReturn(false);
+    replay_cache_add_IgnoreAndReturn(NRF_SUCCESS);
+    nrf_mesh_rx_address_get_StubWithCallback(unicast_rx_address_get_callback);
+    network_packet_alloc_StubWithCallback(segack_alloc_callback);
+    network_packet_send_Ignore();
+    timer_now_IgnoreAndReturn(0);
+    timer_sch_reschedule_Ignore();
+    timer_sch_abort_Ignore();
+    net_state_iv_index_lock_Ignore();
+    enc_nonce_generate_Ignore();
+    nrf_mesh_devkey_secmat_get_StubWithCallback(devkey_secmat_get_callback);
+    enc_aes_ccm_decrypt_StubWithCallback(in_place_decrypt_callback);
+    event_handle_StubWithCallback(in_place_event_handle_callback);
+    memset(&m_rx_evt, 0, sizeof(m_rx_evt));
+    mp_in_place_decrypt_out = NULL;
+
+    /* 16 bytes of access payload and a 4 byte MIC, in a 12 and an 8 byte segment: */
+    uint8_t ciphertext[20];
+    for (uint32_t i = 0; i < sizeof(ciphertext); ++i)
+    {
+        ciphertext[i] = (uint8_t) ~i;
+    }
+
+    for (uint8_t segment = 0; segment < 2; ++segment)
+    {
+        network_packet_metadata_t net_meta;
+        memset(&net_meta, 0, sizeof(net_meta));
+        net_meta.dst.type = NRF_MESH_ADDRESS_TYPE_UNICAST;
+        net_meta.dst.value = SAR_TEST_DST;
+        net_meta.src = SAR_TEST_PEER;
+        net_meta.ttl = 1;
+        net_meta.internal.sequence_number = 0x10 + segment;
+        net_meta.p_security_material = &m_net_secmat;
+
+        uint32_t length = (segment == 0) ? PACKET_MESH_TRS_SEG_ACCESS_PDU_MAX_SIZE : 8;
+        packet_mesh_trs_packet_t transport_packet;
+        memset(&transport_packet, 0, sizeof(transport_packet));
+        packet_mesh_trs_common_seg_set(&transport_packet, true);
+        packet_mesh_trs_access_akf_set(&transport_packet, false);
+        packet_mesh_trs_seg_szmic_set(&transport_packet, false);
+        packet_mesh_trs_seg_seqzero_set(&transport_packet, 0x10);
+        packet_mesh_trs_seg_sego_set(&transport_packet, segment);
+        packet_mesh_trs_seg_segn_set(&transport_packet, 1);
+        memcpy(packet_mesh_trs_seg_payload_get(&transport_packet),
+               &ciphertext[segment * PACKET_MESH_TRS_SEG_ACCESS_PDU_MAX_SIZE],
+               length);
+        TEST_ASSERT_EQUAL(NRF_SUCCESS,
+                          transport_packet_in(&transport_packet, PACKET_MESH_TRS_SEG_PDU_OFFSET + length, &net_meta, &m_rx_meta));
+    }
+
+    TEST_ASSERT_NOT_NULL(mp_in_place_decrypt_out);
+    TEST_ASSERT_EQUAL_PTR(mp_in_place_decrypt_out, m_rx_evt.params.message.p_buffer);
+    TEST_ASSERT_EQUAL(16, m_rx_evt.params.message.length);
+    TEST_ASSERT_EQUAL_PTR(&m_devkey_secmat, m_rx_evt.params.message.secmat.p_app);
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        TEST_ASSERT_EQUAL_HEX8(i, m_rx_message[i]);
+    }
+}
+
+/* Unsegmented access messages are decrypted in the network layer's buffer, and delivered from there. */
+void test_unseg_access_rx_in_place(void)
+{
+    expect_init();
+    transport_init(NULL);
+    replay_cache_has_elem_IgnoreAndReturn(false);
+    replay_cache_add_IgnoreAndReturn(NRF_SUCCESS);
+    nrf_mesh_rx_address_get_StubWithCallback(unicast_rx_address_get_callback);
+    enc_nonce_generate_Ignore();
+    nrf_mesh_devkey_secmat_get_StubWithCallback(devkey_secmat_get_callback);
+    enc_aes_ccm_decrypt_StubWithCallback(in_place_decrypt_callback);
+    event_handle_StubWithCallback(in_place_event_handle_callback);
+    memset(&m_rx_evt, 0, sizeof(m_rx_evt));
+
+    network_packet_metadata_t net_meta;
+    memset(&net_meta, 0, sizeof(net_meta));
+    net_meta.dst.type = NRF_MESH_ADDRESS_TYPE_UNICAST;
+    net_meta.dst.value = SAR_TEST_DST;
+    net_meta.src = SAR_TEST_PEER;
+    net_meta.ttl = 1;
+    net_meta.p_security_material = &m_net_secmat;
+
+    /* 11 bytes of access payload and a 4 byte MIC: */
+    packet_mesh_trs_packet_t transport_packet;
+    memset(&transport_packet, 0, sizeof(transport_packet));
+    packet_mesh_trs_common_seg_set(&transport_packet, false);
+    packet_mesh_trs_access_akf_set(&transport_packet, false);
+    uint8_t * p_payload = (uint8_t *) packet_mesh_trs_unseg_payload_get(&transport_packet);
+    for (uint32_t i = 0; i < PACKET_MESH_TRS_UNSEG_ACCESS_PDU_MAX_SIZE; ++i)
+    {
+        p_payload[i] = (uint8_t) ~i;
+    }
+    TEST_ASSERT_EQUAL(NRF_SUCCESS,
+                      transport_packet_in(&transport_packet,
+                                          PACKET_MESH_TRS_UNSEG_PDU_OFFSET + PACKET_MESH_TRS_UNSEG_ACCESS_PDU_MAX_SIZE,
+                                          &net_meta,
+                                          &m_rx_meta));
+
+    TEST_ASSERT_EQUAL_PTR(p_payload, m_rx_evt.params.message.p_buffer);
+    TEST_ASSERT_EQUAL(PACKET_MESH_TRS_UNSEG_ACCESS_PDU_MAX_SIZE - PACKET_MESH_TRS_TRANSMIC_SMALL_SIZE, m_rx_evt.params.message.length);
+    for (uint32_t i = 0; i < m_rx_evt.params.message.length; ++i)
+    {
+        TEST_ASSERT_EQUAL_HEX8(i, m_rx_message[i]);
+    }
+}
+
+void test_transport_stats(void)
+{
+    sar_tx_test_init();
+    const uint16_t rx_peer = 0x0005;
+    transport_stats_t stats;
+    transport_peer_stats_t peer_stats;
+
+    transport_stats_get(&stats);
+    TEST_ASSERT_EQUAL(0, stats.segments_tx);
+    TEST_ASSERT_EQUAL(NRF_ERROR_NOT_FOUND, transport_peer_stats_get(0, &peer_stats));
+
+    /* A partial acknowledgment after 40 ms triggers a single retransmission: */
+    uint16_t seq_zero = sar_tx_start(SAR_TEST_PEER, 3);
+    m_time_now += MS_TO_US(40);
+    segack_rx(seq_zero, 0x5);
+    segack_rx(seq_zero, 0x7);
+    TEST_ASSERT_EQUAL(1, m_sar_tx_complete_count);
+
+    /* The peer cancels the next session: */
+    seq_zero = sar_tx_start(SAR_TEST_PEER, 2);
+    segack_rx(seq_zero, 0);
+    TEST_ASSERT_EQUAL(1, m_sar_tx_failed_count);
+
+    /* Another peer sends a two segment message, which is acknowledged once complete: */
+    sar_segment_rx(rx_peer, 0);
+    sar_segment_rx(rx_peer, 1);
+
+    /* Replay rejections are counted for known peers only: */
+    replay_cache_has_elem_IgnoreAndReturn(true);
+    segack_rx(seq_zero, 0x3);
+    sar_segment_rx(0x0007, 0);
+
+    transport_stats_get(&stats);
+    TEST_ASSERT_EQUAL(3 + 1 + 2, stats.segments_tx);
+    TEST_ASSERT_EQUAL(2, stats.segments_rx);
+    TEST_ASSERT_EQUAL(1, stats.retransmissions);
+    TEST_ASSERT_EQUAL(0, stats.segments_dropped);
+    TEST_ASSERT_EQUAL(1, stats.sessions_tx_completed);
+    TEST_ASSERT_EQUAL(1, stats.sessions_rx_completed);
+    for (uint32_t i = 0; i < TRANSPORT_SAR_CANCEL_REASON_COUNT; ++i)
+    {
+        TEST_ASSERT_EQUAL((i == NRF_MESH_SAR_CANCEL_BY_PEER) ? 1 : 0, stats.sessions_cancelled[i]);
+    }
+    for (uint32_t i = 0; i < TRANSPORT_SAR_ACK_LATENCY_BIN_COUNT; ++i)
+    {
+        /* 40 ms is in the second bin, from 32 to 64 ms: */
+        TEST_ASSERT_EQUAL((i == 1) ? 1 : 0, stats.ack_latency[i]);
+    }
+    TEST_ASSERT_EQUAL(2, stats.replay_rejections);
+
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, transport_peer_stats_get(0, &peer_stats));
+    TEST_ASSERT_EQUAL_HEX16(SAR_TEST_PEER, peer_stats.address);
+    TEST_ASSERT_EQUAL(3 + 1 + 2, peer_stats.segments_tx);
+    TEST_ASSERT_EQUAL(0, peer_stats.segments_rx);
+    TEST_ASSERT_EQUAL(1, peer_stats.retransmissions);
+    TEST_ASSERT_EQUAL(1, peer_stats.sessions_completed);
+    TEST_ASSERT_EQUAL(1, peer_stats.sessions_cancelled);
+    TEST_ASSERT_EQUAL(1, peer_stats.replay_rejections);
+
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, transport_peer_stats_get(1, &peer_stats));
+    TEST_ASSERT_EQUAL_HEX16(rx_peer, peer_stats.address);
+    TEST_ASSERT_EQUAL(0, peer_stats.segments_tx);
+    TEST_ASSERT_EQUAL(2, peer_stats.segments_rx);
+    TEST_ASSERT_EQUAL(1, peer_stats.sessions_completed);
+    TEST_ASSERT_EQUAL(0, peer_stats.replay_rejections);
+
+    TEST_ASSERT_EQUAL(NRF_ERROR_NOT_FOUND, transport_peer_stats_get(2, &peer_stats));
+    TEST_ASSERT_EQUAL(NRF_ERROR_NOT_FOUND, transport_peer_stats_get(TRANSPORT_PEER_STATS_COUNT, &peer_stats));
+    TEST_ASSERT_EQUAL(NRF_ERROR_NULL, transport_peer_stats_get(0, NULL));
+}
@@ -27,7 +27,7 @@
 # ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 # POSSIBILITY OF SUCH DAMAGE.
 
-# This file was autogenerated by serial_doc_gen_pyaci.py at 2018-07-20 10:42:08.
+# This file was autogenerated by serial_doc_gen_pyaci.py at 2026-10-17 03:15:06.
 from aci.aci_utils import CommandPacket, ResponsePacket, value_to_barray, iterable_to_barray, barray_pop
 from aci.aci_evt import CmdRsp
 import struct
@@ -920,6 +920,31 @@ class StateClear(CommandPacket):
         super(StateClear, self).__init__(0xAC, __data)
 
 
+class TransportStatsGet(CommandPacket):
+    """Get the aggregate transport layer statistics, including the application key trial
+    decryption counters. All counters are reset when the transport layer is initialized.
+    """
+    def __init__(self):
+        __data = bytearray()
+        super(TransportStatsGet, self).__init__(0xAD, __data)
+
+
+class TransportPeerStatsGet(CommandPacket):
+    """Get the transport layer statistics of one of the peers that most recently exchanged
+    segments with the device. Iterate the index from 0 until the command is rejected to get
+    all peers.
+
+    Parameters
+    ----------
+        index : uint8_t
+            Index of the peer statistics entry to get.
+    """
+    def __init__(self, index):
+        __data = bytearray()
+        __data += struct.pack("<B", index)
+        super(TransportPeerStatsGet, self).__init__(0xAE, __data)
+
+
 class JumpToBootloader(CommandPacket):
     """Immediately jump to bootloader mode."""
     def __init__(self):
@@ -1680,6 +1705,38 @@ class AddrPublicationRemoveRsp(ResponsePacket):
         super(AddrPublicationRemoveRsp, self).__init__("AddrPublicationRemove", 0xA6, __data)
 
 
+class TransportStatsGetRsp(ResponsePacket):
+    """Response to a(n) TransportStatsGet command."""
+    def __init__(self, raw_data):
+        __data = {}
+        __data["segments_tx"], = struct.unpack("<I", raw_data[0:4])
+        __data["segments_rx"], = struct.unpack("<I", raw_data[4:8])
+        __data["retransmissions"], = struct.unpack("<I", raw_data[8:12])
+        __data["segments_dropped"], = struct.unpack("<I", raw_data[12:16])
+        __data["sessions_tx_completed"], = struct.unpack("<I", raw_data[16:20])
+        __data["sessions_rx_completed"], = struct.unpack("<I", raw_data[20:24])
+        __data["sessions_cancelled"] = raw_data[24:48]
+        __data["ack_latency"] = raw_data[48:80]
+        __data["replay_rejections"], = struct.unpack("<I", raw_data[80:84])
+        __data["decrypt_messages"], = struct.unpack("<I", raw_data[84:88])
+        __data["decrypt_attempts"], = struct.unpack("<I", raw_data[88:92])
+        super(TransportStatsGetRsp, self).__init__("TransportStatsGet", 0xAD, __data)
+
+
+class TransportPeerStatsGetRsp(ResponsePacket):
+    """Response to a(n) TransportPeerStatsGet command."""
+    def __init__(self, raw_data):
+        __data = {}
+        __data["address"], = struct.unpack("<H", raw_data[0:2])
+        __data["segments_tx"], = struct.unpack("<I", raw_data[2:6])
+        __data["segments_rx"], = struct.unpack("<I", raw_data[6:10])
+        __data["retransmissions"], = struct.unpack("<I", raw_data[10:14])
+        __data["sessions_completed"], = struct.unpack("<I", raw_data[14:18])
+        __data["sessions_cancelled"], = struct.unpack("<I", raw_data[18:22])
+        __data["replay_rejections"], = struct.unpack("<I", raw_data[22:26])
+        super(TransportPeerStatsGetRsp, self).__init__("TransportPeerStatsGet", 0xAE, __data)
+
+
 class BankInfoGetRsp(ResponsePacket):
     """Response to a(n) BankInfoGet command."""
     def __init__(self, raw_data):
@@ -1867,6 +1924,8 @@ RESPONSE_LUT = {
     0xA4: {"object": AddrPublicationAddRsp, "name": "AddrPublicationAdd"},
     0xA5: {"object": AddrPublicationAddVirtualRsp, "name": "AddrPublicationAddVirtual"},
     0xA6: {"object": AddrPublicationRemoveRsp, "name": "AddrPublicationRemove"},
+    0xAD: {"object": TransportStatsGetRsp, "name": "TransportStatsGet"},
+    0xAE: {"object": TransportPeerStatsGetRsp, "name": "TransportPeerStatsGet"},
     0xD4: {"object": BankInfoGetRsp, "name": "BankInfoGet"},
     0xD6: {"object": StateGetRsp, "name": "StateGet"},
     0xE1: {"object": ModelPubAddrGetRsp, "name": "ModelPubAddrGet"},